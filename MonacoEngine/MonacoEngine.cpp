@@ -15,6 +15,34 @@
 #include "DepthStencilView.h"
 #include "Viewport.h"
 #include "ShaderProgram.h"
+#include "ShaderCache.h"
+#include "ShaderCompiler.h"
+#include "ShaderPermutations.h"
+#include "ShaderHotReload.h"
+#include "PipelineStateCache.h"
+#include "SoftwareRasterizer.h"
+#include "CommandList.h"
+#include "ThreadPool.h"
+#include "ConstantBufferRing.h"
+#include "RingAllocator.h"
+#include "RenderQueue.h"
+#include "InstanceBatcher.h"
+#include "GeometryPool.h"
+#include "BuddyAllocator.h"
+#include "UploadManager.h"
+#include "UploadQueue.h"
+#include "ImageDecoder.h"
+#include "BlockCompressor.h"
+#include "TextureStreamer.h"
+#include "TextureResidency.h"
+#include "TextureAtlas.h"
+#include "ObjLoader.h"
+#include "GltfScene.h"
+#include "FramePacer.h"
+#include "RenderTargetPool.h"
+#include "RenderGraph.h"
+#include "MeshComponent.h"
+#include "InputLayout.h"
 //--------------------------------------------------------------------------------------
 // Global Variables
 //--------------------------------------------------------------------------------------
@@ -28,20 +56,92 @@ RenderTargetView									  g_renderTargetView;
 Texture                             g_depthStencil;
 DepthStencilView									  g_depthStencilView;
 Viewport                            g_viewport;
-ShaderProgram												g_shaderProgram;
+// Bytecode compilado en disco; solo se recompila lo que cambi (tambin por includes)
+ShaderCache                         g_shaderCache;
+// Compila en paralelo los shaders del arranque
+ShaderCompiler                      g_shaderCompiler;
+// Variantes del material de la rejilla instanciada; se compilan en segundo plano al pedirlas
+ShaderPermutations                  g_shaderPermutations;
+unsigned int                        g_instancedVariant = 0;
+// Recompila en segundo plano los .fx que se editan y los cambia entre frames
+ShaderHotReload                     g_shaderHotReload;
+// Shaders, input layouts y estados fijos se crean una vez; los draws usan un handle
+PipelineStateCache                  g_pipelineStateCache;
+unsigned int                        g_cubePipelineState = kInvalidPipelineState;
 
 
 ID3D11Buffer* g_pVertexBuffer = NULL;
 ID3D11Buffer* g_pIndexBuffer = NULL;
 ID3D11Buffer* g_pCBNeverChanges = NULL;
 ID3D11Buffer* g_pCBChangeOnResize = NULL;
-ID3D11Buffer* g_pCBChangesEveryFrame = NULL;
+// seafloor.dds se carga por mips segn el tamao del cubo en pantalla; g_pTextureRV es su
+// vista del frame. "-texbudget N" limita a N MB la memoria de las texturas en streaming
+TextureStreamer                     g_textureStreamer;
+unsigned int                        g_seafloorTexture = TextureResidency::kInvalidHandle;
+unsigned long long                  g_textureBudget = 64ull * 1024 * 1024;
 ID3D11ShaderResourceView* g_pTextureRV = NULL;
-ID3D11SamplerState* g_pSamplerLinear = NULL;
 XMMATRIX                            g_World;
 XMMATRIX                            g_View;
 XMMATRIX                            g_Projection;
 XMFLOAT4                            g_vMeshColor(0.7f, 0.7f, 0.7f, 1.0f);
+// CBChangesEveryFrame se escribe en un chunk nuevo del anillo por cada draw
+ConstantBufferRing                  g_constantBufferRing;
+// Los draws del frame se ordenan por llave antes de enviarse
+RenderQueue                         g_renderQueue;
+// "-sortbench N": mide el ordenamiento de N llaves de la cola y termina
+unsigned int                        g_sortBenchmarkItems = 0;
+// "-instances N": N copias del cubo con un solo DrawIndexedInstanced
+unsigned int                        g_instancedPipelineState = kInvalidPipelineState;
+InstanceBatcher                     g_instanceBatcher;
+MeshComponent                       g_cubeMesh;
+unsigned int                        g_instanceCount = 0;
+// Subidas de datos repartidas entre frames con un presupuesto de bytes
+UploadManager                       g_uploadManager;
+// Vrtices e ndices de las mallas en buffers compartidos; el cubo se dibuja desde su rango
+GeometryPool                        g_geometryPool;
+unsigned int                        g_cubeGeometry = GeometryPool::kInvalidHandle;
+// MonacoEngine.jpg se decodifica en segundo plano y se sube por el UploadManager; la rejilla
+// instanciada lo usa cuando llega a la GPU
+ImageDecoder                        g_imageDecoder;
+Texture                             g_logoTexture;
+bool                                g_logoReady = false;
+// "-atlas": la rejilla toma cada cubo de una regin de un atlas (un solo SRV); el logo entra
+// cuando termina de decodificarse. La demo solo usa las regiones de la primera pgina
+TextureAtlas                        g_textureAtlas;
+bool                                g_useAtlas = false;
+std::vector<XMFLOAT4>               g_atlasRegions;
+// "-decodebench N": decodifica N veces MonacoEngine.jpg con 1..ncleos hilos, mide sus mips y termina
+unsigned int                        g_decodeBenchmarkImages = 0;
+// "-bcbench N": comprime N veces MonacoEngine.jpg a BC1/BC3/BC5/BC7, escribe MonacoEngine.dds y termina
+unsigned int                        g_blockCompressionBenchmarkRuns = 0;
+// "-objbench N": carga ObjBenchmark.obj (lo genera de unos N MB si no existe) en un hilo y en todos y termina
+unsigned int                        g_objBenchmarkMegabytes = 0;
+// "-gltfbench N": carga GltfBenchmark.glb (lo genera con N nodos si no existe) en un hilo y en todos y termina
+unsigned int                        g_gltfBenchmarkNodes = 0;
+
+// Modo sin ventana ni GPU ("-headless [frames]") para medir el costo de CPU de Render()
+bool                                g_headless = false;
+unsigned int                        g_headlessFrames = 1000;
+// Backend en CPU ("-headless [frames] -software"); "-threads N" limita los hilos de trabajo; guarda el ltimo frame en un TGA
+SoftwareRasterizer                  g_softwareRasterizer;
+bool                                g_software = false;
+unsigned int                        g_workerThreads = 0;
+// Grabacin en paralelo ("-commandlists N"): cada lista dibuja una copia del cubo
+std::vector<std::unique_ptr<CommandList>> g_commandLists;
+ThreadPool                          g_threadPool;
+unsigned int                        g_commandListCount = 0;
+// Ritmo de frames: "-fps N" limita los frames por segundo, "-vsync N" y "-latency N" frames en vuelo
+SystemPresentClock                  g_presentClock;
+FramePacerDesc                      g_framePacerDesc;
+FramePacer                          g_framePacer;
+// Pases del frame: enlaza y limpia los render targets solo cuando hace falta
+RenderTargetPool                    g_renderTargetPool;
+RenderGraph                         g_renderGraph;
+// "Scene" dibuja en una textura transitoria con MSAA; "Composite" la lee y la resuelve en el
+// back buffer con un quad en espacio de clip
+unsigned int                        g_compositePipelineState = kInvalidPipelineState;
+MeshComponent                       g_fullscreenMesh;
+unsigned int                        g_fullscreenGeometry = GeometryPool::kInvalidHandle;
 
 
 //--------------------------------------------------------------------------------------
@@ -51,6 +151,16 @@ HRESULT InitDevice();
 void CleanupDevice();
 LRESULT CALLBACK    WndProc(HWND, UINT, WPARAM, LPARAM);
 void Render();
+void RenderScene();
+void RenderComposite(DeviceContext& context, ID3D11ShaderResourceView* sceneColor);
+void RenderCommandLists();
+int RunHeadless();
+int RunSortBenchmark();
+int RunDecodeBenchmark();
+int RunBlockCompressionBenchmark();
+int RunObjBenchmark();
+int RunGltfBenchmark();
+int RunSelfTest();
 
 
 //--------------------------------------------------------------------------------------
@@ -60,7 +170,80 @@ void Render();
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow)
 {
 	UNREFERENCED_PARAMETER(hPrevInstance);
-	UNREFERENCED_PARAMETER(lpCmdLine);
+
+	const wchar_t* sortBenchArg = lpCmdLine ? wcsstr(lpCmdLine, L"-sortbench") : nullptr;
+	if (sortBenchArg) {
+		g_sortBenchmarkItems = wcstoul(sortBenchArg + wcslen(L"-sortbench"), nullptr, 10);
+		return RunSortBenchmark();
+	}
+
+	const wchar_t* decodeBenchArg = lpCmdLine ? wcsstr(lpCmdLine, L"-decodebench") : nullptr;
+	if (decodeBenchArg) {
+		g_decodeBenchmarkImages = wcstoul(decodeBenchArg + wcslen(L"-decodebench"), nullptr, 10);
+		return RunDecodeBenchmark();
+	}
+
+	const wchar_t* bcBenchArg = lpCmdLine ? wcsstr(lpCmdLine, L"-bcbench") : nullptr;
+	if (bcBenchArg) {
+		g_blockCompressionBenchmarkRuns = wcstoul(bcBenchArg + wcslen(L"-bcbench"), nullptr, 10);
+		return RunBlockCompressionBenchmark();
+	}
+
+	const wchar_t* objBenchArg = lpCmdLine ? wcsstr(lpCmdLine, L"-objbench") : nullptr;
+	if (objBenchArg) {
+		g_objBenchmarkMegabytes = wcstoul(objBenchArg + wcslen(L"-objbench"), nullptr, 10);
+		return RunObjBenchmark();
+	}
+
+	const wchar_t* gltfBenchArg = lpCmdLine ? wcsstr(lpCmdLine, L"-gltfbench") : nullptr;
+	if (gltfBenchArg) {
+		g_gltfBenchmarkNodes = wcstoul(gltfBenchArg + wcslen(L"-gltfbench"), nullptr, 10);
+		return RunGltfBenchmark();
+	}
+
+	// "-selftest": comprueba en CPU, con resultados calculados a mano, las piezas que no usan Direct3D
+	if (lpCmdLine && wcsstr(lpCmdLine, L"-selftest"))
+		return RunSelfTest();
+
+	const wchar_t* fpsArg = lpCmdLine ? wcsstr(lpCmdLine, L"-fps") : nullptr;
+	if (fpsArg)
+		g_framePacerDesc.targetFps = wcstod(fpsArg + wcslen(L"-fps"), nullptr);
+	const wchar_t* vsyncArg = lpCmdLine ? wcsstr(lpCmdLine, L"-vsync") : nullptr;
+	if (vsyncArg)
+		g_framePacerDesc.vsyncInterval = wcstoul(vsyncArg + wcslen(L"-vsync"), nullptr, 10);
+	const wchar_t* latencyArg = lpCmdLine ? wcsstr(lpCmdLine, L"-latency") : nullptr;
+	if (latencyArg) {
+		// DXGI acepta de 1 a 16 frames de latencia; un valor invlido no debe impedir el arranque
+		unsigned int latency = wcstoul(latencyArg + wcslen(L"-latency"), nullptr, 10);
+		if (latency >= 1 && latency <= 16)
+			g_framePacerDesc.framesInFlight = latency;
+		else
+			MESSAGE("Main", "wWinMain",
+				("Invalid -latency value, using " + std::to_string(g_framePacerDesc.framesInFlight) + " frames in flight").c_str());
+	}
+	const wchar_t* textureBudgetArg = lpCmdLine ? wcsstr(lpCmdLine, L"-texbudget") : nullptr;
+	if (textureBudgetArg)
+		g_textureBudget = static_cast<unsigned long long>(wcstoul(textureBudgetArg + wcslen(L"-texbudget"), nullptr, 10)) * 1024 * 1024;
+
+	const wchar_t* headlessArg = lpCmdLine ? wcsstr(lpCmdLine, L"-headless") : nullptr;
+	if (headlessArg) {
+		g_headless = true;
+		unsigned int frames = wcstoul(headlessArg + wcslen(L"-headless"), nullptr, 10);
+		if (frames > 0)
+			g_headlessFrames = frames;
+		g_software = wcsstr(lpCmdLine, L"-software") != nullptr;
+		const wchar_t* threadsArg = wcsstr(lpCmdLine, L"-threads");
+		if (threadsArg)
+			g_workerThreads = wcstoul(threadsArg + wcslen(L"-threads"), nullptr, 10);
+		const wchar_t* listsArg = wcsstr(lpCmdLine, L"-commandlists");
+		if (listsArg)
+			g_commandListCount = wcstoul(listsArg + wcslen(L"-commandlists"), nullptr, 10);
+		const wchar_t* instancesArg = wcsstr(lpCmdLine, L"-instances");
+		if (instancesArg)
+			g_instanceCount = wcstoul(instancesArg + wcslen(L"-instances"), nullptr, 10);
+		g_useAtlas = wcsstr(lpCmdLine, L"-atlas") != nullptr;
+		return RunHeadless();
+	}
 
 	if (FAILED(g_window.init(hInstance, nCmdShow, WndProc)))
 		return 0;
@@ -93,6 +276,914 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 
 
 
+//--------------------------------------------------------------------------------------
+// Render frames without a window or GPU and report the recorded call statistics
+//--------------------------------------------------------------------------------------
+int RunHeadless()
+{
+	// Mismo tamao de cliente que crea Window::init
+	g_window.m_width = 1200;
+	g_window.m_height = 950;
+
+	if (FAILED(InitDevice()))
+	{
+		CleanupDevice();
+		return 0;
+	}
+
+	if (g_commandListCount > 0)
+	{
+		if (FAILED(g_threadPool.init(g_workerThreads)))
+		{
+			CleanupDevice();
+			return 0;
+		}
+		for (unsigned int i = 0; i < g_commandListCount; ++i)
+		{
+			g_commandLists.push_back(std::make_unique<CommandList>());
+			if (FAILED(g_commandLists.back()->init(g_device, g_deviceContext)))
+			{
+				CleanupDevice();
+				return 0;
+			}
+		}
+	}
+
+	// Solo interesa el costo por frame, no el de la inicializacin
+	g_deviceContext.m_stats.reset();
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (unsigned int frame = 0; frame < g_headlessFrames; ++frame)
+	{
+		Render();
+	}
+	auto elapsed = std::chrono::high_resolution_clock::now() - start;
+	double totalMs = std::chrono::duration<double, std::milli>(elapsed).count();
+
+	std::ostringstream os;
+	os << "Headless run: " << g_headlessFrames << " frames, " << totalMs << " ms total, "
+		<< (totalMs / g_headlessFrames) << " ms/frame\n";
+	os << g_device.m_stats.report("Device");
+	os << g_deviceContext.m_stats.report("DeviceContext");
+	if (!g_commandLists.empty()) {
+		os << "Command lists: " << g_commandLists.size()
+			<< (g_commandLists[0]->isDeferred() ? " (deferred contexts)\n" : " (portable stream)\n");
+	}
+	os << g_constantBufferRing.report();
+	os << "Render queue: " << g_renderQueue.m_stats.draws << " draws, "
+		<< g_renderQueue.m_stats.programChanges << " program changes, "
+		<< g_renderQueue.m_stats.textureChanges << " texture changes in last frame\n";
+	os << g_framePacer.report();
+	os << "Render graph: " << g_renderGraph.m_stats.passes << " passes, "
+		<< g_renderGraph.m_stats.culledPasses << " culled, "
+		<< g_renderGraph.m_stats.transientTextures << " transient textures on "
+		<< g_renderGraph.m_stats.physicalTextures << " physical, "
+		<< g_renderGraph.m_stats.renderTargetBinds << " target binds, "
+		<< g_renderGraph.m_stats.clears << " clears in last frame\n";
+	os << g_renderTargetPool.report();
+	os << g_pipelineStateCache.report();
+	os << g_shaderCache.report();
+	os << g_shaderCompiler.report();
+	os << g_shaderHotReload.report();
+	if (g_instanceCount > 0)
+		os << g_shaderPermutations.report();
+	os << g_uploadManager.report();
+	os << g_imageDecoder.report();
+	os << g_textureStreamer.report();
+	if (g_useAtlas)
+		os << g_textureAtlas.report();
+	os << "Geometry pool: " << g_geometryPool.meshCount() << " meshes, "
+		<< g_geometryPool.vertexAllocator().usedSize() << "/" << g_geometryPool.vertexAllocator().capacity() << " vertices, "
+		<< g_geometryPool.indexAllocator().usedSize() << "/" << g_geometryPool.indexAllocator().capacity() << " indices\n";
+	if (g_instanceCount > 0) {
+		os << "Instancing: " << g_instanceBatcher.instanceCount() << " instances in "
+			<< g_instanceBatcher.drawCount() << " draw calls per frame\n";
+	}
+	if (g_software) {
+		os << "Software rasterizer: " << g_softwareRasterizer.m_trianglesDrawn << " triangles in last frame\n";
+		g_softwareRasterizer.saveToFile("MonacoEngine_software.tga");
+	}
+	OutputDebugStringA(os.str().c_str());
+	printf("%s", os.str().c_str());
+
+	CleanupDevice();
+	return 0;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Time the render queue radix sort against std::sort on random draw keys
+//--------------------------------------------------------------------------------------
+int RunSortBenchmark()
+{
+	unsigned int count = g_sortBenchmarkItems > 0 ? g_sortBenchmarkItems : 100000;
+	const unsigned int iterations = 20;
+
+	// Llaves con la misma distribucin que genera la cola: pocos programas y texturas
+	std::mt19937 random(1234);
+	std::vector<unsigned long long> source(count);
+	for (unsigned long long& key : source)
+	{
+		key = RenderQueue::makeKey(random() % 4,
+			1 + random() % 32,
+			1 + random() % 256,
+			(random() % 10000) / 10000.0f,
+			random() % 8 == 0);
+	}
+
+	std::vector<unsigned long long> keys, keyScratch;
+	std::vector<unsigned int> values, valueScratch;
+	double radixMs = 0.0;
+	unsigned int passes = 0;
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		keys = source;
+		values.resize(count);
+		for (unsigned int j = 0; j < count; ++j)
+			values[j] = j;
+		auto start = std::chrono::high_resolution_clock::now();
+		passes = RenderQueue::radixSort(keys, values, keyScratch, valueScratch);
+		radixMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	std::vector<std::pair<unsigned long long, unsigned int>> pairs;
+	double stdMs = 0.0;
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		pairs.resize(count);
+		for (unsigned int j = 0; j < count; ++j)
+			pairs[j] = std::make_pair(source[j], j);
+		auto start = std::chrono::high_resolution_clock::now();
+		std::sort(pairs.begin(), pairs.end());
+		stdMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	bool matches = true;
+	for (unsigned int j = 0; j < count && matches; ++j)
+		matches = keys[j] == pairs[j].first && values[j] == pairs[j].second;
+
+	std::ostringstream os;
+	os << "Sort benchmark: " << count << " keys, " << iterations << " iterations\n";
+	os << "radix sort: " << (radixMs / iterations) << " ms/sort (" << passes << " passes)\n";
+	os << "std::sort:  " << (stdMs / iterations) << " ms/sort\n";
+	os << "results " << (matches ? "match" : "DIFFER") << "\n";
+	OutputDebugStringA(os.str().c_str());
+	printf("%s", os.str().c_str());
+	return matches ? 0 : 1;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Decode the same JPG on 1..N worker threads, time the SIMD pixel conversion and mip filters
+//--------------------------------------------------------------------------------------
+int RunDecodeBenchmark()
+{
+	unsigned int count = g_decodeBenchmarkImages > 0 ? g_decodeBenchmarkImages : 64;
+	unsigned int hardwareThreads = (std::max)(1u, std::thread::hardware_concurrency());
+	ImageDecodeOptions options;
+	options.premultiplyAlpha = true;
+
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+	os << "Decode benchmark: " << count << " x MonacoEngine.jpg\n";
+
+	double singleThreadRate = 0.0;
+	unsigned long long pixels = 0;
+	for (unsigned int threads = 1; ; threads = (std::min)(threads * 2, hardwareThreads))
+	{
+		ThreadPool pool;
+		if (FAILED(pool.init(threads)))
+			return 1;
+		ImageDecoder decoder;
+		decoder.init(&pool);
+		auto start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < count; ++i)
+			decoder.decodeAsync("MonacoEngine.jpg", options, nullptr);
+		while (decoder.pending() > 0)
+		{
+			decoder.update();
+			std::this_thread::yield();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		if (decoder.m_stats.failures > 0)
+		{
+			os << "failed to decode MonacoEngine.jpg\n";
+			OutputDebugStringA(os.str().c_str());
+			printf("%s", os.str().c_str());
+			return 1;
+		}
+		pixels = decoder.m_stats.pixels / count;
+		double rate = count / seconds;
+		if (threads == 1)
+			singleThreadRate = rate;
+		os << threads << " threads: " << rate << " images/s (x" << (rate / singleThreadRate) << ")\n";
+		decoder.destroy();
+		pool.destroy();
+		if (threads == hardwareThreads)
+			break;
+	}
+
+	// Conversin sola sobre un buffer ya decodificado, SSE2 contra la referencia escalar
+	const unsigned int iterations = 20;
+	std::vector<unsigned char> source(static_cast<size_t>(pixels) * 4);
+	std::mt19937 random(1234);
+	for (unsigned char& byte : source)
+		byte = static_cast<unsigned char>(random());
+	std::vector<unsigned char> simd(source.size()), scalar(source.size());
+	double simdMs = 0.0, scalarMs = 0.0;
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		ImageDecoder::convertPixels(source.data(), simd.data(), pixels, true, true);
+		auto middle = std::chrono::high_resolution_clock::now();
+		ImageDecoder::convertPixelsScalar(source.data(), scalar.data(), pixels, true, true);
+		auto end = std::chrono::high_resolution_clock::now();
+		simdMs += std::chrono::duration<double, std::milli>(middle - start).count();
+		scalarMs += std::chrono::duration<double, std::milli>(end - middle).count();
+	}
+	bool matches = simd == scalar;
+	os << "swizzle + premultiply SSE2: " << (pixels * iterations / (simdMs * 1000.0)) << " MPix/s, scalar: "
+		<< (pixels * iterations / (scalarMs * 1000.0)) << " MPix/s\n";
+
+	// Cadena de mips completa del logo en sRGB, con cada filtro, en un hilo y en todos
+	DecodedImage logo;
+	ImageDecodeOptions logoOptions;
+	logoOptions.format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	if (SUCCEEDED(ImageDecoder::decode("MonacoEngine.jpg", logoOptions, logo)))
+	{
+		ThreadPool pool;
+		pool.init();
+		const char* filterNames[] = { "box", "kaiser", "lanczos" };
+		for (unsigned int filter = 0; filter < 3; ++filter)
+		{
+			MipGenerateOptions mipOptions;
+			mipOptions.filter = static_cast<MipFilter>(filter);
+			std::vector<MipLevel> mips;
+			double threadMs[2] = {};
+			for (unsigned int i = 0; i < iterations; ++i)
+			{
+				for (unsigned int parallel = 0; parallel < 2; ++parallel)
+				{
+					auto start = std::chrono::high_resolution_clock::now();
+					MipGenerator::generate(logo.pixels.data(), logo.width, logo.height, logo.rowPitch, logo.format,
+						mipOptions, mips, parallel ? &pool : nullptr);
+					threadMs[parallel] += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				}
+			}
+			os << "mips " << filterNames[filter] << ": " << (threadMs[0] / iterations) << " ms on 1 thread, "
+				<< (threadMs[1] / iterations) << " ms on " << (pool.size() + 1) << " (" << mips.size() << " levels)\n";
+		}
+		pool.destroy();
+	}
+	os << "results " << (matches ? "match" : "DIFFER") << "\n";
+	OutputDebugStringA(os.str().c_str());
+	printf("%s", os.str().c_str());
+	return matches ? 0 : 1;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Compress the logo to every BC format and quality, then write MonacoEngine.dds for InitDevice
+//--------------------------------------------------------------------------------------
+int RunBlockCompressionBenchmark()
+{
+	unsigned int runs = g_blockCompressionBenchmarkRuns > 0 ? g_blockCompressionBenchmarkRuns : 8;
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+
+	DecodedImage logo;
+	ImageDecodeOptions logoOptions;
+	if (FAILED(ImageDecoder::decode("MonacoEngine.jpg", logoOptions, logo)))
+	{
+		os << "failed to decode MonacoEngine.jpg\n";
+		OutputDebugStringA(os.str().c_str());
+		printf("%s", os.str().c_str());
+		return 1;
+	}
+	os << "Block compression benchmark: " << runs << " x MonacoEngine.jpg (" << logo.width << "x" << logo.height << ")\n";
+
+	ThreadPool pool;
+	pool.init();
+	const DXGI_FORMAT formats[] = { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC7_UNORM };
+	const char* formatNames[] = { "BC1", "BC3", "BC5", "BC7" };
+	const char* qualityNames[] = { "fast", "balanced", "high" };
+	double megapixels = static_cast<double>(logo.width) * logo.height * runs / 1000000.0;
+	for (unsigned int f = 0; f < 4; ++f)
+	{
+		for (unsigned int quality = 0; quality < 3; ++quality)
+		{
+			std::vector<unsigned char> blocks;
+			double threadMs[2] = {};
+			for (unsigned int parallel = 0; parallel < 2; ++parallel)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+				for (unsigned int i = 0; i < runs; ++i)
+					BlockCompressor::compress(logo.pixels.data(), logo.width, logo.height, logo.rowPitch, formats[f],
+						static_cast<BlockCompressionQuality>(quality), blocks, parallel ? &pool : nullptr);
+				threadMs[parallel] = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			}
+
+			// RMSE sobre los canales que guarda cada formato (BC1 sin alfa, BC5 solo R y G)
+			std::vector<unsigned char> decoded;
+			BlockCompressor::decompress(blocks.data(), logo.width, logo.height, formats[f], decoded);
+			unsigned int channels = f == 0 ? 3 : f == 2 ? 2 : 4;
+			double squaredError = 0.0;
+			for (unsigned int y = 0; y < logo.height; ++y)
+			{
+				for (unsigned int x = 0; x < logo.width; ++x)
+				{
+					for (unsigned int c = 0; c < channels; ++c)
+					{
+						double difference = static_cast<double>(logo.pixels[y * logo.rowPitch + x * 4 + c]) - decoded[(y * logo.width + x) * 4 + c];
+						squaredError += difference * difference;
+					}
+				}
+			}
+			double rmse = sqrt(squaredError / (static_cast<double>(logo.width) * logo.height * channels));
+			os << formatNames[f] << " " << qualityNames[quality] << ": " << (megapixels * 1000.0 / threadMs[0])
+				<< " MPix/s on 1 thread, " << (megapixels * 1000.0 / threadMs[1]) << " MPix/s on " << (pool.size() + 1)
+				<< ", RMSE " << rmse << "\n";
+		}
+	}
+
+	// Direct3D 11 exige mltiplos de 4 en texturas BC: se recorta el logo y se rehacen sus mips
+	unsigned int width = logo.width & ~3u;
+	unsigned int height = logo.height & ~3u;
+	MipGenerateOptions mipOptions;
+	mipOptions.filter = MipFilter::Kaiser;
+	mipOptions.srgb = true;
+	std::vector<MipLevel> mips;
+	HRESULT hr = MipGenerator::generate(logo.pixels.data(), width, height, logo.rowPitch, logo.format, mipOptions, mips, &pool);
+	if (SUCCEEDED(hr))
+		hr = BlockCompressor::compressToDDS("MonacoEngine.dds", logo.pixels.data(), width, height, logo.rowPitch, mips,
+			DXGI_FORMAT_BC7_UNORM, BlockCompressionQuality::High, &pool);
+	pool.destroy();
+	if (SUCCEEDED(hr))
+	{
+		unsigned long long uncompressed = static_cast<unsigned long long>(width) * height * 4;
+		for (const MipLevel& mip : mips)
+			uncompressed += mip.pixels.size();
+		WIN32_FILE_ATTRIBUTE_DATA attributes = {};
+		GetFileAttributesExA("MonacoEngine.dds", GetFileExInfoStandard, &attributes);
+		os << "MonacoEngine.dds: BC7 " << width << "x" << height << ", " << (mips.size() + 1) << " levels, "
+			<< attributes.nFileSizeLow << " bytes (RGBA8: " << uncompressed << " bytes)\n";
+	}
+	else
+	{
+		os << "failed to write MonacoEngine.dds\n";
+	}
+	OutputDebugStringA(os.str().c_str());
+	printf("%s", os.str().c_str());
+	return SUCCEEDED(hr) ? 0 : 1;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Load a large OBJ on one thread and on all of them and compare the meshes
+//--------------------------------------------------------------------------------------
+int RunObjBenchmark()
+{
+	unsigned int megabytes = g_objBenchmarkMegabytes > 0 ? g_objBenchmarkMegabytes : 256;
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+
+	// Rejilla con relieve, UV y caras cuadradas; unos 110 bytes por celda
+	if (GetFileAttributesA("ObjBenchmark.obj") == INVALID_FILE_ATTRIBUTES)
+	{
+		unsigned int side = static_cast<unsigned int>(sqrt(megabytes * 1048576.0 / 110.0));
+		std::ofstream file("ObjBenchmark.obj", std::ios::binary);
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+		std::string buffer;
+		char line[128];
+		file << "# ObjBenchmark: " << side << "x" << side << " grid\no grid\n";
+		for (unsigned int y = 0; y <= side; ++y)
+		{
+			for (unsigned int x = 0; x <= side; ++x)
+			{
+				snprintf(line, sizeof(line), "v %.5f %.5f %.5f\nvt %.5f %.5f\n", x * 0.1f, noise(random), y * 0.1f,
+					static_cast<float>(x) / side, static_cast<float>(y) / side);
+				buffer += line;
+			}
+			file << buffer;
+			buffer.clear();
+		}
+		for (unsigned int y = 0; y < side; ++y)
+		{
+			for (unsigned int x = 0; x < side; ++x)
+			{
+				unsigned int a = y * (side + 1) + x + 1;
+				unsigned int b = a + side + 1;
+				snprintf(line, sizeof(line), "f %u/%u %u/%u %u/%u %u/%u\n", a, a, b, b, b + 1, b + 1, a + 1, a + 1);
+				buffer += line;
+			}
+			file << buffer;
+			buffer.clear();
+		}
+		if (!file)
+		{
+			os << "failed to write ObjBenchmark.obj\n";
+			OutputDebugStringA(os.str().c_str());
+			printf("%s", os.str().c_str());
+			return 1;
+		}
+	}
+
+	ThreadPool pool;
+	pool.init();
+	MeshComponent meshes[2];
+	bool loaded = true;
+	for (unsigned int parallel = 0; parallel < 2; ++parallel)
+	{
+		ObjLoadStats stats;
+		if (FAILED(ObjLoader::load("ObjBenchmark.obj", meshes[parallel], ObjLoadOptions(), parallel ? &pool : nullptr, &stats)))
+		{
+			loaded = false;
+			break;
+		}
+		double megabytesLoaded = stats.bytes / 1048576.0;
+		os << "ObjBenchmark.obj on " << (parallel ? pool.size() + 1 : 1) << " threads: " << megabytesLoaded << " MB, "
+			<< (megabytesLoaded * 1000.0 / stats.totalMilliseconds) << " MB/s (map " << stats.mapMilliseconds << " ms, parse "
+			<< stats.parseMilliseconds << " ms in " << stats.chunks << " chunks, dedup " << stats.dedupMilliseconds << " ms), "
+			<< stats.vertices << " vertices, " << stats.triangles << " triangles\n";
+	}
+	pool.destroy();
+	bool matches = loaded && meshes[0].m_index == meshes[1].m_index && meshes[0].m_numVertex == meshes[1].m_numVertex &&
+		memcmp(meshes[0].m_vertex.data(), meshes[1].m_vertex.data(), meshes[0].m_vertex.size() * sizeof(SimpleVertex)) == 0;
+	os << (loaded ? "" : "failed to load ObjBenchmark.obj\n") << "results " << (matches ? "match" : "DIFFER") << "\n";
+	OutputDebugStringA(os.str().c_str());
+	printf("%s", os.str().c_str());
+	return matches ? 0 : 1;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Write a GLB with nodeCount nodes: a 1024-level chain and then a tree with 8 children per
+// node. Half of the meshes store vertices as SimpleVertex with 32-bit indices (copied in
+// bulk); the other half use separate accessors, 16-bit UVs and strips (converted)
+//--------------------------------------------------------------------------------------
+bool WriteGltfBenchmarkScene(const char* fileName, unsigned int nodeCount)
+{
+	const unsigned int meshCount = 64;
+	const unsigned int side = 64;
+	std::vector<unsigned char> binary;
+	std::ostringstream bufferViews, accessors, meshes;
+	unsigned int viewCount = 0;
+	auto addView = [&](const void* data, size_t size, unsigned int stride)
+	{
+		while (binary.size() % 4 != 0)
+			binary.push_back(0);
+		bufferViews << (viewCount > 0 ? "," : "") << "{\"buffer\":0,\"byteOffset\":" << binary.size() << ",\"byteLength\":" << size;
+		if (stride > 0)
+			bufferViews << ",\"byteStride\":" << stride;
+		bufferViews << "}";
+		binary.insert(binary.end(), static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + size);
+		return viewCount++;
+	};
+	unsigned int accessorCount = 0;
+	auto addAccessor = [&](unsigned int view, unsigned int offset, unsigned int componentType, unsigned int count,
+		const char* type, const char* extra)
+	{
+		accessors << (accessorCount > 0 ? "," : "") << "{\"bufferView\":" << view << ",\"byteOffset\":" << offset
+			<< ",\"componentType\":" << componentType << ",\"count\":" << count << ",\"type\":\"" << type << "\"" << extra << "}";
+		return accessorCount++;
+	};
+
+	for (unsigned int m = 0; m < meshCount; ++m)
+	{
+		std::vector<SimpleVertex> vertices(side * side);
+		for (unsigned int i = 0; i < vertices.size(); ++i)
+		{
+			float u = static_cast<float>(i % side) / (side - 1);
+			float v = static_cast<float>(i / side) / (side - 1);
+			vertices[i].Pos = XMFLOAT3(u - 0.5f, 0.05f * sinf(u * 6.2831853f * (m + 1)), v - 0.5f);
+			vertices[i].Tex = XMFLOAT2(u, v);
+		}
+		unsigned int position, texcoord, indices;
+		const char* mode = "";
+		if (m % 2 == 0)
+		{
+			std::vector<unsigned int> list;
+			for (unsigned int y = 0; y + 1 < side; ++y)
+			{
+				for (unsigned int x = 0; x + 1 < side; ++x)
+				{
+					unsigned int a = y * side + x;
+					unsigned int quad[] = { a, a + side, a + 1, a + 1, a + side, a + side + 1 };
+					list.insert(list.end(), quad, quad + 6);
+				}
+			}
+			unsigned int view = addView(vertices.data(), vertices.size() * sizeof(SimpleVertex), sizeof(SimpleVertex));
+			position = addAccessor(view, 0, 5126, side * side, "VEC3", "");
+			texcoord = addAccessor(view, sizeof(XMFLOAT3), 5126, side * side, "VEC2", "");
+			indices = addAccessor(addView(list.data(), list.size() * 4, 0), 0, 5125, static_cast<unsigned int>(list.size()), "SCALAR", "");
+		}
+		else
+		{
+			std::vector<XMFLOAT3> positions(vertices.size());
+			std::vector<unsigned short> uvs(vertices.size() * 2);
+			for (size_t i = 0; i < vertices.size(); ++i)
+			{
+				positions[i] = vertices[i].Pos;
+				uvs[i * 2] = static_cast<unsigned short>(vertices[i].Tex.x * 65535.0f + 0.5f);
+				uvs[i * 2 + 1] = static_cast<unsigned short>(vertices[i].Tex.y * 65535.0f + 0.5f);
+			}
+			// Una tira por fila, unidas con tringulos degenerados
+			std::vector<unsigned short> strip;
+			for (unsigned int y = 0; y + 1 < side; ++y)
+			{
+				if (y > 0)
+				{
+					strip.push_back(static_cast<unsigned short>(strip.back()));
+					strip.push_back(static_cast<unsigned short>(y * side));
+				}
+				for (unsigned int x = 0; x < side; ++x)
+				{
+					strip.push_back(static_cast<unsigned short>(y * side + x));
+					strip.push_back(static_cast<unsigned short>((y + 1) * side + x));
+				}
+			}
+			position = addAccessor(addView(positions.data(), positions.size() * sizeof(XMFLOAT3), 0), 0, 5126, side * side, "VEC3", "");
+			texcoord = addAccessor(addView(uvs.data(), uvs.size() * 2, 0), 0, 5123, side * side, "VEC2", ",\"normalized\":true");
+			indices = addAccessor(addView(strip.data(), strip.size() * 2, 0), 0, 5123, static_cast<unsigned int>(strip.size()), "SCALAR", "");
+			mode = ",\"mode\":5";
+		}
+		meshes << (m > 0 ? "," : "") << "{\"primitives\":[{\"attributes\":{\"POSITION\":" << position << ",\"TEXCOORD_0\":"
+			<< texcoord << "},\"indices\":" << indices << ",\"material\":0" << mode << "}]}";
+	}
+
+	std::vector<std::vector<unsigned int>> children(nodeCount);
+	for (unsigned int i = 1; i < nodeCount; ++i)
+		children[i < 1024 ? i - 1 : (i - 1) / 8].push_back(i);
+	std::ostringstream nodes;
+	for (unsigned int i = 0; i < nodeCount; ++i)
+	{
+		nodes << (i > 0 ? "," : "") << "{\"translation\":[" << ((i % 7) * 0.25f) << ",0," << ((i % 5) * 0.25f) << "]";
+		if (i % 4 == 0)
+			nodes << ",\"mesh\":" << (i / 4) % meshCount;
+		if (!children[i].empty())
+		{
+			nodes << ",\"children\":[";
+			for (size_t c = 0; c < children[i].size(); ++c)
+				nodes << (c > 0 ? "," : "") << children[i][c];
+			nodes << "]";
+		}
+		nodes << "}";
+	}
+
+	std::string json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[" + nodes.str() +
+		"],\"meshes\":[" + meshes.str() + "],\"materials\":[{\"pbrMetallicRoughness\":{\"baseColorTexture\":{\"index\":0}}}]," +
+		"\"textures\":[{\"source\":0}],\"images\":[{\"uri\":\"MonacoEngine.jpg\"}],\"accessors\":[" + accessors.str() +
+		"],\"bufferViews\":[" + bufferViews.str() + "],\"buffers\":[{\"byteLength\":" + std::to_string(binary.size()) + "}]}";
+	while (json.size() % 4 != 0)
+		json += ' ';
+	while (binary.size() % 4 != 0)
+		binary.push_back(0);
+	unsigned int header[] = { 0x46546C67, 2, static_cast<unsigned int>(12 + 8 + json.size() + 8 + binary.size()),
+		static_cast<unsigned int>(json.size()), 0x4E4F534A };
+	unsigned int binaryHeader[] = { static_cast<unsigned int>(binary.size()), 0x004E4942 };
+	std::ofstream file(fileName, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(json.data(), json.size());
+	file.write(reinterpret_cast<const char*>(binaryHeader), sizeof(binaryHeader));
+	file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+	return static_cast<bool>(file);
+}
+
+
+//--------------------------------------------------------------------------------------
+// Load a GLB with tens of thousands of nodes on one thread and on all of them
+//--------------------------------------------------------------------------------------
+int RunGltfBenchmark()
+{
+	unsigned int nodeCount = g_gltfBenchmarkNodes > 0 ? g_gltfBenchmarkNodes : 50000;
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+	if (GetFileAttributesA("GltfBenchmark.glb") == INVALID_FILE_ATTRIBUTES && !WriteGltfBenchmarkScene("GltfBenchmark.glb", nodeCount))
+	{
+		os << "failed to write GltfBenchmark.glb\n";
+		OutputDebugStringA(os.str().c_str());
+		printf("%s", os.str().c_str());
+		return 1;
+	}
+
+	ThreadPool pool;
+	pool.init();
+	GltfScene scenes[2];
+	bool loaded = true;
+	for (unsigned int parallel = 0; parallel < 2; ++parallel)
+	{
+		if (FAILED(scenes[parallel].init("GltfBenchmark.glb", GltfLoadOptions(), parallel ? &pool : nullptr)))
+		{
+			loaded = false;
+			break;
+		}
+		os << (parallel ? pool.size() + 1 : 1) << " threads: " << scenes[parallel].report();
+	}
+	pool.destroy();
+
+	bool matches = loaded && scenes[0].primitives().size() == scenes[1].primitives().size() &&
+		scenes[0].instances().size() == scenes[1].instances().size();
+	for (size_t i = 0; matches && i < scenes[0].primitives().size(); ++i)
+	{
+		const MeshComponent& a = scenes[0].primitives()[i].meshComponent;
+		const MeshComponent& b = scenes[1].primitives()[i].meshComponent;
+		matches = a.m_index == b.m_index && a.m_vertex.size() == b.m_vertex.size() &&
+			memcmp(a.m_vertex.data(), b.m_vertex.data(), a.m_vertex.size() * sizeof(SimpleVertex)) == 0;
+	}
+	for (size_t i = 0; matches && i < scenes[0].instances().size(); ++i)
+		matches = memcmp(&scenes[0].instances()[i], &scenes[1].instances()[i], sizeof(GltfMeshInstance)) == 0;
+	os << (loaded ? "" : "failed to load GltfBenchmark.glb\n") << "results " << (matches ? "match" : "DIFFER") << "\n";
+	OutputDebugStringA(os.str().c_str());
+	printf("%s", os.str().c_str());
+	return matches ? 0 : 1;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Record a failed self-test check
+//--------------------------------------------------------------------------------------
+void SelfTestCheck(std::ostringstream& os, unsigned int& failures, bool condition, const char* description)
+{
+	if (!condition)
+	{
+		os << "  FAILED: " << description << "\n";
+		failures++;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------
+// Ring allocator: alignment, wrap with wasted tail, stalls and fence / forced retirement
+//--------------------------------------------------------------------------------------
+unsigned int SelfTestRingAllocator(std::ostringstream& os)
+{
+	os << "RingAllocator\n";
+	unsigned int failures = 0;
+	RingAllocator ring;
+	unsigned int offset = 0;
+	ring.init(1024, 256);
+
+	// Frame 1: [0, 512); frame 2 llena el resto y la cabeza vuelve a 0
+	SelfTestCheck(os, failures, ring.allocate(100, offset) && offset == 0, "first allocation at 0");
+	SelfTestCheck(os, failures, ring.allocate(256, offset) && offset == 256, "sizes round up to the alignment");
+	ring.endFrame(1);
+	SelfTestCheck(os, failures, ring.allocate(512, offset) && offset == 512, "allocation up to the end of the ring");
+	SelfTestCheck(os, failures, ring.m_stats.wraps == 1, "filling the ring wraps the head");
+	SelfTestCheck(os, failures, !ring.allocate(1, offset) && ring.m_stats.stalls == 1, "full ring stalls");
+	ring.endFrame(2);
+
+	// Al terminar el frame 1 solo se reutiliza su rango
+	ring.retire(1);
+	SelfTestCheck(os, failures, ring.usedBytes() == 512, "retire frees only the completed frame");
+	SelfTestCheck(os, failures, ring.allocate(256, offset) && offset == 0, "allocation reuses the retired range");
+	SelfTestCheck(os, failures, !ring.allocate(512, offset) && ring.m_stats.stalls == 2, "allocation past the tail stalls");
+	ring.endFrame(3);
+	ring.retire(3);
+	SelfTestCheck(os, failures, ring.pendingFrames() == 0 && ring.usedBytes() == 0, "retire frees every completed frame");
+
+	// Un rango que no cabe al final desperdicia la cola del anillo y empieza en 0
+	ring.init(1024, 256);
+	ring.allocate(512, offset);
+	ring.endFrame(1);
+	ring.allocate(256, offset);
+	ring.endFrame(2);
+	ring.retire(1);
+	SelfTestCheck(os, failures, ring.allocate(512, offset) && offset == 0, "allocation that does not fit the end wraps to 0");
+	SelfTestCheck(os, failures, ring.m_stats.wastedBytes == 256 && ring.usedBytes() == 1024, "wrap wastes the end of the ring");
+	ring.endFrame(3);
+	SelfTestCheck(os, failures, !ring.allocate(256, offset), "ring is full again");
+	ring.forceRetire();
+	SelfTestCheck(os, failures, ring.m_stats.forcedRetires == 1 && ring.pendingFrames() == 1, "forceRetire frees the oldest frame");
+	SelfTestCheck(os, failures, ring.allocate(256, offset) && offset == 512, "forced retirement makes room");
+	return failures;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Buddy allocator: splits, rejected double free and coalescing back to one block
+//--------------------------------------------------------------------------------------
+unsigned int SelfTestBuddyAllocator(std::ostringstream& os)
+{
+	os << "BuddyAllocator\n";
+	unsigned int failures = 0;
+	BuddyAllocator buddy;
+	unsigned int offset = 0;
+	buddy.init(1024, 64);
+
+	// El primer bloque mnimo parte 1024 en 512 + 256 + 128 + 64 + 64
+	SelfTestCheck(os, failures, buddy.allocate(64, offset) && offset == 0, "first block at 0");
+	SelfTestCheck(os, failures, buddy.largestFreeBlock() == 512, "split leaves the upper half free");
+	SelfTestCheck(os, failures, buddy.allocate(100, offset) && offset == 128 && buddy.blockSize(128) == 128,
+		"size rounds up to the next power of two");
+	SelfTestCheck(os, failures, buddy.allocate(64, offset) && offset == 64, "smallest free block is used first");
+	SelfTestCheck(os, failures, buddy.usedSize() == 256, "used size counts the rounded blocks");
+
+	// Liberar dos veces no debe cambiar nada (se espera un error en el log)
+	buddy.free(64);
+	buddy.free(64);
+	SelfTestCheck(os, failures, buddy.usedSize() == 192 && buddy.blockSize(64) == 0, "double free is rejected");
+
+	// 0 se une con 64, luego con 128 y as hasta recuperar el espacio completo
+	buddy.free(0);
+	SelfTestCheck(os, failures, buddy.largestFreeBlock() == 512, "no merge while the buddy is allocated");
+	buddy.free(128);
+	SelfTestCheck(os, failures, buddy.usedSize() == 0 && buddy.largestFreeBlock() == 1024, "free blocks coalesce");
+	SelfTestCheck(os, failures, buddy.allocate(1024, offset) && offset == 0, "coalesced space holds a full allocation");
+	SelfTestCheck(os, failures, !buddy.allocate(64, offset), "full allocator rejects allocations");
+	return failures;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Upload queue: budget chunking on the granularity, staging alignment and fence retirement
+//--------------------------------------------------------------------------------------
+unsigned int SelfTestUploadQueue(std::ostringstream& os)
+{
+	os << "UploadQueue\n";
+	unsigned int failures = 0;
+	UploadQueue queue;
+	std::vector<UploadChunk> chunks;
+	std::vector<unsigned int> completed;
+	queue.init(1000, 16);
+
+	// 24 filas de 100 bytes salen en tres frames; la segunda peticin entra en el tercero
+	unsigned int rows = queue.push(2400, 100);
+	unsigned int small = queue.push(50);
+	queue.schedule(chunks);
+	SelfTestCheck(os, failures, chunks.size() == 1 && chunks[0].request == rows && chunks[0].size == 1000,
+		"first frame uses the whole budget");
+	SelfTestCheck(os, failures, queue.pendingBytes() == 1450 && queue.m_stats.budgetFrames == 1, "the rest waits for later frames");
+	queue.endFrame(1);
+	queue.retire(1, completed);
+	SelfTestCheck(os, failures, completed.empty() && !queue.isComplete(rows), "partly scheduled request does not complete");
+
+	queue.schedule(chunks);
+	SelfTestCheck(os, failures, chunks.size() == 1 && chunks[0].offset == 1000 && chunks[0].size == 1000, "second chunk continues the request");
+	queue.endFrame(2);
+	queue.schedule(chunks);
+	SelfTestCheck(os, failures, chunks.size() == 2 && chunks[0].offset == 2000 && chunks[0].size == 400 &&
+		chunks[1].request == small && chunks[1].stagingOffset == 400, "last chunk shares the frame with the next request");
+	queue.endFrame(3);
+
+	queue.retire(2, completed);
+	SelfTestCheck(os, failures, completed.empty(), "requests complete only at their last fence");
+	queue.retire(3, completed);
+	SelfTestCheck(os, failures, completed.size() == 2 && completed[0] == rows && completed[1] == small &&
+		queue.isComplete(small) && queue.pendingRequests() == 0, "requests complete in order");
+
+	// Una fila mayor que el presupuesto se enva sola en su frame
+	unsigned int wide = queue.push(3000, 3000);
+	queue.schedule(chunks);
+	SelfTestCheck(os, failures, chunks.size() == 1 && chunks[0].request == wide && chunks[0].size == 3000,
+		"unit larger than the budget goes alone");
+	return failures;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Simulated clock for the frame pacer: sleeping only moves the time forward
+//--------------------------------------------------------------------------------------
+class
+	SelfTestClock : public PresentClock {
+public:
+	double
+		now() const override { return m_time; }
+
+	void
+		sleepUntil(double time) override { m_time = (std::max)(m_time, time); }
+
+public:
+	double m_time = 0.0;
+};
+
+
+//--------------------------------------------------------------------------------------
+// Frame pacer: deadlines on a fixed period, late frames and the reset after a hitch
+//--------------------------------------------------------------------------------------
+unsigned int SelfTestFramePacer(std::ostringstream& os)
+{
+	os << "FramePacer\n";
+	unsigned int failures = 0;
+	SelfTestClock clock;
+	FramePacer pacer;
+	FramePacerDesc desc;
+	desc.targetFps = 100.0;
+	pacer.init(desc, clock, 8);
+
+	// Periodo de 10 ms. El frame 2 llega 3 ms tarde y el 3 vuelve a la rejilla; el 4 llega
+	// 40 ms tarde y los plazos se cuentan desde l
+	const double work[] = { 0.004, 0.013, 0.001, 0.050, 0.001, 0.001 };
+	const double expectedBegin[] = { 0.0, 0.010, 0.023, 0.030, 0.080, 0.090 };
+	const unsigned int frames = sizeof(work) / sizeof(work[0]);
+	for (unsigned int i = 0; i < frames; ++i)
+	{
+		pacer.beginFrame();
+		clock.m_time += work[i];
+		pacer.beginPresent();
+		pacer.endPresent();
+	}
+
+	const double epsilon = 1e-9;
+	SelfTestCheck(os, failures, pacer.historyCount() == frames, "every frame is recorded");
+	bool deadlines = true;
+	for (unsigned int i = 0; i < frames && i < pacer.historyCount(); ++i)
+		deadlines = deadlines && fabs(pacer.timing(frames - 1 - i).cpuBegin - expectedBegin[i]) < epsilon;
+	SelfTestCheck(os, failures, deadlines, "frames begin on the expected deadlines");
+	SelfTestCheck(os, failures, pacer.historyCount() == frames &&
+		fabs(pacer.timing(frames - 2).waited - 0.006) < epsilon &&
+		fabs(pacer.timing(frames - 3).waited) < epsilon &&
+		fabs(pacer.timing(0).waited - 0.009) < epsilon, "waits cover only the time left to the deadline");
+	SelfTestCheck(os, failures, fabs(pacer.maxFrameTime() - 0.050) < epsilon, "max frame time is the hitch");
+
+	// Sin targetFps no se espera nunca
+	pacer.init(FramePacerDesc(), clock, 8);
+	pacer.beginFrame();
+	pacer.endPresent();
+	pacer.beginFrame();
+	pacer.endPresent();
+	SelfTestCheck(os, failures, pacer.timing(0).waited == 0.0 && pacer.timing(0).cpuBegin == clock.m_time,
+		"unlimited pacing never waits");
+	return failures;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Texture residency: loads under the budget and least recently used eviction order
+//--------------------------------------------------------------------------------------
+unsigned int SelfTestTextureResidency(std::ostringstream& os)
+{
+	os << "TextureResidency\n";
+	unsigned int failures = 0;
+	TextureResidency residency;
+	std::vector<TextureResidencyChange> loads, evictions;
+	residency.init(180, 1);
+
+	// Tres texturas de 8x8 con mips de 64, 16, 4 y 1 bytes; la cola (mips 2 y 3) ocupa 5
+	const std::vector<unsigned long long> levelBytes = { 64, 16, 4, 1 };
+	unsigned int a = residency.add(8, 8, levelBytes, 2);
+	unsigned int b = residency.add(8, 8, levelBytes, 2);
+	unsigned int c = residency.add(8, 8, levelBytes, 2);
+	SelfTestCheck(os, failures, residency.residentBytes() == 15, "only the mip tails start resident");
+
+	// Frames 1 y 2: A y luego B cargan el mip 0 sin expulsar nada (175 de 180 bytes)
+	residency.request(a, 8.0f);
+	residency.schedule(loads, evictions);
+	SelfTestCheck(os, failures, loads.size() == 1 && loads[0].handle == a && loads[0].mip == 0 && evictions.empty(),
+		"requested mip loads while it fits");
+	residency.completeLoad(a, true);
+	residency.request(b, 8.0f);
+	residency.schedule(loads, evictions);
+	residency.completeLoad(b, true);
+	SelfTestCheck(os, failures, residency.residentBytes() == 175 && residency.residentMip(b) == 0, "second texture fits the budget");
+
+	// Frame 3: C no cabe; A se us hace ms tiempo que B, as que sale A completa hasta su cola
+	residency.request(c, 8.0f);
+	residency.schedule(loads, evictions);
+	residency.completeLoad(c, true);
+	SelfTestCheck(os, failures, evictions.size() == 1 && evictions[0].handle == a && evictions[0].mip == 2,
+		"least recently used texture is evicted first");
+	SelfTestCheck(os, failures, residency.residentMip(b) == 0 && residency.residentMip(c) == 0 &&
+		residency.residentBytes() == 175, "more recent textures stay resident");
+
+	// Frame 4: A pide el mip 1 y C sigue en uso; solo se expulsa el mip 0 de B, el nivel ms detallado
+	residency.request(a, 4.0f);
+	residency.request(c, 8.0f);
+	residency.schedule(loads, evictions);
+	residency.completeLoad(a, true);
+	SelfTestCheck(os, failures, evictions.size() == 1 && evictions[0].handle == b && evictions[0].mip == 1,
+		"eviction removes the most detailed mip first");
+	SelfTestCheck(os, failures, residency.residentMip(a) == 1 && residency.residentMip(c) == 0 &&
+		residency.residentBytes() <= residency.budget(), "textures requested this frame are never evicted");
+	SelfTestCheck(os, failures, residency.m_stats.evictions == 3 && residency.m_stats.overBudgetFrames == 0,
+		"residency stays within the budget");
+	return failures;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Run the CPU-only checks and report every failed one
+//--------------------------------------------------------------------------------------
+int RunSelfTest()
+{
+	std::ostringstream os;
+	unsigned int failures = 0;
+	failures += SelfTestRingAllocator(os);
+	failures += SelfTestBuddyAllocator(os);
+	failures += SelfTestUploadQueue(os);
+	failures += SelfTestFramePacer(os);
+	failures += SelfTestTextureResidency(os);
+	os << "Self test: " << failures << " checks failed\n";
+	OutputDebugStringA(os.str().c_str());
+	printf("%s", os.str().c_str());
+	return failures == 0 ? 0 : 1;
+}
+
+
 //--------------------------------------------------------------------------------------
 // Create Direct3D device and swap chain
 //--------------------------------------------------------------------------------------
@@ -100,8 +1191,34 @@ HRESULT InitDevice()
 {
 	HRESULT hr = S_OK;
 
-	// Crear swapchain
-	hr = g_swapChain.init(g_device, g_deviceContext, g_backBuffer, g_window);
+	if (g_headless) {
+		// Dispositivo sin GPU y back buffer fuera de pantalla en lugar del swapchain
+		hr = g_device.init(g_deviceContext, D3D_DRIVER_TYPE_NULL);
+		// Se conecta antes de crear recursos para recibir la copia en CPU de cada buffer
+		if (SUCCEEDED(hr) && g_software) {
+			hr = g_softwareRasterizer.init(g_device,
+				g_deviceContext,
+				g_window.m_width,
+				g_window.m_height,
+				g_workerThreads);
+		}
+		if (SUCCEEDED(hr)) {
+			hr = g_backBuffer.init(g_device,
+				g_window.m_width,
+				g_window.m_height,
+				DXGI_FORMAT_R8G8B8A8_UNORM,
+				D3D11_BIND_RENDER_TARGET,
+				4,
+				0);
+		}
+	}
+	else {
+		// Crear swapchain
+		hr = g_swapChain.init(g_device, g_deviceContext, g_backBuffer, g_window);
+		// Sin lmite la CPU puede encolar varios frames y la entrada se ve con retraso
+		if (SUCCEEDED(hr))
+			g_swapChain.setMaximumFrameLatency(g_framePacerDesc.framesInFlight);
+	}
 
 	if (FAILED(hr)) {
 		ERROR("Main", "InitDevice",
@@ -109,6 +1226,19 @@ HRESULT InitDevice()
 		return hr;
 	}
 
+	hr = g_framePacer.init(g_framePacerDesc, g_presentClock);
+	if (FAILED(hr))
+		return hr;
+
+	// Una textura soltada no se reutiliza mientras su frame pueda seguir en la GPU
+	hr = g_renderTargetPool.init(g_device, g_framePacerDesc.framesInFlight);
+	if (FAILED(hr))
+		return hr;
+
+	hr = g_renderGraph.init(g_renderTargetPool);
+	if (FAILED(hr))
+		return hr;
+
 	// Crear render target view
 	hr = g_renderTargetView.init(g_device, g_backBuffer, DXGI_FORMAT_R8G8B8A8_UNORM);
 
@@ -146,7 +1276,8 @@ HRESULT InitDevice()
 
 
 	// Crear el m_viewport
-	hr = g_viewport.init(g_window);
+	hr = g_headless ? g_viewport.init(g_window.m_width, g_window.m_height)
+		: g_viewport.init(g_window);
 
 	if (FAILED(hr)) {
 		ERROR("Main", "InitDevice",
@@ -179,14 +1310,81 @@ HRESULT InitDevice()
 	texcoord.InstanceDataStepRate = 0;
 	Layout.push_back(texcoord);
 
-	// Create the Shader Program
-	hr = g_shaderProgram.init(g_device, "MonacoEngine.fx", Layout);
+	// Create the pipeline state: shaders, input layout, fixed-function states and the linear sampler
+	hr = g_shaderCache.init("MonacoEngine.shadercache");
+	if (FAILED(hr))
+		return hr;
+
+	hr = g_pipelineStateCache.init(g_device, &g_shaderCache);
+	if (FAILED(hr))
+		return hr;
+
+	PipelineStateDesc pipelineDesc;
+	pipelineDesc.shaderFile = "MonacoEngine.fx";
+	pipelineDesc.layout = Layout;
+	std::vector<PipelineStateDesc> pipelineDescs(1, pipelineDesc);
+	if (g_instanceCount > 0)
+	{
+		// Solo cambian los shaders y el layout; los estados fijos se reutilizan
+		PipelineStateDesc instancedDesc = pipelineDesc;
+		instancedDesc.shaderFile = "MonacoEngineInstanced.fx";
+		InputLayout::appendInstanceData(instancedDesc.layout, 1);
+		pipelineDescs.push_back(instancedDesc);
+	}
+	// El quad cubre la pantalla entera: sin prueba de profundidad
+	PipelineStateDesc compositeDesc = pipelineDesc;
+	compositeDesc.shaderFile = "MonacoEngineComposite.fx";
+	compositeDesc.depthStencil.DepthEnable = FALSE;
+	compositeDesc.depthStencil.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+	pipelineDescs.push_back(compositeDesc);
+
+	// Todos los shaders del arranque en un lote; el pool solo vive durante la compilacin
+	ThreadPool compilePool;
+	compilePool.init(g_workerThreads);
+	g_shaderCompiler.init(&compilePool, &g_shaderCache);
+	std::vector<unsigned int> pipelineStates;
+	hr = g_pipelineStateCache.create(pipelineDescs, g_shaderCompiler, pipelineStates);
+	if (SUCCEEDED(hr) && g_instanceCount > 0)
+	{
+		// Bits en el orden de keywords; las variantes usadas en la ejecucin anterior se precompilan
+		const unsigned int vertexColorKeyword = 1u << 1;
+		const unsigned int instancedKeyword = 1u << 2;
+		ShaderPermutationDesc permutationDesc;
+		permutationDesc.fileName = "MonacoEngineVariants.fx";
+		permutationDesc.keywords = { "TEXTURED", "VERTEX_COLOR", "INSTANCED", "ATLAS" };
+		permutationDesc.layout = Layout;
+		permutationDesc.layoutKeywords = vertexColorKeyword | instancedKeyword;
+		permutationDesc.extendLayout = [=](unsigned int variant, std::vector<D3D11_INPUT_ELEMENT_DESC>& layout) {
+			// SimpleVertex no tiene color: va en su propio flujo por vrtice, despus de las instancias
+			if (variant & vertexColorKeyword)
+				layout.push_back(InputLayout::element("COLOR", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 2));
+			if (variant & instancedKeyword)
+				InputLayout::appendInstanceData(layout, 1);
+		};
+		hr = g_shaderPermutations.init(g_device, permutationDesc, nullptr, &g_shaderCache);
+		if (SUCCEEDED(hr))
+			hr = g_shaderPermutations.loadVariantSet("MonacoEngine.variants", g_shaderCompiler);
+		g_instancedVariant = g_useAtlas ? g_shaderPermutations.variant({ "TEXTURED", "INSTANCED", "ATLAS" })
+			: g_shaderPermutations.variant({ "TEXTURED", "INSTANCED" });
+	}
+	compilePool.destroy();
+	g_cubePipelineState = pipelineStates[0];
+	if (g_instanceCount > 0)
+		g_instancedPipelineState = pipelineStates[1];
+	g_compositePipelineState = pipelineStates.back();
 	if (FAILED(hr)) {
 		ERROR("Main", "InitDevice",
-			("Failed to initialize ShaderProgram. HRESULT: " + std::to_string(hr)).c_str());
+			("Failed to create pipeline state. HRESULT: " + std::to_string(hr)).c_str());
 		return hr;
 	}
 
+	// Sin recarga en caliente la demo sigue funcionando igual
+	if (SUCCEEDED(g_shaderHotReload.init("", nullptr, &g_shaderCache))) {
+		g_shaderHotReload.watch(g_pipelineStateCache);
+		if (g_instanceCount > 0)
+			g_shaderHotReload.watch(g_shaderPermutations);
+	}
+
 	// Create vertex buffer
 	SimpleVertex vertices[] =
 	{
@@ -230,7 +1428,7 @@ HRESULT InitDevice()
 	D3D11_SUBRESOURCE_DATA InitData;
 	ZeroMemory(&InitData, sizeof(InitData));
 	InitData.pSysMem = vertices;
-	hr = g_device.m_device->CreateBuffer(&bd, &InitData, &g_pVertexBuffer);
+	hr = g_device.CreateBuffer(&bd, &InitData, &g_pVertexBuffer);
 	if (FAILED(hr))
 		return hr;
 
@@ -267,13 +1465,53 @@ HRESULT InitDevice()
 	bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
 	bd.CPUAccessFlags = 0;
 	InitData.pSysMem = indices;
-	hr = g_device.m_device->CreateBuffer(&bd, &InitData, &g_pIndexBuffer);
+	hr = g_device.CreateBuffer(&bd, &InitData, &g_pIndexBuffer);
 	if (FAILED(hr))
 		return hr;
 
 	// Set index buffer
 	g_deviceContext.IASetIndexBuffer(g_pIndexBuffer, DXGI_FORMAT_R16_UINT, 0);
 
+	// Misma geometra como MeshComponent para el pool de geometra y el InstanceBatcher
+	g_cubeMesh.m_name = "Cube";
+	g_cubeMesh.m_vertex.assign(vertices, vertices + 24);
+	g_cubeMesh.m_index.assign(indices, indices + 36);
+	g_cubeMesh.m_numVertex = 24;
+	g_cubeMesh.m_numIndex = 36;
+
+	hr = g_uploadManager.init(g_device);
+	if (FAILED(hr))
+		return hr;
+
+	hr = g_geometryPool.init(g_device, 65536, 262144, &g_uploadManager);
+	if (FAILED(hr))
+		return hr;
+	g_cubeGeometry = g_geometryPool.add(g_deviceContext, g_cubeMesh);
+	if (g_cubeGeometry == GeometryPool::kInvalidHandle)
+		return E_FAIL;
+
+	// Quad del pase Composite, ya en espacio de clip y en sentido horario
+	g_fullscreenMesh.m_name = "Fullscreen";
+	g_fullscreenMesh.m_vertex = {
+		{ XMFLOAT3(-1.0f, 1.0f, 0.0f), XMFLOAT2(0.0f, 0.0f) },
+		{ XMFLOAT3(1.0f, 1.0f, 0.0f), XMFLOAT2(1.0f, 0.0f) },
+		{ XMFLOAT3(1.0f, -1.0f, 0.0f), XMFLOAT2(1.0f, 1.0f) },
+		{ XMFLOAT3(-1.0f, -1.0f, 0.0f), XMFLOAT2(0.0f, 1.0f) },
+	};
+	g_fullscreenMesh.m_index = { 0, 1, 2, 0, 2, 3 };
+	g_fullscreenMesh.m_numVertex = 4;
+	g_fullscreenMesh.m_numIndex = 6;
+	g_fullscreenGeometry = g_geometryPool.add(g_deviceContext, g_fullscreenMesh);
+	if (g_fullscreenGeometry == GeometryPool::kInvalidHandle)
+		return E_FAIL;
+
+	if (g_instanceCount > 0)
+	{
+		hr = g_instanceBatcher.init(g_device, g_instanceCount);
+		if (FAILED(hr))
+			return hr;
+	}
+
 	// Set primitive topology
 	g_deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
@@ -282,38 +1520,95 @@ HRESULT InitDevice()
 	bd.ByteWidth = sizeof(CBNeverChanges);
 	bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
 	bd.CPUAccessFlags = 0;
-	hr = g_device.m_device->CreateBuffer(&bd, NULL, &g_pCBNeverChanges);
+	hr = g_device.CreateBuffer(&bd, NULL, &g_pCBNeverChanges);
 	if (FAILED(hr))
 		return hr;
 
 	bd.ByteWidth = sizeof(CBChangeOnResize);
-	hr = g_device.m_device->CreateBuffer(&bd, NULL, &g_pCBChangeOnResize);
+	hr = g_device.CreateBuffer(&bd, NULL, &g_pCBChangeOnResize);
 	if (FAILED(hr))
 		return hr;
 
-	bd.ByteWidth = sizeof(CBChangesEveryFrame);
-	hr = g_device.m_device->CreateBuffer(&bd, NULL, &g_pCBChangesEveryFrame);
+	// Con "-commandlists N" cada lista toma un chunk antes de que se ejecute ninguna; el anillo
+	// aloja los frames en vuelo completos para no quedarse sin chunks a mitad de frame. Sus fences
+	// siguen la misma latencia que el FramePacer
+	hr = g_constantBufferRing.init(g_device,
+		sizeof(CBChangesEveryFrame),
+		(std::max)(256u, (g_commandListCount + 1) * g_framePacerDesc.framesInFlight),
+		g_framePacerDesc.framesInFlight);
 	if (FAILED(hr))
 		return hr;
 
-	// Load the Texture
-	hr = D3DX11CreateShaderResourceViewFromFile(g_device.m_device, "seafloor.dds", NULL, NULL, &g_pTextureRV, NULL);
+	// Mismo plano lejano que la proyeccin
+	hr = g_renderQueue.init(100.0f, 1024, &g_pipelineStateCache);
 	if (FAILED(hr))
 		return hr;
 
-	// Create the sample state
-	D3D11_SAMPLER_DESC sampDesc;
-	ZeroMemory(&sampDesc, sizeof(sampDesc));
-	sampDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-	sampDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-	sampDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-	sampDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-	sampDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
-	sampDesc.MinLOD = 0;
-	sampDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	hr = g_device.m_device->CreateSamplerState(&sampDesc, &g_pSamplerLinear);
+	// Load the Texture: solo su cola de mips; el resto llega segn lo pida cada frame
+	hr = g_textureStreamer.init(g_device, g_textureBudget);
 	if (FAILED(hr))
 		return hr;
+	g_seafloorTexture = g_textureStreamer.load("seafloor.dds");
+	if (g_seafloorTexture == TextureResidency::kInvalidHandle)
+		return E_FAIL;
+	g_pTextureRV = g_textureStreamer.view(g_seafloorTexture);
+
+	// El hilo de render solo crea la textura y encola la subida cuando la imagen ya est decodificada
+	hr = g_imageDecoder.init();
+	if (FAILED(hr))
+		return hr;
+	// MonacoEngine.dds (de "-bcbench") ya trae BC7 con mips y se carga sin decodificar
+	if (GetFileAttributesA("MonacoEngine.dds") != INVALID_FILE_ATTRIBUTES &&
+		SUCCEEDED(g_logoTexture.init(g_device, "MonacoEngine.dds", DDS)))
+	{
+		g_logoReady = true;
+	}
+	else
+	{
+		ImageDecodeOptions logoOptions;
+		logoOptions.generateMips = true;
+		logoOptions.mipOptions.filter = MipFilter::Kaiser;
+		logoOptions.mipOptions.srgb = true;
+		g_imageDecoder.decodeAsync("MonacoEngine.jpg", logoOptions, [](DecodedImage& image) {
+			if (SUCCEEDED(image.result))
+				g_logoTexture.init(g_device, image, &g_uploadManager, [](unsigned int) { g_logoReady = true; });
+		});
+	}
+
+	if (g_useAtlas && g_instanceCount > 0)
+	{
+		// Cuadros de tamaos distintos, como decals pequeos; cada uno sera su propio SRV
+		TextureAtlasDesc atlasDesc;
+		atlasDesc.pageSize = 1024;
+		atlasDesc.mipOptions.srgb = true;
+		hr = g_textureAtlas.init(g_device, atlasDesc, &g_uploadManager);
+		if (FAILED(hr))
+			return hr;
+		std::mt19937 random(7);
+		for (unsigned int i = 0; i < 12; ++i)
+		{
+			unsigned int size = 32u << (i % 3);
+			unsigned int cell = size / 4;
+			unsigned char colors[2][4] = {
+				{ static_cast<unsigned char>(random()), static_cast<unsigned char>(random()), static_cast<unsigned char>(random()), 255 },
+				{ 255, 255, 255, 255 } };
+			std::vector<unsigned char> pixels(size * size * 4);
+			for (unsigned int y = 0; y < size; ++y)
+				for (unsigned int x = 0; x < size; ++x)
+					memcpy(&pixels[(y * size + x) * 4], colors[((x / cell) + (y / cell)) & 1], 4);
+			unsigned int handle = g_textureAtlas.add(pixels.data(), size, size, size * 4);
+			if (handle != TextureAtlas::kInvalidHandle && g_textureAtlas.region(handle)->page == 0)
+				g_atlasRegions.push_back(g_textureAtlas.region(handle)->uvTransform);
+		}
+		ImageDecodeOptions atlasOptions;
+		g_imageDecoder.decodeAsync("MonacoEngine.jpg", atlasOptions, [](DecodedImage& image) {
+			if (FAILED(image.result))
+				return;
+			unsigned int handle = g_textureAtlas.add(image.pixels.data(), image.width, image.height, image.rowPitch);
+			if (handle != TextureAtlas::kInvalidHandle && g_textureAtlas.region(handle)->page == 0)
+				g_atlasRegions.push_back(g_textureAtlas.region(handle)->uvTransform);
+		});
+	}
 
 	// Initialize the world matrices
 	g_World = XMMatrixIdentity();
@@ -345,15 +1640,38 @@ HRESULT InitDevice()
 void CleanupDevice()
 {
 	if (g_deviceContext.m_deviceContext) g_deviceContext.m_deviceContext->ClearState();
-
-	if (g_pSamplerLinear) g_pSamplerLinear->Release();
-	if (g_pTextureRV) g_pTextureRV->Release();
+	for (std::unique_ptr<CommandList>& commandList : g_commandLists) commandList->destroy();
+	g_commandLists.clear();
+	g_threadPool.destroy();
+	g_softwareRasterizer.destroy();
+
+	g_imageDecoder.destroy();
+	g_logoTexture.destroy();
+	g_logoReady = false;
+	g_textureAtlas.destroy();
+	g_atlasRegions.clear();
+	g_textureStreamer.destroy();
+	g_seafloorTexture = TextureResidency::kInvalidHandle;
+	g_pTextureRV = NULL;
 	if (g_pCBNeverChanges) g_pCBNeverChanges->Release();
 	if (g_pCBChangeOnResize) g_pCBChangeOnResize->Release();
-	if (g_pCBChangesEveryFrame) g_pCBChangesEveryFrame->Release();
+	g_constantBufferRing.destroy();
+	g_renderQueue.destroy();
+	g_instanceBatcher.destroy();
+	g_geometryPool.destroy();
+	g_uploadManager.destroy();
+	g_framePacer.destroy();
+	g_renderGraph.destroy();
+	g_renderTargetPool.destroy();
 	if (g_pVertexBuffer) g_pVertexBuffer->Release();
 	if (g_pIndexBuffer) g_pIndexBuffer->Release();
-	g_shaderProgram.destroy();
+	g_shaderHotReload.destroy();
+	g_pipelineStateCache.destroy();
+	if (g_instanceCount > 0)
+		g_shaderPermutations.saveVariantSet("MonacoEngine.variants");
+	g_shaderPermutations.destroy();
+	g_shaderCompiler.destroy();
+	g_shaderCache.destroy();
 	g_depthStencil.destroy();
 	g_depthStencilView.destroy();
 	g_renderTargetView.destroy();
@@ -396,6 +1714,8 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 //--------------------------------------------------------------------------------------
 void Render()
 {
+	g_framePacer.beginFrame();
+
 	// Update our time
 	static float t = 0.0f;
 	if (g_swapChain.m_driverType == D3D_DRIVER_TYPE_REFERENCE)
@@ -419,25 +1739,87 @@ void Render()
 	g_vMeshColor.y = (cosf(t * 3.0f) + 1.0f) * 0.5f;
 	g_vMeshColor.z = (sinf(t * 5.0f) + 1.0f) * 0.5f;
 
-	// Set Render Target View
+	// Imgenes decodificadas en segundo plano: sus subidas entran en el presupuesto de este frame
+	g_imageDecoder.update();
+	// Copias pendientes de este frame (dentro del presupuesto), antes de cualquier draw
+	g_uploadManager.update(g_deviceContext);
+	// Mips de seafloor.dds para el tamao del cubo (lado de 2 unidades) visto desde la cmara
+	XMVECTOR eye = XMMatrixInverse(nullptr, g_View).r[3];
+	float cubeSize = TextureResidency::projectedSize(1.0f, XMVectorGetX(XMVector3Length(eye)), XM_PIDIV4,
+		static_cast<float>(g_window.m_height));
+	g_textureStreamer.request(g_seafloorTexture, cubeSize);
+	g_textureStreamer.update(g_deviceContext);
+	g_pTextureRV = g_textureStreamer.view(g_seafloorTexture);
+	// Shaders editados en disco; antes de las variantes porque les encola su recarga
+	g_shaderHotReload.update();
+	// Variantes de shader que terminaron de compilarse en segundo plano
+	g_shaderPermutations.update();
+
+	if (!g_commandLists.empty())
+	{
+		RenderCommandLists();
+		g_framePacer.beginPresent();
+		g_framePacer.endPresent();
+		return;
+	}
+
+	// El back buffer y la profundidad son externos; el pase de escena los limpia y dibuja
 	float ClearColor[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
-	g_renderTargetView.render(g_deviceContext, g_depthStencilView, 1, ClearColor);
+	g_renderTargetPool.update();
+	g_renderGraph.update();
+	unsigned int backBuffer = g_renderGraph.importRenderTarget("BackBuffer", g_renderTargetView.m_renderTargetView);
+	unsigned int depthBuffer = g_renderGraph.importDepthStencil("DepthBuffer", g_depthStencilView.m_depthStencilView);
+	// Mismo tamao y muestras que el depth buffer, que se comparte con el pase de escena
+	RenderTargetDesc sceneColorDesc;
+	sceneColorDesc.width = g_window.m_width;
+	sceneColorDesc.height = g_window.m_height;
+	sceneColorDesc.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	sceneColorDesc.sampleCount = 4;
+	unsigned int sceneColor = g_renderGraph.createTexture("SceneColor", sceneColorDesc);
+	g_renderGraph.addPass("Scene",
+		[&](RenderGraphBuilder& builder) {
+			builder.writeColor(sceneColor, RenderGraphLoadOp::Clear, ClearColor);
+			builder.writeDepth(depthBuffer, RenderGraphLoadOp::Clear, 1.0f, 0);
+		},
+		[](DeviceContext&, const RenderGraph&) {
+			RenderScene();
+		});
+	g_renderGraph.addPass("Composite",
+		[&](RenderGraphBuilder& builder) {
+			builder.read(sceneColor);
+			builder.writeColor(backBuffer, RenderGraphLoadOp::DontCare, ClearColor);
+		},
+		[sceneColor](DeviceContext& context, const RenderGraph& graph) {
+			RenderComposite(context, graph.shaderResourceView(sceneColor));
+		});
+	if (SUCCEEDED(g_renderGraph.compile()))
+		g_renderGraph.execute(g_deviceContext);
 
+	//
+	// Present our back buffer to our front buffer
+	//
+	g_framePacer.beginPresent();
+	if (!g_headless)
+		g_swapChain.present(g_framePacer.syncInterval());
+	g_framePacer.endPresent();
+	//g_pSwapChain->Present( 0, 0 );
+}
+
+//--------------------------------------------------------------------------------------
+// Draw the cube (and the instanced grid) into the bound render targets
+//--------------------------------------------------------------------------------------
+void RenderScene()
+{
 	// Set Viewport
 	g_viewport.render(g_deviceContext);
 
-	// Set depth stencil view
-	g_depthStencilView.render(g_deviceContext);
-
-	// Set shader program
-	g_shaderProgram.render(g_deviceContext);
 	//
 	// Update variables that change once per frame
 	//
 	CBChangesEveryFrame cb;
 	cb.mWorld = XMMatrixTranspose(g_World);
 	cb.vMeshColor = g_vMeshColor;
-	g_deviceContext.UpdateSubresource(g_pCBChangesEveryFrame, 0, NULL, &cb, 0, 0);
+	ID3D11Buffer* cbChangesEveryFrame = g_constantBufferRing.allocate(g_deviceContext, cb);
 
 	//
 	// Render the cube
@@ -445,15 +1827,139 @@ void Render()
 
 	g_deviceContext.VSSetConstantBuffers(0, 1, &g_pCBNeverChanges);
 	g_deviceContext.VSSetConstantBuffers(1, 1, &g_pCBChangeOnResize);
-	g_deviceContext.VSSetConstantBuffers(2, 1, &g_pCBChangesEveryFrame);
-	g_deviceContext.PSSetConstantBuffers(2, 1, &g_pCBChangesEveryFrame);
-	g_deviceContext.PSSetShaderResources(0, 1, &g_pTextureRV);
-	g_deviceContext.PSSetSamplers(0, 1, &g_pSamplerLinear);
-	g_deviceContext.DrawIndexed(36, 0, 0);
 
-	//
-	// Present our back buffer to our front buffer
-	//
-	g_swapChain.present();
-	//g_pSwapChain->Present( 0, 0 );
-}
\ No newline at end of file
+	DrawItem cube;
+	cube.pipelineState = g_cubePipelineState;
+	cube.texture = g_pTextureRV;
+	const GeometryRange* cubeRange = g_geometryPool.range(g_cubeGeometry);
+	cube.vertexBuffer = g_geometryPool.vertexBuffer();
+	cube.vertexStride = sizeof(SimpleVertex);
+	cube.indexBuffer = g_geometryPool.indexBuffer();
+	cube.indexFormat = DXGI_FORMAT_R32_UINT;
+	cube.constantBuffer = cbChangesEveryFrame;
+	cube.indexCount = cubeRange->indexCount;
+	cube.startIndex = cubeRange->startIndex;
+	cube.baseVertex = static_cast<int>(cubeRange->baseVertex);
+	float cubeDepth = XMVectorGetZ(XMVector3TransformCoord(g_World.r[3], g_View));
+
+	g_renderQueue.update();
+	g_renderQueue.push(cube, 0, cubeDepth);
+	g_renderQueue.submit(g_deviceContext);
+
+	if (g_instanceCount > 0)
+	{
+		// Rejilla de cubos detrs del principal; el color y la matriz viajan por instancia
+		g_pipelineStateCache.apply(g_deviceContext, g_instancedPipelineState);
+		// Hasta que la variante (o un respaldo compatible) est lista quedan los shaders del estado
+		if (ShaderProgram* variant = g_shaderPermutations.request(g_instancedVariant))
+			variant->render(g_deviceContext);
+		if (g_useAtlas && g_textureAtlas.pageCount() > 0)
+			g_textureAtlas.render(g_deviceContext, 0);
+		else if (g_logoReady)
+			g_logoTexture.render(g_deviceContext, 0, 1);
+		g_instanceBatcher.update();
+		unsigned int side = 1;
+		while (side * side < g_instanceCount)
+			++side;
+		for (unsigned int i = 0; i < g_instanceCount; ++i)
+		{
+			float x = ((i % side) - (side - 1) * 0.5f) * 1.5f;
+			float z = 4.0f + (i / side) * 1.5f;
+			InstanceData instance;
+			XMStoreFloat4x4(&instance.mWorld, XMMatrixScaling(0.5f, 0.5f, 0.5f) * g_World * XMMatrixTranslation(x, 0.0f, z));
+			instance.vColor = g_vMeshColor;
+			instance.vCustom = g_atlasRegions.empty() ? XMFLOAT4(static_cast<float>(i), 0.0f, 0.0f, 0.0f)
+				: g_atlasRegions[i % g_atlasRegions.size()];
+			g_instanceBatcher.add(g_cubeMesh, instance);
+		}
+		g_instanceBatcher.render(g_deviceContext);
+	}
+
+	// Fence del frame: los chunks usados se reciclan cuando la GPU lo alcance
+	g_constantBufferRing.update(g_deviceContext);
+}
+
+//--------------------------------------------------------------------------------------
+// Resolve the multisampled scene colour into the bound back buffer
+//--------------------------------------------------------------------------------------
+void RenderComposite(DeviceContext& context, ID3D11ShaderResourceView* sceneColor)
+{
+	// El backend en CPU solo ejecuta MonacoEngine.fx y ya tiene la escena en su buffer de color
+	if (g_software)
+		return;
+
+	g_pipelineStateCache.apply(context, g_compositePipelineState);
+	context.PSSetShaderResources(0, 1, &sceneColor);
+	const GeometryRange* range = g_geometryPool.range(g_fullscreenGeometry);
+	ID3D11Buffer* vertexBuffer = g_geometryPool.vertexBuffer();
+	UINT stride = sizeof(SimpleVertex);
+	UINT offset = 0;
+	context.IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+	context.IASetIndexBuffer(g_geometryPool.indexBuffer(), DXGI_FORMAT_R32_UINT, 0);
+	context.DrawIndexed(range->indexCount, range->startIndex, static_cast<int>(range->baseVertex));
+
+	// SceneColor vuelve a ser render target en el siguiente frame
+	ID3D11ShaderResourceView* nullView = nullptr;
+	context.PSSetShaderResources(0, 1, &nullView);
+}
+
+//--------------------------------------------------------------------------------------
+// Record one cube per command list on the worker threads and replay them in list order
+//--------------------------------------------------------------------------------------
+void RenderCommandLists()
+{
+	float ClearColor[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
+	g_renderTargetView.render(g_deviceContext, g_depthStencilView, 1, ClearColor);
+	g_depthStencilView.render(g_deviceContext);
+
+	// Map solo es vlido en el contexto inmediato: las constantes de cada lista se escriben antes
+	unsigned int listCount = static_cast<unsigned int>(g_commandLists.size());
+	std::vector<ID3D11Buffer*> cbChangesEveryFrame(listCount);
+	for (unsigned int i = 0; i < listCount; ++i)
+	{
+		// Las copias se reparten en una fila centrada en el origen
+		float x = (static_cast<float>(i) - (listCount - 1) * 0.5f) * 2.5f;
+		CBChangesEveryFrame cb;
+		cb.mWorld = XMMatrixTranspose(g_World * XMMatrixTranslation(x, 0.0f, 0.0f));
+		cb.vMeshColor = g_vMeshColor;
+		cbChangesEveryFrame[i] = g_constantBufferRing.allocate(g_deviceContext, cb);
+		// Sin chunk libre se graban solo las listas anteriores
+		if (!cbChangesEveryFrame[i])
+		{
+			listCount = i;
+			break;
+		}
+	}
+
+	g_threadPool.parallelFor(listCount, [&cbChangesEveryFrame](unsigned int i) {
+		CommandList& commandList = *g_commandLists[i];
+		DeviceContext& context = commandList.m_context;
+		commandList.begin();
+
+		// Cada lista empieza sin estado: se asigna todo lo que usa el draw
+		g_renderTargetView.render(context, g_depthStencilView, 1);
+		g_viewport.render(context);
+		g_pipelineStateCache.apply(context, g_cubePipelineState);
+
+		UINT stride = sizeof(SimpleVertex);
+		UINT offset = 0;
+		context.IASetVertexBuffers(0, 1, &g_pVertexBuffer, &stride, &offset);
+		context.IASetIndexBuffer(g_pIndexBuffer, DXGI_FORMAT_R16_UINT, 0);
+		context.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		context.VSSetConstantBuffers(0, 1, &g_pCBNeverChanges);
+		context.VSSetConstantBuffers(1, 1, &g_pCBChangeOnResize);
+		context.VSSetConstantBuffers(2, 1, &cbChangesEveryFrame[i]);
+		context.PSSetConstantBuffers(2, 1, &cbChangesEveryFrame[i]);
+		context.PSSetShaderResources(0, 1, &g_pTextureRV);
+		context.DrawIndexed(36, 0, 0);
+
+		commandList.finish();
+	});
+
+	// La reproduccin sigue el orden de las listas, no el orden en que terminaron
+	for (unsigned int i = 0; i < listCount; ++i)
+		g_commandLists[i]->execute(g_deviceContext);
+
+	g_constantBufferRing.update(g_deviceContext);
+}
@@ -0,0 +1,51 @@
+//--------------------------------------------------------------------------------------
+// File: MonacoEngineComposite.fx
+//
+// Composite pass of the render graph: resolves the multisampled scene colour into the
+// back buffer with a fullscreen quad whose positions are already in clip space.
+//--------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------
+// Constant Buffer Variables
+//--------------------------------------------------------------------------------------
+Texture2DMS<float4> txScene : register( t0 );
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos : POSITION;
+    float2 Tex : TEXCOORD0;
+};
+
+struct PS_INPUT
+{
+    float4 Pos : SV_POSITION;
+};
+
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    PS_INPUT output = (PS_INPUT)0;
+    output.Pos = float4( input.Pos.xy, 0.0f, 1.0f );
+
+    return output;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+float4 PS( PS_INPUT input) : SV_Target
+{
+    uint width, height, samples;
+    txScene.GetDimensions( width, height, samples );
+
+    float4 color = 0;
+    for( uint i = 0; i < samples; ++i )
+        color += txScene.Load( int2( input.Pos.xy ), i );
+
+    return color / samples;
+}
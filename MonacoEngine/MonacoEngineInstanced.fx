@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------------------
+// File: MonacoEngineInstanced.fx
+//
+// Instanced variant of MonacoEngine.fx: the world matrix and colour come from a
+// per-instance vertex stream (InstanceData) instead of cbChangesEveryFrame.
+//--------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------
+// Constant Buffer Variables
+//--------------------------------------------------------------------------------------
+Texture2D txDiffuse : register( t0 );
+SamplerState samLinear : register( s0 );
+
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos : POSITION;
+    float2 Tex : TEXCOORD0;
+    // Per-instance stream (slot 1): rows of the world matrix, colour and free data
+    float4 World0 : WORLD0;
+    float4 World1 : WORLD1;
+    float4 World2 : WORLD2;
+    float4 World3 : WORLD3;
+    float4 Color : COLOR0;
+    float4 Custom : CUSTOM0;
+};
+
+struct PS_INPUT
+{
+    float4 Pos : SV_POSITION;
+    float2 Tex : TEXCOORD0;
+    float4 Color : COLOR0;
+};
+
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    PS_INPUT output = (PS_INPUT)0;
+    float4x4 world = float4x4( input.World0, input.World1, input.World2, input.World3 );
+    output.Pos = mul( input.Pos, world );
+    output.Pos = mul( output.Pos, View );
+    output.Pos = mul( output.Pos, Projection );
+    output.Tex = input.Tex;
+    output.Color = input.Color;
+
+    return output;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+float4 PS( PS_INPUT input) : SV_Target
+{
+    return txDiffuse.Sample( samLinear, input.Tex ) * input.Color;
+}
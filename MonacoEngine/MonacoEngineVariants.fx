@@ -0,0 +1,102 @@
+//--------------------------------------------------------------------------------------
+// File: MonacoEngineVariants.fx
+//
+// Permutation source for ShaderPermutations. Keywords:
+//   TEXTURED      multiply by txDiffuse
+//   VERTEX_COLOR  multiply by a per-vertex colour (COLOR1, its own stream in slot 2;
+//                 SimpleVertex in slot 0 has no colour)
+//   INSTANCED     world matrix and colour from the per-instance stream (slot 1)
+//                 instead of cbChangesEveryFrame
+//   ATLAS         with INSTANCED: Custom is the instance's TextureAtlas region,
+//                 uv * Custom.xy + Custom.zw
+//--------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------
+// Constant Buffer Variables
+//--------------------------------------------------------------------------------------
+Texture2D txDiffuse : register( t0 );
+SamplerState samLinear : register( s0 );
+
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+cbuffer cbChangesEveryFrame : register( b2 )
+{
+    matrix World;
+    float4 vMeshColor;
+};
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos : POSITION;
+    float2 Tex : TEXCOORD0;
+#ifdef VERTEX_COLOR
+    float4 VertexColor : COLOR1;
+#endif
+#ifdef INSTANCED
+    // Per-instance stream (slot 1): rows of the world matrix, colour and free data
+    float4 World0 : WORLD0;
+    float4 World1 : WORLD1;
+    float4 World2 : WORLD2;
+    float4 World3 : WORLD3;
+    float4 Color : COLOR0;
+    float4 Custom : CUSTOM0;
+#endif
+};
+
+struct PS_INPUT
+{
+    float4 Pos : SV_POSITION;
+    float2 Tex : TEXCOORD0;
+    float4 Color : COLOR0;
+};
+
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    PS_INPUT output = (PS_INPUT)0;
+#ifdef INSTANCED
+    float4x4 world = float4x4( input.World0, input.World1, input.World2, input.World3 );
+    output.Color = input.Color;
+#else
+    float4x4 world = World;
+    output.Color = vMeshColor;
+#endif
+#ifdef VERTEX_COLOR
+    output.Color *= input.VertexColor;
+#endif
+    output.Pos = mul( input.Pos, world );
+    output.Pos = mul( output.Pos, View );
+    output.Pos = mul( output.Pos, Projection );
+#if defined( INSTANCED ) && defined( ATLAS )
+    output.Tex = input.Tex * input.Custom.xy + input.Custom.zw;
+#else
+    output.Tex = input.Tex;
+#endif
+
+    return output;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+float4 PS( PS_INPUT input) : SV_Target
+{
+    float4 color = input.Color;
+#ifdef TEXTURED
+    color *= txDiffuse.Sample( samLinear, input.Tex );
+#endif
+    return color;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "Prerequisites.h"
+#include "MipGenerator.h"
+
+class ThreadPool;
+
+/**
+ * @brief Compromiso entre velocidad y calidad de BlockCompressor.
+ *
+ * - @c Fast: extremos por caja envolvente (BC1) o eje principal sin refinar (BC7).
+ * - @c Balanced: eje principal y un refinamiento por mnimos cuadrados.
+ * - @c High: tres refinamientos, bsqueda de los bits p de BC7 y del modo de 6 valores de BC4.
+ */
+enum class BlockCompressionQuality {
+    Fast,
+    Balanced,
+    High
+};
+
+/**
+ * @class BlockCompressor
+ * @brief Compresor de texturas a BC1, BC3, BC5 y BC7 para importar texturas sin conexin.
+ *
+ * La entrada es siempre RGBA8 (orden de @c DXGI_FORMAT_R8G8B8A8_UNORM); los formatos @c _SRGB
+ * comprimen los mismos cdigos, as que la imagen debe estar ya en sRGB. Cada bloque de 4x4
+ * se guarda por canales en flotantes y la eleccin de ndices evala cuatro pxeles a la vez
+ * con SSE contra cada color de la paleta. Las filas de bloques se reparten en un @c ThreadPool.
+ *
+ * - BC1: color de 4 tonos (sin alfa de 1 bit).
+ * - BC3: alfa como un bloque BC4 + color BC1.
+ * - BC5: canales R y G como dos bloques BC4 (mapas de normales).
+ * - BC7: solo el modo 6 (un subconjunto, RGBA con 7 bits + bit p e ndices de 4 bits).
+ *
+ * @note No llama a Direct3D; puede usarse desde cualquier hilo.
+ */
+class
+    BlockCompressor {
+public:
+    /**
+     * @brief Indica si compress() puede generar @p format.
+     */
+    static bool
+        supportsFormat(DXGI_FORMAT format);
+
+    /**
+     * @brief Bytes por bloque de 4x4: 8 para BC1 y 16 para el resto; 0 si no est soportado.
+     */
+    static unsigned int
+        blockBytes(DXGI_FORMAT format);
+
+    /**
+     * @brief Comprime una imagen RGBA8 de cualquier tamao.
+     *
+     * Los bloques del borde derecho e inferior repiten el ltimo pxel.
+     *
+     * @param pixels     Pxeles RGBA8, filas de @p rowPitch bytes.
+     * @param format     Formato BC de salida.
+     * @param blocks     Salida: filas de bloques contiguas, de izquierda a derecha.
+     * @param threadPool Si no es @c nullptr, las filas de bloques se reparten entre sus hilos.
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si el formato no est soportado o la
+     *         imagen no es vlida.
+     */
+    static HRESULT
+        compress(const unsigned char* pixels,
+            unsigned int width,
+            unsigned int height,
+            unsigned int rowPitch,
+            DXGI_FORMAT format,
+            BlockCompressionQuality quality,
+            std::vector<unsigned char>& blocks,
+            ThreadPool* threadPool = nullptr);
+
+    /**
+     * @brief Descomprime bloques de compress() a RGBA8, para medir el error.
+     *
+     * Tambin acepta BC2, que compress() no genera; @c SoftwareRasterizer lo usa para su
+     * copia en CPU de las texturas BC1 a BC3.
+     *
+     * @param blocks Filas de bloques contiguas, como las entrega compress().
+     * @return @c S_OK si fue exitoso; @c E_NOTIMPL si encuentra un bloque BC7 de un modo
+     *         distinto del 6; @c E_INVALIDARG si el formato no est soportado.
+     */
+    static HRESULT
+        decompress(const unsigned char* blocks,
+            unsigned int width,
+            unsigned int height,
+            DXGI_FORMAT format,
+            std::vector<unsigned char>& pixels);
+
+    /**
+     * @brief Comprime el nivel 0 y sus mips y escribe un DDS que @c Texture carga directamente.
+     *
+     * @param pixels Nivel 0 en RGBA8; su ancho y alto deben ser mltiplos de 4 (requisito de
+     *               Direct3D 11 para texturas comprimidas).
+     * @param mips   Niveles 1 a N de @c MipGenerator en RGBA8; puede estar vaco.
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si las dimensiones o el formato no son
+     *         vlidos; @c E_FAIL si el archivo no pudo escribirse.
+     */
+    static HRESULT
+        compressToDDS(const std::string& fileName,
+            const unsigned char* pixels,
+            unsigned int width,
+            unsigned int height,
+            unsigned int rowPitch,
+            const std::vector<MipLevel>& mips,
+            DXGI_FORMAT format,
+            BlockCompressionQuality quality,
+            ThreadPool* threadPool = nullptr);
+};
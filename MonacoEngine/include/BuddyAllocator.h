@@ -0,0 +1,144 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct BuddyMove
+ * @brief Reubicacin de un bloque vivo producida por BuddyAllocator::defragment().
+ */
+struct BuddyMove {
+    unsigned int from;
+    unsigned int to;
+    unsigned int size;
+};
+
+/**
+ * @class BuddyAllocator
+ * @brief Asignador buddy de rangos dentro de un espacio de tamao potencia de dos.
+ *
+ * Solo administra offsets (en las unidades que elija quien lo usa: bytes, vrtices,
+ * ndices, ...), por lo que puede probarse sin Direct3D. Cada asignacin se redondea a
+ * una potencia de dos de bloques mnimos; al liberar, un bloque se une con su buddy si
+ * este tambin est libre.
+ *
+ * Las listas libres son listas doblemente ligadas guardadas en arreglos indexados por
+ * bloque mnimo: asignar y liberar cuestan O(log n) sin reservar memoria.
+ */
+class
+    BuddyAllocator {
+public:
+    BuddyAllocator() = default;
+    ~BuddyAllocator() = default;
+
+    /**
+     * @brief Define el espacio administrado.
+     *
+     * @param capacity     Tamao total; potencia de dos y mltiplo de @p minBlockSize.
+     * @param minBlockSize Tamao del bloque ms pequeo; potencia de dos.
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si los parmetros no son vlidos.
+     */
+    HRESULT
+        init(unsigned int capacity, unsigned int minBlockSize);
+
+    /**
+     * @brief Mtodo de marcador; el asignador no tiene trabajo por frame.
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Mtodo de marcador; el asignador no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Libera las tablas internas.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Reserva un bloque de al menos @p size unidades.
+     *
+     * @param size   Tamao pedido (mayor que cero).
+     * @param offset Offset de salida del bloque.
+     * @return @c true si hubo un bloque libre; @c false si no.
+     */
+    bool
+        allocate(unsigned int size, unsigned int& offset);
+
+    /**
+     * @brief Libera el bloque que empieza en @p offset.
+     */
+    void
+        free(unsigned int offset);
+
+    /**
+     * @brief Tamao real (redondeado) del bloque asignado en @p offset; 0 si no hay ninguno.
+     */
+    unsigned int
+        blockSize(unsigned int offset) const;
+
+    /**
+     * @brief Reempaca los bloques vivos al inicio del espacio, de mayor a menor.
+     *
+     * Con bloques potencia de dos, asignarlos de mayor a menor sobre un espacio vaco no
+     * deja huecos, as que el espacio libre queda contiguo al final.
+     *
+     * @param moves       Salida: un elemento por bloque vivo (incluye los que no cambian),
+     *                    para que quien llama copie los datos de su posicin anterior.
+     * @param newCapacity Nueva capacidad (0 conserva la actual); debe alojar los bloques vivos.
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si @p newCapacity no es vlida.
+     *
+     * @note Los rangos de origen y destino pueden solaparse: copiar desde una copia anterior.
+     */
+    HRESULT
+        defragment(std::vector<BuddyMove>& moves, unsigned int newCapacity = 0);
+
+    unsigned int
+        capacity() const { return m_capacity; }
+
+    unsigned int
+        minBlockSize() const { return m_minBlockSize; }
+
+    /**
+     * @brief Unidades asignadas, contando el redondeo de cada bloque.
+     */
+    unsigned int
+        usedSize() const { return m_usedSize; }
+
+    /**
+     * @brief Tamao del bloque libre ms grande (la mayor asignacin que cabra ahora).
+     */
+    unsigned int
+        largestFreeBlock() const;
+
+    /**
+     * @brief Siguiente potencia de dos mayor o igual a @p value (1 para 0).
+     */
+    static unsigned int
+        nextPowerOfTwo(unsigned int value);
+
+private:
+    void
+        pushFree(unsigned int block, unsigned int order);
+
+    void
+        removeFree(unsigned int block, unsigned int order);
+
+private:
+    static constexpr unsigned int kNone = 0xFFFFFFFF;
+    static constexpr unsigned char kNoBlock = 0xFF;
+    static constexpr unsigned char kAllocated = 0x80;
+
+    unsigned int m_capacity = 0;
+    unsigned int m_minBlockSize = 0;
+    unsigned int m_maxOrder = 0;
+    unsigned int m_usedSize = 0;
+
+    // Por bloque mnimo: estado del bloque que empieza ah (orden | kAllocated, o kNoBlock)
+    std::vector<unsigned char> m_state;
+    std::vector<unsigned int> m_next;
+    std::vector<unsigned int> m_prev;
+    std::vector<unsigned int> m_freeHeads;
+};
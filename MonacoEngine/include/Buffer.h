@@ -13,6 +13,7 @@ class DeviceContext;
  * Soporta:
  * - Creacin como Vertex/Index buffer a partir de un @c MeshComponent.
  * - Creacin como Constant buffer a partir de un tamao (ByteWidth).
+ * - Creacin como flujo de vrtices con stride libre (p. ej. datos por instancia), esttico o dinmico.
  * - Actualizacin de datos (p. ej. @c UpdateSubresource).
  * - Enlace del buffer a la etapa correspondiente del pipeline.
  *
@@ -65,6 +66,45 @@ public:
     HRESULT
         init(Device& device, unsigned int ByteWidth);
 
+    /**
+     * @brief Inicializa el buffer como Vertex Buffer de @p count elementos de @p stride bytes.
+     *
+     * Permite flujos distintos de @c SimpleVertex, como el buffer de @c InstanceData que
+     * se enlaza en un segundo slot para dibujar con instancias.
+     *
+     * @param device   Dispositivo con el que se crear el recurso.
+     * @param stride   Tamao de un elemento en bytes.
+     * @param count    Nmero de elementos.
+     * @param data     Datos iniciales (puede ser @c nullptr si @p dynamic es @c true).
+     * @param dynamic  Crea el buffer @c D3D11_USAGE_DYNAMIC para reescribirlo con write().
+     * @return @c S_OK si la creacin fue exitosa; cdigo @c HRESULT en caso contrario.
+     *
+     * @post Si retorna @c S_OK, @c m_bindFlag == D3D11_BIND_VERTEX_BUFFER.
+     */
+    HRESULT
+        init(Device& device,
+            unsigned int stride,
+            unsigned int count,
+            const void* data,
+            bool dynamic);
+
+    /**
+     * @brief Reescribe el inicio de un buffer dinmico con @c Map(WRITE_DISCARD).
+     *
+     * @param deviceContext Contexto inmediato.
+     * @param data          Datos a copiar.
+     * @param bytes         Bytes a copiar; no debe exceder el tamao del buffer.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        write(DeviceContext& deviceContext, const void* data, unsigned int bytes);
+
+    /**
+     * @brief Tamao del buffer en bytes.
+     */
+    unsigned int
+        size() const { return m_size; }
+
     /**
      * @brief Actualiza el contenido del buffer (tpicamente mediante @c UpdateSubresource).
      *
@@ -161,4 +201,9 @@ private:
      * @brief Bandera de enlace (@c D3D11_BIND_* ) que define el rol del buffer.
      */
     unsigned int m_bindFlag = 0;
+
+    /**
+     * @brief Tamao del recurso en bytes (@c ByteWidth).
+     */
+    unsigned int m_size = 0;
 };
\ No newline at end of file
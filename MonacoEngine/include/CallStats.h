@@ -0,0 +1,179 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @enum GraphicsCall
+ * @brief Identifica cada llamada de @c Device / @c DeviceContext que se contabiliza.
+ *
+ * El orden define el ndice dentro de la tabla de @c CallStats; @c Count debe
+ * permanecer al final.
+ */
+enum class GraphicsCall : unsigned int {
+    CreateBuffer = 0,
+    CreateTexture2D,
+    CreateRenderTargetView,
+    CreateDepthStencilView,
+    CreateShaderResourceView,
+    CreateVertexShader,
+    CreatePixelShader,
+    CreateInputLayout,
+    CreateSamplerState,
+    CreateRasterizerState,
+    CreateBlendState,
+    CreateDepthStencilState,
+    CreateDeferredContext,
+    CreateQuery,
+    RSSetViewports,
+    PSSetShaderResources,
+    IASetInputLayout,
+    VSSetShader,
+    PSSetShader,
+    UpdateSubresource,
+    CopySubresourceRegion,
+    IASetVertexBuffers,
+    IASetIndexBuffer,
+    PSSetSamplers,
+    RSSetState,
+    OMSetBlendState,
+    OMSetDepthStencilState,
+    OMSetRenderTargets,
+    IASetPrimitiveTopology,
+    ClearRenderTargetView,
+    ClearDepthStencilView,
+    VSSetConstantBuffers,
+    PSSetConstantBuffers,
+    DrawIndexed,
+    DrawIndexedInstanced,
+    FinishCommandList,
+    ExecuteCommandList,
+    Map,
+    Unmap,
+    End,
+    GetData,
+    Count
+};
+
+/**
+ * @struct CallRecord
+ * @brief Acumulado de una llamada: nmero de invocaciones, bytes transferidos y tiempo de CPU.
+ *
+ * @c elided cuenta las llamadas que el cdigo pidi pero no llegaron al runtime, ya sea
+ * porque no cambiaban el estado o porque se combinaron con otras en una sola llamada.
+ */
+struct CallRecord {
+    unsigned long long count = 0;
+    unsigned long long bytes = 0;
+    unsigned long long nanoseconds = 0;
+    unsigned long long elided = 0;
+};
+
+/**
+ * @class CallStats
+ * @brief Contabilidad de llamadas al runtime de Direct3D 11 (conteos, bytes y tiempos).
+ *
+ * @c Device y @c DeviceContext registran aqu cada llamada que envuelven, de modo que
+ * el costo de CPU de @c Render() y de la ruta de envo puede medirse tambin con el
+ * backend sin GPU (@c D3D_DRIVER_TYPE_NULL).
+ *
+ * @note La tabla es de tamao fijo e indexada por @c GraphicsCall; registrar no reserva memoria.
+ */
+class
+    CallStats {
+public:
+    CallStats() = default;
+    ~CallStats() = default;
+
+    /**
+     * @brief Acumula una invocacin de @p call.
+     *
+     * @param call        Llamada a registrar.
+     * @param bytes       Bytes enviados o creados por la llamada (0 si no aplica).
+     * @param nanoseconds Tiempo de CPU que tom la llamada al runtime.
+     */
+    void
+        record(GraphicsCall call, unsigned long long bytes, unsigned long long nanoseconds);
+
+    /**
+     * @brief Acumula @p calls llamadas de @p call que no se enviaron al runtime.
+     */
+    void
+        recordElided(GraphicsCall call, unsigned long long calls = 1);
+
+    /**
+     * @brief Reinicia todos los contadores a cero.
+     */
+    void
+        reset();
+
+    /**
+     * @brief Devuelve el acumulado de una llamada.
+     */
+    const CallRecord&
+        get(GraphicsCall call) const { return m_records[static_cast<unsigned int>(call)]; }
+
+    /**
+     * @brief Suma de invocaciones de todas las llamadas registradas.
+     */
+    unsigned long long
+        totalCalls() const;
+
+    /**
+     * @brief Suma de llamadas omitidas por el filtro de estado redundante.
+     */
+    unsigned long long
+        totalElided() const;
+
+    /**
+     * @brief Genera una tabla legible con las llamadas que tienen al menos una invocacin.
+     *
+     * @param title Encabezado de la tabla (p. ej. "Device" o "DeviceContext").
+     * @return Texto con una fila por llamada: invocaciones, omitidas, bytes, tiempo total y promedio.
+     */
+    std::string
+        report(const std::string& title) const;
+
+    /**
+     * @brief Nombre de la llamada tal como aparece en la API de D3D11.
+     */
+    static const char*
+        callName(GraphicsCall call);
+
+public:
+    /**
+     * @brief Permite desactivar la contabilidad sin tocar los sitios de llamada.
+     */
+    bool m_enabled = true;
+
+private:
+    CallRecord m_records[static_cast<unsigned int>(GraphicsCall::Count)];
+};
+
+/**
+ * @class ScopedCallTimer
+ * @brief Mide el tiempo de una llamada y lo registra en @c CallStats al salir de alcance.
+ */
+class
+    ScopedCallTimer {
+public:
+    ScopedCallTimer(CallStats& stats, GraphicsCall call, unsigned long long bytes = 0)
+        : m_stats(stats), m_call(call), m_bytes(bytes),
+        m_start(std::chrono::high_resolution_clock::now()) {}
+
+    ~ScopedCallTimer() {
+        if (!m_stats.m_enabled) {
+            return;
+        }
+        auto elapsed = std::chrono::high_resolution_clock::now() - m_start;
+        m_stats.record(m_call, m_bytes,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    ScopedCallTimer(const ScopedCallTimer&) = delete;
+    ScopedCallTimer& operator=(const ScopedCallTimer&) = delete;
+
+private:
+    CallStats& m_stats;
+    GraphicsCall m_call;
+    unsigned long long m_bytes;
+    std::chrono::high_resolution_clock::time_point m_start;
+};
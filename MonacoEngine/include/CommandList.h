@@ -0,0 +1,284 @@
+#pragma once
+#include "Prerequisites.h"
+#include "DeviceContext.h"
+
+class Device;
+
+/**
+ * @class CommandList
+ * @brief Lista de comandos que un hilo de trabajo graba y el hilo principal reproduce.
+ *
+ * Cada lista expone un @c DeviceContext (@c m_context) que se usa igual que el contexto
+ * inmediato, por lo que los componentes existentes (@c Viewport, @c ShaderProgram,
+ * @c RenderTargetView, ...) pueden grabar en ella sin cambios. Hay dos modos:
+ * - Diferido: @c m_context envuelve un contexto diferido de D3D11 y finish() produce un
+ *   @c ID3D11CommandList que execute() enva con @c ExecuteCommandList.
+ * - Portable: las llamadas se guardan en un flujo propio (comandos + copia de los datos)
+ *   y execute() las vuelve a emitir a travs del @c DeviceContext inmediato.
+ *
+ * Flujo por frame: begin() -> grabar con @c m_context -> finish() en el hilo de trabajo;
+ * despus execute() en el hilo principal, en el orden deseado.
+ *
+ * @note Como en D3D11, cada lista empieza sin estado: debe asignar todo lo que use.
+ * @note Los objetos referenciados (buffers, vistas, shaders) no se retienen y deben seguir
+ *       vivos hasta que la lista se ejecute. Los datos de @c UpdateSubresource s se copian.
+ * @warning Una lista solo puede grabarse desde un hilo a la vez.
+ */
+class
+    CommandList {
+public:
+    CommandList() = default;
+    ~CommandList() = default;
+
+    CommandList(const CommandList&) = delete;
+    CommandList& operator=(const CommandList&) = delete;
+
+    /**
+     * @brief Prepara la lista y elige el modo de grabacin.
+     *
+     * Usa el modo portable si @p useDeferredContext es @c false, si el dispositivo tiene un
+     * @c SoftwareRasterizer conectado (que necesita ver cada llamada) o si no se puede
+     * crear el contexto diferido.
+     *
+     * @param device             Dispositivo que crea el contexto diferido.
+     * @param immediateContext   Contexto inmediato donde se ejecutar la lista.
+     * @param useDeferredContext Preferir contextos diferidos de D3D11 cuando estn disponibles.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        init(Device& device,
+            DeviceContext& immediateContext,
+            bool useDeferredContext = true);
+
+    /**
+     * @brief Mtodo de marcador; la grabacin ocurre a travs de @c m_context.
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Ejecuta la lista en el contexto inmediato indicado en init().
+     */
+    void
+        render() { execute(*m_immediateContext); }
+
+    /**
+     * @brief Libera el contexto diferido, la lista de D3D11 y el flujo grabado.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Descarta lo grabado y deja la lista lista para grabar de nuevo.
+     */
+    void
+        begin();
+
+    /**
+     * @brief Cierra la grabacin.
+     *
+     * En modo diferido llama a @c FinishCommandList; en modo portable no hace nada ms.
+     * Puede llamarse desde el hilo que grab.
+     *
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        finish();
+
+    /**
+     * @brief Reproduce la lista en @p immediateContext.
+     *
+     * @param immediateContext Contexto inmediato (solo desde el hilo que lo posee).
+     */
+    void
+        execute(DeviceContext& immediateContext);
+
+    /**
+     * @brief Indica si la lista usa un contexto diferido de D3D11.
+     */
+    bool
+        isDeferred() const { return m_deferredContext != nullptr; }
+
+    /**
+     * @brief Nmero de comandos grabados en modo portable.
+     */
+    unsigned int
+        commandCount() const { return static_cast<unsigned int>(m_commands.size()); }
+
+    // Grabacin en modo portable; las llama @c DeviceContext cuando @c m_recorder apunta aqu
+    void
+        RSSetViewports(unsigned int NumViewports, const D3D11_VIEWPORT* pViewports);
+
+    void
+        PSSetShaderResources(unsigned int StartSlot,
+            unsigned int NumViews,
+            ID3D11ShaderResourceView* const* ppShaderResourceViews);
+
+    void
+        IASetInputLayout(ID3D11InputLayout* pInputLayout);
+
+    void
+        VSSetShader(ID3D11VertexShader* pVertexShader,
+            ID3D11ClassInstance* const* ppClassInstances,
+            unsigned int NumClassInstances);
+
+    void
+        PSSetShader(ID3D11PixelShader* pPixelShader,
+            ID3D11ClassInstance* const* ppClassInstances,
+            unsigned int NumClassInstances);
+
+    /**
+     * @param bytes Tamao de @p pSrcData calculado por @c DeviceContext; se copia a la lista.
+     */
+    void
+        UpdateSubresource(ID3D11Resource* pDstResource,
+            unsigned int DstSubresource,
+            const D3D11_BOX* pDstBox,
+            const void* pSrcData,
+            unsigned int SrcRowPitch,
+            unsigned int SrcDepthPitch,
+            unsigned long long bytes);
+
+    void
+        IASetVertexBuffers(unsigned int StartSlot,
+            unsigned int NumBuffers,
+            ID3D11Buffer* const* ppVertexBuffers,
+            const unsigned int* pStrides,
+            const unsigned int* pOffsets);
+
+    void
+        IASetIndexBuffer(ID3D11Buffer* pIndexBuffer,
+            DXGI_FORMAT Format,
+            unsigned int Offset);
+
+    void
+        PSSetSamplers(unsigned int StartSlot,
+            unsigned int NumSamplers,
+            ID3D11SamplerState* const* ppSamplers);
+
+    void
+        RSSetState(ID3D11RasterizerState* pRasterizerState);
+
+    void
+        OMSetBlendState(ID3D11BlendState* pBlendState,
+            const float BlendFactor[4],
+            unsigned int SampleMask);
+
+    void
+        OMSetDepthStencilState(ID3D11DepthStencilState* pDepthStencilState,
+            unsigned int StencilRef);
+
+    void
+        OMSetRenderTargets(unsigned int NumViews,
+            ID3D11RenderTargetView* const* ppRenderTargetViews,
+            ID3D11DepthStencilView* pDepthStencilView);
+
+    void
+        IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY Topology);
+
+    void
+        ClearRenderTargetView(ID3D11RenderTargetView* pRenderTargetView,
+            const float ColorRGBA[4]);
+
+    void
+        ClearDepthStencilView(ID3D11DepthStencilView* pDepthStencilView,
+            unsigned int ClearFlags,
+            float Depth,
+            UINT8 Stencil);
+
+    void
+        VSSetConstantBuffers(unsigned int StartSlot,
+            unsigned int NumBuffers,
+            ID3D11Buffer* const* ppConstantBuffers);
+
+    void
+        PSSetConstantBuffers(unsigned int StartSlot,
+            unsigned int NumBuffers,
+            ID3D11Buffer* const* ppConstantBuffers);
+
+    void
+        DrawIndexed(unsigned int IndexCount,
+            unsigned int StartIndexLocation,
+            int BaseVertexLocation);
+
+    void
+        DrawIndexedInstanced(unsigned int IndexCountPerInstance,
+            unsigned int InstanceCount,
+            unsigned int StartIndexLocation,
+            int BaseVertexLocation,
+            unsigned int StartInstanceLocation);
+
+public:
+    /**
+     * @brief Contexto con el que se graba la lista.
+     * @details En modo diferido envuelve el contexto diferido; en modo portable sus
+     *          llamadas se redirigen a esta lista (su @c m_deviceContext apunta al contexto
+     *          inmediato solo para que la validacin de los componentes acepte el contexto).
+     */
+    DeviceContext m_context;
+
+private:
+    /**
+     * @brief Identifica la llamada grabada en modo portable.
+     */
+    enum class CommandType : unsigned char {
+        RSSetViewports,
+        PSSetShaderResources,
+        IASetInputLayout,
+        VSSetShader,
+        PSSetShader,
+        UpdateSubresource,
+        IASetVertexBuffers,
+        IASetIndexBuffer,
+        PSSetSamplers,
+        RSSetState,
+        OMSetBlendState,
+        OMSetDepthStencilState,
+        OMSetRenderTargets,
+        IASetPrimitiveTopology,
+        ClearRenderTargetView,
+        ClearDepthStencilView,
+        VSSetConstantBuffers,
+        PSSetConstantBuffers,
+        DrawIndexed,
+        DrawIndexedInstanced
+    };
+
+    /**
+     * @brief Comando grabado. Los arreglos y datos variables se guardan en @c m_data.
+     */
+    struct Command {
+        CommandType type;
+        void* object;           // Recurso, vista, shader o estado principal
+        unsigned int arg0;      // Slot inicial, conteo, formato, flags, ...
+        unsigned int arg1;
+        unsigned int arg2;
+        int arg3;               // BaseVertexLocation
+        float depth;
+        size_t dataOffset;      // Inicio de los datos variables en m_data
+        size_t extraOffset;     // Segundo bloque de datos (caja de UpdateSubresource, strides)
+    };
+
+    /**
+     * @brief Comando vaco de tipo @p type; los campos que no usa quedan en cero.
+     */
+    static Command
+        makeCommand(CommandType type);
+
+    /**
+     * @brief Copia @p size bytes al final de @c m_data (alineado a 16) y devuelve su offset.
+     */
+    size_t
+        pushData(const void* data, size_t size);
+
+    template<typename T>
+    const T*
+        dataAt(size_t offset) const { return reinterpret_cast<const T*>(m_data.data() + offset); }
+
+private:
+    DeviceContext* m_immediateContext = nullptr;
+    ID3D11DeviceContext* m_deferredContext = nullptr;
+    ID3D11CommandList* m_commandList = nullptr;
+    std::vector<Command> m_commands;
+    std::vector<unsigned char> m_data;
+};
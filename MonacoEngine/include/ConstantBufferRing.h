@@ -0,0 +1,120 @@
+#pragma once
+#include "Prerequisites.h"
+#include "RingAllocator.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class ConstantBufferRing
+ * @brief Asigna constantes por draw desde un anillo de buffers dinmicos en lugar de
+ *        hacer @c UpdateSubresource sobre un buffer @c D3D11_USAGE_DEFAULT.
+ *
+ * El anillo se divide en chunks de tamao fijo (mltiplo de 256 bytes), cada uno un
+ * @c ID3D11Buffer dinmico. allocate() toma el siguiente chunk, lo escribe con
+ * @c Map(WRITE_DISCARD) y devuelve el buffer listo para @c *SetConstantBuffers.
+ *
+ * Un chunk solo se reutiliza cuando el fence (@c D3D11_QUERY_EVENT) del frame que lo us
+ * ya se seal, as el driver no tiene que renombrar memoria que la GPU an lee. Si el
+ * anillo se llena antes, se libera el frame cerrado ms antiguo a la fuerza y se cuenta un
+ * stall: el resultado sigue siendo correcto porque @c WRITE_DISCARD nunca pisa datos en uso.
+ * Los chunks del frame actual nunca se reciclan, porque sus draws pueden no haberse enviado
+ * todava; si un frame pide ms chunks de los que tiene el anillo, allocate() falla.
+ *
+ * @note Direct3D 11.0 no permite enlazar un constant buffer desde un offset ni mapearlo con
+ *       @c WRITE_NO_OVERWRITE, por eso cada chunk es un buffer propio. @c RingAllocator ya
+ *       entrega offsets alineados a 256 bytes, lo que necesita @c VSSetConstantBuffers1.
+ * @warning Usar solo desde el hilo que posee el contexto inmediato.
+ */
+class
+    ConstantBufferRing {
+public:
+    ConstantBufferRing() = default;
+    ~ConstantBufferRing() = default;
+
+    ConstantBufferRing(const ConstantBufferRing&) = delete;
+    ConstantBufferRing& operator=(const ConstantBufferRing&) = delete;
+
+    /**
+     * @brief Crea los chunks y los fences del anillo.
+     *
+     * @param device         Dispositivo con el que se crean los buffers y consultas.
+     * @param chunkSize      Tamao mximo de una asignacin; se redondea a 256 bytes.
+     * @param chunkCount     Nmero de chunks del anillo; al menos las asignaciones de un frame.
+     * @param framesInFlight Frames que la CPU puede adelantarse a la GPU antes de forzar la
+     *                       liberacin del ms antiguo.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        init(Device& device,
+            unsigned int chunkSize = 256,
+            unsigned int chunkCount = 256,
+            unsigned int framesInFlight = 3);
+
+    /**
+     * @brief Cierra el frame: emite su fence y libera los chunks de frames ya terminados.
+     *
+     * Llamar una vez por frame, despus del ltimo draw que use el anillo.
+     *
+     * @param deviceContext Contexto inmediato.
+     */
+    void
+        update(DeviceContext& deviceContext);
+
+    /**
+     * @brief Mtodo de marcador; los buffers los enlaza quien llama a allocate().
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Libera los chunks y los fences.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Copia @p size bytes de @p data a un chunk libre.
+     *
+     * @param deviceContext Contexto inmediato con el que se mapea el chunk.
+     * @param data          Datos de las constantes.
+     * @param size          Bytes a copiar; no debe exceder @c chunkSize.
+     * @return Buffer con los datos, o @c nullptr si fall o si el frame actual ya ocupa
+     *         todos los chunks.
+     */
+    ID3D11Buffer*
+        allocate(DeviceContext& deviceContext, const void* data, unsigned int size);
+
+    template<typename T>
+    ID3D11Buffer*
+        allocate(DeviceContext& deviceContext, const T& data) {
+        return allocate(deviceContext, &data, static_cast<unsigned int>(sizeof(T)));
+    }
+
+    /**
+     * @brief Estado del anillo (capacidad, uso, wraps y stalls).
+     */
+    const RingAllocator&
+        allocator() const { return m_ring; }
+
+    /**
+     * @brief Resumen legible de las estadsticas del anillo.
+     */
+    std::string
+        report() const;
+
+private:
+    /**
+     * @brief Lee los fences emitidos, en orden, y libera los frames que ya terminaron.
+     */
+    void
+        pollFences(DeviceContext& deviceContext);
+
+private:
+    RingAllocator m_ring;
+    std::vector<ID3D11Buffer*> m_chunks;
+    std::vector<ID3D11Query*> m_fences;
+    unsigned int m_chunkSize = 0;
+    unsigned long long m_frame = 0;
+    unsigned long long m_completedFrame = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct DDSSubresource
+ * @brief Un nivel de mip de un elemento del arreglo, dentro de los bytes del archivo.
+ */
+struct DDSSubresource {
+    const unsigned char* data = nullptr;
+    unsigned int rowPitch = 0;
+
+    /**
+     * @brief Bytes de un corte de profundidad; en 2D, el nivel completo.
+     */
+    unsigned int slicePitch = 0;
+};
+
+/**
+ * @struct DDSImage
+ * @brief Descripcin de un archivo DDS ya validado.
+ *
+ * @c subresources sigue el orden de @c D3D11CalcSubresource (elemento por elemento, cada uno
+ * con todos sus mips), as que puede pasarse tal cual como datos iniciales de la textura.
+ * Los punteros apuntan al buffer que recibi DDSLoader::parse().
+ */
+struct DDSImage {
+    D3D11_RESOURCE_DIMENSION dimension = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int depth = 1;
+    unsigned int mipLevels = 1;
+
+    /**
+     * @brief Elementos del arreglo; en un cube map ya incluye las 6 caras de cada cubo.
+     */
+    unsigned int arraySize = 1;
+    bool cubeMap = false;
+    std::vector<DDSSubresource> subresources;
+};
+
+/**
+ * @class DDSLoader
+ * @brief Intrprete de archivos DDS (cabeceras DX9 y extensin DX10).
+ *
+ * parse() solo lee de un buffer en memoria: no abre archivos ni crea recursos, pero describe la
+ * imagen con tipos de DXGI y Direct3D 11. No convierte formatos: los DDS heredados cuyo formato
+ * no existe en DXGI (p. ej. RGB de 24 bits) se rechazan. save() escribe siempre la cabecera DX10.
+ */
+class
+    DDSLoader {
+public:
+    static constexpr unsigned int kMagic = 0x20534444; // "DDS "
+
+    /**
+     * @brief Valida @p data y describe sus subrecursos sin copiarlos.
+     *
+     * @param data  Contenido del archivo, incluyendo el nmero mgico.
+     * @param size  Bytes de @p data.
+     * @param image Salida; sus punteros apuntan dentro de @p data.
+     * @return @c S_OK si fue exitoso; @c E_FAIL si el archivo no es un DDS vlido o est
+     *         truncado; @c E_NOTIMPL si usa un formato o tipo de recurso no soportado.
+     */
+    static HRESULT
+        parse(const unsigned char* data, size_t size, DDSImage& image);
+
+    /**
+     * @brief Escribe una textura 2D (sin cubos ni arreglos) en @p fileName.
+     *
+     * @param image Descripcin y subrecursos de cada mip, con las filas contiguas (el
+     *              @c rowPitch de surfaceInfo()).
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si la imagen no es una textura 2D simple
+     *         o sus subrecursos no tienen el tamao esperado; @c E_FAIL si no pudo escribirse.
+     */
+    static HRESULT
+        save(const std::string& fileName, const DDSImage& image);
+
+    /**
+     * @brief Bits por pxel de @p format; 0 si no se conoce.
+     *
+     * En los formatos comprimidos por bloques es el promedio: 4 para BC1/BC4 y 8 para el resto.
+     */
+    static unsigned int
+        bitsPerPixel(DXGI_FORMAT format);
+
+    /**
+     * @brief Bytes por fila y nmero de filas de una superficie de @p width x @p height.
+     *
+     * En los formatos por bloques una fila es una fila de bloques de 4x4.
+     *
+     * @return @c false si el formato no se conoce.
+     */
+    static bool
+        surfaceInfo(DXGI_FORMAT format,
+            unsigned int width,
+            unsigned int height,
+            size_t& rowPitch,
+            size_t& rowCount);
+};
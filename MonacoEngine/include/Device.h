@@ -1,5 +1,9 @@
 #pragma once
 #include "Prerequisites.h"
+#include "CallStats.h"
+
+class DeviceContext;
+class SoftwareRasterizer;
 
 /**
  * @class Device
@@ -21,6 +25,23 @@ public:
     void
         init();
 
+    /**
+     * @brief Crea el dispositivo y su contexto inmediato sin ventana ni Swap Chain.
+     *
+     * Pensado para ejecutar el motor sin GPU (servidores de build/benchmark): por defecto usa
+     * @c D3D_DRIVER_TYPE_NULL, que acepta buffers, texturas, shaders y draws sin rasterizar.
+     * Si el driver pedido no est disponible se intenta @c D3D_DRIVER_TYPE_WARP.
+     *
+     * @param deviceContext Contexto que recibir el @c ID3D11DeviceContext inmediato.
+     * @param driverType    Tipo de driver a crear (@c D3D_DRIVER_TYPE_NULL por defecto).
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     *
+     * @post Si retorna @c S_OK, @c m_device y @c deviceContext.m_deviceContext != nullptr.
+     * @sa SwapChain::init()
+     */
+    HRESULT
+        init(DeviceContext& deviceContext, D3D_DRIVER_TYPE driverType = D3D_DRIVER_TYPE_NULL);
+
     void
         update();
 
@@ -133,10 +154,91 @@ public:
         CreateSamplerState(const D3D11_SAMPLER_DESC* pSamplerDesc,
             ID3D11SamplerState** ppSamplerState);
 
+    /**
+     * @brief Crea un Rasterizer State.
+     *
+     * @param pRasterizerDesc    Descriptor del estado de rasterizacin.
+     * @param ppRasterizerState  Puntero de salida al estado creado.
+     */
+    HRESULT
+        CreateRasterizerState(const D3D11_RASTERIZER_DESC* pRasterizerDesc,
+            ID3D11RasterizerState** ppRasterizerState);
+
+    /**
+     * @brief Crea un Blend State.
+     *
+     * @param pBlendStateDesc Descriptor del estado de blending.
+     * @param ppBlendState    Puntero de salida al estado creado.
+     */
+    HRESULT
+        CreateBlendState(const D3D11_BLEND_DESC* pBlendStateDesc,
+            ID3D11BlendState** ppBlendState);
+
+    /**
+     * @brief Crea un Depth Stencil State.
+     *
+     * @param pDepthStencilDesc   Descriptor de la prueba de profundidad y estncil.
+     * @param ppDepthStencilState Puntero de salida al estado creado.
+     */
+    HRESULT
+        CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* pDepthStencilDesc,
+            ID3D11DepthStencilState** ppDepthStencilState);
+
+    /**
+     * @brief Crea una Shader Resource View.
+     *
+     * @param pResource Recurso de origen (usualmente una textura).
+     * @param pDesc     Descriptor de la SRV (puede ser @c nullptr).
+     * @param ppSRView  Puntero de salida a la SRV creada.
+     */
+    HRESULT
+        CreateShaderResourceView(ID3D11Resource* pResource,
+            const D3D11_SHADER_RESOURCE_VIEW_DESC* pDesc,
+            ID3D11ShaderResourceView** ppSRView);
+
+    /**
+     * @brief Crea un contexto diferido para grabar comandos desde otro hilo.
+     *
+     * @param ContextFlags       Reservado; debe ser 0.
+     * @param ppDeferredContext  Puntero de salida al contexto diferido creado.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        CreateDeferredContext(unsigned int ContextFlags,
+            ID3D11DeviceContext** ppDeferredContext);
+
+    /**
+     * @brief Crea una consulta de GPU (p. ej. @c D3D11_QUERY_EVENT para usarla como fence).
+     *
+     * @param pQueryDesc Descriptor de la consulta.
+     * @param ppQuery    Puntero de salida a la consulta creada.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        CreateQuery(const D3D11_QUERY_DESC* pQueryDesc,
+            ID3D11Query** ppQuery);
+
 public:
     /**
      * @brief Puntero al dispositivo Direct3D 11.
      * @details Creado en init(), liberado en destroy().
      */
     ID3D11Device* m_device = nullptr;
+
+    /**
+     * @brief Tipo de driver con el que se cre @c m_device.
+     * @details @c D3D_DRIVER_TYPE_NULL / @c D3D_DRIVER_TYPE_WARP indican ejecucin sin GPU.
+     */
+    D3D_DRIVER_TYPE m_driverType = D3D_DRIVER_TYPE_UNKNOWN;
+
+    /**
+     * @brief Conteo, bytes y tiempo de CPU de cada llamada de creacin de recursos.
+     */
+    CallStats m_stats;
+
+    /**
+     * @brief Backend en CPU que recibe una copia de cada buffer/textura creado (opcional).
+     * @details Lo asigna @c SoftwareRasterizer::init(); @c nullptr si no se usa.
+     */
+    SoftwareRasterizer* m_softwareRasterizer = nullptr;
 };
\ No newline at end of file
@@ -1,5 +1,93 @@
 #pragma once
 #include "Prerequisites.h"
+#include "CallStats.h"
+
+class SoftwareRasterizer;
+class CommandList;
+
+/**
+ * @struct BindingSlots
+ * @brief Copia de los slots de una etapa (constant buffers, SRVs, samplers) con asignacin diferida.
+ *
+ * @c pending guarda lo que pidi el cdigo y @c bound lo que realmente tiene el runtime.
+ * Al dibujar, los slots que difieren se envan en una sola llamada que cubre el rango
+ * contiguo [primer slot cambiado, ltimo slot cambiado].
+ */
+template<typename T, unsigned int N>
+struct BindingSlots {
+    T pending[N] = {};
+    T bound[N] = {};
+    unsigned int pendingCalls = 0;
+
+    /**
+     * @brief Registra una asignacin; devuelve @c false si no cambia ningn slot pendiente.
+     */
+    bool
+        stage(unsigned int startSlot, unsigned int count, T const* values) {
+        bool changed = false;
+        for (unsigned int i = 0; i < count; ++i) {
+            if (pending[startSlot + i] != values[i]) {
+                pending[startSlot + i] = values[i];
+                changed = true;
+            }
+        }
+        if (changed) {
+            pendingCalls++;
+        }
+        return changed;
+    }
+
+    /**
+     * @brief Calcula el rango de slots que difiere del runtime; @c false si no hay ninguno.
+     */
+    bool
+        dirtyRange(unsigned int& first, unsigned int& count) const {
+        unsigned int last = 0;
+        bool dirty = false;
+        for (unsigned int i = 0; i < N; ++i) {
+            if (pending[i] != bound[i]) {
+                if (!dirty) {
+                    first = i;
+                    dirty = true;
+                }
+                last = i;
+            }
+        }
+        count = dirty ? last - first + 1 : 0;
+        return dirty;
+    }
+
+    /**
+     * @brief Marca el rango como enviado al runtime.
+     */
+    void
+        commit(unsigned int first, unsigned int count) {
+        for (unsigned int i = first; i < first + count; ++i) {
+            bound[i] = pending[i];
+        }
+        pendingCalls = 0;
+    }
+
+    void
+        reset() {
+        for (unsigned int i = 0; i < N; ++i) {
+            pending[i] = T();
+            bound[i] = T();
+        }
+        pendingCalls = 0;
+    }
+};
+
+/**
+ * @class DeviceContext
+ * @brief Encapsula un @c ID3D11DeviceContext y filtra las llamadas de estado redundantes.
+ *
+ * Mantiene una copia del estado del pipeline asignado (input layout, shaders, viewports,
+ * buffers, render targets, ...) y omite las llamadas que no lo cambiaran. Los constant
+ * buffers, las SRVs y los samplers del pixel shader se asignan de forma diferida: se
+ * acumulan hasta el siguiente draw y se envan como un solo @c *Set* por rango contiguo
+ * de slots. Las llamadas omitidas se cuentan en @c CallRecord::elided.
+ */
 
 class
     DeviceContext {
@@ -38,6 +126,14 @@ public:
     void
         destroy();
 
+    /**
+     * @brief Limpia el estado real del contexto con @c ClearState y reinicia la copia local.
+     *
+     * Necesario si el @c ID3D11DeviceContext se modific sin pasar por esta clase.
+     */
+    void
+        resetState();
+
     /**
      * @brief Configura los viewports en la etapa de rasterizacin.
      *
@@ -109,6 +205,30 @@ public:
             unsigned int SrcRowPitch,
             unsigned int SrcDepthPitch);
 
+    /**
+     * @brief Copia una regin de un recurso a otro en la GPU.
+     *
+     * @param pDstResource   Recurso destino.
+     * @param DstSubresource ndice de subrecurso destino.
+     * @param DstX           Posicin X de destino (bytes para buffers).
+     * @param DstY           Posicin Y de destino.
+     * @param DstZ           Posicin Z de destino.
+     * @param pSrcResource   Recurso origen.
+     * @param SrcSubresource ndice de subrecurso origen.
+     * @param pSrcBox        Regin de origen (puede ser @c nullptr para todo el subrecurso).
+     *
+     * @note No se puede grabar en una @c CommandList portable.
+     */
+    void
+        CopySubresourceRegion(ID3D11Resource* pDstResource,
+            unsigned int DstSubresource,
+            unsigned int DstX,
+            unsigned int DstY,
+            unsigned int DstZ,
+            ID3D11Resource* pSrcResource,
+            unsigned int SrcSubresource,
+            const D3D11_BOX* pSrcBox);
+
     /**
      * @brief Asigna buffers de vrtices a la etapa de ensamblado de entrada.
      *
@@ -160,7 +280,7 @@ public:
     /**
      * @brief Asigna un Blend State al Output Merger.
      *
-     * @param pBlendState Estado de blending.
+     * @param pBlendState Estado de blending; @c nullptr asigna el estado por defecto (sin blending).
      * @param BlendFactor Factor de mezcla (RGBA).
      * @param SampleMask  Mscara de muestras.
      */
@@ -169,6 +289,16 @@ public:
             const float BlendFactor[4],
             unsigned int SampleMask);
 
+    /**
+     * @brief Asigna un Depth Stencil State al Output Merger.
+     *
+     * @param pDepthStencilState Estado de profundidad y estncil.
+     * @param StencilRef         Valor de referencia para la prueba de estncil.
+     */
+    void
+        OMSetDepthStencilState(ID3D11DepthStencilState* pDepthStencilState,
+            unsigned int StencilRef);
+
     /**
      * @brief Asigna Render Targets y Depth Stencil al Output Merger.
      *
@@ -248,6 +378,100 @@ public:
         DrawIndexed(unsigned int IndexCount,
             unsigned int StartIndexLocation,
             int BaseVertexLocation);
+
+    /**
+     * @brief Dibuja @p InstanceCount copias de primitivas indexadas en una sola llamada.
+     *
+     * Los datos por instancia se leen de los vertex buffers cuyo input layout usa
+     * @c D3D11_INPUT_PER_INSTANCE_DATA.
+     *
+     * @param IndexCountPerInstance Nmero de ndices de cada instancia.
+     * @param InstanceCount         Nmero de instancias.
+     * @param StartIndexLocation    Posicin inicial en el buffer de ndices.
+     * @param BaseVertexLocation    Offset aplicado a los vrtices.
+     * @param StartInstanceLocation Primera instancia a leer de los buffers por instancia.
+     *
+     * @note El rasterizador en CPU no ejecuta draws instanciados.
+     */
+    void
+        DrawIndexedInstanced(unsigned int IndexCountPerInstance,
+            unsigned int InstanceCount,
+            unsigned int StartIndexLocation,
+            int BaseVertexLocation,
+            unsigned int StartInstanceLocation);
+
+    /**
+     * @brief Cierra la grabacin de un contexto diferido y devuelve la lista de comandos.
+     *
+     * @param RestoreDeferredContextState Si es @c TRUE conserva el estado del contexto diferido.
+     * @param ppCommandList               Puntero de salida a la lista creada.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        FinishCommandList(BOOL RestoreDeferredContextState,
+            ID3D11CommandList** ppCommandList);
+
+    /**
+     * @brief Ejecuta en este contexto una lista grabada en un contexto diferido.
+     *
+     * @param pCommandList        Lista a ejecutar.
+     * @param RestoreContextState Si es @c TRUE restaura el estado previo al terminar.
+     */
+    void
+        ExecuteCommandList(ID3D11CommandList* pCommandList,
+            BOOL RestoreContextState);
+
+    /**
+     * @brief Obtiene un puntero en CPU al contenido de un recurso dinmico o de staging.
+     *
+     * @param pResource    Recurso a mapear.
+     * @param Subresource  ndice de subrecurso.
+     * @param MapType      Tipo de acceso (p. ej. @c D3D11_MAP_WRITE_DISCARD).
+     * @param MapFlags     Flags adicionales (p. ej. @c D3D11_MAP_FLAG_DO_NOT_WAIT).
+     * @param pMappedResource Puntero de salida con la direccin y los pitches mapeados.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     *
+     * @note No se puede grabar en una @c CommandList portable; mapear en el contexto inmediato.
+     */
+    HRESULT
+        Map(ID3D11Resource* pResource,
+            unsigned int Subresource,
+            D3D11_MAP MapType,
+            unsigned int MapFlags,
+            D3D11_MAPPED_SUBRESOURCE* pMappedResource);
+
+    /**
+     * @brief Invalida el puntero obtenido con Map() y devuelve el recurso a la GPU.
+     *
+     * @param pResource   Recurso mapeado.
+     * @param Subresource ndice de subrecurso.
+     */
+    void
+        Unmap(ID3D11Resource* pResource,
+            unsigned int Subresource);
+
+    /**
+     * @brief Marca el final de una consulta (para @c D3D11_QUERY_EVENT, el punto del fence).
+     *
+     * @param pAsync Consulta a cerrar.
+     */
+    void
+        End(ID3D11Asynchronous* pAsync);
+
+    /**
+     * @brief Lee el resultado de una consulta sin bloquear.
+     *
+     * @param pAsync      Consulta a leer.
+     * @param pData       Destino del resultado (puede ser @c nullptr).
+     * @param DataSize    Tamao de @p pData en bytes.
+     * @param GetDataFlags Flags de lectura (p. ej. @c D3D11_ASYNC_GETDATA_DONOTFLUSH).
+     * @return @c S_OK si el resultado est listo, @c S_FALSE si la GPU no ha llegado a ese punto.
+     */
+    HRESULT
+        GetData(ID3D11Asynchronous* pAsync,
+            void* pData,
+            unsigned int DataSize,
+            unsigned int GetDataFlags);
 public:
     /**
      * @brief Puntero al contexto inmediato de Direct3D 11.
@@ -255,4 +479,82 @@ public:
      */
     ID3D11DeviceContext* m_deviceContext = nullptr;
 
+    /**
+     * @brief Conteo, bytes y tiempo de CPU de cada llamada enviada al contexto.
+     */
+    CallStats m_stats;
+
+    /**
+     * @brief Backend en CPU que ejecuta tambin cada draw del contexto (opcional).
+     * @details Lo asigna @c SoftwareRasterizer::init(); @c nullptr si no se usa.
+     */
+    SoftwareRasterizer* m_softwareRasterizer = nullptr;
+
+    /**
+     * @brief Lista portable que graba las llamadas de este contexto en lugar de enviarlas.
+     * @details Lo asigna @c CommandList::init() cuando no usa un contexto diferido de D3D11.
+     */
+    CommandList* m_recorder = nullptr;
+
+    /**
+     * @brief Activa el filtro de estado redundante y la asignacin diferida de slots.
+     * @details Cambiarlo despus de haber asignado estado requiere llamar a resetState().
+     */
+    bool m_filterRedundantState = true;
+
+private:
+    /**
+     * @brief Enva al runtime los constant buffers, SRVs y samplers pendientes.
+     */
+    void
+        flushBindings();
+
+    /**
+     * @brief Quita de la copia local las SRVs cuyo recurso es un render target o el depth
+     *        stencil actual.
+     *
+     * El runtime las desvincula en silencio (en OMSetRenderTargets y al asignar una SRV de un
+     * recurso que ya es salida); sin esto el filtro creera que siguen asignadas y omitira la
+     * siguiente PSSetShaderResources con la misma vista.
+     */
+    void
+        dropOutputBoundShaderResources();
+
+    /**
+     * @brief Reinicia la copia local al estado por defecto de D3D11 sin tocar el contexto.
+     */
+    void
+        resetShadowState();
+
+private:
+    ID3D11InputLayout* m_inputLayout = nullptr;
+    ID3D11VertexShader* m_vertexShader = nullptr;
+    ID3D11PixelShader* m_pixelShader = nullptr;
+    ID3D11RasterizerState* m_rasterizerState = nullptr;
+    ID3D11BlendState* m_blendState = nullptr;
+    float m_blendFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    unsigned int m_sampleMask = 0xffffffff;
+    ID3D11DepthStencilState* m_depthStencilState = nullptr;
+    unsigned int m_stencilRef = 0;
+    D3D11_PRIMITIVE_TOPOLOGY m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    ID3D11Buffer* m_indexBuffer = nullptr;
+    DXGI_FORMAT m_indexFormat = DXGI_FORMAT_UNKNOWN;
+    unsigned int m_indexOffset = 0;
+    ID3D11Buffer* m_vertexBuffers[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
+    unsigned int m_vertexStrides[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
+    unsigned int m_vertexOffsets[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
+    unsigned int m_viewportCount = 0;
+    D3D11_VIEWPORT m_viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE] = {};
+    unsigned int m_renderTargetCount = 0;
+    ID3D11RenderTargetView* m_renderTargets[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+    ID3D11DepthStencilView* m_depthStencil = nullptr;
+
+    // Buffer mapeado, para reflejar su contenido en el rasterizador en CPU al hacer Unmap
+    ID3D11Resource* m_mappedResource = nullptr;
+    void* m_mappedData = nullptr;
+
+    BindingSlots<ID3D11Buffer*, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> m_vsConstantBuffers;
+    BindingSlots<ID3D11Buffer*, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> m_psConstantBuffers;
+    BindingSlots<ID3D11ShaderResourceView*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> m_psShaderResources;
+    BindingSlots<ID3D11SamplerState*, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT> m_psSamplers;
 };
\ No newline at end of file
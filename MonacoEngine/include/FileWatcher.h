@@ -0,0 +1,75 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class FileWatcher
+ * @brief Avisa qu archivos de un directorio (y sus subdirectorios) se modificaron.
+ *
+ * Usa @c ReadDirectoryChangesW con I/O superpuesta, as que poll() nunca bloquea: solo
+ * revisa si la lectura pendiente termin y la vuelve a lanzar.
+ *
+ * Los editores suelen guardar en varios pasos (truncar, escribir, renombrar un temporal);
+ * un archivo solo se entrega cuando lleva @c settleMilliseconds sin cambios, para no
+ * compilar una versin a medio escribir.
+ */
+class
+    FileWatcher {
+public:
+    FileWatcher() = default;
+    ~FileWatcher() { destroy(); }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * @brief Empieza a vigilar @p directory.
+     *
+     * @param directory          Directorio a vigilar ("" o "." para el directorio actual).
+     * @param settleMilliseconds Tiempo sin cambios antes de entregar un archivo.
+     * @return @c S_OK si fue exitoso; @c E_FAIL si no se pudo abrir el directorio.
+     */
+    HRESULT
+        init(const std::string& directory, unsigned int settleMilliseconds = 200);
+
+    /**
+     * @brief Deja de vigilar y cancela la lectura pendiente.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Agrega a @p changedFiles los archivos modificados que ya se asentaron.
+     *
+     * Las rutas son relativas al directorio vigilado, con '\\' como separador. Si el buffer
+     * del sistema se desbord se entrega una ruta vaca: hay que suponer que cambi todo.
+     *
+     * @return @c true si se agreg alguna ruta.
+     */
+    bool
+        poll(std::vector<std::string>& changedFiles);
+
+    /**
+     * @brief Directorio vigilado, terminado en separador si no est vaco.
+     */
+    const std::string&
+        directory() const { return m_directory; }
+
+private:
+    /**
+     * @brief Lanza la siguiente lectura superpuesta.
+     */
+    bool
+        issueRead();
+
+private:
+    std::string m_directory;
+    unsigned int m_settleMilliseconds = 200;
+    HANDLE m_handle = INVALID_HANDLE_VALUE;
+    HANDLE m_event = nullptr;
+    OVERLAPPED m_overlapped = {};
+    // DWORD para la alineacin que exige FILE_NOTIFY_INFORMATION
+    std::vector<DWORD> m_buffer;
+    bool m_reading = false;
+    // Archivo -> ltimo cambio visto
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> m_pending;
+};
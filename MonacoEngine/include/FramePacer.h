@@ -0,0 +1,199 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class PresentClock
+ * @brief Reloj que usa @c FramePacer para medir y esperar.
+ *
+ * Separar el reloj permite probar el control de ritmo con un reloj simulado, sin ventana
+ * ni GPU.
+ */
+class
+    PresentClock {
+public:
+    virtual ~PresentClock() = default;
+
+    /**
+     * @brief Tiempo actual en segundos desde un origen arbitrario.
+     */
+    virtual double
+        now() const = 0;
+
+    /**
+     * @brief Bloquea el hilo hasta que now() llegue a @p time.
+     */
+    virtual void
+        sleepUntil(double time) = 0;
+};
+
+/**
+ * @class SystemPresentClock
+ * @brief @c PresentClock sobre @c std::chrono::steady_clock.
+ *
+ * sleepUntil() duerme hasta un margen antes del objetivo y termina cediendo el hilo, porque
+ * @c Sleep en Windows puede pasarse por varios milisegundos.
+ */
+class
+    SystemPresentClock : public PresentClock {
+public:
+    double
+        now() const override;
+
+    void
+        sleepUntil(double time) override;
+};
+
+/**
+ * @struct FramePacerDesc
+ * @brief Configuracin de @c FramePacer.
+ *
+ * - @c framesInFlight: frames que la CPU puede adelantarse a la pantalla (latencia mxima).
+ * - @c targetFps: lmite de frames por segundo; 0 no limita.
+ * - @c vsyncInterval: intervalo de sincronizacin para @c Present (0 = sin V-Sync).
+ */
+struct FramePacerDesc {
+    unsigned int framesInFlight = 2;
+    double targetFps = 0.0;
+    unsigned int vsyncInterval = 0;
+};
+
+/**
+ * @struct FrameTiming
+ * @brief Marcas de tiempo de un frame, en segundos del @c PresentClock.
+ */
+struct FrameTiming {
+    unsigned long long frame = 0;
+    double cpuBegin = 0.0;
+    double presentBegin = 0.0;
+    double presentEnd = 0.0;
+    double waited = 0.0;
+};
+
+/**
+ * @class FramePacer
+ * @brief Mantiene un ritmo de frames estable y registra los tiempos de cada frame.
+ *
+ * El uso por frame es:
+ * - beginFrame() antes de leer la entrada; espera hasta el siguiente plazo si hay
+ *   @c targetFps.
+ * - beginPresent() / endPresent() alrededor de @c SwapChain::present(), con syncInterval().
+ *
+ * Los plazos avanzan un periodo exacto desde el plazo anterior, no desde el momento en que
+ * termin la espera, as el promedio no deriva. Si un frame se atrasa ms de un periodo, el
+ * siguiente plazo se cuenta desde ahora en lugar de encadenar frames sin espera.
+ *
+ * El lmite de frames en vuelo lo aplica DXGI (ver @c SwapChain::setMaximumFrameLatency);
+ * aqu solo se guarda la configuracin. No depende de Direct3D.
+ */
+class
+    FramePacer {
+public:
+    FramePacer() = default;
+    ~FramePacer() = default;
+
+    /**
+     * @brief Configura el ritmo y el reloj.
+     *
+     * @param desc        Configuracin.
+     * @param clock       Reloj para medir y esperar; debe vivir ms que el pacer.
+     * @param historySize Frames que se conservan para las estadsticas.
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si los parmetros no son vlidos.
+     */
+    HRESULT
+        init(const FramePacerDesc& desc, PresentClock& clock, unsigned int historySize = 128);
+
+    /**
+     * @brief Mtodo de marcador; el avance ocurre en beginFrame().
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Mtodo de marcador; el pacer no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Descarta la configuracin y el historial.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Empieza un frame, esperando al siguiente plazo si hay @c targetFps.
+     */
+    void
+        beginFrame();
+
+    /**
+     * @brief Marca el inicio de @c Present (fin del trabajo de CPU del frame).
+     */
+    void
+        beginPresent();
+
+    /**
+     * @brief Marca el regreso de @c Present y guarda el frame en el historial.
+     */
+    void
+        endPresent();
+
+    /**
+     * @brief Intervalo de sincronizacin que se pasa a @c Present.
+     */
+    unsigned int
+        syncInterval() const { return m_desc.vsyncInterval; }
+
+    unsigned int
+        framesInFlight() const { return m_desc.framesInFlight; }
+
+    /**
+     * @brief Frames guardados en el historial (como mximo @c historySize).
+     */
+    unsigned int
+        historyCount() const { return static_cast<unsigned int>(m_history.size()); }
+
+    /**
+     * @brief Frame @p index del historial; 0 es el ms reciente.
+     *
+     * @pre @p index < historyCount().
+     */
+    const FrameTiming&
+        timing(unsigned int index) const;
+
+    /**
+     * @brief Promedio entre inicios de frames consecutivos del historial, en segundos.
+     */
+    double
+        averageFrameTime() const;
+
+    /**
+     * @brief Mayor intervalo entre inicios de frames consecutivos del historial.
+     */
+    double
+        maxFrameTime() const;
+
+    /**
+     * @brief Promedio de tiempo de CPU (beginFrame a beginPresent, sin la espera).
+     */
+    double
+        averageCpuTime() const;
+
+    /**
+     * @brief Resumen de una lnea con los promedios del historial.
+     */
+    std::string
+        report() const;
+
+private:
+    FramePacerDesc m_desc;
+    PresentClock* m_clock = nullptr;
+    double m_period = 0.0;
+    double m_nextDeadline = 0.0;
+    unsigned long long m_frame = 0;
+    FrameTiming m_current;
+    // Historial circular; m_historyHead es el siguiente slot a escribir
+    std::vector<FrameTiming> m_history;
+    unsigned int m_historySize = 0;
+    unsigned int m_historyHead = 0;
+};
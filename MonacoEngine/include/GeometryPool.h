@@ -0,0 +1,188 @@
+#pragma once
+#include "Prerequisites.h"
+#include "BuddyAllocator.h"
+
+class Device;
+class DeviceContext;
+class MeshComponent;
+class UploadManager;
+
+/**
+ * @struct GeometryRange
+ * @brief Ubicacin de una malla dentro de los buffers compartidos de @c GeometryPool.
+ *
+ * Los ndices se guardan relativos a la malla, por eso @c baseVertex va en el
+ * @c BaseVertexLocation de @c DrawIndexed.
+ */
+struct GeometryRange {
+    unsigned int baseVertex = 0;
+    unsigned int vertexCount = 0;
+    unsigned int startIndex = 0;
+    unsigned int indexCount = 0;
+};
+
+/**
+ * @class GeometryPool
+ * @brief Guarda los vrtices e ndices de muchas @c MeshComponent en un vertex buffer y un
+ *        index buffer compartidos.
+ *
+ * Cada malla recibe un rango de cada buffer de un @c BuddyAllocator y un handle estable.
+ * Con render() se enlazan los dos buffers una sola vez y cada malla se dibuja con
+ * draw() (o con su @c GeometryRange) sin volver a tocar la etapa IA.
+ *
+ * Si una malla no cabe, el pool se compacta con defragment() y, si an no cabe, duplica
+ * su capacidad. Ambos casos crean buffers nuevos y copian los rangos vivos en la GPU con
+ * @c CopySubresourceRegion; los handles siguen siendo vlidos, pero los @c GeometryRange
+ * ledos antes dejan de serlo.
+ *
+ * Con un @c UploadManager, add() encola los datos en lugar de subirlos con
+ * @c UpdateSubresource; la malla est lista cuando su subida se completa.
+ *
+ * @note Vrtices @c SimpleVertex e ndices @c DXGI_FORMAT_R32_UINT, como @c MeshComponent.
+ */
+class
+    GeometryPool {
+public:
+    GeometryPool() = default;
+    ~GeometryPool() = default;
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    /**
+     * @brief Valor de handle que no corresponde a ninguna malla.
+     */
+    static constexpr unsigned int kInvalidHandle = 0xFFFFFFFF;
+
+    /**
+     * @brief Crea los buffers compartidos.
+     *
+     * @param device         Dispositivo con el que se crean los buffers.
+     * @param vertexCapacity Vrtices iniciales (se redondea a potencia de dos).
+     * @param indexCapacity  ndices iniciales (se redondea a potencia de dos).
+     * @param uploadManager  Si no es @c nullptr, sube las mallas de add() por este manager.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        init(Device& device,
+            unsigned int vertexCapacity = 65536,
+            unsigned int indexCapacity = 262144,
+            UploadManager* uploadManager = nullptr);
+
+    /**
+     * @brief Mtodo de marcador; el pool solo cambia con add() / remove().
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Enlaza el vertex buffer (slot 0) y el index buffer compartidos.
+     *
+     * @param deviceContext Contexto donde se enlazan.
+     */
+    void
+        render(DeviceContext& deviceContext);
+
+    /**
+     * @brief Libera los buffers y todas las mallas.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Copia los vrtices e ndices de @p mesh al pool.
+     *
+     * @param deviceContext Contexto inmediato con el que se suben los datos (sin @c UploadManager).
+     * @param mesh          Malla a agregar.
+     * @return Handle de la malla, o @c kInvalidHandle si fall.
+     */
+    unsigned int
+        add(DeviceContext& deviceContext, const MeshComponent& mesh);
+
+    /**
+     * @brief Libera los rangos de la malla @p handle.
+     */
+    void
+        remove(unsigned int handle);
+
+    /**
+     * @brief Rango actual de la malla @p handle; @c nullptr si el handle no es vlido.
+     */
+    const GeometryRange*
+        range(unsigned int handle) const;
+
+    /**
+     * @brief Dibuja la malla @p handle; los buffers deben estar enlazados con render().
+     */
+    void
+        draw(DeviceContext& deviceContext, unsigned int handle);
+
+    /**
+     * @brief Compacta los rangos vivos al inicio de cada buffer.
+     *
+     * Antes de copiar emite las subidas pendientes del @c UploadManager, que apuntan a los
+     * buffers que se van a reemplazar.
+     *
+     * @param deviceContext  Contexto inmediato con el que se copian los datos.
+     * @param vertexCapacity Nueva capacidad de vrtices (0 conserva la actual).
+     * @param indexCapacity  Nueva capacidad de ndices (0 conserva la actual).
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        defragment(DeviceContext& deviceContext,
+            unsigned int vertexCapacity = 0,
+            unsigned int indexCapacity = 0);
+
+    ID3D11Buffer*
+        vertexBuffer() const { return m_vertexBuffer; }
+
+    ID3D11Buffer*
+        indexBuffer() const { return m_indexBuffer; }
+
+    /**
+     * @brief Mallas vivas en el pool.
+     */
+    unsigned int
+        meshCount() const { return m_meshCount; }
+
+    const BuddyAllocator&
+        vertexAllocator() const { return m_vertexAllocator; }
+
+    const BuddyAllocator&
+        indexAllocator() const { return m_indexAllocator; }
+
+private:
+    /**
+     * @brief Crea un buffer @c D3D11_USAGE_DEFAULT sin datos iniciales.
+     */
+    HRESULT
+        createBuffer(unsigned int byteWidth, unsigned int bindFlags, ID3D11Buffer** buffer);
+
+    /**
+     * @brief Intenta reservar los dos rangos; si falla no deja nada reservado.
+     */
+    bool
+        allocateRanges(unsigned int vertexCount,
+            unsigned int indexCount,
+            GeometryRange& range);
+
+private:
+    /**
+     * @brief Slot de la tabla de handles.
+     */
+    struct Entry {
+        GeometryRange range;
+        bool live = false;
+    };
+
+private:
+    Device* m_device = nullptr;
+    UploadManager* m_uploadManager = nullptr;
+    ID3D11Buffer* m_vertexBuffer = nullptr;
+    ID3D11Buffer* m_indexBuffer = nullptr;
+    BuddyAllocator m_vertexAllocator;
+    BuddyAllocator m_indexAllocator;
+    std::vector<Entry> m_entries;
+    std::vector<unsigned int> m_freeHandles;
+    unsigned int m_meshCount = 0;
+};
@@ -0,0 +1,260 @@
+#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+#include "MeshComponent.h"
+#include "ImageDecoder.h"
+#include "Texture.h"
+
+class Device;
+class ThreadPool;
+class UploadManager;
+struct GltfJson;
+
+/**
+ * @struct GltfLoadOptions
+ * @brief Opciones de GltfScene::init().
+ *
+ * - @c leftHanded: glTF es de mano derecha; los mundos de las instancias llevan un espejo en z
+ *   y los tringulos se invierten. Los vrtices no se tocan, para poder copiarlos en bloque.
+ * - @c loadImages: decodifica las imgenes (PNG/JPG) con @c imageOptions junto con la geometra.
+ */
+struct GltfLoadOptions {
+    bool leftHanded = true;
+    bool loadImages = true;
+    ImageDecodeOptions imageOptions;
+
+    GltfLoadOptions() {
+        // Las texturas de color de glTF estn en sRGB
+        imageOptions.format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        imageOptions.generateMips = true;
+    }
+};
+
+/**
+ * @struct GltfAccessorView
+ * @brief Vista de un accessor de glTF directamente sobre el archivo proyectado.
+ *
+ * @c data apunta al primer elemento; el elemento i est en @c data + i * @c stride. Sigue
+ * siendo vlida mientras la escena no se destruya.
+ */
+struct GltfAccessorView {
+    const unsigned char* data = nullptr;
+    unsigned int count = 0;
+    unsigned int stride = 0;
+    // Tipo de componente de OpenGL: 5120 (BYTE) a 5126 (FLOAT)
+    unsigned int componentType = 0;
+    // 1 (SCALAR) a 16 (MAT4)
+    unsigned int components = 0;
+    bool normalized = false;
+};
+
+/**
+ * @struct GltfPrimitive
+ * @brief Una primitiva de un mesh de glTF, convertida a lista de tringulos.
+ *
+ * - @c image: imagen del @c baseColorTexture de su material; -1 si no tiene.
+ * - @c copiedVertices: @c true si POSITION y TEXCOORD_0 ya estaban intercalados como
+ *   @c SimpleVertex y se copiaron en bloque; @c false si se convirtieron elemento por elemento.
+ */
+struct GltfPrimitive {
+    unsigned int mesh = 0;
+    int material = -1;
+    int image = -1;
+    bool copiedVertices = false;
+    MeshComponent meshComponent;
+};
+
+/**
+ * @struct GltfMeshInstance
+ * @brief Un nodo con mesh: sus primitivas se dibujan con @c world.
+ */
+struct GltfMeshInstance {
+    unsigned int node = 0;
+    unsigned int mesh = 0;
+    XMFLOAT4X4 world;
+};
+
+/**
+ * @struct GltfImage
+ * @brief Imagen de la escena: embebida en un bufferView o en un archivo junto al GLB.
+ *
+ * - @c fileName: vaco si la imagen est embebida.
+ * - @c data, @c size: bytes PNG/JPG embebidos, dentro del archivo proyectado.
+ * - @c decoded: pxeles de @c ImageDecoder; createTextures() los pasa a la textura.
+ */
+struct GltfImage {
+    std::string name;
+    std::string fileName;
+    bool dds = false;
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    DecodedImage decoded;
+};
+
+/**
+ * @struct GltfLoadStats
+ * @brief Tamaos y tiempos de la ltima carga.
+ */
+struct GltfLoadStats {
+    unsigned long long bytes = 0;
+    unsigned int nodes = 0;
+    unsigned int meshes = 0;
+    unsigned int primitives = 0;
+    unsigned int copiedPrimitives = 0;
+    unsigned int instances = 0;
+    unsigned int images = 0;
+    unsigned long long vertices = 0;
+    unsigned long long triangles = 0;
+    double mapMilliseconds = 0.0;
+    double jsonMilliseconds = 0.0;
+    double geometryMilliseconds = 0.0;
+    double nodeMilliseconds = 0.0;
+    double totalMilliseconds = 0.0;
+};
+
+/**
+ * @class GltfScene
+ * @brief Carga escenas glTF 2.0 (GLB o .gltf con buffers .bin) en @c MeshComponent y @c Texture.
+ *
+ * El archivo y sus buffers externos se abren como @c MappedFile y los accessors se leen en
+ * su lugar con @c GltfAccessorView, sin copiar el chunk binario. Cuando POSITION y TEXCOORD_0
+ * ya estn intercalados con la disposicin de @c SimpleVertex (float3 + float2, stride 20),
+ * los vrtices se copian con un solo @c memcpy; los ndices de 32 bits, igual. Cualquier otra
+ * disposicin (UV normalizadas de 8/16 bits, ndices de 8/16 bits, strips, fans) se convierte.
+ *
+ * Las primitivas de todos los meshes y las imgenes se procesan en paralelo en un
+ * @c ThreadPool; cada tarea escribe solo en su propia primitiva o imagen. El JSON se lee a un
+ * arreglo plano de valores y los nodos se recorren con una pila explcita, as que el costo
+ * es lineal en el nmero de nodos aunque la jerarqua sea muy profunda.
+ *
+ * @note No lee materiales ms all del @c baseColorTexture, ni skins, animaciones, morph
+ *       targets, accessors sparse o buffers en data URI.
+ */
+class
+    GltfScene {
+public:
+    GltfScene() = default;
+    ~GltfScene() { destroy(); }
+
+    GltfScene(const GltfScene&) = delete;
+    GltfScene& operator=(const GltfScene&) = delete;
+
+    /**
+     * @brief Carga @p fileName: geometra, jerarqua de nodos e imgenes, sin tocar la GPU.
+     *
+     * @param threadPool Si no es @c nullptr, las primitivas y las imgenes se procesan en sus
+     *                   hilos.
+     * @return @c S_OK si fue exitoso; @c E_FAIL si el archivo no es glTF 2.0 vlido o un
+     *         accessor se sale de su buffer.
+     */
+    HRESULT
+        init(const std::string& fileName,
+            const GltfLoadOptions& options = GltfLoadOptions(),
+            ThreadPool* threadPool = nullptr);
+
+    /**
+     * @brief Crea una @c Texture por imagen: PNG/JPG con los pxeles ya decodificados, DDS
+     *        con la ruta de archivo de @c Texture::init.
+     *
+     * @param uploadManager Si no es @c nullptr, los pxeles se suben de forma asncrona.
+     * @return @c S_OK si todas se crearon; el primer @c HRESULT fallido en caso contrario (las
+     *         dems se crean de todas formas).
+     */
+    HRESULT
+        createTextures(Device& device, UploadManager* uploadManager = nullptr);
+
+    /**
+     * @brief Mtodo de marcador; la escena es esttica.
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Mtodo de marcador; las primitivas se dibujan desde sus @c MeshComponent.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Libera texturas, mallas y archivos proyectados; invalida las vistas.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Vista del accessor @p index; vaca (@c data nulo) si no existe.
+     */
+    GltfAccessorView
+        accessor(unsigned int index) const;
+
+    /**
+     * @brief Textura de la imagen @p image; @c nullptr si no existe o no se cre.
+     */
+    Texture*
+        texture(int image);
+
+    const std::vector<GltfPrimitive>&
+        primitives() const { return m_primitives; }
+
+    /**
+     * @brief Primitivas del mesh @p mesh: [meshPrimitives(mesh), meshPrimitives(mesh + 1)).
+     */
+    unsigned int
+        meshPrimitives(unsigned int mesh) const { return m_meshFirstPrimitive[mesh]; }
+
+    const std::vector<GltfMeshInstance>&
+        instances() const { return m_instances; }
+
+    const std::vector<GltfImage>&
+        images() const { return m_images; }
+
+    std::string
+        report() const;
+
+public:
+    /**
+     * @brief Contadores de la ltima carga.
+     */
+    GltfLoadStats m_stats;
+
+private:
+    struct BufferView {
+        const unsigned char* data;
+        size_t length;
+        unsigned int stride;
+    };
+
+    HRESULT
+        mapBuffers(const GltfJson& json,
+            const unsigned char* binary,
+            size_t binarySize,
+            const std::string& directory);
+
+    HRESULT
+        readAccessors(const GltfJson& json);
+
+    HRESULT
+        buildPrimitive(const GltfJson& json,
+            unsigned int primitiveValue,
+            const GltfLoadOptions& options,
+            GltfPrimitive& primitive) const;
+
+    HRESULT
+        buildInstances(const GltfJson& json, const GltfLoadOptions& options);
+
+    HRESULT
+        readImages(const GltfJson& json, const std::string& directory);
+
+private:
+    MappedFile m_file;
+    std::vector<std::unique_ptr<MappedFile>> m_bufferFiles;
+    // Datos de cada buffer: el chunk BIN del GLB o un archivo externo proyectado
+    std::vector<std::pair<const unsigned char*, size_t>> m_buffers;
+    std::vector<BufferView> m_bufferViews;
+    std::vector<GltfAccessorView> m_accessors;
+    std::vector<GltfPrimitive> m_primitives;
+    std::vector<unsigned int> m_meshFirstPrimitive;
+    std::vector<GltfMeshInstance> m_instances;
+    std::vector<GltfImage> m_images;
+    std::vector<Texture> m_textures;
+};
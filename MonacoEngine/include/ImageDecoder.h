@@ -0,0 +1,208 @@
+#pragma once
+#include "Prerequisites.h"
+#include "ThreadPool.h"
+#include "MipGenerator.h"
+
+/**
+ * @struct ImageDecodeOptions
+ * @brief Formato de salida de una imagen decodificada.
+ *
+ * - @c format: @c DXGI_FORMAT_R8G8B8A8_UNORM o @c DXGI_FORMAT_B8G8R8A8_UNORM (o sus
+ *   variantes @c _SRGB).
+ * - @c premultiplyAlpha: multiplica RGB por alfa, redondeado como x * a / 255.
+ * - @c generateMips: genera la cadena de mips en el mismo hilo de trabajo, con @c mipOptions;
+ *   con un formato @c _SRGB los promedios se hacen en espacio lineal.
+ */
+struct ImageDecodeOptions {
+    DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    bool premultiplyAlpha = false;
+    bool generateMips = false;
+    MipGenerateOptions mipOptions;
+};
+
+/**
+ * @struct DecodedImage
+ * @brief Pxeles de una imagen decodificada, listos para subir a una textura.
+ */
+struct DecodedImage {
+    std::string fileName;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int rowPitch = 0;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    std::vector<unsigned char> pixels;
+
+    /**
+     * @brief Niveles 1 a N, si se pidi @c generateMips; @c pixels es el nivel 0.
+     */
+    std::vector<MipLevel> mips;
+    HRESULT result = S_OK;
+
+    /**
+     * @brief Tiempo de decodificacin, de conversin de pxeles y de generacin de mips, en el
+     *        hilo que la hizo.
+     */
+    double decodeMilliseconds = 0.0;
+    double convertMilliseconds = 0.0;
+    double mipMilliseconds = 0.0;
+};
+
+/**
+ * @brief Se llama en update(), en el hilo de render, con la imagen terminada.
+ *
+ * Puede mover @c pixels (p. ej. a una subida); la imagen se descarta al volver.
+ */
+using ImageDecodeCallback = std::function<void(DecodedImage&)>;
+
+/**
+ * @struct ImageDecoderStats
+ * @brief Contadores acumulados de un @c ImageDecoder.
+ */
+struct ImageDecoderStats {
+    unsigned long long images = 0;
+    unsigned long long failures = 0;
+    unsigned long long pixels = 0;
+    double decodeMilliseconds = 0.0;
+    double convertMilliseconds = 0.0;
+    double mipMilliseconds = 0.0;
+};
+
+/**
+ * @class ImageDecoder
+ * @brief Decodifica PNG y JPG en hilos de trabajo sin bloquear el hilo de render.
+ *
+ * WIC decodifica cada archivo a BGRA de 8 bits; despus convertPixels() cambia el orden de
+ * los canales y premultiplica el alfa con SSE2, cuatro pxeles por iteracin, sobre el mismo
+ * buffer. decodeAsync() encola el trabajo en un @c ThreadPool y update() entrega las imgenes
+ * terminadas en el hilo de render, donde pueden pasar directo a @c Texture::init o a
+ * @c UploadManager sin otra copia.
+ *
+ * @warning decodeAsync(), update() y destroy(), solo desde el hilo de render; decode() y
+ *          convertPixels() pueden llamarse desde cualquier hilo.
+ */
+class
+    ImageDecoder {
+public:
+    ImageDecoder() = default;
+    ~ImageDecoder() { destroy(); }
+
+    ImageDecoder(const ImageDecoder&) = delete;
+    ImageDecoder& operator=(const ImageDecoder&) = delete;
+
+    /**
+     * @brief Prepara el decodificador.
+     *
+     * @param threadPool Hilos para decodificar; con @c nullptr se crea un pool propio con un
+     *                   hilo por ncleo.
+     * @return @c S_OK si fue exitoso; @c E_FAIL si no pudieron crearse los hilos.
+     */
+    HRESULT
+        init(ThreadPool* threadPool = nullptr);
+
+    /**
+     * @brief Llama los callbacks de las imgenes que terminaron de decodificarse.
+     */
+    void
+        update();
+
+    /**
+     * @brief Mtodo de marcador; el decodificador no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Espera las decodificaciones en curso y descarta las no entregadas.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Encola la decodificacin de @p fileName.
+     *
+     * @return @c S_OK si se encol; @c E_FAIL si el decodificador no est inicializado.
+     */
+    HRESULT
+        decodeAsync(const std::string& fileName,
+            const ImageDecodeOptions& options,
+            ImageDecodeCallback callback);
+
+    /**
+     * @brief Decodificaciones encoladas cuyo callback an no se llam.
+     */
+    unsigned int
+        pending() const { return m_pending; }
+
+    /**
+     * @brief Resumen de una lnea con los contadores.
+     */
+    std::string
+        report() const;
+
+    /**
+     * @brief Decodifica @p fileName en el hilo que llama.
+     *
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si el formato pedido no es de 8 bits por
+     *         canal; el @c HRESULT de WIC si el archivo no pudo leerse.
+     */
+    static HRESULT
+        decode(const std::string& fileName, const ImageDecodeOptions& options, DecodedImage& image);
+
+    /**
+     * @brief Igual que decode(), pero desde un PNG o JPG que ya est en memoria (p. ej. una
+     *        imagen dentro de un GLB); @p name solo se usa en los mensajes.
+     */
+    static HRESULT
+        decode(const unsigned char* data,
+            size_t size,
+            const std::string& name,
+            const ImageDecodeOptions& options,
+            DecodedImage& image);
+
+    /**
+     * @brief Convierte @p pixelCount pxeles BGRA8 de @p source a @p destination.
+     *
+     * @p source y @p destination pueden ser el mismo buffer.
+     *
+     * @param swapRedBlue      Intercambia R y B (BGRA <-> RGBA).
+     * @param premultiplyAlpha Multiplica RGB por alfa.
+     */
+    static void
+        convertPixels(const unsigned char* source,
+            unsigned char* destination,
+            size_t pixelCount,
+            bool swapRedBlue,
+            bool premultiplyAlpha);
+
+    /**
+     * @brief Igual que convertPixels() pero pxel por pxel; referencia para medir y validar.
+     */
+    static void
+        convertPixelsScalar(const unsigned char* source,
+            unsigned char* destination,
+            size_t pixelCount,
+            bool swapRedBlue,
+            bool premultiplyAlpha);
+
+public:
+    /**
+     * @brief Contadores desde init().
+     */
+    ImageDecoderStats m_stats;
+
+private:
+    struct CompletedImage {
+        ImageDecodeCallback callback;
+        DecodedImage image;
+    };
+
+    ThreadPool* m_threadPool = nullptr;
+    std::unique_ptr<ThreadPool> m_ownThreadPool;
+    unsigned int m_pending = 0;
+
+    // Compartido con los hilos de decodificacin
+    std::mutex m_mutex;
+    std::condition_variable m_idle;
+    std::vector<CompletedImage> m_completed;
+    unsigned int m_inFlight = 0;
+};
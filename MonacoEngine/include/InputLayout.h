@@ -79,6 +79,38 @@ public:
     void
         destroy();
 
+    /**
+     * @brief Construye la descripcin de un elemento de entrada.
+     *
+     * @param semanticName  Semntica HLSL (p. ej. "POSITION").
+     * @param semanticIndex ndice de la semntica.
+     * @param format        Formato del elemento.
+     * @param inputSlot     Slot del vertex buffer que lo contiene.
+     * @param perInstance   Si es @c true avanza por instancia en lugar de por vrtice.
+     * @param stepRate      Instancias que comparten el mismo valor (solo con @p perInstance).
+     * @return Elemento con offset @c D3D11_APPEND_ALIGNED_ELEMENT.
+     */
+    static D3D11_INPUT_ELEMENT_DESC
+        element(const char* semanticName,
+            unsigned int semanticIndex,
+            DXGI_FORMAT format,
+            unsigned int inputSlot = 0,
+            bool perInstance = false,
+            unsigned int stepRate = 1);
+
+    /**
+     * @brief Agrega a @p Layout el flujo por instancia de @c InstanceData.
+     *
+     * Agrega @c WORLD0-3 (filas de la matriz de mundo), @c COLOR0 y @c CUSTOM0, todos
+     * @c DXGI_FORMAT_R32G32B32A32_FLOAT en @p inputSlot y con @c D3D11_INPUT_PER_INSTANCE_DATA.
+     *
+     * @param Layout    Descripcin a extender (normalmente ya contiene el flujo por vrtice).
+     * @param inputSlot Slot del buffer de instancias; no debe ser el del flujo por vrtice.
+     */
+    static void
+        appendInstanceData(std::vector<D3D11_INPUT_ELEMENT_DESC>& Layout,
+            unsigned int inputSlot = 1);
+
 public:
     /**
      * @brief Recurso COM de Direct3D 11 que representa el Input Layout.
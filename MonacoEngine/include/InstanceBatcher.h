@@ -0,0 +1,105 @@
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+
+class Device;
+class DeviceContext;
+class MeshComponent;
+
+/**
+ * @class InstanceBatcher
+ * @brief Agrupa las copias de un mismo @c MeshComponent en un solo draw instanciado.
+ *
+ * Por frame: update() vaca los lotes, add() registra cada copia con su @c InstanceData y
+ * render() sube todas las instancias a un buffer dinmico con un solo @c Map y emite un
+ * @c DrawIndexedInstanced por malla distinta.
+ *
+ * Los buffers de vrtices/ndices de cada malla se crean la primera vez que aparece y se
+ * conservan hasta destroy(); dos copias pertenecen al mismo lote si usan el mismo objeto
+ * @c MeshComponent.
+ *
+ * @note render() enlaza los buffers (slot 0 = vrtices, slot 1 = instancias); el shader,
+ *       las texturas y las constantes de cmara los asigna quien llama.
+ * @warning Las mallas registradas deben seguir vivas mientras tengan instancias en el frame.
+ */
+class
+    InstanceBatcher {
+public:
+    InstanceBatcher() = default;
+    ~InstanceBatcher() = default;
+
+    InstanceBatcher(const InstanceBatcher&) = delete;
+    InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+
+    /**
+     * @brief Crea el buffer de instancias.
+     *
+     * @param device       Dispositivo con el que se crean los buffers.
+     * @param maxInstances Capacidad inicial; el buffer crece si un frame la excede.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        init(Device& device, unsigned int maxInstances = 1024);
+
+    /**
+     * @brief Vaca los lotes para grabar un nuevo frame.
+     */
+    void
+        update();
+
+    /**
+     * @brief Sube las instancias y emite un draw instanciado por malla.
+     *
+     * @param deviceContext Contexto inmediato (la subida usa @c Map).
+     */
+    void
+        render(DeviceContext& deviceContext);
+
+    /**
+     * @brief Libera el buffer de instancias y los buffers de cada malla.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Agrega una copia de @p mesh al frame.
+     *
+     * @param mesh     Malla a dibujar; se agrupa con las dems copias del mismo objeto.
+     * @param instance Matriz de mundo, color y datos libres de esta copia.
+     */
+    void
+        add(const MeshComponent& mesh, const InstanceData& instance);
+
+    /**
+     * @brief Nmero de instancias registradas en el frame.
+     */
+    unsigned int
+        instanceCount() const { return m_instanceCount; }
+
+    /**
+     * @brief Draws instanciados emitidos por el ltimo render().
+     */
+    unsigned int
+        drawCount() const { return m_drawCount; }
+
+private:
+    /**
+     * @brief Buffers de una malla y las instancias que agreg el frame.
+     */
+    struct Batch {
+        Buffer vertexBuffer;
+        Buffer indexBuffer;
+        unsigned int indexCount = 0;
+        std::vector<InstanceData> instances;
+    };
+
+private:
+    Device* m_device = nullptr;
+    Buffer m_instanceBuffer;
+    unsigned int m_capacity = 0;
+    unsigned int m_drawCount = 0;
+    unsigned int m_instanceCount = 0;
+    std::vector<InstanceData> m_upload;
+    std::unordered_map<const MeshComponent*, std::unique_ptr<Batch>> m_batches;
+    std::vector<Batch*> m_activeBatches;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class MappedFile
+ * @brief Archivo de solo lectura proyectado en memoria con @c MapViewOfFile.
+ *
+ * Los cargadores leen directamente de data() sin copiar el archivo a un buffer propio; el
+ * sistema trae las pginas del disco a medida que se tocan.
+ */
+class
+    MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { destroy(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Abre y proyecta @p fileName completo.
+     *
+     * @return @c S_OK si fue exitoso; @c E_FAIL si el archivo no existe, est vaco o no
+     *         pudo proyectarse.
+     */
+    HRESULT
+        init(const std::string& fileName);
+
+    /**
+     * @brief Cierra la vista; los punteros obtenidos con data() dejan de ser vlidos.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Primer byte del archivo; @c nullptr si no est abierto.
+     */
+    const unsigned char*
+        data() const { return m_view; }
+
+    /**
+     * @brief Tamao del archivo en bytes.
+     */
+    size_t
+        size() const { return m_size; }
+
+private:
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const unsigned char* m_view = nullptr;
+    size_t m_size = 0;
+};
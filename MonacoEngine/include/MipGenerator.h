@@ -0,0 +1,103 @@
+#pragma once
+#include "Prerequisites.h"
+
+class ThreadPool;
+
+/**
+ * @brief Filtro de reduccin entre un nivel de mip y el siguiente.
+ *
+ * - @c Box: promedio de 2x2 pxeles (ponderado en tamaos impares). El ms rpido.
+ * - @c Kaiser: sinc con ventana de Kaiser, radio 3. Ms ntido que @c Box sin halos visibles.
+ * - @c Lanczos: Lanczos-3. El ms ntido; puede marcar un poco los bordes de alto contraste.
+ */
+enum class MipFilter {
+    Box,
+    Kaiser,
+    Lanczos
+};
+
+/**
+ * @struct MipGenerateOptions
+ * @brief Parmetros de MipGenerator::generate().
+ *
+ * - @c srgb: filtra tambin los formatos RGBA8/BGRA8 @c UNORM en espacio lineal, para fotos
+ *   y colores en sRGB que se guardan en una textura sin @c _SRGB.
+ * - @c wrap: los filtros leen del lado opuesto en los bordes (texturas que se repiten); si es
+ *   @c false, repiten el pxel del borde.
+ * - @c preserveAlphaCoverage: escala el alfa de cada nivel para que la fraccin de pxeles con
+ *   alfa mayor que @c alphaReference sea la del nivel 0 (follaje, rejas con alpha test).
+ */
+struct MipGenerateOptions {
+    MipFilter filter = MipFilter::Box;
+    bool srgb = false;
+    bool wrap = false;
+    bool preserveAlphaCoverage = false;
+    float alphaReference = 0.5f;
+};
+
+/**
+ * @struct MipLevel
+ * @brief Un nivel de mip generado, en el mismo formato que la imagen de origen.
+ */
+struct MipLevel {
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int rowPitch = 0;
+    std::vector<unsigned char> pixels;
+};
+
+/**
+ * @class MipGenerator
+ * @brief Genera en CPU la cadena de mips completa de una imagen 2D.
+ *
+ * Cada nivel se calcula a partir del anterior, guardado en RGBA de 32 bits flotantes y en
+ * espacio lineal: los formatos @c _SRGB se decodifican con una tabla antes de filtrar y se
+ * vuelven a codificar al escribir, as que los promedios no oscurecen la imagen. El filtro es
+ * separable (primero filas, luego columnas) y cada pxel es un registro SSE con sus cuatro
+ * canales; los pesos de cada columna y fila de destino se calculan una sola vez por nivel.
+ *
+ * Formatos soportados: RGBA8 y BGRA8 (@c UNORM y @c UNORM_SRGB), @c R16G16B16A16_FLOAT y
+ * @c R32G32B32A32_FLOAT.
+ *
+ * @note Solo lee y escribe memoria; no llama a Direct3D y puede usarse desde cualquier hilo.
+ */
+class
+    MipGenerator {
+public:
+    /**
+     * @brief Indica si generate() acepta @p format.
+     */
+    static bool
+        supportsFormat(DXGI_FORMAT format);
+
+    /**
+     * @brief Nmero de niveles de una cadena completa de @p width x @p height, incluyendo el 0.
+     */
+    static unsigned int
+        mipCount(unsigned int width, unsigned int height);
+
+    /**
+     * @brief Genera los niveles 1 a N de la imagen @p pixels.
+     *
+     * @param pixels     Nivel 0, filas de @p rowPitch bytes.
+     * @param width      Ancho del nivel 0.
+     * @param height     Alto del nivel 0.
+     * @param rowPitch   Bytes por fila de @p pixels.
+     * @param format     Formato de @p pixels y de los niveles generados.
+     * @param options    Filtro y manejo de bordes y alfa.
+     * @param mips       Salida; mipCount() - 1 niveles, del ms grande al de 1x1.
+     * @param threadPool Si no es @c nullptr, las filas de cada nivel se reparten entre sus
+     *                   hilos (el hilo que llama tambin trabaja).
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si el formato no est soportado o las
+     *         dimensiones no son vlidas.
+     */
+    static HRESULT
+        generate(const void* pixels,
+            unsigned int width,
+            unsigned int height,
+            unsigned int rowPitch,
+            DXGI_FORMAT format,
+            const MipGenerateOptions& options,
+            std::vector<MipLevel>& mips,
+            ThreadPool* threadPool = nullptr);
+};
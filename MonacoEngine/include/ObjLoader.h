@@ -0,0 +1,80 @@
+#pragma once
+#include "Prerequisites.h"
+
+class ThreadPool;
+class MeshComponent;
+
+/**
+ * @struct ObjLoadOptions
+ * @brief Conversin de las coordenadas de un OBJ a las del motor.
+ *
+ * - @c flipV: OBJ pone v = 0 abajo; Direct3D arriba.
+ * - @c leftHanded: niega z e invierte el orden de los tringulos (OBJ es de mano derecha).
+ */
+struct ObjLoadOptions {
+    bool flipV = true;
+    bool leftHanded = true;
+};
+
+/**
+ * @struct ObjLoadStats
+ * @brief Tamaos y tiempos de una carga, por fase.
+ *
+ * - @c vertices: vrtices nicos despus de unir las esquinas con la misma posicin y UV.
+ */
+struct ObjLoadStats {
+    unsigned long long bytes = 0;
+    unsigned int chunks = 0;
+    unsigned long long positions = 0;
+    unsigned long long texcoords = 0;
+    unsigned long long triangles = 0;
+    unsigned long long vertices = 0;
+    double mapMilliseconds = 0.0;
+    double parseMilliseconds = 0.0;
+    double dedupMilliseconds = 0.0;
+    double totalMilliseconds = 0.0;
+};
+
+/**
+ * @class ObjLoader
+ * @brief Carga mallas Wavefront OBJ en un @c MeshComponent.
+ *
+ * El archivo se abre como @c MappedFile y se corta en chunks de unos megabytes en saltos de
+ * lnea; cada chunk se interpreta en un hilo de @c ThreadPool con @c std::from_chars, sin
+ * copiar el texto. Los ndices negativos (relativos) se resuelven despus con la suma de
+ * los conteos de los chunks anteriores. Las esquinas con la misma pareja de ndices de
+ * posicin y UV se unen en un vrtice con una tabla hash de direccionamiento abierto en dos
+ * arreglos planos; si el archivo no tiene UV, cada posicin es directamente un vrtice.
+ *
+ * Lee @c v, @c vt y @c f (polgonos en abanico; las normales se ignoran porque
+ * @c SimpleVertex no las tiene). Grupos, objetos y materiales se unen en una sola malla.
+ */
+class
+    ObjLoader {
+public:
+    /**
+     * @brief Carga @p fileName en @p mesh, reemplazando sus vrtices e ndices.
+     *
+     * @param threadPool Si no es @c nullptr, los chunks se interpretan en sus hilos.
+     * @param stats      Si no es @c nullptr, recibe tamaos y tiempos.
+     * @return @c S_OK si fue exitoso; @c E_FAIL si el archivo no pudo abrirse, tiene una lnea
+     *         mal formada o un ndice fuera de rango.
+     */
+    static HRESULT
+        load(const std::string& fileName,
+            MeshComponent& mesh,
+            const ObjLoadOptions& options = ObjLoadOptions(),
+            ThreadPool* threadPool = nullptr,
+            ObjLoadStats* stats = nullptr);
+
+    /**
+     * @brief Igual que load(), pero con el texto ya en memoria.
+     */
+    static HRESULT
+        parse(const char* text,
+            size_t size,
+            MeshComponent& mesh,
+            const ObjLoadOptions& options = ObjLoadOptions(),
+            ThreadPool* threadPool = nullptr,
+            ObjLoadStats* stats = nullptr);
+};
@@ -0,0 +1,271 @@
+#pragma once
+#include "Prerequisites.h"
+#include "ShaderProgram.h"
+
+class Device;
+class DeviceContext;
+class ShaderCache;
+class ShaderCompiler;
+
+/**
+ * @brief Valor de handle que no corresponde a ningn estado de pipeline.
+ */
+static constexpr unsigned int kInvalidPipelineState = 0xFFFFFFFF;
+
+/**
+ * @struct PipelineStateDesc
+ * @brief Todo lo que define un estado de pipeline: shaders, input layout y estados fijos.
+ *
+ * El constructor deja los valores por defecto de Direct3D 11 en rasterizer, blend y
+ * depth-stencil, y un sampler lineal con repeticin.
+ */
+struct PipelineStateDesc {
+    PipelineStateDesc();
+
+    /**
+     * @brief Archivo HLSL con los puntos de entrada @c VS y @c PS.
+     */
+    std::string shaderFile;
+
+    /**
+     * @brief Descripcin de la entrada del Vertex Shader.
+     */
+    std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
+
+    D3D11_RASTERIZER_DESC rasterizer;
+    D3D11_BLEND_DESC blend;
+    D3D11_DEPTH_STENCIL_DESC depthStencil;
+    unsigned int stencilRef = 0;
+
+    /**
+     * @brief Sampler que se asigna en PS s0.
+     */
+    D3D11_SAMPLER_DESC sampler;
+};
+
+/**
+ * @struct PipelineState
+ * @brief Objetos de Direct3D que forman un estado de pipeline; los posee el @c PipelineStateCache.
+ */
+struct PipelineState {
+    ID3D11VertexShader* vertexShader = nullptr;
+    ID3D11PixelShader* pixelShader = nullptr;
+    ID3D11InputLayout* inputLayout = nullptr;
+    ID3D11RasterizerState* rasterizerState = nullptr;
+    ID3D11BlendState* blendState = nullptr;
+    ID3D11DepthStencilState* depthStencilState = nullptr;
+    ID3D11SamplerState* sampler = nullptr;
+    unsigned int stencilRef = 0;
+};
+
+/**
+ * @struct PipelineStateCacheStats
+ * @brief Contadores acumulados de un @c PipelineStateCache.
+ *
+ * - @c requests / @c hits: llamadas a create() y cuntas encontraron el estado ya creado.
+ * - @c createdObjects: shaders, input layouts y estados fijos que s hubo que crear.
+ * - @c reusedObjects: los que se pidieron y ya existan (creaciones evitadas).
+ * - @c shaderReloads: archivos de shader reemplazados con replaceShader().
+ */
+struct PipelineStateCacheStats {
+    unsigned long long requests = 0;
+    unsigned long long hits = 0;
+    unsigned long long createdObjects = 0;
+    unsigned long long reusedObjects = 0;
+    unsigned long long shaderReloads = 0;
+};
+
+/**
+ * @class PipelineStateCache
+ * @brief Crea cada shader, input layout y estado fijo una sola vez y los agrupa en estados
+ *        de pipeline identificados por un handle compacto.
+ *
+ * create() busca cada parte por separado en tablas hash:
+ * - los shaders por nombre de archivo (se compilan una vez);
+ * - los input layouts por la firma de entrada del VS y la descripcin de los elementos, as
+ *   dos shaders con la misma firma comparten layout;
+ * - rasterizer, blend, depth-stencil y sampler por el contenido de su descripcin.
+ *
+ * Despus busca la combinacin resultante; si ya existe devuelve el mismo handle. Los
+ * handles son ndices consecutivos y no cambian mientras viva el cach.
+ *
+ * @note El runtime de Direct3D 11 tambin devuelve el mismo objeto para descripciones de
+ *       estado iguales, pero solo despus de validar la descripcin en cada llamada; aqu
+ *       ni siquiera se llega a llamarlo.
+ * @warning Usar solo desde el hilo que posee el contexto inmediato.
+ */
+class
+    PipelineStateCache {
+public:
+    PipelineStateCache() = default;
+    ~PipelineStateCache() = default;
+
+    PipelineStateCache(const PipelineStateCache&) = delete;
+    PipelineStateCache& operator=(const PipelineStateCache&) = delete;
+
+    /**
+     * @brief Guarda el dispositivo con el que se crean los objetos.
+     *
+     * @param device      Dispositivo.
+     * @param shaderCache Cach de bytecode para compilar los shaders; opcional.
+     */
+    HRESULT
+        init(Device& device, ShaderCache* shaderCache = nullptr);
+
+    /**
+     * @brief Mtodo de marcador; el cach no cambia entre frames.
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Asigna el estado @p pipelineState (ver apply()).
+     */
+    void
+        render(DeviceContext& deviceContext, unsigned int pipelineState) { apply(deviceContext, pipelineState); }
+
+    /**
+     * @brief Libera todos los objetos; los handles entregados dejan de ser vlidos.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Devuelve el estado de pipeline de @p desc, creando solo las partes que falten.
+     *
+     * @param desc          Descripcin del estado.
+     * @param pipelineState Salida: handle del estado.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT si fall la compilacin o creacin.
+     */
+    HRESULT
+        create(const PipelineStateDesc& desc, unsigned int& pipelineState);
+
+    /**
+     * @brief Crea varios estados de pipeline compilando en paralelo los shaders que falten.
+     *
+     * Los archivos de shader que an no estn en el cach se compilan en un solo lote de
+     * @p compiler; despus cada descripcin se resuelve como en create().
+     *
+     * @param descs          Descripciones de los estados.
+     * @param compiler       Compilador con el que se construye el lote.
+     * @param pipelineStates Salida: un handle por descripcin (@c kInvalidPipelineState si fall).
+     * @return @c S_OK si todos se crearon; el primer @c HRESULT de error en otro caso.
+     */
+    HRESULT
+        create(const std::vector<PipelineStateDesc>& descs,
+            ShaderCompiler& compiler,
+            std::vector<unsigned int>& pipelineStates);
+
+    /**
+     * @brief Reemplaza los shaders de @p fileName en todos los estados que los usan.
+     *
+     * Crea los shaders nuevos y, para cada estado que usaba el archivo, el input layout
+     * contra la firma del VS nuevo. Solo si todo eso funcion se actualizan los estados; si
+     * algo falla se conservan los shaders anteriores. Los handles no cambian.
+     *
+     * Toma posesin de @p vertexShaderData y @p pixelShaderData en todos los casos.
+     *
+     * @return @c S_OK si se reemplaz; @c S_FALSE si ningn estado usa @p fileName;
+     *         cdigo @c HRESULT de error si se conservaron los anteriores.
+     */
+    HRESULT
+        replaceShader(const std::string& fileName,
+            ID3DBlob* vertexShaderData,
+            ID3DBlob* pixelShaderData);
+
+    /**
+     * @brief Archivos de shader que usa algn estado.
+     */
+    std::vector<std::string>
+        shaderFiles() const;
+
+    /**
+     * @brief Asigna input layout, shaders, estados fijos y el sampler de PS s0.
+     *
+     * Las partes que ya estaban asignadas las omite el filtro de estado de @c DeviceContext.
+     */
+    void
+        apply(DeviceContext& deviceContext, unsigned int pipelineState) const;
+
+    /**
+     * @brief Objetos del estado @p pipelineState; @c nullptr si el handle no es vlido.
+     *
+     * La direccin es estable mientras viva el cach.
+     */
+    const PipelineState*
+        state(unsigned int pipelineState) const;
+
+    /**
+     * @brief Nmero de estados de pipeline distintos.
+     */
+    unsigned int
+        pipelineStateCount() const { return static_cast<unsigned int>(m_states.size()); }
+
+    /**
+     * @brief Resumen de una lnea con los objetos creados y los contadores.
+     */
+    std::string
+        report() const;
+
+public:
+    /**
+     * @brief Contadores desde init().
+     */
+    PipelineStateCacheStats m_stats;
+
+private:
+    /**
+     * @brief Shaders de @p fileName, compilndolos si es la primera vez.
+     */
+    HRESULT
+        findShader(const std::string& fileName, ShaderProgram*& program);
+
+    /**
+     * @brief Input layout para @p layout y la firma de entrada del VS de @p program.
+     */
+    HRESULT
+        findInputLayout(ShaderProgram& program,
+            const std::vector<D3D11_INPUT_ELEMENT_DESC>& layout,
+            ID3D11InputLayout*& inputLayout);
+
+    /**
+     * @brief Busca @p key en @p states o llama a @p create para crear el objeto.
+     */
+    /**
+     * @brief Llave de @c m_stateIndex: la combinacin de punteros del estado.
+     */
+    static std::string
+        stateKey(const PipelineState& state);
+
+    template<typename State, typename Create>
+    HRESULT
+        findState(std::unordered_map<std::string, State*>& states,
+            const std::string& key,
+            Create create,
+            State*& state);
+
+private:
+    Device* m_device = nullptr;
+    ShaderCache* m_shaderCache = nullptr;
+    std::unordered_map<std::string, std::unique_ptr<ShaderProgram>> m_shaders;
+    std::unordered_map<std::string, std::unique_ptr<InputLayout>> m_inputLayouts;
+    std::unordered_map<std::string, ID3D11RasterizerState*> m_rasterizerStates;
+    std::unordered_map<std::string, ID3D11BlendState*> m_blendStates;
+    std::unordered_map<std::string, ID3D11DepthStencilState*> m_depthStencilStates;
+    std::unordered_map<std::string, ID3D11SamplerState*> m_samplerStates;
+    // La llave es la combinacin de objetos; deque para que state() devuelva direcciones estables
+    std::unordered_map<std::string, unsigned int> m_stateIndex;
+    std::deque<PipelineState> m_states;
+
+    /**
+     * @brief Archivo y layout de cada estado (mismo ndice), para recrearlo en replaceShader().
+     *
+     * Las semnticas apuntan a @c m_semanticNames: el puntero del llamador no es estable.
+     */
+    struct StateSource {
+        std::string shaderFile;
+        std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
+    };
+    std::deque<StateSource> m_sources;
+    std::unordered_set<std::string> m_semanticNames;
+};
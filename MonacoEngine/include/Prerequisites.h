@@ -6,11 +6,29 @@
 #include <windows.h>
 #include <xnamath.h>
 #include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <random>
+#include <fstream>
+#include <charconv>
+#include <emmintrin.h>
 
 // Librerias DirectX
 #include <d3d11.h>
 #include <d3dx11.h>
 #include <d3dcompiler.h>
+#include <wincodec.h>
 #include "Resource.h"
 #include "resource.h"
 
@@ -63,6 +81,15 @@ struct CBChangesEveryFrame
     XMFLOAT4 vMeshColor;
 };
 
+// Datos por instancia (WORLD0-3, COLOR0, CUSTOM0); mWorld va sin transponer. vCustom es libre;
+// con el keyword ATLAS de MonacoEngineVariants.fx es la regin de TextureAtlas (AtlasRegion::uvTransform)
+struct InstanceData
+{
+    XMFLOAT4X4 mWorld;
+    XMFLOAT4 vColor;
+    XMFLOAT4 vCustom;
+};
+
 enum ExtensionType {
     DDS = 0,
     PNG = 1,
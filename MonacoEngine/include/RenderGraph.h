@@ -0,0 +1,308 @@
+#pragma once
+#include "Prerequisites.h"
+#include "RenderTargetPool.h"
+
+class DeviceContext;
+class RenderGraph;
+
+/**
+ * @enum RenderGraphLoadOp
+ * @brief Qu hacer con el contenido previo de un render target al empezar un pase.
+ *
+ * - @c Load: conservarlo (el pase dibuja encima).
+ * - @c Clear: limpiarlo con el valor indicado.
+ * - @c DontCare: el pase sobrescribe todo; no se limpia.
+ */
+enum class RenderGraphLoadOp {
+    Load,
+    Clear,
+    DontCare
+};
+
+/**
+ * @struct RenderGraphStats
+ * @brief Resultado del ltimo compile() / execute().
+ */
+struct RenderGraphStats {
+    unsigned int passes = 0;
+    unsigned int culledPasses = 0;
+    unsigned int transientTextures = 0;
+    unsigned int physicalTextures = 0;
+    unsigned int renderTargetBinds = 0;
+    unsigned int clears = 0;
+};
+
+/**
+ * @brief Valor de handle que no corresponde a ningn recurso del grafo.
+ */
+static constexpr unsigned int kInvalidRenderGraphHandle = 0xFFFFFFFF;
+
+/**
+ * @class RenderGraphBuilder
+ * @brief Lo recibe la funcin de setup de un pase para declarar qu lee y qu escribe.
+ */
+class
+    RenderGraphBuilder {
+public:
+    /**
+     * @brief Declara que el pase lee @p texture como shader resource.
+     */
+    void
+        read(unsigned int texture);
+
+    /**
+     * @brief Declara que el pase escribe @p texture como render target.
+     *
+     * Los render targets se enlazan en el orden en que se declaran (SV_Target0, 1, ...).
+     *
+     * @param texture    Textura destino.
+     * @param loadOp     Qu hacer con el contenido previo.
+     * @param clearColor Color de limpieza para @c RenderGraphLoadOp::Clear.
+     */
+    void
+        writeColor(unsigned int texture,
+            RenderGraphLoadOp loadOp = RenderGraphLoadOp::Load,
+            const float clearColor[4] = nullptr);
+
+    /**
+     * @brief Declara que el pase escribe @p texture como depth-stencil.
+     */
+    void
+        writeDepth(unsigned int texture,
+            RenderGraphLoadOp loadOp = RenderGraphLoadOp::Load,
+            float clearDepth = 1.0f,
+            unsigned char clearStencil = 0);
+
+    /**
+     * @brief Marca el pase como necesario aunque nadie lea lo que escribe.
+     */
+    void
+        sideEffect();
+
+private:
+    friend class RenderGraph;
+
+    RenderGraphBuilder(RenderGraph& graph, unsigned int pass) : m_graph(graph), m_pass(pass) {}
+
+    RenderGraph& m_graph;
+    unsigned int m_pass;
+};
+
+/**
+ * @brief Declara las lecturas y escrituras de un pase.
+ */
+using RenderGraphSetup = std::function<void(RenderGraphBuilder&)>;
+
+/**
+ * @brief Emite los draws de un pase; los render targets ya estn enlazados y limpios.
+ */
+using RenderGraphExecute = std::function<void(DeviceContext&, const RenderGraph&)>;
+
+/**
+ * @class RenderGraph
+ * @brief Grafo de pases de render que se declara cada frame.
+ *
+ * Por frame:
+ * - update() descarta los pases y recursos del frame anterior.
+ * - createTexture() / importRenderTarget() / importDepthStencil() declaran los recursos.
+ * - addPass() declara cada pase con su setup (lecturas y escrituras) y su ejecucin.
+ * - compile() elimina los pases cuyo resultado nadie usa, calcula la vida de cada textura
+ *   transitoria y le asigna un recurso fsico.
+ * - execute() enlaza los render targets solo cuando cambian, limpia los que lo piden y
+ *   llama a cada pase en orden.
+ *
+ * Un pase se conserva si escribe un recurso importado, si se marc con sideEffect() o si
+ * un pase posterior lee lo que escribe. Escribir con @c Clear o @c DontCare descarta el
+ * contenido anterior, as que los pases que solo lo producan se eliminan tambin.
+ *
+ * Las texturas transitorias cuyos rangos de pases no se solapan comparten el mismo
+ * @c ID3D11Texture2D si tienen la misma descripcin. Los recursos fsicos se piden al
+ * @c RenderTargetPool en compile() y se le devuelven al terminar execute(), as que las
+ * vistas de las texturas transitorias solo son vlidas durante execute().
+ *
+ * @note Direct3D 11 no permite colocar dos recursos en la misma memoria, por eso el
+ *       aliasing es por recurso completo y exige descripciones iguales.
+ * @note La primera escritura de una textura transitoria con @c Load se trata como
+ *       @c DontCare: su contenido previo no est definido.
+ * @warning Los pases no deben cambiar los render targets por su cuenta.
+ */
+class
+    RenderGraph {
+public:
+    RenderGraph() = default;
+    ~RenderGraph() = default;
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    /**
+     * @brief Guarda el pool del que se toman los recursos fsicos.
+     *
+     * @param pool Pool ya inicializado; debe vivir ms que el grafo.
+     */
+    HRESULT
+        init(RenderTargetPool& pool);
+
+    /**
+     * @brief Descarta los pases y recursos declarados y devuelve al pool lo que quede.
+     */
+    void
+        update();
+
+    /**
+     * @brief Ejecuta el grafo compilado (ver execute()).
+     */
+    void
+        render(DeviceContext& deviceContext) { execute(deviceContext); }
+
+    /**
+     * @brief Devuelve los recursos fsicos al pool y descarta todo lo declarado.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Declara una textura transitoria; su recurso fsico sale del pool.
+     *
+     * @return Handle de la textura.
+     */
+    unsigned int
+        createTexture(const std::string& name, const RenderTargetDesc& desc);
+
+    /**
+     * @brief Declara un render target externo (p. ej. el back buffer).
+     */
+    unsigned int
+        importRenderTarget(const std::string& name, ID3D11RenderTargetView* renderTargetView);
+
+    /**
+     * @brief Declara un depth-stencil externo.
+     */
+    unsigned int
+        importDepthStencil(const std::string& name, ID3D11DepthStencilView* depthStencilView);
+
+    /**
+     * @brief Declara un pase; @p setup se llama de inmediato.
+     *
+     * @param name    Nombre del pase (para diagnstico).
+     * @param setup   Declara lecturas y escrituras con el @c RenderGraphBuilder.
+     * @param execute Emite los draws del pase.
+     */
+    void
+        addPass(const std::string& name, const RenderGraphSetup& setup, const RenderGraphExecute& execute);
+
+    /**
+     * @brief Elimina pases sin uso, calcula vidas y asigna recursos fsicos del pool.
+     *
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT si el pool no pudo crear un recurso.
+     */
+    HRESULT
+        compile();
+
+    /**
+     * @brief Enlaza, limpia y ejecuta los pases que sobrevivieron a compile().
+     *
+     * Al terminar devuelve los recursos fsicos al pool.
+     */
+    void
+        execute(DeviceContext& deviceContext);
+
+    /**
+     * @brief Render target view de @p texture; @c nullptr si no tiene.
+     */
+    ID3D11RenderTargetView*
+        renderTargetView(unsigned int texture) const;
+
+    /**
+     * @brief Depth-stencil view de @p texture; @c nullptr si no tiene.
+     */
+    ID3D11DepthStencilView*
+        depthStencilView(unsigned int texture) const;
+
+    /**
+     * @brief Shader resource view de @p texture; @c nullptr si no tiene.
+     */
+    ID3D11ShaderResourceView*
+        shaderResourceView(unsigned int texture) const;
+
+    /**
+     * @brief Indica si el pase @p name sobrevivi al ltimo compile().
+     */
+    bool
+        isPassAlive(const std::string& name) const;
+
+public:
+    /**
+     * @brief Estadsticas del ltimo compile() / execute().
+     */
+    RenderGraphStats m_stats;
+
+private:
+    friend class RenderGraphBuilder;
+
+    /**
+     * @brief Escritura de un pase sobre un render target o depth-stencil.
+     */
+    struct Attachment {
+        unsigned int resource = kInvalidRenderGraphHandle;
+        RenderGraphLoadOp loadOp = RenderGraphLoadOp::Load;
+        float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float clearDepth = 1.0f;
+        unsigned char clearStencil = 0;
+    };
+
+    struct Pass {
+        std::string name;
+        std::vector<unsigned int> reads;
+        std::vector<Attachment> colors;
+        Attachment depth;
+        bool sideEffect = false;
+        bool alive = false;
+        RenderGraphExecute execute;
+    };
+
+    struct Resource {
+        std::string name;
+        RenderTargetDesc desc;
+        bool imported = false;
+        ID3D11RenderTargetView* renderTargetView = nullptr;
+        ID3D11DepthStencilView* depthStencilView = nullptr;
+        int firstPass = -1;
+        int lastPass = -1;
+        unsigned int physical = kInvalidRenderGraphHandle;
+    };
+
+    /**
+     * @brief Textura del pool tomada en este frame; la comparten transitorias de vidas disjuntas.
+     */
+    struct PhysicalTexture {
+        PooledRenderTarget* target = nullptr;
+        bool inUse = false;
+    };
+
+private:
+    /**
+     * @brief Busca entre las texturas del frame una libre con @p desc o pide otra al pool.
+     */
+    HRESULT
+        acquirePhysical(const RenderTargetDesc& desc, unsigned int& physical);
+
+    /**
+     * @brief Devuelve al pool las texturas tomadas en este frame.
+     */
+    void
+        releasePhysical();
+
+    const PooledRenderTarget*
+        physicalTarget(unsigned int texture) const;
+
+    bool
+        validResource(unsigned int texture) const { return texture < m_resources.size(); }
+
+private:
+    RenderTargetPool* m_pool = nullptr;
+    bool m_compiled = false;
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<PhysicalTexture> m_physical;
+};
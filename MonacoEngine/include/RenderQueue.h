@@ -0,0 +1,196 @@
+#pragma once
+#include "Prerequisites.h"
+#include "PipelineStateCache.h"
+
+class DeviceContext;
+class ShaderProgram;
+
+/**
+ * @struct DrawItem
+ * @brief Todo lo que necesita un draw indexado para enviarse desde @c RenderQueue.
+ *
+ * Los objetos no se retienen: deben seguir vivos hasta que la cola se enve.
+ *
+ * Con @c pipelineState vlido, el estado del @c PipelineStateCache de la cola reemplaza a
+ * @c shaderProgram, @c sampler y @c blendState.
+ */
+struct DrawItem {
+    unsigned int pipelineState = kInvalidPipelineState;
+    ShaderProgram* shaderProgram = nullptr;
+    ID3D11ShaderResourceView* texture = nullptr;     // PS t0
+    ID3D11SamplerState* sampler = nullptr;           // PS s0
+    ID3D11BlendState* blendState = nullptr;          // nullptr = sin blending
+    ID3D11Buffer* vertexBuffer = nullptr;
+    unsigned int vertexStride = 0;
+    unsigned int vertexOffset = 0;
+    ID3D11Buffer* indexBuffer = nullptr;
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT;
+    ID3D11Buffer* constantBuffer = nullptr;          // VS/PS b2 (CBChangesEveryFrame)
+    unsigned int indexCount = 0;
+    unsigned int startIndex = 0;
+    int baseVertex = 0;
+};
+
+/**
+ * @struct RenderQueueStats
+ * @brief Cambios de estado que hizo el ltimo submit().
+ */
+struct RenderQueueStats {
+    unsigned int draws = 0;
+    unsigned int programChanges = 0;
+    unsigned int textureChanges = 0;
+    unsigned int radixPasses = 0;
+};
+
+/**
+ * @class RenderQueue
+ * @brief Cola de draws ordenada por una llave de 64 bits.
+ *
+ * Cada draw se empaqueta en una llave cuyos bits ms altos pesan ms en el orden:
+ * - Opaco:      [pase:4][0][programa:12][textura:12][profundidad:16][sin uso:19]
+ * - Translcido: [pase:4][1][profundidad invertida:16][programa:12][textura:12][sin uso:19]
+ *
+ * Dentro de un pase, los opacos van primero agrupados por programa (@c ShaderProgram o
+ * estado de pipeline) y textura, y
+ * de adelante hacia atrs; los translcidos despus, de atrs hacia adelante. Las llaves
+ * se ordenan con un radix sort LSD de 8 bits que se salta los bytes iguales en todas las
+ * llaves, y el orden es estable para draws con la misma llave.
+ *
+ * Los identificadores de programa se asignan al registrarlos por primera vez y se conservan
+ * entre frames, as el orden no cambia de un frame a otro. Los de textura se reasignan en cada
+ * update() en el orden de push(), porque las vistas se recrean y sus direcciones se reutilizan.
+ * Pasados 4095 objetos distintos, los dems comparten el identificador 0xFFF: el orden sigue
+ * siendo vlido, solo se agrupan peor.
+ */
+class
+    RenderQueue {
+public:
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+
+    /**
+     * @brief Configura el rango de profundidad y reserva espacio para los draws.
+     *
+     * @param farPlane       Profundidad en espacio de vista que corresponde al ltimo bucket.
+     * @param capacity       Nmero de draws a reservar.
+     * @param pipelineStates Cach que resuelve @c DrawItem::pipelineState; puede ser @c nullptr
+     *                       si ningn draw lo usa.
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si @p farPlane no es positivo.
+     */
+    HRESULT
+        init(float farPlane, unsigned int capacity = 1024, const PipelineStateCache* pipelineStates = nullptr);
+
+    /**
+     * @brief Vaca la cola y los identificadores de textura para grabar un nuevo frame.
+     */
+    void
+        update();
+
+    /**
+     * @brief Ordena la cola y enva los draws a @p deviceContext (ver submit()).
+     */
+    void
+        render(DeviceContext& deviceContext) { submit(deviceContext); }
+
+    /**
+     * @brief Libera la memoria y olvida los identificadores asignados.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Agrega un draw a la cola.
+     *
+     * @param item        Draw a enviar.
+     * @param pass        Pase de render (0-15); los pases menores se envan primero.
+     * @param viewDepth   Profundidad del objeto en espacio de vista.
+     * @param translucent Si es @c true se ordena de atrs hacia adelante despus de los opacos.
+     */
+    void
+        push(const DrawItem& item, unsigned int pass, float viewDepth, bool translucent = false);
+
+    /**
+     * @brief Ordena los draws por llave.
+     */
+    void
+        sort();
+
+    /**
+     * @brief Ordena (si hace falta) y enva los draws, omitiendo los cambios de estado repetidos.
+     *
+     * @param deviceContext Contexto donde se envan los draws.
+     */
+    void
+        submit(DeviceContext& deviceContext);
+
+    /**
+     * @brief Nmero de draws en la cola.
+     */
+    unsigned int
+        size() const { return static_cast<unsigned int>(m_items.size()); }
+
+    /**
+     * @brief Construye la llave de un draw (ver la descripcin de la clase).
+     *
+     * @param pass        Pase de render (0-15).
+     * @param programId   Identificador del programa (12 bits).
+     * @param textureId   Identificador de la textura (12 bits).
+     * @param depth       Profundidad normalizada en [0, 1].
+     * @param translucent Elige la distribucin de bits translcida.
+     */
+    static unsigned long long
+        makeKey(unsigned int pass,
+            unsigned int programId,
+            unsigned int textureId,
+            float depth,
+            bool translucent);
+
+    /**
+     * @brief Radix sort LSD estable de @p keys, moviendo @p values junto con sus llaves.
+     *
+     * @param keys        Llaves a ordenar.
+     * @param values      Valor asociado a cada llave (mismo tamao que @p keys).
+     * @param keyScratch  Memoria auxiliar; se redimensiona si hace falta.
+     * @param valueScratch Memoria auxiliar; se redimensiona si hace falta.
+     * @return Nmero de pasadas de 8 bits que hubo que hacer (0-8).
+     */
+    static unsigned int
+        radixSort(std::vector<unsigned long long>& keys,
+            std::vector<unsigned int>& values,
+            std::vector<unsigned long long>& keyScratch,
+            std::vector<unsigned int>& valueScratch);
+
+public:
+    /**
+     * @brief Estadsticas del ltimo submit().
+     */
+    RenderQueueStats m_stats;
+
+private:
+    /**
+     * @brief Identificador de @p object en @p ids (a lo sumo 0xFFF); 0 se reserva para @c nullptr.
+     */
+    static unsigned int
+        objectId(std::unordered_map<const void*, unsigned int>& ids, const void* object);
+
+    /**
+     * @brief Identificador estable del programa de @p item: su handle de estado de pipeline o
+     *        su @c ShaderProgram. Los dos comparten la numeracin, empezando en 1.
+     */
+    unsigned int
+        programId(const DrawItem& item);
+
+private:
+    float m_farPlane = 1.0f;
+    const PipelineStateCache* m_pipelineStates = nullptr;
+    bool m_sorted = true;
+    std::vector<DrawItem> m_items;
+    std::vector<unsigned long long> m_keys;
+    std::vector<unsigned int> m_order;
+    std::vector<unsigned long long> m_keyScratch;
+    std::vector<unsigned int> m_orderScratch;
+    std::unordered_map<const void*, unsigned int> m_programIds;
+    std::unordered_map<unsigned int, unsigned int> m_pipelineStateIds;
+    unsigned int m_programCount = 0;
+    std::unordered_map<const void*, unsigned int> m_textureIds;
+};
@@ -0,0 +1,210 @@
+#pragma once
+#include "Prerequisites.h"
+
+class Device;
+
+/**
+ * @struct RenderTargetDesc
+ * @brief Descripcin completa de una textura de render; es la llave del @c RenderTargetPool.
+ */
+struct RenderTargetDesc {
+    unsigned int width = 0;
+    unsigned int height = 0;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    unsigned int bindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    unsigned int sampleCount = 1;
+    unsigned int sampleQuality = 0;
+
+    bool
+        operator==(const RenderTargetDesc& other) const {
+        return width == other.width && height == other.height && format == other.format &&
+            bindFlags == other.bindFlags && sampleCount == other.sampleCount &&
+            sampleQuality == other.sampleQuality;
+    }
+};
+
+/**
+ * @struct RenderTargetDescHash
+ * @brief Hash de @c RenderTargetDesc para @c std::unordered_map.
+ */
+struct RenderTargetDescHash {
+    size_t
+        operator()(const RenderTargetDesc& desc) const {
+        unsigned long long hash = 1469598103934665603ull;
+        const unsigned int fields[] = { desc.width, desc.height, static_cast<unsigned int>(desc.format),
+            desc.bindFlags, desc.sampleCount, desc.sampleQuality };
+        for (unsigned int field : fields) {
+            hash = (hash ^ field) * 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+/**
+ * @struct PooledRenderTarget
+ * @brief Textura del pool con las vistas que permiten sus @c bindFlags.
+ *
+ * Los campos despus de @c shaderResourceView los administra el pool.
+ */
+struct PooledRenderTarget {
+    RenderTargetDesc desc;
+    ID3D11Texture2D* texture = nullptr;
+    ID3D11RenderTargetView* renderTargetView = nullptr;
+    ID3D11DepthStencilView* depthStencilView = nullptr;
+    ID3D11ShaderResourceView* shaderResourceView = nullptr;
+
+    unsigned long long lastUsedFrame = 0;
+    unsigned long long releasedFrame = 0;
+    unsigned long long bytes = 0;
+    bool inUse = false;
+};
+
+/**
+ * @struct RenderTargetPoolStats
+ * @brief Contadores acumulados de un @c RenderTargetPool.
+ *
+ * - @c hits / @c misses: acquire() que reutilizaron / crearon una textura.
+ * - @c evictions: texturas libres destruidas por antigedad o por el presupuesto.
+ */
+struct RenderTargetPoolStats {
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    unsigned long long evictions = 0;
+};
+
+/**
+ * @class RenderTargetPool
+ * @brief Reutiliza render targets y depth-stencils (con sus vistas) por descripcin.
+ *
+ * acquire() entrega una textura libre con la misma descripcin o crea una nueva; release()
+ * la devuelve, pero solo vuelve a entregarse @c recycleDelay frames despus, para que no se
+ * reutilice mientras el frame que la solt sigue en la GPU.
+ *
+ * update() avanza el frame y aplica la poltica de desalojo sobre las texturas libres:
+ * - se destruyen las que llevan ms de @c maxIdleFrames frames sin usarse;
+ * - si los bytes libres superan @c idleBudget, se destruyen las menos usadas recientemente.
+ *
+ * @warning Usar solo desde el hilo que posee el contexto inmediato.
+ */
+class
+    RenderTargetPool {
+public:
+    RenderTargetPool() = default;
+    ~RenderTargetPool() = default;
+
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    /**
+     * @brief Configura el pool.
+     *
+     * @param device        Dispositivo con el que se crean las texturas.
+     * @param recycleDelay  Frames entre release() y la siguiente entrega de la textura.
+     * @param maxIdleFrames Frames que una textura libre puede esperar antes de destruirse.
+     * @param idleBudget    Bytes mximos en texturas libres.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        init(Device& device,
+            unsigned int recycleDelay = 1,
+            unsigned int maxIdleFrames = 120,
+            unsigned long long idleBudget = 256ull * 1024 * 1024);
+
+    /**
+     * @brief Avanza un frame: libera lo soltado hace @c recycleDelay frames y desaloja.
+     *
+     * Llamar una vez por frame, antes de los acquire() del frame.
+     */
+    void
+        update();
+
+    /**
+     * @brief Mtodo de marcador; el pool no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Destruye todas las texturas, tambin las que siguen en uso.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Entrega una textura con la descripcin @p desc.
+     *
+     * @param desc   Descripcin pedida.
+     * @param target Salida: textura entregada; vlida hasta release() o destroy().
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT si fall la creacin.
+     */
+    HRESULT
+        acquire(const RenderTargetDesc& desc, PooledRenderTarget*& target);
+
+    /**
+     * @brief Devuelve @p target al pool.
+     */
+    void
+        release(PooledRenderTarget* target);
+
+    /**
+     * @brief Texturas vivas (en uso, esperando el retraso o libres).
+     */
+    unsigned int
+        textureCount() const { return static_cast<unsigned int>(m_targets.size()); }
+
+    /**
+     * @brief Bytes aproximados de todas las texturas vivas.
+     */
+    unsigned long long
+        totalBytes() const { return m_totalBytes; }
+
+    /**
+     * @brief Bytes aproximados de las texturas libres.
+     */
+    unsigned long long
+        idleBytes() const { return m_idleBytes; }
+
+    /**
+     * @brief Resumen de una lnea con los contadores del pool.
+     */
+    std::string
+        report() const;
+
+    /**
+     * @brief Bytes por pxel de @p format (aproximado para formatos poco comunes).
+     */
+    static unsigned int
+        bytesPerPixel(DXGI_FORMAT format);
+
+public:
+    /**
+     * @brief Aciertos, fallos y desalojos desde init().
+     */
+    RenderTargetPoolStats m_stats;
+
+private:
+    HRESULT
+        createTarget(PooledRenderTarget& target);
+
+    /**
+     * @brief Destruye la textura libre @p target y la saca de todas las listas.
+     */
+    void
+        evict(PooledRenderTarget* target);
+
+    static void
+        releaseViews(PooledRenderTarget& target);
+
+private:
+    Device* m_device = nullptr;
+    unsigned int m_recycleDelay = 1;
+    unsigned int m_maxIdleFrames = 120;
+    unsigned long long m_idleBudget = 0;
+    unsigned long long m_frame = 0;
+    unsigned long long m_totalBytes = 0;
+    unsigned long long m_idleBytes = 0;
+    std::vector<std::unique_ptr<PooledRenderTarget>> m_targets;
+    std::unordered_map<RenderTargetDesc, std::vector<PooledRenderTarget*>, RenderTargetDescHash> m_free;
+    // Soltadas que an esperan el retraso de reciclado, en orden de release()
+    std::deque<PooledRenderTarget*> m_pending;
+};
@@ -80,6 +80,23 @@ public:
             unsigned int numViews,
             const float ClearColor[4]);
 
+    /**
+     * @brief Asigna el RTV junto con un Depth Stencil View sin limpiar.
+     *
+     * til al grabar listas de comandos, donde la limpieza ocurre una sola vez en el
+     * contexto inmediato.
+     *
+     * @param deviceContext    Contexto de dispositivo donde se aplicar.
+     * @param depthStencilView Depth Stencil View a asociar.
+     * @param numViews         Nmero de vistas de render (tpicamente 1).
+     *
+     * @pre @c m_renderTargetView debe estar creado con init().
+     */
+    void
+        render(DeviceContext& deviceContext,
+            DepthStencilView& depthStencilView,
+            unsigned int numViews);
+
     /**
      * @brief Asigna el RTV al contexto sin limpiar ni usar Depth Stencil.
      *
@@ -103,7 +120,7 @@ public:
      */
     void
         destroy();
-private:
+public:
     /**
      * @brief Recurso COM de Direct3D 11 para la vista de Render Target.
      * @details Vlido tras init(); @c nullptr despus de destroy().
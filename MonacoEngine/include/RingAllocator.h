@@ -0,0 +1,146 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct RingAllocatorStats
+ * @brief Contadores acumulados de un @c RingAllocator.
+ *
+ * - @c wraps: veces que la cabeza volvi al inicio del anillo.
+ * - @c stalls: asignaciones rechazadas porque el espacio siguiente sigue en uso por la GPU.
+ * - @c forcedRetires: frames liberados sin que su fence terminara (ver forceRetire()).
+ */
+struct RingAllocatorStats {
+    unsigned long long allocations = 0;
+    unsigned long long bytes = 0;
+    unsigned long long wastedBytes = 0;
+    unsigned long long wraps = 0;
+    unsigned long long stalls = 0;
+    unsigned long long forcedRetires = 0;
+};
+
+/**
+ * @class RingAllocator
+ * @brief Asignador lineal circular de rangos alineados, con reutilizacin por fences.
+ *
+ * Solo administra offsets: no conoce Direct3D, por lo que puede probarse en CPU. El uso
+ * por frame es:
+ * - allocate() las veces necesarias mientras se graba el frame.
+ * - endFrame(fence) al terminar, para asociar lo asignado con el fence de ese frame.
+ * - retire(completedFence) cuando la GPU confirma que lleg a un fence; el espacio de
+ *   los frames con fence <= @p completedFence vuelve a estar libre.
+ *
+ * Cada asignacin ocupa un rango contiguo: si no cabe al final del anillo, el resto se
+ * desperdicia hasta que el frame se libere y la cabeza vuelve al offset 0.
+ */
+class
+    RingAllocator {
+public:
+    RingAllocator() = default;
+    ~RingAllocator() = default;
+
+    /**
+     * @brief Define el tamao del anillo.
+     *
+     * @param capacity  Bytes administrados; debe ser mltiplo de @p alignment.
+     * @param alignment Alineacin de cada offset y tamao; debe ser potencia de dos.
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si los parmetros no son vlidos.
+     */
+    HRESULT
+        init(unsigned int capacity, unsigned int alignment = 256);
+
+    /**
+     * @brief Mtodo de marcador; el avance ocurre en endFrame() / retire().
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Mtodo de marcador; el asignador no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Vaca el anillo y los frames pendientes.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Reserva @p size bytes (redondeados a la alineacin).
+     *
+     * @param size   Bytes pedidos; debe ser mayor que cero y no exceder la capacidad.
+     * @param offset Offset de salida del rango reservado.
+     * @return @c true si hubo espacio; @c false si la asignacin tendra que esperar a la GPU
+     *         (cuenta un @c stall y no modifica el anillo).
+     */
+    bool
+        allocate(unsigned int size, unsigned int& offset);
+
+    /**
+     * @brief Cierra el frame actual y lo asocia con @p fence.
+     *
+     * @param fence Valor creciente que la GPU sealar al terminar el frame.
+     */
+    void
+        endFrame(unsigned long long fence);
+
+    /**
+     * @brief Libera los frames cuyo fence es menor o igual a @p completedFence.
+     */
+    void
+        retire(unsigned long long completedFence);
+
+    /**
+     * @brief Libera el frame pendiente ms antiguo sin esperar a su fence.
+     *
+     * Si no hay frames cerrados, descarta tambin lo asignado en el frame actual. Solo es
+     * seguro si quien escribe en el rango evita pisar datos en uso (p. ej. con
+     * @c D3D11_MAP_WRITE_DISCARD).
+     */
+    void
+        forceRetire();
+
+    /**
+     * @brief Nmero de frames cerrados que an no se liberan.
+     */
+    unsigned int
+        pendingFrames() const { return static_cast<unsigned int>(m_frames.size()); }
+
+    unsigned int
+        capacity() const { return m_capacity; }
+
+    unsigned int
+        alignment() const { return m_alignment; }
+
+    /**
+     * @brief Bytes ocupados (asignados o desperdiciados) que an no se liberan.
+     */
+    unsigned int
+        usedBytes() const { return m_used; }
+
+public:
+    /**
+     * @brief Contadores de asignaciones, wraps y stalls desde init().
+     */
+    RingAllocatorStats m_stats;
+
+private:
+    /**
+     * @brief Frame cerrado: su fence, dnde termin y cuntos bytes ocup.
+     */
+    struct Frame {
+        unsigned long long fence;
+        unsigned int end;
+        unsigned int bytes;
+    };
+
+private:
+    unsigned int m_capacity = 0;
+    unsigned int m_alignment = 0;
+    unsigned int m_head = 0;
+    unsigned int m_tail = 0;
+    unsigned int m_used = 0;
+    unsigned int m_frameBytes = 0;
+    std::deque<Frame> m_frames;
+};
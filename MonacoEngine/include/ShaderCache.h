@@ -0,0 +1,189 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct ShaderCacheStats
+ * @brief Contadores acumulados de un @c ShaderCache.
+ *
+ * - @c hits: compile() que devolvieron bytecode guardado.
+ * - @c misses: no haba entrada para la llave.
+ * - @c stale: haba entrada pero un include cambi; cuentan tambin como compilacin.
+ * - @c compiles / @c failures: llamadas al compilador y cuntas fallaron.
+ */
+struct ShaderCacheStats {
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    unsigned long long stale = 0;
+    unsigned long long compiles = 0;
+    unsigned long long failures = 0;
+};
+
+/**
+ * @class ShaderCache
+ * @brief Cach persistente de bytecode de shaders indexado por contenido.
+ *
+ * La llave de una entrada es un hash FNV-1a de la ruta y el contenido del archivo, los
+ * defines, el punto de entrada, el modelo y los flags de compilacin. Cada entrada guarda
+ * adems la lista de includes que abri el compilador con el hash de su contenido; si al
+ * buscarla alguno cambi, la entrada se descarta y se recompila. As un cambio en un
+ * include invalida todo lo que lo usa, aunque el archivo principal no cambie.
+ *
+ * La ranura de una entrada es el mismo hash sin el contenido del archivo: identifica una
+ * compilacin (ruta, defines, entrada, modelo y flags). Cada ranura guarda una sola entrada;
+ * al compilar una versin nueva del archivo se reemplaza la anterior, as el cach no crece
+ * con cada edicin.
+ *
+ * El archivo se abre con @c MapViewOfFile en init(): se leen el ndice y las dependencias, y
+ * el bytecode se copia directamente de la vista cuando se pide. save() reescribe el archivo completo
+ * (vista actual ms entradas nuevas) en un temporal y lo reemplaza.
+ *
+ * Formato (little-endian):
+ * - Cabecera: @c kMagic, @c kVersion, nmero de entradas, 32 bits reservados y offset del
+ *   ndice (64 bits).
+ * - Datos: por entrada, sus dependencias (hash, longitud y ruta) y su bytecode.
+ * - ndice: por entrada, llave, ranura, offsets y tamaos de sus datos.
+ *
+ * @note compile() puede llamarse desde varios hilos a la vez: las tablas se protegen con un
+ *       mutex y el compilador corre fuera de l. El resto de los mtodos, solo desde un hilo
+ *       y sin compilaciones en curso.
+ */
+class
+    ShaderCache {
+public:
+    ShaderCache() = default;
+    ~ShaderCache() = default;
+
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    static constexpr unsigned int kMagic = 0x4353534D; // "MSSC"
+    static constexpr unsigned int kVersion = 2;
+
+    /**
+     * @brief Abre (si existe) y mapea el archivo de cach.
+     *
+     * Un archivo ausente, truncado o de otra versin no es un error: se empieza vaco.
+     *
+     * @param cacheFile Ruta del archivo de cach.
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si la ruta est vaca.
+     */
+    HRESULT
+        init(const std::string& cacheFile);
+
+    /**
+     * @brief Mtodo de marcador; el cach no cambia entre frames.
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Mtodo de marcador; el cach no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Guarda las entradas nuevas y cierra el archivo.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Devuelve el bytecode de un shader, compilndolo solo si no est en el cach.
+     *
+     * @param fileName     Archivo HLSL.
+     * @param defines      Defines terminados en @c {nullptr, nullptr}; puede ser @c nullptr.
+     * @param entryPoint   Funcin de entrada.
+     * @param shaderModel  Modelo de shader (p. ej. "vs_4_0").
+     * @param flags        Flags de @c D3DCompile.
+     * @param ppBlobOut    Salida con el bytecode.
+     * @param ppErrorBlob  Salida opcional con los mensajes del compilador si hubo que compilar.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT del compilador o de lectura en caso de error.
+     */
+    HRESULT
+        compile(const std::string& fileName,
+            const D3D_SHADER_MACRO* defines,
+            LPCSTR entryPoint,
+            LPCSTR shaderModel,
+            unsigned int flags,
+            ID3DBlob** ppBlobOut,
+            ID3DBlob** ppErrorBlob = nullptr);
+
+    /**
+     * @brief Escribe el archivo si hay entradas nuevas y vuelve a mapearlo.
+     *
+     * @return @c S_OK si fue exitoso o no haba nada que guardar; @c E_FAIL si no pudo escribirse.
+     */
+    HRESULT
+        save();
+
+    /**
+     * @brief Nmero de entradas (del archivo y nuevas).
+     */
+    unsigned int
+        entryCount() const { return static_cast<unsigned int>(m_entries.size()); }
+
+    /**
+     * @brief Resumen de una lnea con los contadores del cach.
+     */
+    std::string
+        report() const;
+
+    /**
+     * @brief Hash FNV-1a de 64 bits de @p size bytes, continuando desde @p seed.
+     */
+    static unsigned long long
+        hash(const void* data, size_t size, unsigned long long seed = 1469598103934665603ull);
+
+public:
+    /**
+     * @brief Contadores desde init().
+     */
+    ShaderCacheStats m_stats;
+
+private:
+    /**
+     * @brief Include que us una compilacin y el hash de su contenido en ese momento.
+     */
+    struct Dependency {
+        std::string path;
+        unsigned long long hash = 0;
+    };
+
+    /**
+     * @brief Entrada del cach; el bytecode apunta a la vista del archivo o a @c owned.
+     */
+    struct Entry {
+        unsigned long long slot = 0;
+        std::vector<Dependency> dependencies;
+        const unsigned char* bytecode = nullptr;
+        size_t bytecodeSize = 0;
+        std::vector<unsigned char> owned;
+    };
+
+    /**
+     * @brief Mapea @c m_cacheFile y carga su ndice; deja el cach vaco si no es vlido.
+     */
+    void
+        mapFile();
+
+    void
+        unmapFile();
+
+    /**
+     * @brief Lee un archivo completo en @p contents.
+     */
+    static bool
+        readFile(const std::string& path, std::string& contents);
+
+private:
+    std::string m_cacheFile;
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const unsigned char* m_view = nullptr;
+    unsigned long long m_viewSize = 0;
+    bool m_dirty = false;
+    std::mutex m_mutex;
+    std::unordered_map<unsigned long long, Entry> m_entries;
+    std::unordered_map<unsigned long long, unsigned long long> m_slots; // ranura -> llave
+};
@@ -0,0 +1,147 @@
+#pragma once
+#include "Prerequisites.h"
+#include "ShaderProgram.h"
+
+class Device;
+class ShaderCache;
+class ThreadPool;
+
+/**
+ * @struct ShaderCompileRequest
+ * @brief Programa de shaders a construir en un lote de @c ShaderCompiler.
+ */
+struct ShaderCompileRequest {
+    /**
+     * @brief Programa que recibe los shaders; debe seguir vivo hasta que termine compile().
+     */
+    ShaderProgram* program = nullptr;
+
+    /**
+     * @brief Archivo HLSL con los puntos de entrada @c VS y @c PS.
+     */
+    std::string fileName;
+
+    /**
+     * @brief Defines de esta variante.
+     */
+    std::vector<ShaderMacro> defines;
+
+    /**
+     * @brief Layout del VS; vaco para conservar el bytecode del VS y crear los layouts despus.
+     */
+    std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
+};
+
+/**
+ * @struct ShaderCompileTiming
+ * @brief Tiempo de compilacin de una etapa de un programa del ltimo lote.
+ */
+struct ShaderCompileTiming {
+    std::string fileName;
+    std::string defines;
+    ShaderType type = VERTEX_SHADER;
+    double milliseconds = 0.0;
+    HRESULT result = S_OK;
+};
+
+/**
+ * @struct ShaderCompilerStats
+ * @brief Contadores acumulados de un @c ShaderCompiler.
+ *
+ * - @c compileMilliseconds: suma de los tiempos de cada etapa (lo que costara en serie).
+ * - @c wallMilliseconds: tiempo real de los lotes, incluida la creacin de objetos.
+ */
+struct ShaderCompilerStats {
+    unsigned long long batches = 0;
+    unsigned long long programs = 0;
+    unsigned long long stages = 0;
+    unsigned long long failures = 0;
+    double compileMilliseconds = 0.0;
+    double wallMilliseconds = 0.0;
+};
+
+/**
+ * @class ShaderCompiler
+ * @brief Compila lotes de programas de shaders en paralelo.
+ *
+ * compile() reparte todas las etapas (VS y PS de cada peticin) entre los hilos de un
+ * @c ThreadPool con parallelFor(); cada etapa solo produce bytecode, sin tocar el
+ * dispositivo. Al terminar, en el hilo que llama y en el orden de las peticiones, se crean
+ * los objetos de Direct3D respetando sus dependencias: VS, luego el input layout (que
+ * necesita el bytecode del VS) y luego PS.
+ *
+ * Si hay un @c ShaderCache, las etapas pasan por l; compile() del cach es seguro entre hilos.
+ */
+class
+    ShaderCompiler {
+public:
+    ShaderCompiler() = default;
+    ~ShaderCompiler() = default;
+
+    ShaderCompiler(const ShaderCompiler&) = delete;
+    ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+    /**
+     * @brief Configura el compilador.
+     *
+     * @param threadPool  Hilos para compilar; con @c nullptr o un pool sin hilos se compila
+     *                    en el hilo que llama. Solo se usa dentro de compile().
+     * @param shaderCache Cach de bytecode; opcional.
+     * @return @c S_OK.
+     */
+    HRESULT
+        init(ThreadPool* threadPool = nullptr, ShaderCache* shaderCache = nullptr);
+
+    /**
+     * @brief Mtodo de marcador; el compilador no cambia entre frames.
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Mtodo de marcador; el compilador no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    void
+        destroy();
+
+    /**
+     * @brief Compila y crea todos los programas de @p requests.
+     *
+     * Una peticin que falla no detiene a las dems; su programa queda destruido.
+     *
+     * @param device   Dispositivo con el que se crean los shaders y layouts.
+     * @param requests Programas a construir.
+     * @return @c S_OK si todos se crearon; el primer @c HRESULT de error en otro caso.
+     */
+    HRESULT
+        compile(Device& device, const std::vector<ShaderCompileRequest>& requests);
+
+    /**
+     * @brief Tiempos por etapa del ltimo lote, en el orden de las peticiones (VS, PS).
+     */
+    const std::vector<ShaderCompileTiming>&
+        timings() const { return m_timings; }
+
+    /**
+     * @brief Resumen del ltimo lote y las etapas ms lentas.
+     */
+    std::string
+        report() const;
+
+public:
+    /**
+     * @brief Contadores desde init().
+     */
+    ShaderCompilerStats m_stats;
+
+private:
+    ThreadPool* m_threadPool = nullptr;
+    ShaderCache* m_shaderCache = nullptr;
+    std::vector<ShaderCompileTiming> m_timings;
+    double m_lastWallMilliseconds = 0.0;
+    unsigned int m_lastFailures = 0;
+    unsigned int m_lastThreads = 0;
+};
@@ -0,0 +1,156 @@
+#pragma once
+#include "Prerequisites.h"
+#include "FileWatcher.h"
+#include "ThreadPool.h"
+
+class PipelineStateCache;
+class ShaderCache;
+class ShaderPermutations;
+
+/**
+ * @struct ShaderHotReloadStats
+ * @brief Contadores acumulados de un @c ShaderHotReload.
+ *
+ * - @c changes: archivos de shader modificados que entreg el @c FileWatcher.
+ * - @c compiles / @c failures: archivos recompilados en segundo plano y cuntos no compilaron.
+ * - @c applied: archivos cuyos shaders se reemplazaron en un frame.
+ * - @c discarded: compilaciones descartadas porque el archivo volvi a cambiar.
+ */
+struct ShaderHotReloadStats {
+    unsigned long long changes = 0;
+    unsigned long long compiles = 0;
+    unsigned long long failures = 0;
+    unsigned long long applied = 0;
+    unsigned long long discarded = 0;
+    double compileMilliseconds = 0.0;
+};
+
+/**
+ * @class ShaderHotReload
+ * @brief Recompila los shaders que cambian en disco sin detener el render.
+ *
+ * update() se llama al inicio de cada frame: primero reemplaza los shaders de las
+ * compilaciones que ya terminaron y despus revisa el @c FileWatcher y encola las nuevas.
+ * La compilacin corre en un @c ThreadPool y solo produce bytecode; los objetos de D3D11 se
+ * crean en update(), entre frames, as que ningn frame ve una mezcla de shaders viejos y nuevos.
+ *
+ * Si el archivo modificado es el principal de un estado o de una permutacin, solo se recompila
+ * ese; si es un include (o el sistema perdi notificaciones) se recompila todo lo registrado.
+ * Cuando un shader no compila se conserva el anterior y el error queda en la salida de depuracin.
+ *
+ * @warning Todos los mtodos, solo desde el hilo de render.
+ */
+class
+    ShaderHotReload {
+public:
+    ShaderHotReload() = default;
+    ~ShaderHotReload() { destroy(); }
+
+    ShaderHotReload(const ShaderHotReload&) = delete;
+    ShaderHotReload& operator=(const ShaderHotReload&) = delete;
+
+    /**
+     * @brief Empieza a vigilar @p directory.
+     *
+     * @param directory   Directorio con los shaders ("" para el directorio actual).
+     * @param threadPool  Hilos para compilar; con @c nullptr se crea un hilo propio.
+     * @param shaderCache Cach de bytecode; opcional.
+     * @return @c S_OK si fue exitoso; el @c HRESULT del @c FileWatcher en caso de error.
+     */
+    HRESULT
+        init(const std::string& directory,
+            ThreadPool* threadPool = nullptr,
+            ShaderCache* shaderCache = nullptr);
+
+    /**
+     * @brief Recarga los archivos de shader de los estados de @p pipelineStateCache.
+     */
+    void
+        watch(PipelineStateCache& pipelineStateCache);
+
+    /**
+     * @brief Recarga las variantes de @p permutations cuando cambia su archivo.
+     *
+     * Las variantes se recompilan con el hilo de la propia permutacin y se reemplazan en su
+     * update(), que debe llamarse despus del update() de esta clase.
+     */
+    void
+        watch(ShaderPermutations& permutations);
+
+    /**
+     * @brief Aplica las compilaciones terminadas y encola las de los archivos modificados.
+     */
+    void
+        update();
+
+    /**
+     * @brief Mtodo de marcador; la recarga no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Espera las compilaciones en curso y deja de vigilar.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Resumen de una lnea con los contadores.
+     */
+    std::string
+        report() const;
+
+public:
+    /**
+     * @brief Contadores desde init().
+     */
+    ShaderHotReloadStats m_stats;
+
+private:
+    /**
+     * @brief Bytecode de un archivo recompilado, pendiente de aplicar en update().
+     */
+    struct CompiledFile {
+        std::string fileName;
+        unsigned int generation = 0;
+        ID3DBlob* vertexShaderData = nullptr;
+        ID3DBlob* pixelShaderData = nullptr;
+        HRESULT result = S_OK;
+        double milliseconds = 0.0;
+    };
+
+    /**
+     * @brief Ruta comparable: minsculas, separador '\\' y sin ".\\" inicial.
+     */
+    static std::string
+        normalize(const std::string& path);
+
+    /**
+     * @brief Si @p path tiene extensin de cdigo HLSL.
+     */
+    static bool
+        isShaderSource(const std::string& path);
+
+    /**
+     * @brief Encola la recompilacin de @p fileName, invalidando la que estuviera en curso.
+     */
+    void
+        compileInBackground(const std::string& fileName);
+
+private:
+    FileWatcher m_watcher;
+    ThreadPool* m_threadPool = nullptr;
+    std::unique_ptr<ThreadPool> m_ownThreadPool;
+    ShaderCache* m_shaderCache = nullptr;
+    std::vector<PipelineStateCache*> m_pipelineStateCaches;
+    std::vector<ShaderPermutations*> m_permutations;
+    // Archivo -> ltima compilacin encolada; las anteriores se descartan
+    std::unordered_map<std::string, unsigned int> m_generations;
+
+    // Compartido con los hilos de compilacin
+    std::mutex m_mutex;
+    std::condition_variable m_idle;
+    std::vector<CompiledFile> m_completed;
+    unsigned int m_inFlight = 0;
+};
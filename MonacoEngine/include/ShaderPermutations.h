@@ -0,0 +1,248 @@
+#pragma once
+#include "Prerequisites.h"
+#include "ShaderProgram.h"
+#include "ThreadPool.h"
+
+class Device;
+class DeviceContext;
+class ShaderCache;
+class ShaderCompiler;
+
+/**
+ * @struct ShaderPermutationDesc
+ * @brief Archivo de shaders con keywords de preprocesador que se combinan en variantes.
+ *
+ * Una variante es una mscara de bits sobre @c keywords: el bit @c i activo compila con
+ * @c keywords[i] definido a 1.
+ */
+struct ShaderPermutationDesc {
+    /**
+     * @brief Archivo HLSL con los puntos de entrada @c VS y @c PS.
+     */
+    std::string fileName;
+
+    /**
+     * @brief Keywords de la permutacin (mximo 32), p. ej. "TEXTURED" o "INSTANCED".
+     */
+    std::vector<std::string> keywords;
+
+    /**
+     * @brief Layout de la variante sin keywords.
+     */
+    std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
+
+    /**
+     * @brief Keywords que cambian la firma de entrada del VS.
+     *
+     * Una variante solo sirve de respaldo de otra si coinciden en estos bits.
+     */
+    unsigned int layoutKeywords = 0;
+
+    /**
+     * @brief Agrega a @p layout los elementos que necesita @p variant; opcional.
+     */
+    std::function<void(unsigned int variant, std::vector<D3D11_INPUT_ELEMENT_DESC>& layout)> extendLayout;
+};
+
+/**
+ * @struct ShaderPermutationStats
+ * @brief Contadores acumulados de un @c ShaderPermutations.
+ *
+ * - @c requests / @c fallbacks: request() y cuntas no devolvieron la variante pedida.
+ * - @c backgroundCompiles / @c failures: variantes compiladas en segundo plano y cuntas fallaron.
+ * - @c preloaded: variantes creadas por loadVariantSet().
+ * - @c reloads: variantes reemplazadas despus de reload().
+ */
+struct ShaderPermutationStats {
+    unsigned long long requests = 0;
+    unsigned long long fallbacks = 0;
+    unsigned long long backgroundCompiles = 0;
+    unsigned long long failures = 0;
+    unsigned long long preloaded = 0;
+    unsigned long long reloads = 0;
+    double compileMilliseconds = 0.0;
+};
+
+/**
+ * @class ShaderPermutations
+ * @brief Variantes de un programa de shaders compiladas bajo demanda en segundo plano.
+ *
+ * init() compila solo la variante sin keywords. request() devuelve la variante pedida si ya
+ * est creada; si no, encola su compilacin en un @c ThreadPool y mientras tanto devuelve la
+ * variante lista ms parecida: la que tiene ms keywords, todas incluidas en las pedidas y
+ * con los mismos bits de @c layoutKeywords. Los hilos solo producen bytecode; update(), en
+ * el hilo de render, crea los shaders y el layout de las variantes terminadas.
+ *
+ * loadVariantSet() compila en paralelo, al arrancar, una lista de variantes guardada con
+ * saveVariantSet(); con un @c ShaderCache esas compilaciones son lecturas del disco.
+ *
+ * @warning request(), update() y el resto de los mtodos, solo desde el hilo de render.
+ */
+class
+    ShaderPermutations {
+public:
+    ShaderPermutations() = default;
+    ~ShaderPermutations() { destroy(); }
+
+    ShaderPermutations(const ShaderPermutations&) = delete;
+    ShaderPermutations& operator=(const ShaderPermutations&) = delete;
+
+    /**
+     * @brief Registra la permutacin y crea la variante sin keywords.
+     *
+     * @param device      Dispositivo con el que se crean los shaders.
+     * @param desc        Archivo, keywords y layout.
+     * @param threadPool  Hilos para compilar; con @c nullptr se crea un hilo propio.
+     * @param shaderCache Cach de bytecode; opcional.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT si la variante base no compila.
+     */
+    HRESULT
+        init(Device& device,
+            const ShaderPermutationDesc& desc,
+            ThreadPool* threadPool = nullptr,
+            ShaderCache* shaderCache = nullptr);
+
+    /**
+     * @brief Crea las variantes que terminaron de compilarse.
+     *
+     * Llamar una vez por frame, antes de los request() del frame.
+     */
+    void
+        update();
+
+    /**
+     * @brief Asigna la variante @p variant (o su respaldo) al pipeline.
+     */
+    void
+        render(DeviceContext& deviceContext, unsigned int variant);
+
+    /**
+     * @brief Espera las compilaciones en curso y libera todas las variantes.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Mscara de la variante con @p keywords activos; los desconocidos se ignoran.
+     */
+    unsigned int
+        variant(const std::vector<std::string>& keywords) const;
+
+    /**
+     * @brief Programa de @p variant, o de su respaldo si an no est listo.
+     *
+     * @return @c nullptr si no hay ninguna variante lista compatible con el layout.
+     */
+    ShaderProgram*
+        request(unsigned int variant);
+
+    /**
+     * @brief Si la variante @p variant ya puede usarse.
+     */
+    bool
+        isReady(unsigned int variant) const;
+
+    /**
+     * @brief Vuelve a compilar en segundo plano todas las variantes creadas o fallidas.
+     *
+     * Mientras tanto se siguen usando los programas actuales; update() los reemplaza solo
+     * si la variante nueva se cre bien. Una variante que falla de nuevo conserva el anterior.
+     * Si una compilacin anterior de la misma variante termina despus, se descarta.
+     */
+    void
+        reload();
+
+    /**
+     * @brief Archivo HLSL de la permutacin.
+     */
+    const std::string&
+        fileName() const { return m_desc.fileName; }
+
+    /**
+     * @brief Compila en un lote las variantes listadas en @p fileName.
+     *
+     * Cada lnea contiene los keywords de una variante separados por espacios; las lneas
+     * vacas corresponden a la variante sin keywords. Un archivo ausente no es un error.
+     *
+     * @return @c S_OK si todas se crearon; el primer @c HRESULT de error en otro caso.
+     */
+    HRESULT
+        loadVariantSet(const std::string& fileName, ShaderCompiler& compiler);
+
+    /**
+     * @brief Escribe en @p fileName las variantes listas, en el formato de loadVariantSet().
+     */
+    HRESULT
+        saveVariantSet(const std::string& fileName) const;
+
+    /**
+     * @brief Resumen de una lnea con las variantes y los contadores.
+     */
+    std::string
+        report() const;
+
+public:
+    /**
+     * @brief Contadores desde init().
+     */
+    ShaderPermutationStats m_stats;
+
+private:
+    enum VariantState {
+        VARIANT_COMPILING,
+        VARIANT_READY,
+        VARIANT_FAILED
+    };
+
+    // @c generation cuenta las compilaciones encoladas; update() solo acepta la ltima
+    struct Variant {
+        std::unique_ptr<ShaderProgram> program;
+        VariantState state = VARIANT_COMPILING;
+        unsigned int generation = 0;
+    };
+
+    /**
+     * @brief Bytecode producido por un hilo, pendiente de que update() cree los objetos.
+     */
+    struct CompiledVariant {
+        unsigned int variant = 0;
+        unsigned int generation = 0;
+        ID3DBlob* vertexShaderData = nullptr;
+        ID3DBlob* pixelShaderData = nullptr;
+        HRESULT result = S_OK;
+        double milliseconds = 0.0;
+    };
+
+    std::vector<ShaderMacro>
+        defines(unsigned int variant) const;
+
+    std::vector<D3D11_INPUT_ELEMENT_DESC>
+        layout(unsigned int variant) const;
+
+    /**
+     * @brief Variante lista ms cercana a @p variant; @c nullptr si no hay ninguna compatible.
+     */
+    ShaderProgram*
+        fallback(unsigned int variant) const;
+
+    /**
+     * @brief Encola la compilacin de @p variant con una generacin nueva.
+     */
+    void
+        compileInBackground(unsigned int variant);
+
+private:
+    Device* m_device = nullptr;
+    ShaderPermutationDesc m_desc;
+    unsigned int m_validMask = 0;
+    ThreadPool* m_threadPool = nullptr;
+    std::unique_ptr<ThreadPool> m_ownThreadPool;
+    ShaderCache* m_shaderCache = nullptr;
+    std::unordered_map<unsigned int, Variant> m_variants;
+
+    // Compartido con los hilos de compilacin
+    std::mutex m_mutex;
+    std::condition_variable m_idle;
+    std::vector<CompiledVariant> m_completed;
+    unsigned int m_inFlight = 0;
+};
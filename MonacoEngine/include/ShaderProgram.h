@@ -4,8 +4,19 @@
 #include "InputLayout.h"
 
 class Device;
+class ShaderCache;
 class DeviceContext;
 
+/**
+ * @struct ShaderMacro
+ * @brief Define de preprocesador para compilar un shader; a diferencia de
+ *        @c D3D_SHADER_MACRO, es dueo de sus cadenas.
+ */
+struct ShaderMacro {
+    std::string name;
+    std::string definition;
+};
+
 /**
  * @class ShaderProgram
  * @brief Encapsula la creacin, compilacin y uso de Vertex Shader y Pixel Shader en Direct3D 11.
@@ -123,11 +134,25 @@ public:
     HRESULT
         CreateShader(Device& device, ShaderType type, const std::string& fileName);
 
+    /**
+     * @brief Crea un shader (Vertex o Pixel) a partir de bytecode ya compilado.
+     *
+     * El programa toma posesin de @p shaderData, tambin si la creacin falla.
+     *
+     * @param device     Dispositivo con el que se crear el recurso.
+     * @param type       Tipo de shader a crear.
+     * @param shaderData Bytecode compilado.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        CreateShader(Device& device, ShaderType type, ID3DBlob* shaderData);
+
     /**
      * @brief Compila un shader desde archivo.
      *
      * Llama internamente a @c D3DCompileFromFile para obtener el bytecode
-     * de un shader en funcin de su punto de entrada y modelo.
+     * de un shader en funcin de su punto de entrada y modelo. Si hay un
+     * @c ShaderCache asignado, el bytecode se pide al cach.
      *
      * @param szFileName   Ruta del archivo HLSL.
      * @param szEntryPoint Punto de entrada de la funcin shader (ej. "VSMain").
@@ -141,6 +166,56 @@ public:
             LPCSTR szShaderModel,
             ID3DBlob** ppBlobOut);
 
+    /**
+     * @brief Compila un punto de entrada de un archivo HLSL con los flags del proyecto.
+     *
+     * No usa estado del programa, por lo que puede llamarse desde varios hilos a la vez
+     * (el @c ShaderCache protege sus tablas).
+     *
+     * @param fileName    Ruta del archivo HLSL.
+     * @param defines     Defines del preprocesador.
+     * @param entryPoint  Punto de entrada (ver entryPoint()).
+     * @param shaderModel Modelo de shader (ver shaderModel()).
+     * @param shaderCache Cach de bytecode; @c nullptr compila siempre desde el archivo.
+     * @param ppBlobOut   Salida con el bytecode compilado.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    static HRESULT
+        CompileShader(const std::string& fileName,
+            const std::vector<ShaderMacro>& defines,
+            LPCSTR entryPoint,
+            LPCSTR shaderModel,
+            ShaderCache* shaderCache,
+            ID3DBlob** ppBlobOut);
+
+    /**
+     * @brief Punto de entrada HLSL de cada tipo de shader ("VS" / "PS").
+     */
+    static LPCSTR
+        entryPoint(ShaderType type) { return type == PIXEL_SHADER ? "PS" : "VS"; }
+
+    /**
+     * @brief Modelo de shader de cada tipo ("vs_4_0" / "ps_4_0").
+     */
+    static LPCSTR
+        shaderModel(ShaderType type) { return type == PIXEL_SHADER ? "ps_4_0" : "vs_4_0"; }
+
+    /**
+     * @brief Hace que las compilaciones siguientes pasen por @p shaderCache.
+     *
+     * @param shaderCache Cach de bytecode; @c nullptr compila siempre desde el archivo.
+     */
+    void
+        setShaderCache(ShaderCache* shaderCache) { m_shaderCache = shaderCache; }
+
+    /**
+     * @brief Bytecode del Vertex Shader, necesario para crear Input Layouts.
+     *
+     * @return @c nullptr si no se ha creado el VS o si CreateInputLayout() ya lo liber.
+     */
+    ID3DBlob*
+        vertexShaderData() const { return m_vertexShaderData; }
+
 public:
     /**
      * @brief Vertex Shader compilado y creado en GPU.
@@ -172,4 +247,9 @@ private:
      * @brief Bytecode compilado del Pixel Shader.
      */
     ID3DBlob* m_pixelShaderData = nullptr;
+
+    /**
+     * @brief Cach de bytecode opcional; no lo posee el programa.
+     */
+    ShaderCache* m_shaderCache = nullptr;
 };
@@ -0,0 +1,99 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class SkylinePacker
+ * @brief Acomoda rectngulos en un rea fija con el algoritmo skyline (bottom-left).
+ *
+ * Guarda solo el contorno superior de lo ya ocupado, como una lista de segmentos
+ * horizontales. Cada insert() prueba el rectngulo sobre cada segmento y elige la posicin
+ * cuyo borde superior queda ms bajo (a igualdad, la que desperdicia menos rea debajo y luego
+ * la ms a la izquierda). Los rectngulos no se liberan: es un empaquetado en lnea que
+ * crece conforme llegan, como el de las pginas de un @c TextureAtlas.
+ *
+ * Las unidades son libres (p. ej. bloques de 16x16 texels). No conoce Direct3D, por lo que
+ * puede probarse en CPU.
+ */
+class
+    SkylinePacker {
+public:
+    SkylinePacker() = default;
+    ~SkylinePacker() = default;
+
+    /**
+     * @brief Vaca el rea y define su tamao.
+     *
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si el tamao es 0.
+     */
+    HRESULT
+        init(unsigned int width, unsigned int height);
+
+    /**
+     * @brief Mtodo de marcador; el empaquetado ocurre en insert().
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Mtodo de marcador; el empaquetador no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Libera el contorno.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Busca lugar para un rectngulo de @p width x @p height y lo ocupa.
+     *
+     * @param x Salida: columna de la esquina superior izquierda.
+     * @param y Salida: fila de la esquina superior izquierda.
+     * @return @c false si no cabe en ninguna posicin.
+     */
+    bool
+        insert(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y);
+
+    /**
+     * @brief rea ocupada por los rectngulos insertados.
+     */
+    unsigned long long
+        usedArea() const { return m_usedArea; }
+
+    /**
+     * @brief Fraccin del rea total ocupada, entre 0 y 1.
+     */
+    float
+        occupancy() const;
+
+    unsigned int
+        width() const { return m_width; }
+
+    unsigned int
+        height() const { return m_height; }
+
+private:
+    struct Segment {
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+    };
+
+    /**
+     * @brief Fila en la que un rectngulo de @p width apoyado desde el segmento @p index
+     *        queda sobre todo lo ocupado; @c false si se sale del rea.
+     *
+     * @param waste Salida: rea libre que queda atrapada debajo del rectngulo.
+     */
+    bool
+        fit(size_t index, unsigned int width, unsigned int height, unsigned int& y, unsigned long long& waste) const;
+
+private:
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+    unsigned long long m_usedArea = 0;
+    // Ordenados por x, sin huecos entre ellos y cubriendo todo el ancho
+    std::vector<Segment> m_skyline;
+};
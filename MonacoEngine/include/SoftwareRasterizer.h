@@ -0,0 +1,290 @@
+#pragma once
+#include "Prerequisites.h"
+#include "ThreadPool.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class SoftwareRasterizer
+ * @brief Backend de render en CPU que ejecuta el pipeline de @c MonacoEngine.fx.
+ *
+ * Recibe las mismas llamadas que @c DeviceContext enva a D3D11 (buffers, constantes,
+ * texturas, clears y @c DrawIndexed) y produce la imagen en memoria de sistema:
+ * - VS: @c Pos * World * View * Projection usando @c CBNeverChanges (b0),
+ *   @c CBChangeOnResize (b1) y @c CBChangesEveryFrame (b2).
+ * - PS: @c txDiffuse.Sample(samLinear, Tex) * vMeshColor (bilineal, wrap).
+ * - Prueba de profundidad @c LESS y culling de caras traseras (frente en sentido horario).
+ *
+ * Los tringulos se agrupan por tiles de pantalla y los tiles se rasterizan en paralelo
+ * con un @c ThreadPool. Cada tile procesa sus tringulos en el orden de envo, por lo que
+ * el resultado es determinista sin importar el nmero de hilos.
+ *
+ * Como D3D11 no permite leer los recursos de vuelta, el rasterizador guarda una copia en
+ * CPU de cada buffer/textura creado con @c Device y de cada @c UpdateSubresource y
+ * @c CopySubresourceRegion. De las texturas solo se guarda el nivel 0 en RGBA8/BGRA8: las
+ * BC1 a BC3 se descomprimen al copiarse y los niveles inferiores que se copien a otra textura
+ * se reconstruyen con @c MipGenerator.
+ *
+ * @note Solo soporta @c SimpleVertex con topologa @c TRIANGLELIST y los formatos de
+ *       supportsTextureFormat(). Sin textura enlazada se muestrea blanco.
+ */
+class
+    SoftwareRasterizer {
+public:
+    SoftwareRasterizer() = default;
+    ~SoftwareRasterizer() = default;
+
+    /**
+     * @brief Crea los buffers de color/profundidad y se conecta a @p device y @p deviceContext.
+     *
+     * @param device        Dispositivo cuyas creaciones de recursos se copiarn en CPU.
+     * @param deviceContext Contexto cuyas llamadas se ejecutarn tambin en CPU.
+     * @param width         Ancho del render target en pxeles.
+     * @param height        Alto del render target en pxeles.
+     * @param numThreads    Hilos de rasterizacin; 0 usa todos los ncleos.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        init(Device& device,
+            DeviceContext& deviceContext,
+            unsigned int width,
+            unsigned int height,
+            unsigned int numThreads = 0);
+
+    /**
+     * @brief Mtodo de marcador; el estado se actualiza con cada llamada del contexto.
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Mtodo de marcador; el render ocurre en drawIndexed().
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Se desconecta de @c Device / @c DeviceContext y libera la memoria.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Indica si las texturas en @p format tienen copia en CPU: RGBA8/BGRA8 @c UNORM y
+     *        BC1 a BC3 @c UNORM.
+     */
+    static bool
+        supportsTextureFormat(DXGI_FORMAT format);
+
+    /**
+     * @brief Guarda una copia en CPU del contenido inicial de un recurso recin creado.
+     *
+     * @param resource Recurso creado (buffer o textura 2D).
+     * @param data     Datos iniciales (puede ser @c nullptr; se rellena con ceros).
+     * @param size     Tamao total en bytes del recurso.
+     * @param width    Ancho en texels (0 para buffers).
+     * @param height   Alto en texels (0 para buffers).
+     * @param rowPitch Bytes por fila de @p data (0 para buffers); en formatos BC, por fila
+     *                 de bloques.
+     * @param format   Formato de la textura (@c DXGI_FORMAT_UNKNOWN para buffers).
+     */
+    void
+        registerResource(ID3D11Resource* resource,
+            const void* data,
+            unsigned int size,
+            unsigned int width = 0,
+            unsigned int height = 0,
+            unsigned int rowPitch = 0,
+            DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN);
+
+    /**
+     * @brief Refleja un @c UpdateSubresource en la copia en CPU.
+     */
+    void
+        updateResource(ID3D11Resource* resource,
+            const D3D11_BOX* pDstBox,
+            const void* pSrcData,
+            unsigned int SrcRowPitch);
+
+    /**
+     * @brief Refleja un @c CopySubresourceRegion entre dos buffers en las copias en CPU.
+     *
+     * @param destination       Buffer destino.
+     * @param destinationOffset Offset en bytes dentro de @p destination.
+     * @param source            Buffer origen.
+     * @param sourceOffset      Offset en bytes dentro de @p source.
+     * @param size              Bytes a copiar.
+     */
+    void
+        copyBufferRegion(ID3D11Resource* destination,
+            unsigned int destinationOffset,
+            ID3D11Resource* source,
+            unsigned int sourceOffset,
+            unsigned int size);
+
+    /**
+     * @brief Refleja un @c CopySubresourceRegion hacia el nivel 0 de una textura.
+     *
+     * @param destination  Textura destino.
+     * @param destinationX Columna destino en texels.
+     * @param destinationY Fila destino en texels.
+     * @param source       Textura origen.
+     * @param sourceLevel  Nivel de mip del origen (texturas sin arreglo: subrecurso = nivel).
+     * @param sourceBox    Regin del origen en texels de @p sourceLevel; @c nullptr copia todo.
+     */
+    void
+        copyTextureRegion(ID3D11Resource* destination,
+            unsigned int destinationX,
+            unsigned int destinationY,
+            ID3D11Resource* source,
+            unsigned int sourceLevel,
+            const D3D11_BOX* sourceBox);
+
+    void
+        setViewport(const D3D11_VIEWPORT& viewport);
+
+    void
+        setVertexBuffer(ID3D11Buffer* buffer, unsigned int stride, unsigned int offset);
+
+    void
+        setIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, unsigned int offset);
+
+    void
+        setTopology(D3D11_PRIMITIVE_TOPOLOGY topology) { m_topology = topology; }
+
+    void
+        setVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer);
+
+    void
+        setPSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer);
+
+    void
+        setPSShaderResource(unsigned int slot, ID3D11ShaderResourceView* view);
+
+    /**
+     * @brief Limpia el buffer de color con @p color (RGBA en [0, 1]).
+     */
+    void
+        clearColor(const float color[4]);
+
+    /**
+     * @brief Limpia el buffer de profundidad con @p depth.
+     */
+    void
+        clearDepth(float depth);
+
+    /**
+     * @brief Ejecuta un draw indexado con el estado actual.
+     *
+     * @param IndexCount         Nmero de ndices.
+     * @param StartIndexLocation Primer ndice a leer.
+     * @param BaseVertexLocation Valor sumado a cada ndice antes de leer el vrtice.
+     */
+    void
+        drawIndexed(unsigned int IndexCount,
+            unsigned int StartIndexLocation,
+            int BaseVertexLocation);
+
+    /**
+     * @brief Guarda el buffer de color en un archivo TGA de 32 bits.
+     *
+     * @param fileName Ruta del archivo de salida.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        saveToFile(const std::string& fileName) const;
+
+public:
+    /**
+     * @brief Buffer de color en formato @c R8G8B8A8 (R en el byte bajo).
+     */
+    std::vector<unsigned int> m_colorBuffer;
+
+    /**
+     * @brief Buffer de profundidad en [0, 1].
+     */
+    std::vector<float> m_depthBuffer;
+
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+
+    /**
+     * @brief Tringulos rasterizados desde el ltimo clear de color.
+     */
+    unsigned long long m_trianglesDrawn = 0;
+
+private:
+    /**
+     * @brief Copia en CPU de un recurso de D3D11.
+     */
+    struct ResourceData {
+        std::vector<unsigned char> bytes;
+        unsigned int width = 0;
+        unsigned int height = 0;
+        unsigned int rowPitch = 0;
+        // Formato de @c bytes; @c sourceFormat es el del recurso (BC si se descomprimi)
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        DXGI_FORMAT sourceFormat = DXGI_FORMAT_UNKNOWN;
+    };
+
+    /**
+     * @brief Tringulo en espacio de pantalla listo para rasterizar.
+     */
+    struct Triangle {
+        long long x[3];       // Posicin en punto fijo (1/16 de pxel)
+        long long y[3];
+        float z[3];           // Profundidad tras la divisin de perspectiva
+        float invW[3];        // 1/w para correccin de perspectiva
+        float uOverW[3];
+        float vOverW[3];
+        int minX, minY, maxX, maxY;
+    };
+
+    const ResourceData*
+        findResource(ID3D11Resource* resource) const;
+
+    /**
+     * @brief Descomprime filas de bloques BC en la regin de @p entry que empieza en
+     *        (@p left, @p top); lo que quede fuera de la textura se descarta.
+     */
+    static void
+        writeBlocks(ResourceData& entry,
+            unsigned int left,
+            unsigned int top,
+            unsigned int width,
+            unsigned int height,
+            const unsigned char* blocks,
+            unsigned int rowPitch);
+
+    void
+        rasterizeTile(unsigned int tileIndex,
+            const ResourceData* texture,
+            const XMFLOAT4& meshColor);
+
+private:
+    Device* m_device = nullptr;
+    DeviceContext* m_deviceContext = nullptr;
+    ThreadPool m_threadPool;
+
+    mutable std::mutex m_resourceMutex;
+    std::unordered_map<ID3D11Resource*, ResourceData> m_resources;
+
+    D3D11_VIEWPORT m_viewport = {};
+    D3D11_PRIMITIVE_TOPOLOGY m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    ID3D11Buffer* m_vertexBuffer = nullptr;
+    unsigned int m_vertexStride = 0;
+    unsigned int m_vertexOffset = 0;
+    ID3D11Buffer* m_indexBuffer = nullptr;
+    DXGI_FORMAT m_indexFormat = DXGI_FORMAT_UNKNOWN;
+    unsigned int m_indexOffset = 0;
+    ID3D11Buffer* m_vsConstantBuffers[3] = {};
+    ID3D11Buffer* m_psConstantBuffers[3] = {};
+    ID3D11Resource* m_psTexture = nullptr;
+
+    unsigned int m_tilesX = 0;
+    unsigned int m_tilesY = 0;
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<std::vector<unsigned int>>> m_chunkBins;
+    std::vector<std::vector<unsigned int>> m_tileBins;
+};
@@ -40,6 +40,7 @@ public:
      * @param deviceContext Contexto de dispositivo asociado.
      * @param backBuffer   Textura que representar el back buffer.
      * @param window       Ventana de la aplicacin donde se presentar la imagen.
+     * @param bufferCount  Nmero de back buffers (2 = doble buffer).
      * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso contrario.
      *
      * @post Si retorna @c S_OK, @c m_swapChain != nullptr.
@@ -48,7 +49,8 @@ public:
         init(Device& device,
             DeviceContext& deviceContext,
             Texture& backBuffer,
-            Window window);
+            Window window,
+            unsigned int bufferCount = 2);
 
     /**
      * @brief Actualiza parmetros internos del Swap Chain.
@@ -88,10 +90,23 @@ public:
      * Llama a @c IDXGISwapChain::Present para mostrar el contenido renderizado
      * en la ventana asociada.
      *
-     * @note Si se utiliza V-Sync, puede configurarse en la implementacin de este mtodo.
+     * @param syncInterval Intervalos de V-Sync a esperar (0 = presentar de inmediato).
+     * @param flags        Flags de @c Present (p. ej. @c DXGI_PRESENT_TEST).
      */
     void
-        present();
+        present(unsigned int syncInterval = 0, unsigned int flags = 0);
+
+    /**
+     * @brief Limita cuntos frames puede encolar la CPU antes de que @c Present bloquee.
+     *
+     * Usa @c IDXGIDevice1::SetMaximumFrameLatency; acota la latencia de entrada cuando la
+     * GPU es el cuello de botella.
+     *
+     * @param framesInFlight Frames en cola permitidos (1 a 16).
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        setMaximumFrameLatency(unsigned int framesInFlight);
 
 public:
     /**
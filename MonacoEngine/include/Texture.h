@@ -3,6 +3,8 @@
 
 class Device;
 class DeviceContext;
+class UploadManager;
+struct DecodedImage;
 
 /**
  * @class Texture
@@ -47,6 +49,27 @@ public:
             const std::string& textureName,
             ExtensionType extensionType);
 
+    /**
+     * @brief Inicializa una textura 2D con los pxeles de una imagen ya decodificada.
+     *
+     * Si la imagen trae mips (@c ImageDecodeOptions::generateMips), la textura y su vista los
+     * incluyen todos.
+     *
+     * @param device         Dispositivo con el que se crear la textura.
+     * @param image          Imagen de @c ImageDecoder; con @p uploadManager sus pxeles se
+     *                       mueven a la cola de subidas.
+     * @param uploadManager  Si no es @c nullptr, la textura se crea vaca y se llena de forma
+     *                       asncrona; si es @c nullptr, se crea inmutable con los pxeles.
+     * @param onUploaded     Se llama cuando los pxeles llegan a la GPU (solo con
+     *                       @p uploadManager).
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso contrario.
+     */
+    HRESULT
+        init(Device& device,
+            DecodedImage& image,
+            UploadManager* uploadManager = nullptr,
+            std::function<void(unsigned int)> onUploaded = nullptr);
+
     /**
      * @brief Inicializa una textura creada desde memoria.
      *
@@ -75,7 +98,7 @@ public:
      * @brief Inicializa una textura a partir de otra existente.
      *
      * Crea una nueva textura basada en la descripcin de @p textureRef,
-     * con un formato diferente.
+     * con un formato diferente. La vista cubre todos los mips de @p textureRef.
      *
      * @param device     Dispositivo con el que se crear la textura.
      * @param textureRef Referencia a otra textura existente.
@@ -91,7 +114,8 @@ public:
      * Mtodo de marcador, til para soportar carga dinmica de datos o streaming
      * de texturas desde CPU hacia GPU.
      *
-     * @note Actualmente no realiza ninguna operacin.
+     * @note Actualmente no realiza ninguna operacin; las texturas DDS que se cargan por mips
+     *       segn su tamao en pantalla las administra @c TextureStreamer.
      */
     void
         update();
@@ -0,0 +1,201 @@
+#pragma once
+#include "Prerequisites.h"
+#include "SkylinePacker.h"
+#include "MipGenerator.h"
+
+class Device;
+class DeviceContext;
+class UploadManager;
+class MeshComponent;
+
+/**
+ * @struct TextureAtlasDesc
+ * @brief Parmetros de un @c TextureAtlas.
+ *
+ * - @c pageSize: lado de cada pgina; potencia de dos.
+ * - @c mipLevels: niveles de cada pgina. Los tiles se alinean a 2^(mipLevels - 1) texels, as
+ *   que en cada nivel empiezan y terminan en pxeles enteros y nunca comparten un texel.
+ * - @c padding: borde, en texels del nivel 0, que repite el pxel del contorno de cada tile;
+ *   con el valor por defecto (la alineacin) queda al menos un texel en el ltimo nivel.
+ * - @c format: RGBA8 o BGRA8 (@c UNORM o @c _SRGB); los pxeles de add() deben venir en l.
+ * - @c mipOptions: filtro de los mips de cada tile; @c wrap se ignora (el borde repite).
+ */
+struct TextureAtlasDesc {
+    unsigned int pageSize = 2048;
+    unsigned int mipLevels = 5;
+    unsigned int padding = 16;
+    DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    MipGenerateOptions mipOptions;
+};
+
+/**
+ * @struct AtlasRegion
+ * @brief Lugar de una textura dentro del atlas.
+ *
+ * @c uvTransform lleva las UV de la textura original a la pgina: @c uv * xy + zw. Cabe tal
+ * cual en @c InstanceData::vCustom para la variante @c ATLAS de los shaders.
+ */
+struct AtlasRegion {
+    unsigned int page = 0;
+    unsigned int x = 0;
+    unsigned int y = 0;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    XMFLOAT4 uvTransform = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f);
+};
+
+/**
+ * @struct TextureAtlasStats
+ * @brief Contadores acumulados de un @c TextureAtlas.
+ *
+ * - @c rejected: texturas que no caben en una pgina (deben usar su propia textura).
+ */
+struct TextureAtlasStats {
+    unsigned long long entries = 0;
+    unsigned long long rejected = 0;
+    unsigned long long uploadedBytes = 0;
+};
+
+/**
+ * @class TextureAtlas
+ * @brief Junta texturas pequeas (decals, UI, props) en pginas compartidas.
+ *
+ * Las texturas que se enlazan con el mismo SRV se dibujan sin cambios de estado y pueden ir
+ * en el mismo lote instanciado. Cada add() busca lugar con un @c SkylinePacker en las pginas
+ * existentes y, si no cabe en ninguna, abre otra. El tile (textura + borde repetido) se
+ * arma en CPU con sus propios mips de @c MipGenerator, as que agregar una textura solo sube
+ * su regin de cada nivel: las pginas crecen sin reconstruirse.
+ *
+ * Para usar una regin:
+ * - Mallas: remapUVs() reescribe las UV de un @c MeshComponent (deben estar en [0, 1]; las
+ *   UV que repiten la textura no pueden ir en un atlas).
+ * - Instancias: AtlasRegion::uvTransform como @c InstanceData::vCustom con el keyword
+ *   @c ATLAS de MonacoEngineVariants.fx.
+ *
+ * @warning Usar update() y render() desde el hilo que posee el contexto inmediato.
+ */
+class
+    TextureAtlas {
+public:
+    static constexpr unsigned int kInvalidHandle = 0;
+
+    TextureAtlas() = default;
+    ~TextureAtlas() = default;
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    /**
+     * @brief Valida los parmetros; las pginas se crean al necesitarse.
+     *
+     * @param device        Dispositivo con el que se crean las pginas.
+     * @param desc          Tamao, niveles, borde y formato de las pginas.
+     * @param uploadManager Si no es @c nullptr, los tiles se suben por l dentro de su
+     *                      presupuesto; si no, update() los sube con @c UpdateSubresource.
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si los parmetros no son vlidos.
+     */
+    HRESULT
+        init(Device& device, const TextureAtlasDesc& desc = TextureAtlasDesc(), UploadManager* uploadManager = nullptr);
+
+    /**
+     * @brief Sube los tiles agregados desde el ltimo update().
+     *
+     * @param deviceContext Contexto inmediato.
+     */
+    void
+        update(DeviceContext& deviceContext);
+
+    /**
+     * @brief Enlaza la pgina @p page en el slot @p slot del pixel shader.
+     */
+    void
+        render(DeviceContext& deviceContext, unsigned int page, unsigned int slot = 0);
+
+    /**
+     * @brief Libera las pginas y descarta las regiones.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Agrega una imagen al atlas.
+     *
+     * @param pixels Pxeles en el formato del atlas, filas de @p rowPitch bytes.
+     * @return Handle de la regin (mayor que cero), o @c kInvalidHandle si la imagen no es
+     *         vlida o con su borde no cabe en una pgina.
+     */
+    unsigned int
+        add(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int rowPitch);
+
+    /**
+     * @brief Regin de @p handle; @c nullptr si el handle no es vlido.
+     */
+    const AtlasRegion*
+        region(unsigned int handle) const;
+
+    /**
+     * @brief Aplica la transformacin de UV de @p handle a los vrtices de @p mesh.
+     *
+     * @return @c E_INVALIDARG si el handle no es vlido.
+     */
+    HRESULT
+        remapUVs(MeshComponent& mesh, unsigned int handle) const;
+
+    /**
+     * @brief Vista de la pgina @p page; @c nullptr si no existe.
+     */
+    ID3D11ShaderResourceView*
+        view(unsigned int page) const;
+
+    unsigned int
+        pageCount() const { return static_cast<unsigned int>(m_pages.size()); }
+
+    unsigned int
+        regionCount() const { return static_cast<unsigned int>(m_regions.size()); }
+
+    /**
+     * @brief Resumen de una lnea con las pginas, su ocupacin y los bytes subidos.
+     */
+    std::string
+        report() const;
+
+public:
+    /**
+     * @brief Contadores desde init().
+     */
+    TextureAtlasStats m_stats;
+
+private:
+    struct Page {
+        ID3D11Texture2D* texture = nullptr;
+        ID3D11ShaderResourceView* view = nullptr;
+        // En unidades de la alineacin de los tiles
+        SkylinePacker packer;
+    };
+
+    /**
+     * @brief Un nivel de un tile que espera su subida.
+     */
+    struct PendingTile {
+        unsigned int page;
+        unsigned int level;
+        D3D11_BOX box;
+        unsigned int rowPitch;
+        std::vector<unsigned char> pixels;
+    };
+
+    /**
+     * @brief Crea la textura y la vista de una pgina nueva.
+     */
+    HRESULT
+        addPage();
+
+private:
+    Device* m_device = nullptr;
+    UploadManager* m_uploadManager = nullptr;
+    TextureAtlasDesc m_desc;
+    unsigned int m_alignment = 0;
+    std::vector<Page> m_pages;
+    std::vector<AtlasRegion> m_regions;
+    std::vector<PendingTile> m_pending;
+};
@@ -0,0 +1,222 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct TextureResidencyChange
+ * @brief Cambio de residencia planificado: @c mip es el nuevo mip ms detallado de la textura.
+ */
+struct TextureResidencyChange {
+    unsigned int handle;
+    unsigned int mip;
+};
+
+/**
+ * @struct TextureResidencyStats
+ * @brief Contadores acumulados de un @c TextureResidency.
+ *
+ * - @c evictions: niveles expulsados (una textura que baja dos mips cuenta dos).
+ * - @c deferredLoads: cargas que un frame no pudo planificar por el presupuesto o por el
+ *   lmite de cargas en vuelo.
+ * - @c overBudgetFrames: frames que terminaron por encima del presupuesto porque los mips
+ *   pedidos y las colas residentes no caben.
+ */
+struct TextureResidencyStats {
+    unsigned long long loads = 0;
+    unsigned long long failedLoads = 0;
+    unsigned long long evictions = 0;
+    unsigned long long loadedBytes = 0;
+    unsigned long long evictedBytes = 0;
+    unsigned long long deferredLoads = 0;
+    unsigned long long overBudgetFrames = 0;
+};
+
+/**
+ * @class TextureResidency
+ * @brief Decide qu mips de cada textura deben estar en memoria, con un presupuesto global.
+ *
+ * Solo lleva la cuenta de bytes y niveles: no conoce Direct3D ni los archivos, por lo que
+ * puede probarse en CPU. El uso por frame es:
+ * - request() por cada textura visible, con su tamao proyectado en pantalla.
+ * - schedule() una vez por frame; devuelve las cargas a iniciar y las expulsiones a aplicar.
+ * - completeLoad() cuando termina una carga (en cualquier frame posterior).
+ *
+ * Cada textura guarda siempre su cola de mips pequeos (desde @c tailMip); por encima de
+ * ella los niveles se cargan segn lo pedido y se quedan en memoria mientras haya espacio.
+ * Cuando una carga no cabe, se expulsan primero los mips ms detallados de las texturas
+ * usadas hace ms tiempo (LRU); nunca se expulsan los que pidi el frame actual. Las cargas
+ * de mayor dficit (niveles que faltan) van primero; las que no caben se bajan a un mip
+ * menos detallado o se posponen.
+ */
+class
+    TextureResidency {
+public:
+    static constexpr unsigned int kInvalidHandle = 0;
+
+    TextureResidency() = default;
+    ~TextureResidency() = default;
+
+    /**
+     * @brief Define el presupuesto y descarta las texturas registradas.
+     *
+     * @param budget           Bytes que pueden ocupar todas las texturas juntas.
+     * @param maxLoadsInFlight Cargas planificadas que an no llaman a completeLoad().
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si los parmetros no son vlidos.
+     */
+    HRESULT
+        init(unsigned long long budget, unsigned int maxLoadsInFlight = 2);
+
+    /**
+     * @brief Mtodo de marcador; el avance ocurre en schedule() / completeLoad().
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Mtodo de marcador; la residencia no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Descarta todas las texturas.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Registra una textura con solo su cola de mips residente.
+     *
+     * @param width      Ancho del mip 0.
+     * @param height     Alto del mip 0.
+     * @param levelBytes Bytes de cada mip, del 0 al ltimo.
+     * @param tailMip    Primer mip que siempre est en memoria; se carga con la textura.
+     * @return Handle de la textura (mayor que cero), o @c kInvalidHandle si los parmetros no
+     *         son vlidos.
+     */
+    unsigned int
+        add(unsigned int width,
+            unsigned int height,
+            const std::vector<unsigned long long>& levelBytes,
+            unsigned int tailMip);
+
+    /**
+     * @brief Pide para este frame el mip adecuado a @p screenSize pxeles en pantalla.
+     *
+     * Si la textura se pide varias veces en el frame, gana el mip ms detallado.
+     */
+    void
+        request(unsigned int handle, float screenSize);
+
+    /**
+     * @brief Planifica las cargas y expulsiones del frame y avanza al siguiente.
+     *
+     * Las expulsiones ya se descuentan de residentBytes() y las cargas ya reservan sus bytes;
+     * quien llama debe aplicar ambas.
+     *
+     * @param loads     Salida: texturas a cargar hasta @c mip (ms detallado que el actual).
+     * @param evictions Salida: texturas que deben quedarse solo desde @c mip.
+     */
+    void
+        schedule(std::vector<TextureResidencyChange>& loads,
+            std::vector<TextureResidencyChange>& evictions);
+
+    /**
+     * @brief Termina la carga en vuelo de @p handle.
+     *
+     * @param succeeded Si es @c false, la textura conserva sus mips y se libera la reserva.
+     */
+    void
+        completeLoad(unsigned int handle, bool succeeded);
+
+    /**
+     * @brief Mip ms detallado en memoria de @p handle; 0 si el handle no es vlido.
+     */
+    unsigned int
+        residentMip(unsigned int handle) const;
+
+    /**
+     * @brief Mip pedido en el ltimo frame en que se us @p handle.
+     */
+    unsigned int
+        requestedMip(unsigned int handle) const;
+
+    /**
+     * @brief Bytes residentes, incluyendo los reservados por las cargas en vuelo.
+     */
+    unsigned long long
+        residentBytes() const { return m_residentBytes; }
+
+    unsigned long long
+        budget() const { return m_budget; }
+
+    /**
+     * @brief Cambia el presupuesto; si baja, el siguiente schedule() expulsa lo que sobra.
+     */
+    void
+        setBudget(unsigned long long budget) { m_budget = budget; }
+
+    unsigned int
+        loadsInFlight() const { return m_loadsInFlight; }
+
+    unsigned int
+        textureCount() const { return static_cast<unsigned int>(m_entries.size()); }
+
+    /**
+     * @brief Resumen de una lnea con la ocupacin y los contadores.
+     */
+    std::string
+        report() const;
+
+    /**
+     * @brief Mip cuyo tamao se acerca ms a un texel por pxel sin quedar por debajo.
+     *
+     * @param screenSize Pxeles en pantalla del lado ms largo de la textura; si es 0 o menor,
+     *                   el ltimo mip.
+     */
+    static unsigned int
+        mipForScreenSize(unsigned int width, unsigned int height, unsigned int mipLevels, float screenSize);
+
+    /**
+     * @brief Dimetro en pxeles de una esfera de radio @p radius a @p distance de la cmara.
+     *
+     * @param fovY           Campo de visin vertical en radianes.
+     * @param viewportHeight Alto del viewport en pxeles.
+     */
+    static float
+        projectedSize(float radius, float distance, float fovY, float viewportHeight);
+
+public:
+    /**
+     * @brief Contadores de cargas y expulsiones desde init().
+     */
+    TextureResidencyStats m_stats;
+
+private:
+    struct Entry {
+        unsigned int width;
+        unsigned int height;
+        unsigned int tailMip;
+        unsigned int residentMip;
+        // Igual a residentMip si no hay carga en vuelo
+        unsigned int loadingMip;
+        unsigned int requestedMip;
+        float screenSize;
+        unsigned long long lastUsedFrame;
+        // levelBytes acumulados desde cada mip hasta el ltimo
+        std::vector<unsigned long long> bytesFrom;
+    };
+
+    /**
+     * @brief Mip que el frame actual no debe expulsar.
+     */
+    unsigned int
+        keepMip(const Entry& entry) const;
+
+private:
+    unsigned long long m_budget = 0;
+    unsigned long long m_residentBytes = 0;
+    unsigned long long m_frame = 1;
+    unsigned int m_maxLoadsInFlight = 0;
+    unsigned int m_loadsInFlight = 0;
+    std::vector<Entry> m_entries;
+};
@@ -0,0 +1,172 @@
+#pragma once
+#include "Prerequisites.h"
+#include "ThreadPool.h"
+#include "TextureResidency.h"
+#include "MappedFile.h"
+#include "DDSLoader.h"
+#include "Texture.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class TextureStreamer
+ * @brief Carga los mips de texturas DDS segn su tamao en pantalla, con un presupuesto global.
+ *
+ * Cada textura se abre como @c MappedFile y empieza solo con su cola de mips (desde el primer
+ * nivel de @c tailSize pxeles o menos). Cada frame:
+ * - request() con el tamao proyectado de cada textura visible.
+ * - update() entrega las cargas terminadas, planifica con un @c TextureResidency y aplica sus
+ *   expulsiones; las cargas nuevas leen los bytes del archivo en un @c ThreadPool, as que el
+ *   hilo de render no espera al disco.
+ *
+ * La textura de Direct3D solo tiene los niveles residentes: al cargar o expulsar se crea una
+ * nueva con el mip superior correspondiente, los niveles que siguen en memoria se copian en la
+ * GPU (@c CopySubresourceRegion) y los nuevos se suben con @c UpdateSubresource. La vista de
+ * view() cambia con cada reemplazo; hay que pedirla en cada frame.
+ *
+ * @note Solo texturas 2D sin arreglos ni cubos. En los formatos por bloques el mip superior
+ *       debe medir mltiplos de 4, as que la cola empieza en el primer nivel que no lo cumple.
+ * @warning Usar solo desde el hilo que posee el contexto inmediato.
+ */
+class
+    TextureStreamer {
+public:
+    TextureStreamer() = default;
+    ~TextureStreamer() = default;
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    /**
+     * @brief Prepara el presupuesto y los hilos de lectura.
+     *
+     * @param device           Dispositivo con el que se crean las texturas.
+     * @param budget           Bytes de GPU para todas las texturas.
+     * @param threadPool       Hilos de lectura; si es @c nullptr se crea uno propio.
+     * @param tailSize         Lado mximo del mip superior de la cola siempre residente.
+     * @param maxLoadsInFlight Lecturas simultneas como mximo.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        init(Device& device,
+            unsigned long long budget = 64ull * 1024 * 1024,
+            ThreadPool* threadPool = nullptr,
+            unsigned int tailSize = 64,
+            unsigned int maxLoadsInFlight = 2);
+
+    /**
+     * @brief Entrega las cargas terminadas y planifica las del frame.
+     *
+     * Llamar una vez por frame, despus de los request() del frame y antes de dibujar.
+     *
+     * @param deviceContext Contexto inmediato.
+     */
+    void
+        update(DeviceContext& deviceContext);
+
+    /**
+     * @brief Mtodo de marcador; las texturas se enlazan con view().
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Espera las lecturas en curso y libera todas las texturas.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Abre @p fileName y crea su textura con la cola de mips.
+     *
+     * @return Handle de la textura, o @c TextureResidency::kInvalidHandle si fall.
+     */
+    unsigned int
+        load(const std::string& fileName);
+
+    /**
+     * @brief Pide para este frame los mips adecuados a @p screenSize pxeles en pantalla.
+     *
+     * @see TextureResidency::projectedSize()
+     */
+    void
+        request(unsigned int handle, float screenSize) { m_residency.request(handle, screenSize); }
+
+    /**
+     * @brief Vista de los niveles residentes de @p handle; @c nullptr si el handle no es vlido.
+     */
+    ID3D11ShaderResourceView*
+        view(unsigned int handle) const;
+
+    /**
+     * @brief Resumen con la ocupacin, los contadores y el tiempo de lectura.
+     */
+    std::string
+        report() const;
+
+    TextureResidency&
+        residency() { return m_residency; }
+
+    const TextureResidency&
+        residency() const { return m_residency; }
+
+private:
+    struct StreamedTexture {
+        MappedFile file;
+        DDSImage image;
+        Texture texture;
+        // Mip del archivo que es el nivel 0 de la textura actual
+        unsigned int topMip = 0;
+    };
+
+    struct CompletedLoad {
+        unsigned int handle = 0;
+        unsigned int mip = 0;
+        // Niveles mip..topMip-1 uno tras otro, con sus filas contiguas
+        std::vector<unsigned char> data;
+        double milliseconds = 0.0;
+    };
+
+    /**
+     * @brief Reemplaza la textura de @p texture por una que empieza en @p mip.
+     *
+     * @param data Bytes de los niveles nuevos (ms detallados que @c topMip), o @c nullptr al
+     *             expulsar.
+     */
+    HRESULT
+        recreate(DeviceContext& deviceContext,
+            StreamedTexture& texture,
+            unsigned int mip,
+            const unsigned char* data);
+
+    /**
+     * @brief Crea la textura de los niveles @p mip al ltimo con los datos del archivo.
+     */
+    HRESULT
+        createFromFile(StreamedTexture& texture, unsigned int mip);
+
+    /**
+     * @brief Crea la vista de la textura de @p texture con todos sus niveles.
+     */
+    HRESULT
+        createView(StreamedTexture& texture, ID3D11Texture2D* resource, ID3D11ShaderResourceView** view);
+
+private:
+    Device* m_device = nullptr;
+    ThreadPool* m_threadPool = nullptr;
+    std::unique_ptr<ThreadPool> m_ownThreadPool;
+    TextureResidency m_residency;
+    std::vector<std::unique_ptr<StreamedTexture>> m_textures;
+    unsigned int m_tailSize = 0;
+    std::vector<TextureResidencyChange> m_loads;
+    std::vector<TextureResidencyChange> m_evictions;
+    double m_readMilliseconds = 0.0;
+    unsigned long long m_recreations = 0;
+
+    // Compartido con los hilos de lectura
+    std::mutex m_mutex;
+    std::condition_variable m_idle;
+    std::vector<CompletedLoad> m_completed;
+    unsigned int m_inFlight = 0;
+};
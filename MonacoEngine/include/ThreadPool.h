@@ -0,0 +1,91 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class ThreadPool
+ * @brief Conjunto fijo de hilos de trabajo con una cola de tareas compartida.
+ *
+ * Se usa para repartir trabajo de CPU entre todos los ncleos (rasterizacin por tiles,
+ * compilacin de shaders, decodificacin de imgenes, etc.).
+ *
+ * - enqueue(): agrega una tarea sin esperar su resultado.
+ * - parallelFor(): ejecuta @c count iteraciones repartidas entre los hilos y el hilo
+ *   que llama, y regresa cuando todas terminaron.
+ *
+ * @note El destructor llama a destroy(); las tareas pendientes se completan antes de unir los hilos.
+ */
+class
+    ThreadPool {
+public:
+    ThreadPool() = default;
+
+    /**
+     * @brief Detiene y une los hilos si siguen activos.
+     */
+    ~ThreadPool() { destroy(); }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Crea los hilos de trabajo.
+     *
+     * @param numThreads Nmero de hilos; 0 usa @c std::thread::hardware_concurrency().
+     * @return @c S_OK si fue exitoso; @c E_FAIL si el pool ya estaba inicializado.
+     */
+    HRESULT
+        init(unsigned int numThreads = 0);
+
+    /**
+     * @brief Espera a que se vace la cola y une todos los hilos.
+     *
+     * Idempotente.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Agrega una tarea a la cola.
+     *
+     * Si el pool no tiene hilos la tarea se ejecuta de inmediato en el hilo que llama.
+     */
+    void
+        enqueue(std::function<void()> task);
+
+    /**
+     * @brief Ejecuta @p body(i) para i en [0, count) y espera a que terminen todas.
+     *
+     * Las iteraciones se reparten dinmicamente; el hilo que llama tambin trabaja,
+     * por lo que puede usarse con un pool de 0 hilos.
+     *
+     * @param count Nmero de iteraciones.
+     * @param body  Funcin a ejecutar por iteracin. Debe ser segura entre hilos.
+     */
+    void
+        parallelFor(unsigned int count, const std::function<void(unsigned int)>& body);
+
+    /**
+     * @brief Bloquea hasta que no queden tareas en cola ni en ejecucin.
+     */
+    void
+        wait();
+
+    /**
+     * @brief Nmero de hilos de trabajo (sin contar el hilo que llama).
+     */
+    unsigned int
+        size() const { return static_cast<unsigned int>(m_workers.size()); }
+
+private:
+    void
+        workerLoop();
+
+private:
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_idle;
+    unsigned int m_activeTasks = 0;
+    bool m_stopping = false;
+};
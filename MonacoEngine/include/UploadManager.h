@@ -0,0 +1,197 @@
+#pragma once
+#include "Prerequisites.h"
+#include "UploadQueue.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @brief Funcin que se llama cuando una subida llega a la GPU; recibe su ticket.
+ */
+using UploadCallback = std::function<void(unsigned int)>;
+
+/**
+ * @class UploadManager
+ * @brief Sube datos a buffers y texturas de forma asncrona, con un lmite de bytes por frame.
+ *
+ * Las peticiones copian sus datos a memoria del manager y se encolan en un @c UploadQueue.
+ * Cada update() toma como mximo @c budgetPerFrame bytes:
+ * - Buffers: se escriben en una pgina de staging (@c D3D11_USAGE_STAGING) y se copian al
+ *   destino con @c CopySubresourceRegion.
+ * - Texturas: se suben por bandas de filas con @c UpdateSubresource.
+ *
+ * Hay una pgina por frame en vuelo, reutilizada solo cuando el fence
+ * (@c D3D11_QUERY_EVENT) de su frame ya se seal; si la siguiente sigue ocupada el frame
+ * se salta en lugar de bloquear. Al completarse una subida se llama su callback y
+ * isComplete() devuelve @c true.
+ *
+ * @note Direct3D 11.0 no copia de un buffer a una textura, por eso las texturas no pasan por
+ *       las pginas de staging; igual cuentan contra el presupuesto.
+ * @warning Usar solo desde el hilo que posee el contexto inmediato.
+ */
+class
+    UploadManager {
+public:
+    UploadManager() = default;
+    ~UploadManager() = default;
+
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    /**
+     * @brief Crea las pginas de staging y los fences.
+     *
+     * @param device         Dispositivo con el que se crean los recursos.
+     * @param budgetPerFrame Bytes que se suben como mximo por frame (tamao de cada pgina).
+     * @param framesInFlight Nmero de pginas de staging.
+     * @return @c S_OK si fue exitoso; cdigo @c HRESULT en caso de error.
+     */
+    HRESULT
+        init(Device& device,
+            unsigned int budgetPerFrame = 4 * 1024 * 1024,
+            unsigned int framesInFlight = 3);
+
+    /**
+     * @brief Completa las subidas terminadas y emite las copias del frame.
+     *
+     * Llamar una vez por frame en el contexto inmediato.
+     *
+     * @param deviceContext Contexto inmediato.
+     */
+    void
+        update(DeviceContext& deviceContext);
+
+    /**
+     * @brief Mtodo de marcador; las copias se emiten en update().
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Libera las pginas, los fences y las subidas pendientes (sin llamar callbacks).
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Encola una subida a un rango de @p destination.
+     *
+     * @param destination Buffer destino (@c D3D11_USAGE_DEFAULT).
+     * @param dstOffset   Offset en bytes dentro de @p destination.
+     * @param data        Datos a subir; se copian, as que pueden liberarse al volver.
+     * @param size        Bytes a subir.
+     * @param callback    Se llama cuando la subida llega a la GPU (opcional).
+     * @return Ticket de la subida, o 0 si fall.
+     */
+    unsigned int
+        uploadBuffer(ID3D11Buffer* destination,
+            unsigned int dstOffset,
+            const void* data,
+            unsigned int size,
+            UploadCallback callback = nullptr);
+
+    /**
+     * @brief Encola una subida a la regin @p box de una textura 2D.
+     *
+     * @param destination Textura destino.
+     * @param subresource Subrecurso destino (mip / elemento del arreglo).
+     * @param box         Regin destino; @c front y @c back deben ser 0 y 1.
+     * @param data        Filas de la regin, una tras otra; se copian.
+     * @param rowPitch    Bytes por fila en @p data.
+     * @param callback    Se llama cuando la subida llega a la GPU (opcional).
+     * @return Ticket de la subida, o 0 si fall.
+     *
+     * @note Solo formatos sin compresin: cada fila de @p data es una fila de pxeles.
+     */
+    unsigned int
+        uploadTexture(ID3D11Resource* destination,
+            unsigned int subresource,
+            const D3D11_BOX& box,
+            const void* data,
+            unsigned int rowPitch,
+            UploadCallback callback = nullptr);
+
+    /**
+     * @brief Igual que la anterior, pero toma posesin de @p data en lugar de copiarlo.
+     *
+     * @p data debe contener exactamente las filas de @p box.
+     */
+    unsigned int
+        uploadTexture(ID3D11Resource* destination,
+            unsigned int subresource,
+            const D3D11_BOX& box,
+            std::vector<unsigned char>&& data,
+            unsigned int rowPitch,
+            UploadCallback callback = nullptr);
+
+    /**
+     * @brief Emite todas las subidas pendientes sin respetar el presupuesto.
+     *
+     * Espera a las pginas ocupadas; pensado para pantallas de carga o antes de reemplazar
+     * un recurso destino.
+     *
+     * @param deviceContext Contexto inmediato.
+     */
+    void
+        flush(DeviceContext& deviceContext);
+
+    /**
+     * @brief Indica si la subida @p ticket ya lleg a la GPU.
+     */
+    bool
+        isComplete(unsigned int ticket) const { return m_queue.isComplete(ticket); }
+
+    /**
+     * @brief Resumen de una lnea con los contadores de la cola.
+     */
+    std::string
+        report() const;
+
+    const UploadQueue&
+        queue() const { return m_queue; }
+
+private:
+    /**
+     * @brief Copia a una pgina los chunks del frame y emite su fence.
+     */
+    void
+        submit(DeviceContext& deviceContext);
+
+    /**
+     * @brief Lee los fences terminados y llama los callbacks de lo completado.
+     */
+    void
+        pollFences(DeviceContext& deviceContext);
+
+    /**
+     * @brief Indica si la pgina del siguiente frame sigue en uso por la GPU.
+     */
+    bool
+        nextPageBusy() const { return m_frame - m_completedFrame >= m_pages.size(); }
+
+private:
+    /**
+     * @brief Datos y destino de una subida pendiente.
+     */
+    struct Upload {
+        ID3D11Resource* destination = nullptr;
+        bool texture = false;
+        unsigned int subresource = 0;
+        unsigned int dstOffset = 0;
+        D3D11_BOX box = {};
+        unsigned int rowPitch = 0;
+        std::vector<unsigned char> data;
+        UploadCallback callback;
+    };
+
+private:
+    UploadQueue m_queue;
+    std::unordered_map<unsigned int, Upload> m_uploads;
+    std::vector<ID3D11Buffer*> m_pages;
+    std::vector<ID3D11Query*> m_fences;
+    std::vector<UploadChunk> m_chunks;
+    unsigned long long m_frame = 0;
+    unsigned long long m_completedFrame = 0;
+    // Frames que no subieron nada porque la siguiente pgina segua en uso
+    unsigned long long m_busyFrames = 0;
+};
@@ -0,0 +1,162 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @struct UploadChunk
+ * @brief Parte de una subida que cabe en el presupuesto del frame.
+ *
+ * @c offset es relativo a los datos de la peticin y @c stagingOffset es la posicin
+ * asignada dentro de la pgina de staging del frame.
+ */
+struct UploadChunk {
+    unsigned int request;
+    unsigned int offset;
+    unsigned int size;
+    unsigned int stagingOffset;
+};
+
+/**
+ * @struct UploadQueueStats
+ * @brief Contadores acumulados de un @c UploadQueue.
+ *
+ * - @c budgetFrames: frames que agotaron el presupuesto y dejaron trabajo para despus.
+ */
+struct UploadQueueStats {
+    unsigned long long requests = 0;
+    unsigned long long completed = 0;
+    unsigned long long bytes = 0;
+    unsigned long long chunks = 0;
+    unsigned long long budgetFrames = 0;
+};
+
+/**
+ * @class UploadQueue
+ * @brief Cola FIFO de subidas que reparte los bytes entre frames con un presupuesto fijo.
+ *
+ * Solo planifica tamaos y offsets: no conoce Direct3D, por lo que puede probarse en CPU.
+ * El uso por frame es:
+ * - push() al pedir una subida; devuelve su id.
+ * - schedule() para obtener los chunks del frame, como mximo @c budget bytes de staging.
+ * - endFrame(fence) despus de emitir las copias de esos chunks.
+ * - retire(completedFence) cuando la GPU confirma un fence; las peticiones cuyo ltimo chunk
+ *   pertenece a un fence terminado se reportan como completas.
+ *
+ * Una peticin grande se corta en varios frames, siempre en mltiplos de su granularidad
+ * (p. ej. el pitch de una fila de textura). Las peticiones terminan en el orden en que se
+ * pidieron.
+ */
+class
+    UploadQueue {
+public:
+    UploadQueue() = default;
+    ~UploadQueue() = default;
+
+    /**
+     * @brief Define el presupuesto por frame.
+     *
+     * @param budget    Bytes de staging por frame.
+     * @param alignment Alineacin de cada @c stagingOffset; debe ser potencia de dos.
+     * @return @c S_OK si fue exitoso; @c E_INVALIDARG si los parmetros no son vlidos.
+     */
+    HRESULT
+        init(unsigned int budget, unsigned int alignment = 16);
+
+    /**
+     * @brief Mtodo de marcador; el avance ocurre en schedule() / endFrame() / retire().
+     */
+    void
+        update() {}
+
+    /**
+     * @brief Mtodo de marcador; la cola no enva nada al pipeline.
+     */
+    void
+        render() {}
+
+    /**
+     * @brief Descarta todas las peticiones.
+     */
+    void
+        destroy();
+
+    /**
+     * @brief Encola una subida de @p size bytes.
+     *
+     * @param size        Bytes a subir; mltiplo de @p granularity.
+     * @param granularity Unidad mnima en la que se puede cortar la peticin.
+     * @return Id de la peticin (mayor que cero), o 0 si los parmetros no son vlidos.
+     */
+    unsigned int
+        push(unsigned int size, unsigned int granularity = 1);
+
+    /**
+     * @brief Toma de la cola los chunks del frame actual.
+     *
+     * Si la primera unidad pendiente es mayor que el presupuesto, se enva sola en su frame.
+     *
+     * @param chunks Salida: chunks en orden, con offsets de staging crecientes.
+     */
+    void
+        schedule(std::vector<UploadChunk>& chunks);
+
+    /**
+     * @brief Asocia con @p fence las peticiones que terminaron de planificarse.
+     */
+    void
+        endFrame(unsigned long long fence);
+
+    /**
+     * @brief Completa las peticiones cuyo fence es menor o igual a @p completedFence.
+     *
+     * @param completedFence ltimo fence sealado por la GPU.
+     * @param completed      Salida: ids completados, en orden.
+     */
+    void
+        retire(unsigned long long completedFence, std::vector<unsigned int>& completed);
+
+    /**
+     * @brief Indica si la peticin @p id ya lleg a la GPU.
+     */
+    bool
+        isComplete(unsigned int id) const { return id != 0 && id <= m_lastCompleted; }
+
+    /**
+     * @brief Bytes encolados que todava no se planifican.
+     */
+    unsigned long long
+        pendingBytes() const { return m_pendingBytes; }
+
+    /**
+     * @brief Peticiones que an no se completan (planificadas o no).
+     */
+    unsigned int
+        pendingRequests() const { return static_cast<unsigned int>(m_requests.size()); }
+
+    unsigned int
+        budget() const { return m_budget; }
+
+public:
+    /**
+     * @brief Contadores de peticiones, bytes y chunks desde init().
+     */
+    UploadQueueStats m_stats;
+
+private:
+    struct Request {
+        unsigned int id;
+        unsigned int size;
+        unsigned int granularity;
+        unsigned int scheduled;
+        unsigned long long fence;
+    };
+
+private:
+    unsigned int m_budget = 0;
+    unsigned int m_alignment = 0;
+    unsigned int m_nextId = 1;
+    unsigned int m_lastCompleted = 0;
+    unsigned long long m_pendingBytes = 0;
+    // Las primeras m_scheduledCount peticiones ya estn planificadas por completo
+    size_t m_scheduledCount = 0;
+    std::deque<Request> m_requests;
+};
@@ -0,0 +1,841 @@
+#include "BlockCompressor.h"
+#include "DDSLoader.h"
+#include "ThreadPool.h"
+
+// Bloque de 4x4 por canales (R, G, B, A): cuatro pxeles por registro SSE
+struct ColorBlock {
+	float channels[4][16];
+};
+
+// Hasta 16 colores candidatos, por canales
+struct Palette {
+	float channels[4][16];
+	unsigned int count = 0;
+};
+
+static const unsigned int kMaskRGB = 0x7;
+static const unsigned int kMaskRGBA = 0xF;
+// Pesos de interpolacin de BC7 con ndices de 4 bits, sobre 64
+static const unsigned int kBC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static float
+clampUnorm(float value) {
+	return (std::max)(0.0f, (std::min)(value, 255.0f));
+}
+
+static void
+forEachRow(ThreadPool* threadPool, unsigned int rows, const std::function<void(unsigned int)>& body) {
+	if (threadPool && rows > 1) {
+		threadPool->parallelFor(rows, body);
+		return;
+	}
+	for (unsigned int y = 0; y < rows; ++y) {
+		body(y);
+	}
+}
+
+static void
+loadBlock(const unsigned char* pixels,
+	unsigned int width,
+	unsigned int height,
+	unsigned int rowPitch,
+	unsigned int blockX,
+	unsigned int blockY,
+	ColorBlock& block) {
+	for (unsigned int y = 0; y < 4; ++y) {
+		unsigned int sourceY = (std::min)(blockY * 4 + y, height - 1);
+		for (unsigned int x = 0; x < 4; ++x) {
+			unsigned int sourceX = (std::min)(blockX * 4 + x, width - 1);
+			const unsigned char* pixel = pixels + static_cast<size_t>(sourceY) * rowPitch + sourceX * 4;
+			for (unsigned int c = 0; c < 4; ++c) {
+				block.channels[c][y * 4 + x] = pixel[c];
+			}
+		}
+	}
+}
+
+// ndice del color de @p palette ms cercano a cada pxel, comparando solo los canales de
+// @p mask; devuelve el error cuadrtico total
+static float
+selectIndices(const ColorBlock& block, const Palette& palette, unsigned int mask, unsigned int* indices) {
+	float total = 0.0f;
+	for (unsigned int group = 0; group < 16; group += 4) {
+		__m128 pixel[4];
+		for (unsigned int c = 0; c < 4; ++c) {
+			pixel[c] = _mm_loadu_ps(&block.channels[c][group]);
+		}
+		__m128 best = _mm_set1_ps(1e30f);
+		__m128 bestIndex = _mm_setzero_ps();
+		for (unsigned int i = 0; i < palette.count; ++i) {
+			__m128 error = _mm_setzero_ps();
+			for (unsigned int c = 0; c < 4; ++c) {
+				if (mask & (1u << c)) {
+					__m128 difference = _mm_sub_ps(pixel[c], _mm_set1_ps(palette.channels[c][i]));
+					error = _mm_add_ps(error, _mm_mul_ps(difference, difference));
+				}
+			}
+			__m128 closer = _mm_cmplt_ps(error, best);
+			best = _mm_min_ps(error, best);
+			bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps(static_cast<float>(i))), _mm_andnot_ps(closer, bestIndex));
+		}
+		float errors[4];
+		float groupIndices[4];
+		_mm_storeu_ps(errors, best);
+		_mm_storeu_ps(groupIndices, bestIndex);
+		for (unsigned int k = 0; k < 4; ++k) {
+			indices[group + k] = static_cast<unsigned int>(groupIndices[k]);
+			total += errors[k];
+		}
+	}
+	return total;
+}
+
+// Extremos que minimizan el error para los pesos @p weights (0 = primero, 1 = segundo)
+static bool
+fitEndpoints(const ColorBlock& block, const float* weights, unsigned int mask, float* first, float* second) {
+	float a = 0.0f, b = 0.0f, c = 0.0f;
+	float x0[4] = {}, x1[4] = {};
+	for (unsigned int i = 0; i < 16; ++i) {
+		float t = weights[i];
+		float s = 1.0f - t;
+		a += s * s;
+		b += s * t;
+		c += t * t;
+		for (unsigned int channel = 0; channel < 4; ++channel) {
+			x0[channel] += s * block.channels[channel][i];
+			x1[channel] += t * block.channels[channel][i];
+		}
+	}
+	float determinant = a * c - b * b;
+	if (fabsf(determinant) < 1e-6f) {
+		// Todos los pxeles usan el mismo ndice: no hay un par nico
+		return false;
+	}
+	for (unsigned int channel = 0; channel < 4; ++channel) {
+		if (mask & (1u << channel)) {
+			first[channel] = clampUnorm((c * x0[channel] - b * x1[channel]) / determinant);
+			second[channel] = clampUnorm((a * x1[channel] - b * x0[channel]) / determinant);
+		}
+	}
+	return true;
+}
+
+// Extremos sobre el eje principal de los canales de @p mask (iteracin de potencias)
+static void
+principalEndpoints(const ColorBlock& block, unsigned int mask, unsigned int iterations, float* first, float* second) {
+	float mean[4] = {};
+	float low[4], high[4];
+	for (unsigned int c = 0; c < 4; ++c) {
+		low[c] = high[c] = block.channels[c][0];
+		for (unsigned int i = 0; i < 16; ++i) {
+			mean[c] += block.channels[c][i];
+			low[c] = (std::min)(low[c], block.channels[c][i]);
+			high[c] = (std::max)(high[c], block.channels[c][i]);
+		}
+		mean[c] /= 16.0f;
+	}
+	float covariance[4][4] = {};
+	for (unsigned int i = 0; i < 16; ++i) {
+		for (unsigned int r = 0; r < 4; ++r) {
+			for (unsigned int c = 0; c < 4; ++c) {
+				covariance[r][c] += (block.channels[r][i] - mean[r]) * (block.channels[c][i] - mean[c]);
+			}
+		}
+	}
+	float axis[4];
+	for (unsigned int c = 0; c < 4; ++c) {
+		axis[c] = (mask & (1u << c)) ? high[c] - low[c] + 1e-3f : 0.0f;
+	}
+	for (unsigned int iteration = 0; iteration < iterations; ++iteration) {
+		float next[4] = {};
+		float length = 0.0f;
+		for (unsigned int r = 0; r < 4; ++r) {
+			if (mask & (1u << r)) {
+				for (unsigned int c = 0; c < 4; ++c) {
+					next[r] += (mask & (1u << c)) ? covariance[r][c] * axis[c] : 0.0f;
+				}
+				length = (std::max)(length, fabsf(next[r]));
+			}
+		}
+		if (length < 1e-6f) {
+			break;
+		}
+		for (unsigned int c = 0; c < 4; ++c) {
+			axis[c] = next[c] / length;
+		}
+	}
+	float axisLength = 0.0f;
+	for (unsigned int c = 0; c < 4; ++c) {
+		axisLength += axis[c] * axis[c];
+	}
+	float minimum = 0.0f, maximum = 0.0f;
+	if (axisLength > 0.0f) {
+		minimum = 1e30f;
+		maximum = -1e30f;
+		for (unsigned int i = 0; i < 16; ++i) {
+			float t = 0.0f;
+			for (unsigned int c = 0; c < 4; ++c) {
+				t += (block.channels[c][i] - mean[c]) * axis[c];
+			}
+			minimum = (std::min)(minimum, t / axisLength);
+			maximum = (std::max)(maximum, t / axisLength);
+		}
+	}
+	for (unsigned int c = 0; c < 4; ++c) {
+		first[c] = (mask & (1u << c)) ? clampUnorm(mean[c] + axis[c] * minimum) : mean[c];
+		second[c] = (mask & (1u << c)) ? clampUnorm(mean[c] + axis[c] * maximum) : mean[c];
+	}
+}
+
+static unsigned short
+to565(const float* color) {
+	unsigned int r = static_cast<unsigned int>(clampUnorm(color[0]) * 31.0f / 255.0f + 0.5f);
+	unsigned int g = static_cast<unsigned int>(clampUnorm(color[1]) * 63.0f / 255.0f + 0.5f);
+	unsigned int b = static_cast<unsigned int>(clampUnorm(color[2]) * 31.0f / 255.0f + 0.5f);
+	return static_cast<unsigned short>((r << 11) | (g << 5) | b);
+}
+
+static void
+from565(unsigned short value, unsigned int* color) {
+	unsigned int r = value >> 11;
+	unsigned int g = (value >> 5) & 0x3F;
+	unsigned int b = value & 0x1F;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+// Paleta de BC1 de 4 colores; en el modo de 3 (color0 <= color1) el ltimo es negro transparente
+static void
+bc1Colors(unsigned short color0, unsigned short color1, bool fourColors, unsigned int colors[4][4]) {
+	from565(color0, colors[0]);
+	from565(color1, colors[1]);
+	colors[0][3] = colors[1][3] = 255;
+	for (unsigned int c = 0; c < 3; ++c) {
+		if (fourColors) {
+			colors[2][c] = (2 * colors[0][c] + colors[1][c] + 1) / 3;
+			colors[3][c] = (colors[0][c] + 2 * colors[1][c] + 1) / 3;
+		}
+		else {
+			colors[2][c] = (colors[0][c] + colors[1][c] + 1) / 2;
+			colors[3][c] = 0;
+		}
+	}
+	colors[2][3] = 255;
+	colors[3][3] = fourColors ? 255 : 0;
+}
+
+static float
+evaluateBC1(const ColorBlock& block, unsigned short color0, unsigned short color1, unsigned int* indices) {
+	unsigned int colors[4][4];
+	bc1Colors(color0, color1, true, colors);
+	Palette palette;
+	palette.count = 4;
+	for (unsigned int i = 0; i < 4; ++i) {
+		for (unsigned int c = 0; c < 4; ++c) {
+			palette.channels[c][i] = static_cast<float>(colors[i][c]);
+		}
+	}
+	return selectIndices(block, palette, kMaskRGB, indices);
+}
+
+// Caja envolvente RGB con un pequeo margen; la diagonal sigue el signo de la covarianza
+static void
+boundingBoxEndpoints(const ColorBlock& block, float* first, float* second) {
+	float low[3], high[3], mean[3] = {};
+	for (unsigned int c = 0; c < 3; ++c) {
+		low[c] = high[c] = block.channels[c][0];
+		for (unsigned int i = 0; i < 16; ++i) {
+			low[c] = (std::min)(low[c], block.channels[c][i]);
+			high[c] = (std::max)(high[c], block.channels[c][i]);
+			mean[c] += block.channels[c][i] / 16.0f;
+		}
+		float inset = (high[c] - low[c]) / 16.0f;
+		low[c] += inset;
+		high[c] -= inset;
+	}
+	for (unsigned int c = 1; c < 3; ++c) {
+		float covariance = 0.0f;
+		for (unsigned int i = 0; i < 16; ++i) {
+			covariance += (block.channels[0][i] - mean[0]) * (block.channels[c][i] - mean[c]);
+		}
+		if (covariance < 0.0f) {
+			std::swap(low[c], high[c]);
+		}
+	}
+	for (unsigned int c = 0; c < 3; ++c) {
+		first[c] = low[c];
+		second[c] = high[c];
+	}
+}
+
+static void
+encodeBC1(const ColorBlock& block, BlockCompressionQuality quality, unsigned char* out) {
+	float first[4], second[4];
+	if (quality == BlockCompressionQuality::Fast) {
+		boundingBoxEndpoints(block, first, second);
+	}
+	else {
+		principalEndpoints(block, kMaskRGB, 8, first, second);
+	}
+
+	unsigned short color0 = to565(first);
+	unsigned short color1 = to565(second);
+	unsigned int indices[16];
+	float error = evaluateBC1(block, color0, color1, indices);
+	if (quality == BlockCompressionQuality::High) {
+		// El eje principal falla con bloques de pocos colores muy separados; se prueba tambin la caja
+		float boxFirst[4], boxSecond[4];
+		boundingBoxEndpoints(block, boxFirst, boxSecond);
+		unsigned int boxIndices[16];
+		float boxError = evaluateBC1(block, to565(boxFirst), to565(boxSecond), boxIndices);
+		if (boxError < error) {
+			color0 = to565(boxFirst);
+			color1 = to565(boxSecond);
+			error = boxError;
+			memcpy(indices, boxIndices, sizeof(indices));
+		}
+	}
+
+	// ndices 0..3 -> posicin entre los extremos
+	static const float kWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	unsigned int refinements = quality == BlockCompressionQuality::Fast ? 0 : quality == BlockCompressionQuality::Balanced ? 1 : 3;
+	for (unsigned int iteration = 0; iteration < refinements && error > 0.0f; ++iteration) {
+		float weights[16];
+		for (unsigned int i = 0; i < 16; ++i) {
+			weights[i] = kWeights[indices[i]];
+		}
+		if (!fitEndpoints(block, weights, kMaskRGB, first, second)) {
+			break;
+		}
+		unsigned short candidate0 = to565(first);
+		unsigned short candidate1 = to565(second);
+		unsigned int candidateIndices[16];
+		float candidateError = evaluateBC1(block, candidate0, candidate1, candidateIndices);
+		if (candidateError >= error) {
+			break;
+		}
+		color0 = candidate0;
+		color1 = candidate1;
+		error = candidateError;
+		memcpy(indices, candidateIndices, sizeof(indices));
+	}
+
+	// color0 > color1 selecciona el modo de 4 colores; al intercambiarlos, 0<->1 y 2<->3
+	if (color0 < color1) {
+		std::swap(color0, color1);
+		for (unsigned int& index : indices) {
+			index ^= 1;
+		}
+	}
+	else if (color0 == color1) {
+		memset(indices, 0, sizeof(indices));
+	}
+	unsigned int bits = 0;
+	for (unsigned int i = 0; i < 16; ++i) {
+		bits |= indices[i] << (i * 2);
+	}
+	out[0] = static_cast<unsigned char>(color0 & 0xFF);
+	out[1] = static_cast<unsigned char>(color0 >> 8);
+	out[2] = static_cast<unsigned char>(color1 & 0xFF);
+	out[3] = static_cast<unsigned char>(color1 >> 8);
+	memcpy(out + 4, &bits, sizeof(bits));
+}
+
+// Paleta de BC4: 8 valores interpolados si e0 > e1; si no, 6 ms 0 y 255
+static void
+bc4Values(unsigned int e0, unsigned int e1, unsigned int values[8]) {
+	values[0] = e0;
+	values[1] = e1;
+	if (e0 > e1) {
+		for (unsigned int k = 1; k < 7; ++k) {
+			values[k + 1] = ((7 - k) * e0 + k * e1 + 3) / 7;
+		}
+	}
+	else {
+		for (unsigned int k = 1; k < 5; ++k) {
+			values[k + 1] = ((5 - k) * e0 + k * e1 + 2) / 5;
+		}
+		values[6] = 0;
+		values[7] = 255;
+	}
+}
+
+static float
+evaluateBC4(const ColorBlock& block, unsigned int channel, unsigned int e0, unsigned int e1, unsigned int* indices) {
+	unsigned int values[8];
+	bc4Values(e0, e1, values);
+	Palette palette;
+	palette.count = 8;
+	for (unsigned int i = 0; i < 8; ++i) {
+		palette.channels[channel][i] = static_cast<float>(values[i]);
+	}
+	return selectIndices(block, palette, 1u << channel, indices);
+}
+
+static void
+encodeBC4(const ColorBlock& block, unsigned int channel, BlockCompressionQuality quality, unsigned char* out) {
+	const float* values = block.channels[channel];
+	unsigned int low = 255, high = 0;
+	// Extremos sin contar 0 y 255, que el modo de 6 valores ya representa exactos
+	unsigned int innerLow = 255, innerHigh = 0;
+	for (unsigned int i = 0; i < 16; ++i) {
+		unsigned int value = static_cast<unsigned int>(values[i]);
+		low = (std::min)(low, value);
+		high = (std::max)(high, value);
+		if (value != 0 && value != 255) {
+			innerLow = (std::min)(innerLow, value);
+			innerHigh = (std::max)(innerHigh, value);
+		}
+	}
+
+	unsigned int e0 = high, e1 = low;
+	unsigned int indices[16];
+	float error = evaluateBC4(block, channel, e0, e1, indices);
+	if (quality == BlockCompressionQuality::High && error > 0.0f) {
+		// Extremos un poco hacia adentro o afuera y el modo de 6 valores
+		unsigned int candidates[10][2];
+		unsigned int candidateCount = 0;
+		for (int d0 = -1; d0 <= 1; ++d0) {
+			for (int d1 = -1; d1 <= 1; ++d1) {
+				int candidate0 = static_cast<int>(high) + d0;
+				int candidate1 = static_cast<int>(low) + d1;
+				if (candidate0 > candidate1 && candidate0 <= 255 && candidate1 >= 0) {
+					candidates[candidateCount][0] = static_cast<unsigned int>(candidate0);
+					candidates[candidateCount][1] = static_cast<unsigned int>(candidate1);
+					++candidateCount;
+				}
+			}
+		}
+		if (innerLow <= innerHigh) {
+			candidates[candidateCount][0] = innerLow;
+			candidates[candidateCount][1] = innerHigh;
+			++candidateCount;
+		}
+		for (unsigned int i = 0; i < candidateCount; ++i) {
+			unsigned int candidateIndices[16];
+			float candidateError = evaluateBC4(block, channel, candidates[i][0], candidates[i][1], candidateIndices);
+			if (candidateError < error) {
+				error = candidateError;
+				e0 = candidates[i][0];
+				e1 = candidates[i][1];
+				memcpy(indices, candidateIndices, sizeof(indices));
+			}
+		}
+	}
+
+	unsigned long long bits = 0;
+	for (unsigned int i = 0; i < 16; ++i) {
+		bits |= static_cast<unsigned long long>(indices[i]) << (i * 3);
+	}
+	out[0] = static_cast<unsigned char>(e0);
+	out[1] = static_cast<unsigned char>(e1);
+	for (unsigned int i = 0; i < 6; ++i) {
+		out[2 + i] = static_cast<unsigned char>(bits >> (i * 8));
+	}
+}
+
+static void
+writeBits(unsigned char* out, unsigned int& position, unsigned int value, unsigned int count) {
+	for (unsigned int i = 0; i < count; ++i, ++position) {
+		if (value & (1u << i)) {
+			out[position / 8] |= static_cast<unsigned char>(1u << (position % 8));
+		}
+	}
+}
+
+static unsigned int
+readBits(const unsigned char* data, unsigned int& position, unsigned int count) {
+	unsigned int value = 0;
+	for (unsigned int i = 0; i < count; ++i, ++position) {
+		value |= ((data[position / 8] >> (position % 8)) & 1u) << i;
+	}
+	return value;
+}
+
+// Extremo de BC7 modo 6: 7 bits por canal ms un bit p compartido
+struct BC7Endpoint {
+	unsigned int channels[4];
+	unsigned int pbit;
+};
+
+static BC7Endpoint
+quantizeBC7(const float* color, unsigned int pbit) {
+	BC7Endpoint endpoint;
+	endpoint.pbit = pbit;
+	for (unsigned int c = 0; c < 4; ++c) {
+		int quantized = static_cast<int>(floorf((clampUnorm(color[c]) - pbit) * 0.5f + 0.5f));
+		endpoint.channels[c] = static_cast<unsigned int>((std::max)(0, (std::min)(quantized, 127)));
+	}
+	return endpoint;
+}
+
+// Bit p que deja el extremo cuantizado ms cerca de @p color
+static BC7Endpoint
+quantizeBC7BestPBit(const float* color) {
+	BC7Endpoint best = quantizeBC7(color, 0);
+	float bestError = 1e30f;
+	for (unsigned int pbit = 0; pbit < 2; ++pbit) {
+		BC7Endpoint endpoint = quantizeBC7(color, pbit);
+		float error = 0.0f;
+		for (unsigned int c = 0; c < 4; ++c) {
+			float difference = static_cast<float>((endpoint.channels[c] << 1) | pbit) - color[c];
+			error += difference * difference;
+		}
+		if (error < bestError) {
+			bestError = error;
+			best = endpoint;
+		}
+	}
+	return best;
+}
+
+static void
+bc7Colors(const BC7Endpoint& e0, const BC7Endpoint& e1, unsigned int colors[16][4]) {
+	for (unsigned int c = 0; c < 4; ++c) {
+		unsigned int v0 = (e0.channels[c] << 1) | e0.pbit;
+		unsigned int v1 = (e1.channels[c] << 1) | e1.pbit;
+		for (unsigned int i = 0; i < 16; ++i) {
+			colors[i][c] = ((64 - kBC7Weights[i]) * v0 + kBC7Weights[i] * v1 + 32) >> 6;
+		}
+	}
+}
+
+static float
+evaluateBC7(const ColorBlock& block, const BC7Endpoint& e0, const BC7Endpoint& e1, unsigned int* indices) {
+	unsigned int colors[16][4];
+	bc7Colors(e0, e1, colors);
+	Palette palette;
+	palette.count = 16;
+	for (unsigned int i = 0; i < 16; ++i) {
+		for (unsigned int c = 0; c < 4; ++c) {
+			palette.channels[c][i] = static_cast<float>(colors[i][c]);
+		}
+	}
+	return selectIndices(block, palette, kMaskRGBA, indices);
+}
+
+// Cuantiza el par de extremos; @p searchPBits prueba las cuatro combinaciones de bits p
+static float
+quantizeBC7Pair(const ColorBlock& block,
+	const float* first,
+	const float* second,
+	bool searchPBits,
+	BC7Endpoint& e0,
+	BC7Endpoint& e1,
+	unsigned int* indices) {
+	if (!searchPBits) {
+		e0 = quantizeBC7BestPBit(first);
+		e1 = quantizeBC7BestPBit(second);
+		return evaluateBC7(block, e0, e1, indices);
+	}
+	float bestError = 1e30f;
+	for (unsigned int p = 0; p < 4; ++p) {
+		BC7Endpoint candidate0 = quantizeBC7(first, p & 1);
+		BC7Endpoint candidate1 = quantizeBC7(second, p >> 1);
+		unsigned int candidateIndices[16];
+		float error = evaluateBC7(block, candidate0, candidate1, candidateIndices);
+		if (error < bestError) {
+			bestError = error;
+			e0 = candidate0;
+			e1 = candidate1;
+			memcpy(indices, candidateIndices, sizeof(unsigned int) * 16);
+		}
+	}
+	return bestError;
+}
+
+static void
+encodeBC7(const ColorBlock& block, BlockCompressionQuality quality, unsigned char* out) {
+	float first[4], second[4];
+	principalEndpoints(block, kMaskRGBA, quality == BlockCompressionQuality::Fast ? 3 : 8, first, second);
+
+	bool searchPBits = quality == BlockCompressionQuality::High;
+	BC7Endpoint e0, e1;
+	unsigned int indices[16];
+	float error = quantizeBC7Pair(block, first, second, searchPBits, e0, e1, indices);
+
+	unsigned int refinements = quality == BlockCompressionQuality::Fast ? 0 : quality == BlockCompressionQuality::Balanced ? 1 : 3;
+	for (unsigned int iteration = 0; iteration < refinements && error > 0.0f; ++iteration) {
+		float weights[16];
+		for (unsigned int i = 0; i < 16; ++i) {
+			weights[i] = kBC7Weights[indices[i]] / 64.0f;
+		}
+		if (!fitEndpoints(block, weights, kMaskRGBA, first, second)) {
+			break;
+		}
+		BC7Endpoint candidate0, candidate1;
+		unsigned int candidateIndices[16];
+		float candidateError = quantizeBC7Pair(block, first, second, searchPBits, candidate0, candidate1, candidateIndices);
+		if (candidateError >= error) {
+			break;
+		}
+		error = candidateError;
+		e0 = candidate0;
+		e1 = candidate1;
+		memcpy(indices, candidateIndices, sizeof(indices));
+	}
+
+	// El ndice del pxel 0 se guarda con 3 bits: su bit alto debe ser 0
+	if (indices[0] >= 8) {
+		std::swap(e0, e1);
+		for (unsigned int& index : indices) {
+			index = 15 - index;
+		}
+	}
+
+	memset(out, 0, 16);
+	unsigned int position = 0;
+	writeBits(out, position, 1u << 6, 7);
+	for (unsigned int c = 0; c < 4; ++c) {
+		writeBits(out, position, e0.channels[c], 7);
+		writeBits(out, position, e1.channels[c], 7);
+	}
+	writeBits(out, position, e0.pbit, 1);
+	writeBits(out, position, e1.pbit, 1);
+	for (unsigned int i = 0; i < 16; ++i) {
+		writeBits(out, position, indices[i], i == 0 ? 3 : 4);
+	}
+}
+
+static void
+encodeBlock(const ColorBlock& block, DXGI_FORMAT format, BlockCompressionQuality quality, unsigned char* out) {
+	switch (format) {
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		encodeBC1(block, quality, out);
+		break;
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+		encodeBC4(block, 3, quality, out);
+		encodeBC1(block, quality, out + 8);
+		break;
+	case DXGI_FORMAT_BC5_UNORM:
+		encodeBC4(block, 0, quality, out);
+		encodeBC4(block, 1, quality, out + 8);
+		break;
+	default:
+		encodeBC7(block, quality, out);
+		break;
+	}
+}
+
+static void
+decodeBC1(const unsigned char* data, bool alwaysFourColors, unsigned char pixels[16][4]) {
+	unsigned short color0 = static_cast<unsigned short>(data[0] | (data[1] << 8));
+	unsigned short color1 = static_cast<unsigned short>(data[2] | (data[3] << 8));
+	unsigned int colors[4][4];
+	bc1Colors(color0, color1, alwaysFourColors || color0 > color1, colors);
+	unsigned int bits;
+	memcpy(&bits, data + 4, sizeof(bits));
+	for (unsigned int i = 0; i < 16; ++i) {
+		unsigned int index = (bits >> (i * 2)) & 3;
+		for (unsigned int c = 0; c < 4; ++c) {
+			pixels[i][c] = static_cast<unsigned char>(colors[index][c]);
+		}
+	}
+}
+
+static void
+decodeBC4(const unsigned char* data, unsigned int channel, unsigned char pixels[16][4]) {
+	unsigned int values[8];
+	bc4Values(data[0], data[1], values);
+	unsigned long long bits = 0;
+	for (unsigned int i = 0; i < 6; ++i) {
+		bits |= static_cast<unsigned long long>(data[2 + i]) << (i * 8);
+	}
+	for (unsigned int i = 0; i < 16; ++i) {
+		pixels[i][channel] = static_cast<unsigned char>(values[(bits >> (i * 3)) & 7]);
+	}
+}
+
+// Alfa explcito de BC2: 4 bits por pxel, en orden de fila
+static void
+decodeBC2Alpha(const unsigned char* data, unsigned char pixels[16][4]) {
+	for (unsigned int i = 0; i < 16; ++i) {
+		unsigned int alpha = (data[i / 2] >> ((i % 2) * 4)) & 0xF;
+		pixels[i][3] = static_cast<unsigned char>(alpha * 17);
+	}
+}
+
+static bool
+decodeBC7(const unsigned char* data, unsigned char pixels[16][4]) {
+	unsigned int position = 0;
+	if (readBits(data, position, 7) != (1u << 6)) {
+		return false;
+	}
+	BC7Endpoint e0, e1;
+	for (unsigned int c = 0; c < 4; ++c) {
+		e0.channels[c] = readBits(data, position, 7);
+		e1.channels[c] = readBits(data, position, 7);
+	}
+	e0.pbit = readBits(data, position, 1);
+	e1.pbit = readBits(data, position, 1);
+	unsigned int colors[16][4];
+	bc7Colors(e0, e1, colors);
+	for (unsigned int i = 0; i < 16; ++i) {
+		unsigned int index = readBits(data, position, i == 0 ? 3 : 4);
+		for (unsigned int c = 0; c < 4; ++c) {
+			pixels[i][c] = static_cast<unsigned char>(colors[index][c]);
+		}
+	}
+	return true;
+}
+
+bool
+BlockCompressor::supportsFormat(DXGI_FORMAT format) {
+	return blockBytes(format) != 0;
+}
+
+unsigned int
+BlockCompressor::blockBytes(DXGI_FORMAT format) {
+	switch (format) {
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		return 8;
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+HRESULT
+BlockCompressor::compress(const unsigned char* pixels,
+	unsigned int width,
+	unsigned int height,
+	unsigned int rowPitch,
+	DXGI_FORMAT format,
+	BlockCompressionQuality quality,
+	std::vector<unsigned char>& blocks,
+	ThreadPool* threadPool) {
+	unsigned int bytes = blockBytes(format);
+	if (bytes == 0) {
+		ERROR("BlockCompressor", "compress", "Unsupported block compression format");
+		return E_INVALIDARG;
+	}
+	if (!pixels || width == 0 || height == 0 || rowPitch < width * 4) {
+		ERROR("BlockCompressor", "compress", "Invalid image");
+		return E_INVALIDARG;
+	}
+	unsigned int blocksWide = (width + 3) / 4;
+	unsigned int blocksHigh = (height + 3) / 4;
+	blocks.assign(static_cast<size_t>(blocksWide) * blocksHigh * bytes, 0);
+	forEachRow(threadPool, blocksHigh, [&](unsigned int blockY) {
+		ColorBlock block;
+		for (unsigned int blockX = 0; blockX < blocksWide; ++blockX) {
+			loadBlock(pixels, width, height, rowPitch, blockX, blockY, block);
+			encodeBlock(block, format, quality, &blocks[(static_cast<size_t>(blockY) * blocksWide + blockX) * bytes]);
+		}
+	});
+	return S_OK;
+}
+
+HRESULT
+BlockCompressor::decompress(const unsigned char* blocks,
+	unsigned int width,
+	unsigned int height,
+	DXGI_FORMAT format,
+	std::vector<unsigned char>& pixels) {
+	// BC2 solo se descomprime (DDS de otras herramientas); compress() no lo genera
+	bool bc2 = format == DXGI_FORMAT_BC2_UNORM || format == DXGI_FORMAT_BC2_UNORM_SRGB;
+	unsigned int bytes = bc2 ? 16 : blockBytes(format);
+	if (bytes == 0 || !blocks) {
+		ERROR("BlockCompressor", "decompress", "Unsupported block compression format");
+		return E_INVALIDARG;
+	}
+	unsigned int blocksWide = (width + 3) / 4;
+	unsigned int blocksHigh = (height + 3) / 4;
+	pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+	for (unsigned int blockY = 0; blockY < blocksHigh; ++blockY) {
+		for (unsigned int blockX = 0; blockX < blocksWide; ++blockX) {
+			const unsigned char* data = blocks + (static_cast<size_t>(blockY) * blocksWide + blockX) * bytes;
+			unsigned char block[16][4] = {};
+			switch (format) {
+			case DXGI_FORMAT_BC1_UNORM:
+			case DXGI_FORMAT_BC1_UNORM_SRGB:
+				decodeBC1(data, false, block);
+				break;
+			case DXGI_FORMAT_BC2_UNORM:
+			case DXGI_FORMAT_BC2_UNORM_SRGB:
+				decodeBC1(data + 8, true, block);
+				decodeBC2Alpha(data, block);
+				break;
+			case DXGI_FORMAT_BC3_UNORM:
+			case DXGI_FORMAT_BC3_UNORM_SRGB:
+				decodeBC1(data + 8, true, block);
+				decodeBC4(data, 3, block);
+				break;
+			case DXGI_FORMAT_BC5_UNORM:
+				decodeBC4(data, 0, block);
+				decodeBC4(data + 8, 1, block);
+				for (unsigned int i = 0; i < 16; ++i) {
+					block[i][3] = 255;
+				}
+				break;
+			default:
+				if (!decodeBC7(data, block)) {
+					ERROR("BlockCompressor", "decompress", "Only BC7 mode 6 blocks can be decoded");
+					return E_NOTIMPL;
+				}
+				break;
+			}
+			for (unsigned int y = 0; y < 4 && blockY * 4 + y < height; ++y) {
+				for (unsigned int x = 0; x < 4 && blockX * 4 + x < width; ++x) {
+					size_t offset = (static_cast<size_t>(blockY * 4 + y) * width + blockX * 4 + x) * 4;
+					memcpy(&pixels[offset], block[y * 4 + x], 4);
+				}
+			}
+		}
+	}
+	return S_OK;
+}
+
+HRESULT
+BlockCompressor::compressToDDS(const std::string& fileName,
+	const unsigned char* pixels,
+	unsigned int width,
+	unsigned int height,
+	unsigned int rowPitch,
+	const std::vector<MipLevel>& mips,
+	DXGI_FORMAT format,
+	BlockCompressionQuality quality,
+	ThreadPool* threadPool) {
+	if (width % 4 != 0 || height % 4 != 0) {
+		ERROR("BlockCompressor", "compressToDDS",
+			("Block compressed textures must be a multiple of 4 in size: " + fileName).c_str());
+		return E_INVALIDARG;
+	}
+	std::vector<std::vector<unsigned char>> levels(1 + mips.size());
+	HRESULT hr = compress(pixels, width, height, rowPitch, format, quality, levels[0], threadPool);
+	for (size_t level = 1; level < levels.size() && SUCCEEDED(hr); ++level) {
+		const MipLevel& mip = mips[level - 1];
+		if (mip.width != (std::max)(1u, width >> level) || mip.height != (std::max)(1u, height >> level)) {
+			ERROR("BlockCompressor", "compressToDDS", ("Mip chain does not match the image: " + fileName).c_str());
+			return E_INVALIDARG;
+		}
+		hr = compress(mip.pixels.data(), mip.width, mip.height, mip.rowPitch, format, quality, levels[level], threadPool);
+	}
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	DDSImage image;
+	image.dimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+	image.format = format;
+	image.width = width;
+	image.height = height;
+	image.mipLevels = static_cast<unsigned int>(levels.size());
+	for (size_t level = 0; level < levels.size(); ++level) {
+		DDSSubresource subresource;
+		subresource.data = levels[level].data();
+		subresource.rowPitch = (std::max)(1u, ((width >> level) + 3) / 4) * blockBytes(format);
+		subresource.slicePitch = static_cast<unsigned int>(levels[level].size());
+		image.subresources.push_back(subresource);
+	}
+	return DDSLoader::save(fileName, image);
+}
@@ -0,0 +1,190 @@
+#include "BuddyAllocator.h"
+
+HRESULT
+BuddyAllocator::init(unsigned int capacity, unsigned int minBlockSize) {
+	if (minBlockSize == 0 || (minBlockSize & (minBlockSize - 1)) != 0) {
+		ERROR("BuddyAllocator", "init", "minBlockSize must be a power of two");
+		return E_INVALIDARG;
+	}
+	if (capacity < minBlockSize || (capacity & (capacity - 1)) != 0) {
+		ERROR("BuddyAllocator", "init", "capacity must be a power of two not smaller than minBlockSize");
+		return E_INVALIDARG;
+	}
+
+	m_capacity = capacity;
+	m_minBlockSize = minBlockSize;
+	m_usedSize = 0;
+	unsigned int blocks = capacity / minBlockSize;
+	m_maxOrder = 0;
+	while ((1u << m_maxOrder) < blocks) {
+		m_maxOrder++;
+	}
+
+	m_state.assign(blocks, kNoBlock);
+	m_next.assign(blocks, kNone);
+	m_prev.assign(blocks, kNone);
+	m_freeHeads.assign(m_maxOrder + 1, kNone);
+	pushFree(0, m_maxOrder);
+	return S_OK;
+}
+
+void
+BuddyAllocator::destroy() {
+	m_state = std::vector<unsigned char>();
+	m_next = std::vector<unsigned int>();
+	m_prev = std::vector<unsigned int>();
+	m_freeHeads = std::vector<unsigned int>();
+	m_capacity = 0;
+	m_minBlockSize = 0;
+	m_maxOrder = 0;
+	m_usedSize = 0;
+}
+
+bool
+BuddyAllocator::allocate(unsigned int size, unsigned int& offset) {
+	if (size == 0 || size > m_capacity) {
+		return false;
+	}
+	unsigned int blocks = (size + m_minBlockSize - 1) / m_minBlockSize;
+	unsigned int order = 0;
+	while ((1u << order) < blocks) {
+		order++;
+	}
+
+	// Menor orden con un bloque libre
+	unsigned int found = order;
+	while (found <= m_maxOrder && m_freeHeads[found] == kNone) {
+		found++;
+	}
+	if (found > m_maxOrder) {
+		return false;
+	}
+
+	unsigned int block = m_freeHeads[found];
+	removeFree(block, found);
+	// Partir hasta el orden pedido; la mitad superior queda libre en cada nivel
+	while (found > order) {
+		found--;
+		pushFree(block + (1u << found), found);
+	}
+
+	m_state[block] = static_cast<unsigned char>(order | kAllocated);
+	m_usedSize += (1u << order) * m_minBlockSize;
+	offset = block * m_minBlockSize;
+	return true;
+}
+
+void
+BuddyAllocator::free(unsigned int offset) {
+	unsigned int block = offset / m_minBlockSize;
+	if (offset % m_minBlockSize != 0 || block >= m_state.size() ||
+		m_state[block] == kNoBlock || !(m_state[block] & kAllocated)) {
+		ERROR("BuddyAllocator", "free", "offset is not the start of an allocated block");
+		return;
+	}
+
+	unsigned int order = m_state[block] & ~kAllocated;
+	m_state[block] = kNoBlock;
+	m_usedSize -= (1u << order) * m_minBlockSize;
+
+	// Unir con el buddy mientras est libre y sea del mismo orden
+	while (order < m_maxOrder) {
+		unsigned int buddy = block ^ (1u << order);
+		if (m_state[buddy] != order) {
+			break;
+		}
+		removeFree(buddy, order);
+		block = (std::min)(block, buddy);
+		order++;
+	}
+	pushFree(block, order);
+}
+
+unsigned int
+BuddyAllocator::blockSize(unsigned int offset) const {
+	unsigned int block = offset / m_minBlockSize;
+	if (m_minBlockSize == 0 || offset % m_minBlockSize != 0 || block >= m_state.size() ||
+		m_state[block] == kNoBlock || !(m_state[block] & kAllocated)) {
+		return 0;
+	}
+	return (1u << (m_state[block] & ~kAllocated)) * m_minBlockSize;
+}
+
+HRESULT
+BuddyAllocator::defragment(std::vector<BuddyMove>& moves, unsigned int newCapacity) {
+	moves.clear();
+	if (newCapacity == 0) {
+		newCapacity = m_capacity;
+	}
+	if (newCapacity < m_usedSize || newCapacity < m_minBlockSize ||
+		(newCapacity & (newCapacity - 1)) != 0) {
+		ERROR("BuddyAllocator", "defragment", "newCapacity must be a power of two that fits the live blocks");
+		return E_INVALIDARG;
+	}
+
+	// Bloques vivos de mayor a menor; a igual tamao se conserva el orden por offset
+	for (unsigned int block = 0; block < m_state.size(); ++block) {
+		if (m_state[block] != kNoBlock && (m_state[block] & kAllocated)) {
+			unsigned int size = (1u << (m_state[block] & ~kAllocated)) * m_minBlockSize;
+			moves.push_back({ block * m_minBlockSize, 0, size });
+		}
+	}
+	std::stable_sort(moves.begin(), moves.end(), [](const BuddyMove& a, const BuddyMove& b) {
+		return a.size > b.size;
+	});
+
+	HRESULT hr = init(newCapacity, m_minBlockSize);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	for (BuddyMove& move : moves) {
+		allocate(move.size, move.to);
+	}
+	return S_OK;
+}
+
+unsigned int
+BuddyAllocator::largestFreeBlock() const {
+	for (unsigned int order = m_maxOrder + 1; order-- > 0;) {
+		if (order < m_freeHeads.size() && m_freeHeads[order] != kNone) {
+			return (1u << order) * m_minBlockSize;
+		}
+	}
+	return 0;
+}
+
+unsigned int
+BuddyAllocator::nextPowerOfTwo(unsigned int value) {
+	unsigned int result = 1;
+	while (result < value) {
+		result <<= 1;
+	}
+	return result;
+}
+
+void
+BuddyAllocator::pushFree(unsigned int block, unsigned int order) {
+	m_state[block] = static_cast<unsigned char>(order);
+	m_prev[block] = kNone;
+	m_next[block] = m_freeHeads[order];
+	if (m_freeHeads[order] != kNone) {
+		m_prev[m_freeHeads[order]] = block;
+	}
+	m_freeHeads[order] = block;
+}
+
+void
+BuddyAllocator::removeFree(unsigned int block, unsigned int order) {
+	if (m_prev[block] != kNone) {
+		m_next[m_prev[block]] = m_next[block];
+	}
+	else {
+		m_freeHeads[order] = m_next[block];
+	}
+	if (m_next[block] != kNone) {
+		m_prev[m_next[block]] = m_prev[block];
+	}
+	m_state[block] = kNoBlock;
+	m_next[block] = kNone;
+	m_prev[block] = kNone;
+}
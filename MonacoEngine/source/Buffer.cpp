@@ -61,6 +61,62 @@ Buffer::init(Device& device, unsigned int ByteWidth) {
 	return createBuffer(device, desc, nullptr);
 }
 
+HRESULT
+Buffer::init(Device& device,
+	unsigned int stride,
+	unsigned int count,
+	const void* data,
+	bool dynamic) {
+	if (!device.m_device) {
+		ERROR("Buffer", "init", "Device is null.");
+		return E_POINTER;
+	}
+	if (stride == 0 || count == 0) {
+		ERROR("Buffer", "init", "stride or count is zero");
+		return E_INVALIDARG;
+	}
+	if (!data && !dynamic) {
+		ERROR("Buffer", "init", "A static vertex stream needs initial data");
+		return E_INVALIDARG;
+	}
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.Usage = dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
+	desc.CPUAccessFlags = dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+	desc.ByteWidth = stride * count;
+	desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	m_bindFlag = desc.BindFlags;
+	m_stride = stride;
+	m_offset = 0;
+
+	D3D11_SUBRESOURCE_DATA initData = {};
+	initData.pSysMem = data;
+	return createBuffer(device, desc, data ? &initData : nullptr);
+}
+
+HRESULT
+Buffer::write(DeviceContext& deviceContext, const void* data, unsigned int bytes) {
+	if (!m_buffer) {
+		ERROR("Buffer", "write", "m_buffer is null.");
+		return E_POINTER;
+	}
+	if (!data || bytes == 0 || bytes > m_size) {
+		ERROR("Buffer", "write", "bytes must be between 1 and the buffer size");
+		return E_INVALIDARG;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	HRESULT hr = deviceContext.Map(m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+	if (FAILED(hr)) {
+		ERROR("Buffer", "write",
+			("Failed to map buffer. HRESULT: " + std::to_string(hr)).c_str());
+		return hr;
+	}
+	memcpy(mapped.pData, data, bytes);
+	deviceContext.Unmap(m_buffer, 0);
+	return S_OK;
+}
+
 void
 Buffer::update(DeviceContext& deviceContext,
 	ID3D11Resource* pDstResource,
@@ -77,7 +133,7 @@ Buffer::update(DeviceContext& deviceContext,
 		ERROR("ShaderProgram", "update", "pSrcData is null.");
 		return;
 	}
-	deviceContext.m_deviceContext->UpdateSubresource(m_buffer,
+	deviceContext.UpdateSubresource(m_buffer,
 		DstSubresource,
 		pDstBox,
 		pSrcData,
@@ -104,16 +160,16 @@ Buffer::render(DeviceContext& deviceContext,
 
 	switch (m_bindFlag) {
 	case D3D11_BIND_VERTEX_BUFFER:
-		deviceContext.m_deviceContext->IASetVertexBuffers(StartSlot, NumBuffers, &m_buffer, &m_stride, &m_offset);
+		deviceContext.IASetVertexBuffers(StartSlot, NumBuffers, &m_buffer, &m_stride, &m_offset);
 		break;
 	case D3D11_BIND_CONSTANT_BUFFER:
-		deviceContext.m_deviceContext->VSSetConstantBuffers(StartSlot, NumBuffers, &m_buffer);
+		deviceContext.VSSetConstantBuffers(StartSlot, NumBuffers, &m_buffer);
 		if (setPixelShader) {
-			deviceContext.m_deviceContext->PSSetConstantBuffers(StartSlot, NumBuffers, &m_buffer);
+			deviceContext.PSSetConstantBuffers(StartSlot, NumBuffers, &m_buffer);
 		}
 		break;
 	case D3D11_BIND_INDEX_BUFFER:
-		deviceContext.m_deviceContext->IASetIndexBuffer(m_buffer, format, m_offset);
+		deviceContext.IASetIndexBuffer(m_buffer, format, m_offset);
 		break;
 	default:
 		ERROR("Buffer", "render", "Unsupported BindFlag");
@@ -124,6 +180,10 @@ Buffer::render(DeviceContext& deviceContext,
 void
 Buffer::destroy() {
 	SAFE_RELEASE(m_buffer);
+	m_stride = 0;
+	m_offset = 0;
+	m_bindFlag = 0;
+	m_size = 0;
 }
 
 HRESULT
@@ -140,5 +200,6 @@ Buffer::createBuffer(Device& device,
 		ERROR("Buffer", "createBuffer", "Failed to create buffer");
 		return hr;
 	}
+	m_size = desc.ByteWidth;
 	return S_OK;
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "CallStats.h"
+
+void
+CallStats::record(GraphicsCall call, unsigned long long bytes, unsigned long long nanoseconds) {
+	if (!m_enabled || call >= GraphicsCall::Count) {
+		return;
+	}
+	CallRecord& entry = m_records[static_cast<unsigned int>(call)];
+	entry.count++;
+	entry.bytes += bytes;
+	entry.nanoseconds += nanoseconds;
+}
+
+void
+CallStats::recordElided(GraphicsCall call, unsigned long long calls) {
+	if (!m_enabled || call >= GraphicsCall::Count) {
+		return;
+	}
+	m_records[static_cast<unsigned int>(call)].elided += calls;
+}
+
+void
+CallStats::reset() {
+	for (CallRecord& entry : m_records) {
+		entry = CallRecord();
+	}
+}
+
+unsigned long long
+CallStats::totalCalls() const {
+	unsigned long long total = 0;
+	for (const CallRecord& entry : m_records) {
+		total += entry.count;
+	}
+	return total;
+}
+
+unsigned long long
+CallStats::totalElided() const {
+	unsigned long long total = 0;
+	for (const CallRecord& entry : m_records) {
+		total += entry.elided;
+	}
+	return total;
+}
+
+std::string
+CallStats::report(const std::string& title) const {
+	std::ostringstream os;
+	os << "---- " << title << " call stats ----\n";
+	os << "call                       count   elided        bytes     total ms   avg us\n";
+
+	unsigned long long totalNs = 0;
+	for (unsigned int i = 0; i < static_cast<unsigned int>(GraphicsCall::Count); ++i) {
+		const CallRecord& entry = m_records[i];
+		if (entry.count == 0 && entry.elided == 0) {
+			continue;
+		}
+		totalNs += entry.nanoseconds;
+
+		char line[160];
+		snprintf(line, sizeof(line), "%-24s %8llu %8llu %12llu %12.3f %8.3f\n",
+			callName(static_cast<GraphicsCall>(i)),
+			entry.count,
+			entry.elided,
+			entry.bytes,
+			entry.nanoseconds / 1.0e6,
+			entry.count ? (entry.nanoseconds / 1.0e3) / static_cast<double>(entry.count) : 0.0);
+		os << line;
+	}
+	os << "total calls: " << totalCalls() << ", elided: " << totalElided() << ", total time: " << (totalNs / 1.0e6) << " ms\n";
+	return os.str();
+}
+
+const char*
+CallStats::callName(GraphicsCall call) {
+	switch (call) {
+	case GraphicsCall::CreateBuffer:             return "CreateBuffer";
+	case GraphicsCall::CreateTexture2D:          return "CreateTexture2D";
+	case GraphicsCall::CreateRenderTargetView:   return "CreateRenderTargetView";
+	case GraphicsCall::CreateDepthStencilView:   return "CreateDepthStencilView";
+	case GraphicsCall::CreateShaderResourceView: return "CreateShaderResourceView";
+	case GraphicsCall::CreateVertexShader:       return "CreateVertexShader";
+	case GraphicsCall::CreatePixelShader:        return "CreatePixelShader";
+	case GraphicsCall::CreateInputLayout:        return "CreateInputLayout";
+	case GraphicsCall::CreateSamplerState:       return "CreateSamplerState";
+	case GraphicsCall::CreateRasterizerState:    return "CreateRasterizerState";
+	case GraphicsCall::CreateBlendState:         return "CreateBlendState";
+	case GraphicsCall::CreateDepthStencilState:  return "CreateDepthStencilState";
+	case GraphicsCall::CreateDeferredContext:    return "CreateDeferredContext";
+	case GraphicsCall::CreateQuery:              return "CreateQuery";
+	case GraphicsCall::RSSetViewports:           return "RSSetViewports";
+	case GraphicsCall::PSSetShaderResources:     return "PSSetShaderResources";
+	case GraphicsCall::IASetInputLayout:         return "IASetInputLayout";
+	case GraphicsCall::VSSetShader:              return "VSSetShader";
+	case GraphicsCall::PSSetShader:              return "PSSetShader";
+	case GraphicsCall::UpdateSubresource:        return "UpdateSubresource";
+	case GraphicsCall::CopySubresourceRegion:    return "CopySubresourceRegion";
+	case GraphicsCall::IASetVertexBuffers:       return "IASetVertexBuffers";
+	case GraphicsCall::IASetIndexBuffer:         return "IASetIndexBuffer";
+	case GraphicsCall::PSSetSamplers:            return "PSSetSamplers";
+	case GraphicsCall::RSSetState:               return "RSSetState";
+	case GraphicsCall::OMSetBlendState:          return "OMSetBlendState";
+	case GraphicsCall::OMSetDepthStencilState:   return "OMSetDepthStencilState";
+	case GraphicsCall::OMSetRenderTargets:       return "OMSetRenderTargets";
+	case GraphicsCall::IASetPrimitiveTopology:   return "IASetPrimitiveTopology";
+	case GraphicsCall::ClearRenderTargetView:    return "ClearRenderTargetView";
+	case GraphicsCall::ClearDepthStencilView:    return "ClearDepthStencilView";
+	case GraphicsCall::VSSetConstantBuffers:     return "VSSetConstantBuffers";
+	case GraphicsCall::PSSetConstantBuffers:     return "PSSetConstantBuffers";
+	case GraphicsCall::DrawIndexed:              return "DrawIndexed";
+	case GraphicsCall::DrawIndexedInstanced:     return "DrawIndexedInstanced";
+	case GraphicsCall::FinishCommandList:        return "FinishCommandList";
+	case GraphicsCall::ExecuteCommandList:       return "ExecuteCommandList";
+	case GraphicsCall::Map:                      return "Map";
+	case GraphicsCall::Unmap:                    return "Unmap";
+	case GraphicsCall::End:                      return "End";
+	case GraphicsCall::GetData:                  return "GetData";
+	default:                                     return "Unknown";
+	}
+}
@@ -0,0 +1,431 @@
+#include "CommandList.h"
+#include "Device.h"
+
+HRESULT
+CommandList::init(Device& device,
+	DeviceContext& immediateContext,
+	bool useDeferredContext) {
+	if (!device.m_device || !immediateContext.m_deviceContext) {
+		ERROR("CommandList", "init", "Device or immediate context is not initialized");
+		return E_INVALIDARG;
+	}
+	if (m_immediateContext) {
+		ERROR("CommandList", "init", "CommandList is already initialized.");
+		return E_FAIL;
+	}
+	m_immediateContext = &immediateContext;
+
+	// El rasterizador en CPU solo ve las llamadas que pasan por el contexto inmediato
+	if (useDeferredContext && !device.m_softwareRasterizer) {
+		ID3D11DeviceContext* deferredContext = nullptr;
+		if (SUCCEEDED(device.CreateDeferredContext(0, &deferredContext))) {
+			m_deferredContext = deferredContext;
+			m_context.m_deviceContext = deferredContext;
+			return S_OK;
+		}
+		MESSAGE("CommandList", "init", "Deferred contexts unavailable, using portable command stream");
+	}
+
+	// Modo portable: el contexto de grabacin redirige todas sus llamadas a esta lista
+	m_context.m_deviceContext = immediateContext.m_deviceContext;
+	m_context.m_deviceContext->AddRef();
+	m_context.m_recorder = this;
+	return S_OK;
+}
+
+void
+CommandList::destroy() {
+	SAFE_RELEASE(m_commandList);
+	m_context.destroy();
+	m_context.m_recorder = nullptr;
+	m_deferredContext = nullptr;
+	m_immediateContext = nullptr;
+	m_commands.clear();
+	m_data.clear();
+}
+
+void
+CommandList::begin() {
+	SAFE_RELEASE(m_commandList);
+	// Se conserva la capacidad para no reservar memoria en cada frame
+	m_commands.clear();
+	m_data.clear();
+}
+
+HRESULT
+CommandList::finish() {
+	if (!m_deferredContext) {
+		return S_OK;
+	}
+	SAFE_RELEASE(m_commandList);
+	return m_context.FinishCommandList(FALSE, &m_commandList);
+}
+
+void
+CommandList::execute(DeviceContext& immediateContext) {
+	if (m_deferredContext) {
+		if (!m_commandList) {
+			ERROR("CommandList", "execute", "finish() was not called after recording");
+			return;
+		}
+		immediateContext.ExecuteCommandList(m_commandList, FALSE);
+		return;
+	}
+
+	for (const Command& command : m_commands) {
+		switch (command.type) {
+		case CommandType::RSSetViewports:
+			immediateContext.RSSetViewports(command.arg0,
+				dataAt<D3D11_VIEWPORT>(command.dataOffset));
+			break;
+		case CommandType::PSSetShaderResources:
+			immediateContext.PSSetShaderResources(command.arg0,
+				command.arg1,
+				dataAt<ID3D11ShaderResourceView*>(command.dataOffset));
+			break;
+		case CommandType::IASetInputLayout:
+			immediateContext.IASetInputLayout(static_cast<ID3D11InputLayout*>(command.object));
+			break;
+		case CommandType::VSSetShader:
+			immediateContext.VSSetShader(static_cast<ID3D11VertexShader*>(command.object),
+				command.arg1 ? dataAt<ID3D11ClassInstance*>(command.dataOffset) : nullptr,
+				command.arg0);
+			break;
+		case CommandType::PSSetShader:
+			immediateContext.PSSetShader(static_cast<ID3D11PixelShader*>(command.object),
+				command.arg1 ? dataAt<ID3D11ClassInstance*>(command.dataOffset) : nullptr,
+				command.arg0);
+			break;
+		case CommandType::UpdateSubresource:
+			immediateContext.UpdateSubresource(static_cast<ID3D11Resource*>(command.object),
+				command.arg0,
+				command.arg3 ? dataAt<D3D11_BOX>(command.extraOffset) : nullptr,
+				dataAt<unsigned char>(command.dataOffset),
+				command.arg1,
+				command.arg2);
+			break;
+		case CommandType::IASetVertexBuffers: {
+			const unsigned int* strides = dataAt<unsigned int>(command.extraOffset);
+			immediateContext.IASetVertexBuffers(command.arg0,
+				command.arg1,
+				dataAt<ID3D11Buffer*>(command.dataOffset),
+				strides,
+				strides + command.arg1);
+			break;
+		}
+		case CommandType::IASetIndexBuffer:
+			immediateContext.IASetIndexBuffer(static_cast<ID3D11Buffer*>(command.object),
+				static_cast<DXGI_FORMAT>(command.arg0),
+				command.arg1);
+			break;
+		case CommandType::PSSetSamplers:
+			immediateContext.PSSetSamplers(command.arg0,
+				command.arg1,
+				dataAt<ID3D11SamplerState*>(command.dataOffset));
+			break;
+		case CommandType::RSSetState:
+			immediateContext.RSSetState(static_cast<ID3D11RasterizerState*>(command.object));
+			break;
+		case CommandType::OMSetBlendState:
+			immediateContext.OMSetBlendState(static_cast<ID3D11BlendState*>(command.object),
+				command.arg1 ? dataAt<float>(command.dataOffset) : nullptr,
+				command.arg0);
+			break;
+		case CommandType::OMSetDepthStencilState:
+			immediateContext.OMSetDepthStencilState(static_cast<ID3D11DepthStencilState*>(command.object),
+				command.arg0);
+			break;
+		case CommandType::OMSetRenderTargets:
+			immediateContext.OMSetRenderTargets(command.arg0,
+				command.arg0 ? dataAt<ID3D11RenderTargetView*>(command.dataOffset) : nullptr,
+				static_cast<ID3D11DepthStencilView*>(command.object));
+			break;
+		case CommandType::IASetPrimitiveTopology:
+			immediateContext.IASetPrimitiveTopology(static_cast<D3D11_PRIMITIVE_TOPOLOGY>(command.arg0));
+			break;
+		case CommandType::ClearRenderTargetView:
+			immediateContext.ClearRenderTargetView(static_cast<ID3D11RenderTargetView*>(command.object),
+				dataAt<float>(command.dataOffset));
+			break;
+		case CommandType::ClearDepthStencilView:
+			immediateContext.ClearDepthStencilView(static_cast<ID3D11DepthStencilView*>(command.object),
+				command.arg0,
+				command.depth,
+				static_cast<UINT8>(command.arg1));
+			break;
+		case CommandType::VSSetConstantBuffers:
+			immediateContext.VSSetConstantBuffers(command.arg0,
+				command.arg1,
+				dataAt<ID3D11Buffer*>(command.dataOffset));
+			break;
+		case CommandType::PSSetConstantBuffers:
+			immediateContext.PSSetConstantBuffers(command.arg0,
+				command.arg1,
+				dataAt<ID3D11Buffer*>(command.dataOffset));
+			break;
+		case CommandType::DrawIndexed:
+			immediateContext.DrawIndexed(command.arg0, command.arg1, command.arg3);
+			break;
+		case CommandType::DrawIndexedInstanced:
+			immediateContext.DrawIndexedInstanced(command.arg0,
+				command.arg1,
+				command.arg2,
+				command.arg3,
+				*dataAt<unsigned int>(command.dataOffset));
+			break;
+		}
+	}
+}
+
+size_t
+CommandList::pushData(const void* data, size_t size) {
+	size_t offset = (m_data.size() + 15) & ~static_cast<size_t>(15);
+	m_data.resize(offset + size);
+	if (size > 0) {
+		memcpy(m_data.data() + offset, data, size);
+	}
+	return offset;
+}
+
+CommandList::Command
+CommandList::makeCommand(CommandType type) {
+	Command command = {};
+	command.type = type;
+	return command;
+}
+
+void
+CommandList::RSSetViewports(unsigned int NumViewports, const D3D11_VIEWPORT* pViewports) {
+	Command command = makeCommand(CommandType::RSSetViewports);
+	command.arg0 = NumViewports;
+	command.dataOffset = pushData(pViewports, NumViewports * sizeof(D3D11_VIEWPORT));
+	m_commands.push_back(command);
+}
+
+void
+CommandList::PSSetShaderResources(unsigned int StartSlot,
+	unsigned int NumViews,
+	ID3D11ShaderResourceView* const* ppShaderResourceViews) {
+	Command command = makeCommand(CommandType::PSSetShaderResources);
+	command.arg0 = StartSlot;
+	command.arg1 = NumViews;
+	command.dataOffset = pushData(ppShaderResourceViews, NumViews * sizeof(ID3D11ShaderResourceView*));
+	m_commands.push_back(command);
+}
+
+void
+CommandList::IASetInputLayout(ID3D11InputLayout* pInputLayout) {
+	Command command = makeCommand(CommandType::IASetInputLayout);
+	command.object = pInputLayout;
+	m_commands.push_back(command);
+}
+
+void
+CommandList::VSSetShader(ID3D11VertexShader* pVertexShader,
+	ID3D11ClassInstance* const* ppClassInstances,
+	unsigned int NumClassInstances) {
+	Command command = makeCommand(CommandType::VSSetShader);
+	command.object = pVertexShader;
+	command.arg0 = NumClassInstances;
+	command.arg1 = ppClassInstances ? 1 : 0;
+	if (ppClassInstances) {
+		command.dataOffset = pushData(ppClassInstances, NumClassInstances * sizeof(ID3D11ClassInstance*));
+	}
+	m_commands.push_back(command);
+}
+
+void
+CommandList::PSSetShader(ID3D11PixelShader* pPixelShader,
+	ID3D11ClassInstance* const* ppClassInstances,
+	unsigned int NumClassInstances) {
+	Command command = makeCommand(CommandType::PSSetShader);
+	command.object = pPixelShader;
+	command.arg0 = NumClassInstances;
+	command.arg1 = ppClassInstances ? 1 : 0;
+	if (ppClassInstances) {
+		command.dataOffset = pushData(ppClassInstances, NumClassInstances * sizeof(ID3D11ClassInstance*));
+	}
+	m_commands.push_back(command);
+}
+
+void
+CommandList::UpdateSubresource(ID3D11Resource* pDstResource,
+	unsigned int DstSubresource,
+	const D3D11_BOX* pDstBox,
+	const void* pSrcData,
+	unsigned int SrcRowPitch,
+	unsigned int SrcDepthPitch,
+	unsigned long long bytes) {
+	Command command = makeCommand(CommandType::UpdateSubresource);
+	command.object = pDstResource;
+	command.arg0 = DstSubresource;
+	command.arg1 = SrcRowPitch;
+	command.arg2 = SrcDepthPitch;
+	command.arg3 = pDstBox ? 1 : 0;
+	if (pDstBox) {
+		command.extraOffset = pushData(pDstBox, sizeof(D3D11_BOX));
+	}
+	// Se copian los datos: el llamador puede reutilizar su memoria al volver
+	command.dataOffset = pushData(pSrcData, static_cast<size_t>(bytes));
+	m_commands.push_back(command);
+}
+
+void
+CommandList::IASetVertexBuffers(unsigned int StartSlot,
+	unsigned int NumBuffers,
+	ID3D11Buffer* const* ppVertexBuffers,
+	const unsigned int* pStrides,
+	const unsigned int* pOffsets) {
+	Command command = makeCommand(CommandType::IASetVertexBuffers);
+	command.arg0 = StartSlot;
+	command.arg1 = NumBuffers;
+	command.dataOffset = pushData(ppVertexBuffers, NumBuffers * sizeof(ID3D11Buffer*));
+	// Strides y offsets contiguos: [strides..., offsets...]
+	command.extraOffset = pushData(pStrides, NumBuffers * sizeof(unsigned int));
+	m_data.insert(m_data.end(),
+		reinterpret_cast<const unsigned char*>(pOffsets),
+		reinterpret_cast<const unsigned char*>(pOffsets + NumBuffers));
+	m_commands.push_back(command);
+}
+
+void
+CommandList::IASetIndexBuffer(ID3D11Buffer* pIndexBuffer,
+	DXGI_FORMAT Format,
+	unsigned int Offset) {
+	Command command = makeCommand(CommandType::IASetIndexBuffer);
+	command.object = pIndexBuffer;
+	command.arg0 = static_cast<unsigned int>(Format);
+	command.arg1 = Offset;
+	m_commands.push_back(command);
+}
+
+void
+CommandList::PSSetSamplers(unsigned int StartSlot,
+	unsigned int NumSamplers,
+	ID3D11SamplerState* const* ppSamplers) {
+	Command command = makeCommand(CommandType::PSSetSamplers);
+	command.arg0 = StartSlot;
+	command.arg1 = NumSamplers;
+	command.dataOffset = pushData(ppSamplers, NumSamplers * sizeof(ID3D11SamplerState*));
+	m_commands.push_back(command);
+}
+
+void
+CommandList::RSSetState(ID3D11RasterizerState* pRasterizerState) {
+	Command command = makeCommand(CommandType::RSSetState);
+	command.object = pRasterizerState;
+	m_commands.push_back(command);
+}
+
+void
+CommandList::OMSetBlendState(ID3D11BlendState* pBlendState,
+	const float BlendFactor[4],
+	unsigned int SampleMask) {
+	Command command = makeCommand(CommandType::OMSetBlendState);
+	command.object = pBlendState;
+	command.arg0 = SampleMask;
+	command.arg1 = BlendFactor ? 1 : 0;
+	if (BlendFactor) {
+		command.dataOffset = pushData(BlendFactor, 4 * sizeof(float));
+	}
+	m_commands.push_back(command);
+}
+
+void
+CommandList::OMSetDepthStencilState(ID3D11DepthStencilState* pDepthStencilState,
+	unsigned int StencilRef) {
+	Command command = makeCommand(CommandType::OMSetDepthStencilState);
+	command.object = pDepthStencilState;
+	command.arg0 = StencilRef;
+	m_commands.push_back(command);
+}
+
+void
+CommandList::OMSetRenderTargets(unsigned int NumViews,
+	ID3D11RenderTargetView* const* ppRenderTargetViews,
+	ID3D11DepthStencilView* pDepthStencilView) {
+	Command command = makeCommand(CommandType::OMSetRenderTargets);
+	command.object = pDepthStencilView;
+	command.arg0 = ppRenderTargetViews ? NumViews : 0;
+	if (ppRenderTargetViews) {
+		command.dataOffset = pushData(ppRenderTargetViews, NumViews * sizeof(ID3D11RenderTargetView*));
+	}
+	m_commands.push_back(command);
+}
+
+void
+CommandList::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY Topology) {
+	Command command = makeCommand(CommandType::IASetPrimitiveTopology);
+	command.arg0 = static_cast<unsigned int>(Topology);
+	m_commands.push_back(command);
+}
+
+void
+CommandList::ClearRenderTargetView(ID3D11RenderTargetView* pRenderTargetView,
+	const float ColorRGBA[4]) {
+	Command command = makeCommand(CommandType::ClearRenderTargetView);
+	command.object = pRenderTargetView;
+	command.dataOffset = pushData(ColorRGBA, 4 * sizeof(float));
+	m_commands.push_back(command);
+}
+
+void
+CommandList::ClearDepthStencilView(ID3D11DepthStencilView* pDepthStencilView,
+	unsigned int ClearFlags,
+	float Depth,
+	UINT8 Stencil) {
+	Command command = makeCommand(CommandType::ClearDepthStencilView);
+	command.object = pDepthStencilView;
+	command.arg0 = ClearFlags;
+	command.arg1 = Stencil;
+	command.depth = Depth;
+	m_commands.push_back(command);
+}
+
+void
+CommandList::VSSetConstantBuffers(unsigned int StartSlot,
+	unsigned int NumBuffers,
+	ID3D11Buffer* const* ppConstantBuffers) {
+	Command command = makeCommand(CommandType::VSSetConstantBuffers);
+	command.arg0 = StartSlot;
+	command.arg1 = NumBuffers;
+	command.dataOffset = pushData(ppConstantBuffers, NumBuffers * sizeof(ID3D11Buffer*));
+	m_commands.push_back(command);
+}
+
+void
+CommandList::PSSetConstantBuffers(unsigned int StartSlot,
+	unsigned int NumBuffers,
+	ID3D11Buffer* const* ppConstantBuffers) {
+	Command command = makeCommand(CommandType::PSSetConstantBuffers);
+	command.arg0 = StartSlot;
+	command.arg1 = NumBuffers;
+	command.dataOffset = pushData(ppConstantBuffers, NumBuffers * sizeof(ID3D11Buffer*));
+	m_commands.push_back(command);
+}
+
+void
+CommandList::DrawIndexed(unsigned int IndexCount,
+	unsigned int StartIndexLocation,
+	int BaseVertexLocation) {
+	Command command = makeCommand(CommandType::DrawIndexed);
+	command.arg0 = IndexCount;
+	command.arg1 = StartIndexLocation;
+	command.arg3 = BaseVertexLocation;
+	m_commands.push_back(command);
+}
+
+void
+CommandList::DrawIndexedInstanced(unsigned int IndexCountPerInstance,
+	unsigned int InstanceCount,
+	unsigned int StartIndexLocation,
+	int BaseVertexLocation,
+	unsigned int StartInstanceLocation) {
+	Command command = makeCommand(CommandType::DrawIndexedInstanced);
+	command.arg0 = IndexCountPerInstance;
+	command.arg1 = InstanceCount;
+	command.arg2 = StartIndexLocation;
+	command.arg3 = BaseVertexLocation;
+	command.dataOffset = pushData(&StartInstanceLocation, sizeof(StartInstanceLocation));
+	m_commands.push_back(command);
+}
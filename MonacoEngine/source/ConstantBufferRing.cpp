@@ -0,0 +1,156 @@
+#include "ConstantBufferRing.h"
+#include "Device.h"
+#include "DeviceContext.h"
+
+HRESULT
+ConstantBufferRing::init(Device& device,
+	unsigned int chunkSize,
+	unsigned int chunkCount,
+	unsigned int framesInFlight) {
+	if (!device.m_device) {
+		ERROR("ConstantBufferRing", "init", "Device is null.");
+		return E_POINTER;
+	}
+	if (chunkSize == 0 || chunkCount == 0 || framesInFlight == 0) {
+		ERROR("ConstantBufferRing", "init", "chunkSize, chunkCount and framesInFlight must be non-zero");
+		return E_INVALIDARG;
+	}
+	if (chunkSize > D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16) {
+		ERROR("ConstantBufferRing", "init", "chunkSize exceeds the constant buffer size limit");
+		return E_INVALIDARG;
+	}
+	destroy();
+
+	// Un chunk por asignacin: la alineacin del anillo es el tamao del chunk
+	m_chunkSize = (chunkSize + 255) & ~255u;
+	HRESULT hr = m_ring.init(m_chunkSize * chunkCount, m_chunkSize);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.ByteWidth = m_chunkSize;
+	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	m_chunks.resize(chunkCount, nullptr);
+	for (ID3D11Buffer*& chunk : m_chunks) {
+		hr = device.CreateBuffer(&desc, nullptr, &chunk);
+		if (FAILED(hr)) {
+			ERROR("ConstantBufferRing", "init", "Failed to create constant buffer chunk");
+			destroy();
+			return hr;
+		}
+	}
+
+	D3D11_QUERY_DESC queryDesc = {};
+	queryDesc.Query = D3D11_QUERY_EVENT;
+	m_fences.resize(framesInFlight, nullptr);
+	for (ID3D11Query*& fence : m_fences) {
+		hr = device.CreateQuery(&queryDesc, &fence);
+		if (FAILED(hr)) {
+			ERROR("ConstantBufferRing", "init", "Failed to create fence query");
+			destroy();
+			return hr;
+		}
+	}
+	return S_OK;
+}
+
+void
+ConstantBufferRing::update(DeviceContext& deviceContext) {
+	if (m_chunks.empty() || !deviceContext.m_deviceContext) {
+		return;
+	}
+	unsigned long long frameCount = m_fences.size();
+
+	// Si el fence que se va a reutilizar no se ha ledo, su frame se libera sin esperar
+	while (m_frame - m_completedFrame >= frameCount) {
+		m_ring.forceRetire();
+		m_completedFrame++;
+	}
+
+	unsigned long long fence = ++m_frame;
+	m_ring.endFrame(fence);
+	deviceContext.End(m_fences[fence % frameCount]);
+
+	pollFences(deviceContext);
+}
+
+void
+ConstantBufferRing::destroy() {
+	for (ID3D11Buffer*& chunk : m_chunks) {
+		SAFE_RELEASE(chunk);
+	}
+	for (ID3D11Query*& fence : m_fences) {
+		SAFE_RELEASE(fence);
+	}
+	m_chunks.clear();
+	m_fences.clear();
+	m_ring.destroy();
+	m_chunkSize = 0;
+	m_frame = 0;
+	m_completedFrame = 0;
+}
+
+ID3D11Buffer*
+ConstantBufferRing::allocate(DeviceContext& deviceContext, const void* data, unsigned int size) {
+	if (m_chunks.empty()) {
+		ERROR("ConstantBufferRing", "allocate", "Ring is not initialized.");
+		return nullptr;
+	}
+	if (!data || size == 0 || size > m_chunkSize) {
+		ERROR("ConstantBufferRing", "allocate", "size must be between 1 and the chunk size");
+		return nullptr;
+	}
+
+	unsigned int offset = 0;
+	if (!m_ring.allocate(size, offset)) {
+		pollFences(deviceContext);
+		// Sin espacio: se libera el frame cerrado ms antiguo aunque la GPU no haya confirmado
+		// su fence. Los chunks del frame actual no se tocan: sus draws an no se envan
+		while (!m_ring.allocate(size, offset)) {
+			if (m_ring.pendingFrames() == 0) {
+				ERROR("ConstantBufferRing", "allocate", "The current frame already uses every chunk of the ring");
+				return nullptr;
+			}
+			m_completedFrame++;
+			m_ring.forceRetire();
+		}
+	}
+
+	ID3D11Buffer* chunk = m_chunks[offset / m_chunkSize];
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	HRESULT hr = deviceContext.Map(chunk, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+	if (FAILED(hr)) {
+		ERROR("ConstantBufferRing", "allocate",
+			("Failed to map constant buffer chunk. HRESULT: " + std::to_string(hr)).c_str());
+		return nullptr;
+	}
+	memcpy(mapped.pData, data, size);
+	deviceContext.Unmap(chunk, 0);
+	return chunk;
+}
+
+std::string
+ConstantBufferRing::report() const {
+	const RingAllocatorStats& stats = m_ring.m_stats;
+	std::ostringstream os;
+	os << "Constant buffer ring: " << m_chunks.size() << " chunks x " << m_chunkSize << " bytes, "
+		<< stats.allocations << " allocations, " << stats.wraps << " wraps, "
+		<< stats.stalls << " stalls, " << stats.forcedRetires << " forced retires\n";
+	return os.str();
+}
+
+void
+ConstantBufferRing::pollFences(DeviceContext& deviceContext) {
+	unsigned long long frameCount = m_fences.size();
+	while (m_completedFrame < m_frame) {
+		ID3D11Query* fence = m_fences[(m_completedFrame + 1) % frameCount];
+		if (deviceContext.GetData(fence, nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) {
+			break;
+		}
+		m_completedFrame++;
+	}
+	m_ring.retire(m_completedFrame);
+}
@@ -0,0 +1,468 @@
+#include "DDSLoader.h"
+
+// Cabeceras tal como estn en el archivo; todos los campos son de 32 bits, sin relleno
+struct DDSPixelFormat {
+	unsigned int size;
+	unsigned int flags;
+	unsigned int fourCC;
+	unsigned int rgbBitCount;
+	unsigned int rBitMask;
+	unsigned int gBitMask;
+	unsigned int bBitMask;
+	unsigned int aBitMask;
+};
+
+struct DDSHeader {
+	unsigned int size;
+	unsigned int flags;
+	unsigned int height;
+	unsigned int width;
+	unsigned int pitchOrLinearSize;
+	unsigned int depth;
+	unsigned int mipMapCount;
+	unsigned int reserved1[11];
+	DDSPixelFormat pixelFormat;
+	unsigned int caps;
+	unsigned int caps2;
+	unsigned int caps3;
+	unsigned int caps4;
+	unsigned int reserved2;
+};
+
+struct DDSHeaderDXT10 {
+	unsigned int dxgiFormat;
+	unsigned int resourceDimension;
+	unsigned int miscFlag;
+	unsigned int arraySize;
+	unsigned int miscFlags2;
+};
+
+static_assert(sizeof(DDSPixelFormat) == 32, "DDS_PIXELFORMAT must be 32 bytes");
+static_assert(sizeof(DDSHeader) == 124, "DDS_HEADER must be 124 bytes");
+static_assert(sizeof(DDSHeaderDXT10) == 20, "DDS_HEADER_DXT10 must be 20 bytes");
+
+static const unsigned int kHeaderFlagDepth = 0x800000;
+static const unsigned int kPixelAlphaPixels = 0x1;
+static const unsigned int kPixelAlpha = 0x2;
+static const unsigned int kPixelFourCC = 0x4;
+static const unsigned int kPixelRGB = 0x40;
+static const unsigned int kPixelLuminance = 0x20000;
+static const unsigned int kPixelBumpDuDv = 0x80000;
+static const unsigned int kCaps2CubeMap = 0x200;
+static const unsigned int kCaps2AllFaces = 0xFC00;
+static const unsigned int kCaps2Volume = 0x200000;
+static const unsigned int kMiscTextureCube = 0x4;
+// Lmite de D3D11 por lado; acota los mips y evita desbordes al calcular tamaos
+static const unsigned int kMaxDimension = 16384;
+
+static constexpr unsigned int
+fourCC(char a, char b, char c, char d) {
+	return static_cast<unsigned int>(static_cast<unsigned char>(a)) |
+		(static_cast<unsigned int>(static_cast<unsigned char>(b)) << 8) |
+		(static_cast<unsigned int>(static_cast<unsigned char>(c)) << 16) |
+		(static_cast<unsigned int>(static_cast<unsigned char>(d)) << 24);
+}
+
+static bool
+hasMasks(const DDSPixelFormat& pf, unsigned int r, unsigned int g, unsigned int b, unsigned int a) {
+	return pf.rBitMask == r && pf.gBitMask == g && pf.bBitMask == b && pf.aBitMask == a;
+}
+
+/**
+ * @brief Formato DXGI de una cabecera DX9; @c DXGI_FORMAT_UNKNOWN si no tiene equivalente directo.
+ */
+static DXGI_FORMAT
+legacyFormat(const DDSPixelFormat& pf) {
+	if (pf.flags & kPixelFourCC) {
+		switch (pf.fourCC) {
+		case fourCC('D', 'X', 'T', '1'): return DXGI_FORMAT_BC1_UNORM;
+		// DXT2 y DXT4 son las versiones con alfa premultiplicado; el bloque es el mismo
+		case fourCC('D', 'X', 'T', '2'):
+		case fourCC('D', 'X', 'T', '3'): return DXGI_FORMAT_BC2_UNORM;
+		case fourCC('D', 'X', 'T', '4'):
+		case fourCC('D', 'X', 'T', '5'): return DXGI_FORMAT_BC3_UNORM;
+		case fourCC('A', 'T', 'I', '1'):
+		case fourCC('B', 'C', '4', 'U'): return DXGI_FORMAT_BC4_UNORM;
+		case fourCC('B', 'C', '4', 'S'): return DXGI_FORMAT_BC4_SNORM;
+		case fourCC('A', 'T', 'I', '2'):
+		case fourCC('B', 'C', '5', 'U'): return DXGI_FORMAT_BC5_UNORM;
+		case fourCC('B', 'C', '5', 'S'): return DXGI_FORMAT_BC5_SNORM;
+		case fourCC('R', 'G', 'B', 'G'): return DXGI_FORMAT_R8G8_B8G8_UNORM;
+		case fourCC('G', 'R', 'G', 'B'): return DXGI_FORMAT_G8R8_G8B8_UNORM;
+		// Valores de D3DFORMAT escritos como fourCC
+		case 36: return DXGI_FORMAT_R16G16B16A16_UNORM;
+		case 110: return DXGI_FORMAT_R16G16B16A16_SNORM;
+		case 111: return DXGI_FORMAT_R16_FLOAT;
+		case 112: return DXGI_FORMAT_R16G16_FLOAT;
+		case 113: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+		case 114: return DXGI_FORMAT_R32_FLOAT;
+		case 115: return DXGI_FORMAT_R32G32_FLOAT;
+		case 116: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		default: return DXGI_FORMAT_UNKNOWN;
+		}
+	}
+	if (pf.flags & kPixelRGB) {
+		if (pf.rgbBitCount == 32) {
+			if (hasMasks(pf, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000)) return DXGI_FORMAT_R8G8B8A8_UNORM;
+			if (hasMasks(pf, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000)) return DXGI_FORMAT_B8G8R8A8_UNORM;
+			if (hasMasks(pf, 0x00FF0000, 0x0000FF00, 0x000000FF, 0x00000000)) return DXGI_FORMAT_B8G8R8X8_UNORM;
+			// D3DX escribe R10G10B10A2 con las mscaras invertidas; ambos se leen igual
+			if (hasMasks(pf, 0x000003FF, 0x000FFC00, 0x3FF00000, 0xC0000000) ||
+				hasMasks(pf, 0x3FF00000, 0x000FFC00, 0x000003FF, 0xC0000000)) return DXGI_FORMAT_R10G10B10A2_UNORM;
+			if (hasMasks(pf, 0x0000FFFF, 0xFFFF0000, 0x00000000, 0x00000000)) return DXGI_FORMAT_R16G16_UNORM;
+			if (hasMasks(pf, 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000)) return DXGI_FORMAT_R32_FLOAT;
+		}
+		else if (pf.rgbBitCount == 16) {
+			if (hasMasks(pf, 0x7C00, 0x03E0, 0x001F, 0x8000)) return DXGI_FORMAT_B5G5R5A1_UNORM;
+			if (hasMasks(pf, 0xF800, 0x07E0, 0x001F, 0x0000)) return DXGI_FORMAT_B5G6R5_UNORM;
+		}
+		return DXGI_FORMAT_UNKNOWN;
+	}
+	if (pf.flags & kPixelLuminance) {
+		if (pf.rgbBitCount == 8 && hasMasks(pf, 0xFF, 0, 0, 0)) return DXGI_FORMAT_R8_UNORM;
+		if (pf.rgbBitCount == 16 && hasMasks(pf, 0xFFFF, 0, 0, 0)) return DXGI_FORMAT_R16_UNORM;
+		if (pf.rgbBitCount == 16 && (pf.flags & kPixelAlphaPixels) && hasMasks(pf, 0xFF, 0, 0, 0xFF00)) {
+			return DXGI_FORMAT_R8G8_UNORM;
+		}
+		return DXGI_FORMAT_UNKNOWN;
+	}
+	if (pf.flags & kPixelAlpha) {
+		return pf.rgbBitCount == 8 ? DXGI_FORMAT_A8_UNORM : DXGI_FORMAT_UNKNOWN;
+	}
+	if (pf.flags & kPixelBumpDuDv) {
+		if (pf.rgbBitCount == 16 && hasMasks(pf, 0x00FF, 0xFF00, 0, 0)) return DXGI_FORMAT_R8G8_SNORM;
+		if (pf.rgbBitCount == 32 && hasMasks(pf, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000)) {
+			return DXGI_FORMAT_R8G8B8A8_SNORM;
+		}
+		if (pf.rgbBitCount == 32 && hasMasks(pf, 0x0000FFFF, 0xFFFF0000, 0, 0)) return DXGI_FORMAT_R16G16_SNORM;
+	}
+	return DXGI_FORMAT_UNKNOWN;
+}
+
+HRESULT
+DDSLoader::parse(const unsigned char* data, size_t size, DDSImage& image) {
+	image = DDSImage();
+	unsigned int magic = 0;
+	DDSHeader header;
+	if (!data || size < sizeof(magic) + sizeof(header)) {
+		ERROR("DDSLoader", "parse", "File is too small to be a DDS file");
+		return E_FAIL;
+	}
+	memcpy(&magic, data, sizeof(magic));
+	memcpy(&header, data + sizeof(magic), sizeof(header));
+	if (magic != kMagic || header.size != sizeof(DDSHeader) || header.pixelFormat.size != sizeof(DDSPixelFormat)) {
+		ERROR("DDSLoader", "parse", "Invalid DDS header");
+		return E_FAIL;
+	}
+	size_t offset = sizeof(magic) + sizeof(header);
+
+	image.width = header.width;
+	image.height = header.height;
+	image.mipLevels = header.mipMapCount ? header.mipMapCount : 1;
+	if ((header.pixelFormat.flags & kPixelFourCC) && header.pixelFormat.fourCC == fourCC('D', 'X', '1', '0')) {
+		DDSHeaderDXT10 extension;
+		if (size - offset < sizeof(extension)) {
+			ERROR("DDSLoader", "parse", "Truncated DX10 header");
+			return E_FAIL;
+		}
+		memcpy(&extension, data + offset, sizeof(extension));
+		offset += sizeof(extension);
+
+		image.format = static_cast<DXGI_FORMAT>(extension.dxgiFormat);
+		image.arraySize = extension.arraySize;
+		switch (extension.resourceDimension) {
+		case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
+			image.height = 1;
+			break;
+		case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
+			if (extension.miscFlag & kMiscTextureCube) {
+				image.cubeMap = true;
+				image.arraySize = extension.arraySize > kMaxDimension ? 0 : extension.arraySize * 6;
+			}
+			break;
+		case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
+			if (!(header.flags & kHeaderFlagDepth) || extension.arraySize != 1) {
+				ERROR("DDSLoader", "parse", "Invalid volume texture");
+				return E_FAIL;
+			}
+			image.depth = header.depth;
+			break;
+		default:
+			ERROR("DDSLoader", "parse", "Unsupported resource dimension");
+			return E_NOTIMPL;
+		}
+		image.dimension = static_cast<D3D11_RESOURCE_DIMENSION>(extension.resourceDimension);
+	}
+	else {
+		image.format = legacyFormat(header.pixelFormat);
+		if ((header.flags & kHeaderFlagDepth) && (header.caps2 & kCaps2Volume)) {
+			image.dimension = D3D11_RESOURCE_DIMENSION_TEXTURE3D;
+			image.depth = header.depth;
+		}
+		else {
+			image.dimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+			if (header.caps2 & kCaps2CubeMap) {
+				// D3D11 no admite cubos con caras faltantes
+				if ((header.caps2 & kCaps2AllFaces) != kCaps2AllFaces) {
+					ERROR("DDSLoader", "parse", "Partial cube maps are not supported");
+					return E_NOTIMPL;
+				}
+				image.cubeMap = true;
+				image.arraySize = 6;
+			}
+		}
+	}
+
+	if (bitsPerPixel(image.format) == 0) {
+		ERROR("DDSLoader", "parse", "Unsupported DDS pixel format");
+		return E_NOTIMPL;
+	}
+	unsigned int largest = (std::max)(image.width, (std::max)(image.height, image.depth));
+	unsigned int maxMips = 1;
+	while ((largest >> maxMips) > 0) {
+		++maxMips;
+	}
+	if (image.width == 0 || image.height == 0 || image.depth == 0 || image.arraySize == 0 ||
+		largest > kMaxDimension || image.arraySize > kMaxDimension || image.mipLevels > maxMips) {
+		ERROR("DDSLoader", "parse", "Invalid DDS dimensions");
+		return E_FAIL;
+	}
+
+	image.subresources.reserve(static_cast<size_t>(image.arraySize) * image.mipLevels);
+	for (unsigned int item = 0; item < image.arraySize; ++item) {
+		unsigned int width = image.width;
+		unsigned int height = image.height;
+		unsigned int depth = image.depth;
+		for (unsigned int mip = 0; mip < image.mipLevels; ++mip) {
+			size_t rowPitch = 0, rowCount = 0;
+			surfaceInfo(image.format, width, height, rowPitch, rowCount);
+			// En 64 bits: con 16384 por lado el producto no cabe en un size_t de 32
+			unsigned long long slicePitch = static_cast<unsigned long long>(rowPitch) * rowCount;
+			unsigned long long levelSize = slicePitch * depth;
+			if (slicePitch > 0xFFFFFFFFull || size - offset < levelSize) {
+				ERROR("DDSLoader", "parse", "Truncated DDS file");
+				image.subresources.clear();
+				return E_FAIL;
+			}
+			DDSSubresource subresource;
+			subresource.data = data + offset;
+			subresource.rowPitch = static_cast<unsigned int>(rowPitch);
+			subresource.slicePitch = static_cast<unsigned int>(slicePitch);
+			image.subresources.push_back(subresource);
+			offset += static_cast<size_t>(levelSize);
+
+			width = (std::max)(width / 2, 1u);
+			height = (std::max)(height / 2, 1u);
+			depth = (std::max)(depth / 2, 1u);
+		}
+	}
+	return S_OK;
+}
+
+HRESULT
+DDSLoader::save(const std::string& fileName, const DDSImage& image) {
+	if (image.dimension != D3D11_RESOURCE_DIMENSION_TEXTURE2D || image.cubeMap || image.arraySize != 1 ||
+		image.depth != 1 || image.width == 0 || image.height == 0 || image.mipLevels == 0 ||
+		image.subresources.size() != image.mipLevels) {
+		ERROR("DDSLoader", "save", ("Only simple 2D textures can be saved: " + fileName).c_str());
+		return E_INVALIDARG;
+	}
+	for (unsigned int level = 0; level < image.mipLevels; ++level) {
+		size_t rowPitch = 0;
+		size_t rowCount = 0;
+		if (!surfaceInfo(image.format, (std::max)(1u, image.width >> level), (std::max)(1u, image.height >> level),
+			rowPitch, rowCount) || !image.subresources[level].data ||
+			image.subresources[level].slicePitch != rowPitch * rowCount) {
+			ERROR("DDSLoader", "save", ("Invalid subresource size for " + fileName).c_str());
+			return E_INVALIDARG;
+		}
+	}
+
+	DDSHeader header;
+	memset(&header, 0, sizeof(header));
+	header.size = sizeof(DDSHeader);
+	// CAPS | HEIGHT | WIDTH | PIXELFORMAT | MIPMAPCOUNT | LINEARSIZE
+	header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;
+	header.height = image.height;
+	header.width = image.width;
+	header.pitchOrLinearSize = image.subresources[0].slicePitch;
+	header.mipMapCount = image.mipLevels;
+	header.pixelFormat.size = sizeof(DDSPixelFormat);
+	header.pixelFormat.flags = kPixelFourCC;
+	header.pixelFormat.fourCC = fourCC('D', 'X', '1', '0');
+	// TEXTURE | MIPMAP | COMPLEX
+	header.caps = 0x1000 | (image.mipLevels > 1 ? 0x400000 | 0x8 : 0);
+	DDSHeaderDXT10 extension = {};
+	extension.dxgiFormat = image.format;
+	extension.resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+	extension.arraySize = 1;
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	unsigned int magic = kMagic;
+	file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(&extension), sizeof(extension));
+	for (const DDSSubresource& subresource : image.subresources) {
+		file.write(reinterpret_cast<const char*>(subresource.data), subresource.slicePitch);
+	}
+	if (!file) {
+		ERROR("DDSLoader", "save", ("Failed to write " + fileName).c_str());
+		return E_FAIL;
+	}
+	return S_OK;
+}
+
+unsigned int
+DDSLoader::bitsPerPixel(DXGI_FORMAT format) {
+	switch (format) {
+	case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+	case DXGI_FORMAT_R32G32B32A32_UINT:
+	case DXGI_FORMAT_R32G32B32A32_SINT:
+		return 128;
+
+	case DXGI_FORMAT_R32G32B32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32_FLOAT:
+	case DXGI_FORMAT_R32G32B32_UINT:
+	case DXGI_FORMAT_R32G32B32_SINT:
+		return 96;
+
+	case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+	case DXGI_FORMAT_R16G16B16A16_UINT:
+	case DXGI_FORMAT_R16G16B16A16_SNORM:
+	case DXGI_FORMAT_R16G16B16A16_SINT:
+	case DXGI_FORMAT_R32G32_TYPELESS:
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_R32G32_UINT:
+	case DXGI_FORMAT_R32G32_SINT:
+	case DXGI_FORMAT_R32G8X24_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+	case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+	case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+		return 64;
+
+	case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+	case DXGI_FORMAT_R10G10B10A2_UNORM:
+	case DXGI_FORMAT_R10G10B10A2_UINT:
+	case DXGI_FORMAT_R11G11B10_FLOAT:
+	case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_R8G8B8A8_UINT:
+	case DXGI_FORMAT_R8G8B8A8_SNORM:
+	case DXGI_FORMAT_R8G8B8A8_SINT:
+	case DXGI_FORMAT_R16G16_TYPELESS:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R16G16_UNORM:
+	case DXGI_FORMAT_R16G16_UINT:
+	case DXGI_FORMAT_R16G16_SNORM:
+	case DXGI_FORMAT_R16G16_SINT:
+	case DXGI_FORMAT_R32_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT:
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32_UINT:
+	case DXGI_FORMAT_R32_SINT:
+	case DXGI_FORMAT_R24G8_TYPELESS:
+	case DXGI_FORMAT_D24_UNORM_S8_UINT:
+	case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+	case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+	case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+	case DXGI_FORMAT_R8G8_B8G8_UNORM:
+	case DXGI_FORMAT_G8R8_G8B8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		return 32;
+
+	case DXGI_FORMAT_R8G8_TYPELESS:
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R8G8_UINT:
+	case DXGI_FORMAT_R8G8_SNORM:
+	case DXGI_FORMAT_R8G8_SINT:
+	case DXGI_FORMAT_R16_TYPELESS:
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_D16_UNORM:
+	case DXGI_FORMAT_R16_UNORM:
+	case DXGI_FORMAT_R16_UINT:
+	case DXGI_FORMAT_R16_SNORM:
+	case DXGI_FORMAT_R16_SINT:
+	case DXGI_FORMAT_B5G6R5_UNORM:
+	case DXGI_FORMAT_B5G5R5A1_UNORM:
+		return 16;
+
+	case DXGI_FORMAT_R8_TYPELESS:
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_R8_UINT:
+	case DXGI_FORMAT_R8_SNORM:
+	case DXGI_FORMAT_R8_SINT:
+	case DXGI_FORMAT_A8_UNORM:
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return 8;
+
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		return 4;
+
+	case DXGI_FORMAT_R1_UNORM:
+		return 1;
+
+	default:
+		return 0;
+	}
+}
+
+bool
+DDSLoader::surfaceInfo(DXGI_FORMAT format,
+	unsigned int width,
+	unsigned int height,
+	size_t& rowPitch,
+	size_t& rowCount) {
+	unsigned int bits = bitsPerPixel(format);
+	rowPitch = 0;
+	rowCount = 0;
+	if (bits == 0) {
+		return false;
+	}
+	bool blockCompressed = (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+		(format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+	if (blockCompressed) {
+		// Un bloque de 4x4 ocupa 16 pxeles: 8 bytes a 4 bpp, 16 bytes a 8 bpp
+		size_t blocksWide = (std::max)(1u, (width + 3) / 4);
+		rowPitch = blocksWide * bits * 2;
+		rowCount = (std::max)(1u, (height + 3) / 4);
+	}
+	else if (format == DXGI_FORMAT_R8G8_B8G8_UNORM || format == DXGI_FORMAT_G8R8_G8B8_UNORM) {
+		// Dos pxeles comparten 4 bytes
+		rowPitch = ((static_cast<size_t>(width) + 1) / 2) * 4;
+		rowCount = height;
+	}
+	else {
+		rowPitch = (static_cast<size_t>(width) * bits + 7) / 8;
+		rowCount = height;
+	}
+	return true;
+}
@@ -1,4 +1,95 @@
 #include "Device.h"
+#include "DeviceContext.h"
+#include "SoftwareRasterizer.h"
+
+/**
+ * Tamao aproximado en bytes de una textura 2D (todas las mips y slices) para la contabilidad.
+ */
+static unsigned long long
+textureBytes(const D3D11_TEXTURE2D_DESC& desc) {
+	unsigned int bitsPerPixel = 32;
+	switch (desc.Format) {
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		bitsPerPixel = 128;
+		break;
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		bitsPerPixel = 64;
+		break;
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R16_FLOAT:
+		bitsPerPixel = 16;
+		break;
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_A8_UNORM:
+		bitsPerPixel = 8;
+		break;
+	default:
+		break;
+	}
+
+	unsigned long long total = 0;
+	unsigned int mipLevels = desc.MipLevels ? desc.MipLevels : 1;
+	for (unsigned int mip = 0; mip < mipLevels; ++mip) {
+		unsigned long long width = (desc.Width >> mip) ? (desc.Width >> mip) : 1;
+		unsigned long long height = (desc.Height >> mip) ? (desc.Height >> mip) : 1;
+		total += width * height * bitsPerPixel / 8;
+	}
+	return total * desc.ArraySize * (desc.SampleDesc.Count ? desc.SampleDesc.Count : 1);
+}
+
+HRESULT
+Device::init(DeviceContext& deviceContext, D3D_DRIVER_TYPE driverType) {
+	if (m_device) {
+		ERROR("Device", "init", "Device is already initialized.");
+		return E_FAIL;
+	}
+
+	unsigned int createDeviceFlags = 0;
+#ifdef _DEBUG
+	createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+	D3D_FEATURE_LEVEL featureLevels[] = {
+		D3D_FEATURE_LEVEL_11_0,
+		D3D_FEATURE_LEVEL_10_1,
+		D3D_FEATURE_LEVEL_10_0,
+	};
+	unsigned int numFeatureLevels = ARRAYSIZE(featureLevels);
+
+	// El driver NULL depende de las capas del SDK; WARP sirve como respaldo sin GPU
+	D3D_DRIVER_TYPE driverTypes[] = { driverType, D3D_DRIVER_TYPE_WARP };
+	unsigned int numDriverTypes = (driverType == D3D_DRIVER_TYPE_WARP) ? 1 : ARRAYSIZE(driverTypes);
+
+	HRESULT hr = E_FAIL;
+	D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
+	for (unsigned int i = 0; i < numDriverTypes; ++i) {
+		hr = D3D11CreateDevice(nullptr,
+			driverTypes[i],
+			nullptr,
+			createDeviceFlags,
+			featureLevels,
+			numFeatureLevels,
+			D3D11_SDK_VERSION,
+			&m_device,
+			&featureLevel,
+			&deviceContext.m_deviceContext);
+
+		if (SUCCEEDED(hr)) {
+			m_driverType = driverTypes[i];
+			MESSAGE("Device", "init", "Headless device created successfully!");
+			break;
+		}
+	}
+
+	if (FAILED(hr)) {
+		ERROR("Device", "init",
+			("Failed to create headless D3D11 device. HRESULT: " + std::to_string(hr)).c_str());
+		return hr;
+	}
+
+	return S_OK;
+}
+
 void
 Device::destroy() {
 	SAFE_RELEASE(m_device);
@@ -19,7 +110,11 @@ Device::CreateRenderTargetView(ID3D11Resource* pResource,
 	}
 
 	// Crear el Render Target View
-	HRESULT hr = m_device->CreateRenderTargetView(pResource, pDesc, ppRTView);
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateRenderTargetView);
+		hr = m_device->CreateRenderTargetView(pResource, pDesc, ppRTView);
+	}
 
 	if (SUCCEEDED(hr)) {
 		MESSAGE("Device", "CreateRenderTargetView",
@@ -48,9 +143,24 @@ Device::CreateTexture2D(const D3D11_TEXTURE2D_DESC* pDesc,
 	}
 
 	// Crear la textura 2D
-	HRESULT hr = m_device->CreateTexture2D(pDesc, pInitialData, ppTexture2D);
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateTexture2D, textureBytes(*pDesc));
+		hr = m_device->CreateTexture2D(pDesc, pInitialData, ppTexture2D);
+	}
 
 	if (SUCCEEDED(hr)) {
+		// El backend en CPU guarda el nivel de mip 0 en RGBA8; los formatos BC se descomprimen
+		if (m_softwareRasterizer && (pDesc->BindFlags & D3D11_BIND_SHADER_RESOURCE) &&
+			SoftwareRasterizer::supportsTextureFormat(pDesc->Format)) {
+			m_softwareRasterizer->registerResource(*ppTexture2D,
+				pInitialData ? pInitialData->pSysMem : nullptr,
+				pDesc->Width * pDesc->Height * 4,
+				pDesc->Width,
+				pDesc->Height,
+				pInitialData ? pInitialData->SysMemPitch : 0,
+				pDesc->Format);
+		}
 		MESSAGE("Device", "CreateTexture2D",
 			"Texture2D created successfully!");
 	}
@@ -77,7 +187,11 @@ Device::CreateDepthStencilView(ID3D11Resource* pResource,
 	}
 
 	// Crear el Depth Stencil View
-	HRESULT hr = m_device->CreateDepthStencilView(pResource, pDesc, ppDepthStencilView);
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateDepthStencilView);
+		hr = m_device->CreateDepthStencilView(pResource, pDesc, ppDepthStencilView);
+	}
 
 	if (SUCCEEDED(hr)) {
 		MESSAGE("Device", "CreateDepthStencilView",
@@ -107,10 +221,14 @@ Device::CreateVertexShader(const void* pShaderBytecode,
 	}
 
 	// Crear el Vertex Shader
-	HRESULT hr = m_device->CreateVertexShader(pShaderBytecode,
-		BytecodeLength,
-		pClassLinkage,
-		ppVertexShader);
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateVertexShader, BytecodeLength);
+		hr = m_device->CreateVertexShader(pShaderBytecode,
+			BytecodeLength,
+			pClassLinkage,
+			ppVertexShader);
+	}
 
 	if (SUCCEEDED(hr)) {
 		MESSAGE("Device", "CreateVertexShader",
@@ -141,11 +259,15 @@ Device::CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* pInputElementDescs,
 	}
 
 	// Crear el Input Layout
-	HRESULT hr = m_device->CreateInputLayout(pInputElementDescs,
-		NumElements,
-		pShaderBytecodeWithInputSignature,
-		BytecodeLength,
-		ppInputLayout);
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateInputLayout);
+		hr = m_device->CreateInputLayout(pInputElementDescs,
+			NumElements,
+			pShaderBytecodeWithInputSignature,
+			BytecodeLength,
+			ppInputLayout);
+	}
 
 	if (SUCCEEDED(hr)) {
 		MESSAGE("Device", "CreateInputLayout",
@@ -175,10 +297,14 @@ Device::CreatePixelShader(const void* pShaderBytecode,
 	}
 
 	// Crear el Pixel Shader
-	HRESULT hr = m_device->CreatePixelShader(pShaderBytecode,
-		BytecodeLength,
-		pClassLinkage,
-		ppPixelShader);
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreatePixelShader, BytecodeLength);
+		hr = m_device->CreatePixelShader(pShaderBytecode,
+			BytecodeLength,
+			pClassLinkage,
+			ppPixelShader);
+	}
 
 	if (SUCCEEDED(hr)) {
 		MESSAGE("Device", "CreatePixelShader",
@@ -206,7 +332,11 @@ Device::CreateSamplerState(const D3D11_SAMPLER_DESC* pSamplerDesc,
 	}
 
 	// Crear el Sampler State
-	HRESULT hr = m_device->CreateSamplerState(pSamplerDesc, ppSamplerState);
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateSamplerState);
+		hr = m_device->CreateSamplerState(pSamplerDesc, ppSamplerState);
+	}
 
 	if (SUCCEEDED(hr)) {
 		MESSAGE("Device", "CreateSamplerState",
@@ -220,6 +350,102 @@ Device::CreateSamplerState(const D3D11_SAMPLER_DESC* pSamplerDesc,
 	return hr;
 }
 
+HRESULT
+Device::CreateRasterizerState(const D3D11_RASTERIZER_DESC* pRasterizerDesc,
+	ID3D11RasterizerState** ppRasterizerState) {
+	// Validar parametros de entrada
+	if (!pRasterizerDesc) {
+		ERROR("Device", "CreateRasterizerState", "pRasterizerDesc is nullptr");
+		return E_INVALIDARG;
+	}
+	if (!ppRasterizerState) {
+		ERROR("Device", "CreateRasterizerState", "ppRasterizerState is nullptr");
+		return E_POINTER;
+	}
+
+	// Crear el Rasterizer State
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateRasterizerState);
+		hr = m_device->CreateRasterizerState(pRasterizerDesc, ppRasterizerState);
+	}
+
+	if (SUCCEEDED(hr)) {
+		MESSAGE("Device", "CreateRasterizerState",
+			"Rasterizer State created successfully!");
+	}
+	else {
+		ERROR("Device", "CreateRasterizerState",
+			("Failed to create Rasterizer State. HRESULT: " + std::to_string(hr)).c_str());
+	}
+
+	return hr;
+}
+
+HRESULT
+Device::CreateBlendState(const D3D11_BLEND_DESC* pBlendStateDesc,
+	ID3D11BlendState** ppBlendState) {
+	// Validar parametros de entrada
+	if (!pBlendStateDesc) {
+		ERROR("Device", "CreateBlendState", "pBlendStateDesc is nullptr");
+		return E_INVALIDARG;
+	}
+	if (!ppBlendState) {
+		ERROR("Device", "CreateBlendState", "ppBlendState is nullptr");
+		return E_POINTER;
+	}
+
+	// Crear el Blend State
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateBlendState);
+		hr = m_device->CreateBlendState(pBlendStateDesc, ppBlendState);
+	}
+
+	if (SUCCEEDED(hr)) {
+		MESSAGE("Device", "CreateBlendState",
+			"Blend State created successfully!");
+	}
+	else {
+		ERROR("Device", "CreateBlendState",
+			("Failed to create Blend State. HRESULT: " + std::to_string(hr)).c_str());
+	}
+
+	return hr;
+}
+
+HRESULT
+Device::CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* pDepthStencilDesc,
+	ID3D11DepthStencilState** ppDepthStencilState) {
+	// Validar parametros de entrada
+	if (!pDepthStencilDesc) {
+		ERROR("Device", "CreateDepthStencilState", "pDepthStencilDesc is nullptr");
+		return E_INVALIDARG;
+	}
+	if (!ppDepthStencilState) {
+		ERROR("Device", "CreateDepthStencilState", "ppDepthStencilState is nullptr");
+		return E_POINTER;
+	}
+
+	// Crear el Depth Stencil State
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateDepthStencilState);
+		hr = m_device->CreateDepthStencilState(pDepthStencilDesc, ppDepthStencilState);
+	}
+
+	if (SUCCEEDED(hr)) {
+		MESSAGE("Device", "CreateDepthStencilState",
+			"Depth Stencil State created successfully!");
+	}
+	else {
+		ERROR("Device", "CreateDepthStencilState",
+			("Failed to create Depth Stencil State. HRESULT: " + std::to_string(hr)).c_str());
+	}
+
+	return hr;
+}
+
 HRESULT
 Device::CreateBuffer(const D3D11_BUFFER_DESC* pDesc,
 	const D3D11_SUBRESOURCE_DATA* pInitialData,
@@ -235,9 +461,18 @@ Device::CreateBuffer(const D3D11_BUFFER_DESC* pDesc,
 	}
 
 	// Crear el Buffer
-	HRESULT hr = m_device->CreateBuffer(pDesc, pInitialData, ppBuffer);
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateBuffer, pDesc->ByteWidth);
+		hr = m_device->CreateBuffer(pDesc, pInitialData, ppBuffer);
+	}
 
 	if (SUCCEEDED(hr)) {
+		if (m_softwareRasterizer) {
+			m_softwareRasterizer->registerResource(*ppBuffer,
+				pInitialData ? pInitialData->pSysMem : nullptr,
+				pDesc->ByteWidth);
+		}
 		MESSAGE("Device", "CreateBuffer",
 			"Buffer created successfully!");
 	}
@@ -247,4 +482,92 @@ Device::CreateBuffer(const D3D11_BUFFER_DESC* pDesc,
 
 	}
 	return hr;
-}
\ No newline at end of file
+}
+
+HRESULT
+Device::CreateShaderResourceView(ID3D11Resource* pResource,
+	const D3D11_SHADER_RESOURCE_VIEW_DESC* pDesc,
+	ID3D11ShaderResourceView** ppSRView) {
+	// Validar parametros de entrada
+	if (!pResource) {
+		ERROR("Device", "CreateShaderResourceView", "pResource is nullptr");
+		return E_INVALIDARG;
+	}
+	if (!ppSRView) {
+		ERROR("Device", "CreateShaderResourceView", "ppSRView is nullptr");
+		return E_POINTER;
+	}
+
+	// Crear la Shader Resource View
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateShaderResourceView);
+		hr = m_device->CreateShaderResourceView(pResource, pDesc, ppSRView);
+	}
+
+	if (SUCCEEDED(hr)) {
+		MESSAGE("Device", "CreateShaderResourceView",
+			"Shader Resource View created successfully!");
+	}
+	else {
+		ERROR("Device", "CreateShaderResourceView",
+			("Failed to create Shader Resource View. HRESULT: " + std::to_string(hr)).c_str());
+	}
+
+	return hr;
+}
+
+HRESULT
+Device::CreateDeferredContext(unsigned int ContextFlags,
+	ID3D11DeviceContext** ppDeferredContext) {
+	// Validar parametros de entrada
+	if (!ppDeferredContext) {
+		ERROR("Device", "CreateDeferredContext", "ppDeferredContext is nullptr");
+		return E_POINTER;
+	}
+
+	// Crear el contexto diferido
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateDeferredContext);
+		hr = m_device->CreateDeferredContext(ContextFlags, ppDeferredContext);
+	}
+
+	if (SUCCEEDED(hr)) {
+		MESSAGE("Device", "CreateDeferredContext",
+			"Deferred Context created successfully!");
+	}
+	else {
+		ERROR("Device", "CreateDeferredContext",
+			("Failed to create Deferred Context. HRESULT: " + std::to_string(hr)).c_str());
+	}
+
+	return hr;
+}
+
+HRESULT
+Device::CreateQuery(const D3D11_QUERY_DESC* pQueryDesc,
+	ID3D11Query** ppQuery) {
+	// Validar parametros de entrada
+	if (!pQueryDesc) {
+		ERROR("Device", "CreateQuery", "pQueryDesc is nullptr");
+		return E_INVALIDARG;
+	}
+	if (!ppQuery) {
+		ERROR("Device", "CreateQuery", "ppQuery is nullptr");
+		return E_POINTER;
+	}
+
+	// Crear la consulta
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::CreateQuery);
+		hr = m_device->CreateQuery(pQueryDesc, ppQuery);
+	}
+
+	if (FAILED(hr)) {
+		ERROR("Device", "CreateQuery",
+			("Failed to create Query. HRESULT: " + std::to_string(hr)).c_str());
+	}
+	return hr;
+}
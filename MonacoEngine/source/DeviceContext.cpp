@@ -1,8 +1,144 @@
 #include "DeviceContext.h"
+#include "SoftwareRasterizer.h"
+#include "CommandList.h"
+
+/**
+ * Bytes que copia un @c UpdateSubresource, para la contabilidad de transferencias.
+ */
+static unsigned long long
+subresourceBytes(ID3D11Resource* pDstResource,
+	unsigned int DstSubresource,
+	const D3D11_BOX* pDstBox,
+	unsigned int SrcRowPitch,
+	unsigned int SrcDepthPitch) {
+	D3D11_RESOURCE_DIMENSION dimension = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+	pDstResource->GetType(&dimension);
+
+	if (dimension == D3D11_RESOURCE_DIMENSION_BUFFER) {
+		if (pDstBox) {
+			return pDstBox->right - pDstBox->left;
+		}
+		D3D11_BUFFER_DESC desc;
+		static_cast<ID3D11Buffer*>(pDstResource)->GetDesc(&desc);
+		return desc.ByteWidth;
+	}
+	if (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE2D) {
+		unsigned long long rows = 0;
+		if (pDstBox) {
+			rows = pDstBox->bottom - pDstBox->top;
+		}
+		else {
+			D3D11_TEXTURE2D_DESC desc;
+			static_cast<ID3D11Texture2D*>(pDstResource)->GetDesc(&desc);
+			unsigned int mip = DstSubresource % (desc.MipLevels ? desc.MipLevels : 1);
+			rows = (desc.Height >> mip) ? (desc.Height >> mip) : 1;
+		}
+		return rows * SrcRowPitch;
+	}
+	return SrcDepthPitch;
+}
 
 void
 DeviceContext::destroy() {
 	SAFE_RELEASE(m_deviceContext);
+	resetShadowState();
+}
+
+void
+DeviceContext::resetState() {
+	if (m_deviceContext) {
+		m_deviceContext->ClearState();
+	}
+	resetShadowState();
+}
+
+void
+DeviceContext::resetShadowState() {
+	m_inputLayout = nullptr;
+	m_vertexShader = nullptr;
+	m_pixelShader = nullptr;
+	m_rasterizerState = nullptr;
+	m_blendState = nullptr;
+	for (float& factor : m_blendFactor) {
+		factor = 1.0f;
+	}
+	m_sampleMask = 0xffffffff;
+	m_depthStencilState = nullptr;
+	m_stencilRef = 0;
+	m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+	m_indexBuffer = nullptr;
+	m_indexFormat = DXGI_FORMAT_UNKNOWN;
+	m_indexOffset = 0;
+	for (unsigned int i = 0; i < D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT; ++i) {
+		m_vertexBuffers[i] = nullptr;
+		m_vertexStrides[i] = 0;
+		m_vertexOffsets[i] = 0;
+	}
+	m_viewportCount = 0;
+	m_renderTargetCount = 0;
+	for (ID3D11RenderTargetView*& renderTarget : m_renderTargets) {
+		renderTarget = nullptr;
+	}
+	m_depthStencil = nullptr;
+	m_vsConstantBuffers.reset();
+	m_psConstantBuffers.reset();
+	m_psShaderResources.reset();
+	m_psSamplers.reset();
+}
+
+void
+DeviceContext::flushBindings() {
+	unsigned int first = 0;
+	unsigned int count = 0;
+
+	if (m_vsConstantBuffers.pendingCalls > 0) {
+		if (m_vsConstantBuffers.dirtyRange(first, count)) {
+			m_stats.recordElided(GraphicsCall::VSSetConstantBuffers, m_vsConstantBuffers.pendingCalls - 1);
+			ScopedCallTimer timer(m_stats, GraphicsCall::VSSetConstantBuffers);
+			m_deviceContext->VSSetConstantBuffers(first, count, &m_vsConstantBuffers.pending[first]);
+		}
+		else {
+			m_stats.recordElided(GraphicsCall::VSSetConstantBuffers, m_vsConstantBuffers.pendingCalls);
+		}
+		m_vsConstantBuffers.commit(first, count);
+	}
+
+	if (m_psConstantBuffers.pendingCalls > 0) {
+		if (m_psConstantBuffers.dirtyRange(first, count)) {
+			m_stats.recordElided(GraphicsCall::PSSetConstantBuffers, m_psConstantBuffers.pendingCalls - 1);
+			ScopedCallTimer timer(m_stats, GraphicsCall::PSSetConstantBuffers);
+			m_deviceContext->PSSetConstantBuffers(first, count, &m_psConstantBuffers.pending[first]);
+		}
+		else {
+			m_stats.recordElided(GraphicsCall::PSSetConstantBuffers, m_psConstantBuffers.pendingCalls);
+		}
+		m_psConstantBuffers.commit(first, count);
+	}
+
+	if (m_psShaderResources.pendingCalls > 0) {
+		if (m_psShaderResources.dirtyRange(first, count)) {
+			m_stats.recordElided(GraphicsCall::PSSetShaderResources, m_psShaderResources.pendingCalls - 1);
+			ScopedCallTimer timer(m_stats, GraphicsCall::PSSetShaderResources);
+			m_deviceContext->PSSetShaderResources(first, count, &m_psShaderResources.pending[first]);
+		}
+		else {
+			m_stats.recordElided(GraphicsCall::PSSetShaderResources, m_psShaderResources.pendingCalls);
+		}
+		m_psShaderResources.commit(first, count);
+		dropOutputBoundShaderResources();
+	}
+
+	if (m_psSamplers.pendingCalls > 0) {
+		if (m_psSamplers.dirtyRange(first, count)) {
+			m_stats.recordElided(GraphicsCall::PSSetSamplers, m_psSamplers.pendingCalls - 1);
+			ScopedCallTimer timer(m_stats, GraphicsCall::PSSetSamplers);
+			m_deviceContext->PSSetSamplers(first, count, &m_psSamplers.pending[first]);
+		}
+		else {
+			m_stats.recordElided(GraphicsCall::PSSetSamplers, m_psSamplers.pendingCalls);
+		}
+		m_psSamplers.commit(first, count);
+	}
 }
 
 void
@@ -12,6 +148,23 @@ DeviceContext::RSSetViewports(unsigned int NumViewports,
 		ERROR("DeviceContext", "RSSetViewports", "pViewports is nullptr");
 		return;
 	}
+	if (m_recorder) {
+		m_recorder->RSSetViewports(NumViewports, pViewports);
+		return;
+	}
+	if (m_softwareRasterizer) {
+		m_softwareRasterizer->setViewport(pViewports[0]);
+	}
+	if (m_filterRedundantState && NumViewports <= D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE) {
+		if (NumViewports == m_viewportCount &&
+			memcmp(m_viewports, pViewports, NumViewports * sizeof(D3D11_VIEWPORT)) == 0) {
+			m_stats.recordElided(GraphicsCall::RSSetViewports);
+			return;
+		}
+		m_viewportCount = NumViewports;
+		memcpy(m_viewports, pViewports, NumViewports * sizeof(D3D11_VIEWPORT));
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::RSSetViewports);
 	m_deviceContext->RSSetViewports(NumViewports, pViewports);
 }
 
@@ -23,6 +176,27 @@ DeviceContext::PSSetShaderResources(unsigned int StartSlot,
 		ERROR("DeviceContext", "PSSetShaderResources", "ppShaderResourceViews is nullptr");
 		return;
 	}
+	if (m_recorder) {
+		m_recorder->PSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
+		return;
+	}
+	if (m_softwareRasterizer) {
+		for (unsigned int i = 0; i < NumViews; ++i) {
+			m_softwareRasterizer->setPSShaderResource(StartSlot + i, ppShaderResourceViews[i]);
+		}
+	}
+	if (m_filterRedundantState) {
+		if (StartSlot + NumViews > D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT) {
+			ERROR("DeviceContext", "PSSetShaderResources", "Slot range exceeds the pipeline limit");
+			return;
+		}
+		// Se difiere hasta el draw para combinar slots contiguos en una sola llamada
+		if (!m_psShaderResources.stage(StartSlot, NumViews, ppShaderResourceViews)) {
+			m_stats.recordElided(GraphicsCall::PSSetShaderResources);
+		}
+		return;
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::PSSetShaderResources);
 	m_deviceContext->PSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
 }
 
@@ -32,6 +206,18 @@ DeviceContext::IASetInputLayout(ID3D11InputLayout* pInputLayout) {
 		ERROR("DeviceContext", "IASetInputLayout", "pInputLayout is nullptr");
 		return;
 	}
+	if (m_recorder) {
+		m_recorder->IASetInputLayout(pInputLayout);
+		return;
+	}
+	if (m_filterRedundantState) {
+		if (m_inputLayout == pInputLayout) {
+			m_stats.recordElided(GraphicsCall::IASetInputLayout);
+			return;
+		}
+		m_inputLayout = pInputLayout;
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::IASetInputLayout);
 	m_deviceContext->IASetInputLayout(pInputLayout);
 }
 
@@ -43,6 +229,19 @@ DeviceContext::VSSetShader(ID3D11VertexShader* pVertexShader,
 		ERROR("DeviceContext", "VSSetShader", "pVertexShader is nullptr");
 		return;
 	}
+	if (m_recorder) {
+		m_recorder->VSSetShader(pVertexShader, ppClassInstances, NumClassInstances);
+		return;
+	}
+	// Con class instances el estado incluye la vinculacin dinmica; no se filtra
+	if (m_filterRedundantState) {
+		if (m_vertexShader == pVertexShader && NumClassInstances == 0) {
+			m_stats.recordElided(GraphicsCall::VSSetShader);
+			return;
+		}
+		m_vertexShader = (NumClassInstances == 0) ? pVertexShader : nullptr;
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::VSSetShader);
 	m_deviceContext->VSSetShader(pVertexShader, ppClassInstances, NumClassInstances);
 }
 
@@ -54,6 +253,19 @@ DeviceContext::PSSetShader(ID3D11PixelShader* pPixelShader,
 		ERROR("DeviceContext", "PSSetShader", "pPixelShader is nullptr");
 		return;
 	}
+	if (m_recorder) {
+		m_recorder->PSSetShader(pPixelShader, ppClassInstances, NumClassInstances);
+		return;
+	}
+	// Con class instances el estado incluye la vinculacin dinmica; no se filtra
+	if (m_filterRedundantState) {
+		if (m_pixelShader == pPixelShader && NumClassInstances == 0) {
+			m_stats.recordElided(GraphicsCall::PSSetShader);
+			return;
+		}
+		m_pixelShader = (NumClassInstances == 0) ? pPixelShader : nullptr;
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::PSSetShader);
 	m_deviceContext->PSSetShader(pPixelShader, ppClassInstances, NumClassInstances);
 }
 
@@ -69,6 +281,25 @@ DeviceContext::UpdateSubresource(ID3D11Resource* pDstResource,
 			"Invalid arguments: pDstResource or pSrcData is nullptr");
 		return;
 	}
+	unsigned long long bytes = subresourceBytes(pDstResource,
+		DstSubresource,
+		pDstBox,
+		SrcRowPitch,
+		SrcDepthPitch);
+	if (m_recorder) {
+		m_recorder->UpdateSubresource(pDstResource,
+			DstSubresource,
+			pDstBox,
+			pSrcData,
+			SrcRowPitch,
+			SrcDepthPitch,
+			bytes);
+		return;
+	}
+	if (m_softwareRasterizer && DstSubresource == 0) {
+		m_softwareRasterizer->updateResource(pDstResource, pDstBox, pSrcData, SrcRowPitch);
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::UpdateSubresource, bytes);
 	m_deviceContext->UpdateSubresource(pDstResource,
 		DstSubresource,
 		pDstBox,
@@ -77,6 +308,61 @@ DeviceContext::UpdateSubresource(ID3D11Resource* pDstResource,
 		SrcDepthPitch);
 }
 
+void
+DeviceContext::CopySubresourceRegion(ID3D11Resource* pDstResource,
+	unsigned int DstSubresource,
+	unsigned int DstX,
+	unsigned int DstY,
+	unsigned int DstZ,
+	ID3D11Resource* pSrcResource,
+	unsigned int SrcSubresource,
+	const D3D11_BOX* pSrcBox) {
+	// Validar parmetros
+	if (!pDstResource || !pSrcResource) {
+		ERROR("DeviceContext", "CopySubresourceRegion",
+			"Invalid arguments: pDstResource or pSrcResource is nullptr");
+		return;
+	}
+	if (m_recorder) {
+		ERROR("DeviceContext", "CopySubresourceRegion",
+			"CopySubresourceRegion cannot be recorded in a portable command list");
+		return;
+	}
+
+	unsigned long long bytes = 0;
+	D3D11_RESOURCE_DIMENSION dimension = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+	pSrcResource->GetType(&dimension);
+	if (dimension == D3D11_RESOURCE_DIMENSION_BUFFER) {
+		bytes = subresourceBytes(pSrcResource, SrcSubresource, pSrcBox, 0, 0);
+		if (m_softwareRasterizer) {
+			m_softwareRasterizer->copyBufferRegion(pDstResource,
+				DstX,
+				pSrcResource,
+				pSrcBox ? pSrcBox->left : 0,
+				static_cast<unsigned int>(bytes));
+		}
+	}
+	else if (m_softwareRasterizer && dimension == D3D11_RESOURCE_DIMENSION_TEXTURE2D && DstSubresource == 0) {
+		// La copia en CPU solo tiene el nivel 0 del destino
+		m_softwareRasterizer->copyTextureRegion(pDstResource,
+			DstX,
+			DstY,
+			pSrcResource,
+			SrcSubresource,
+			pSrcBox);
+	}
+
+	ScopedCallTimer timer(m_stats, GraphicsCall::CopySubresourceRegion, bytes);
+	m_deviceContext->CopySubresourceRegion(pDstResource,
+		DstSubresource,
+		DstX,
+		DstY,
+		DstZ,
+		pSrcResource,
+		SrcSubresource,
+		pSrcBox);
+}
+
 void
 DeviceContext::IASetVertexBuffers(unsigned int StartSlot,
 	unsigned int NumBuffers,
@@ -88,6 +374,32 @@ DeviceContext::IASetVertexBuffers(unsigned int StartSlot,
 			"Invalid arguments: ppVertexBuffers, pStrides, or pOffsets is nullptr");
 		return;
 	}
+	if (m_recorder) {
+		m_recorder->IASetVertexBuffers(StartSlot, NumBuffers, ppVertexBuffers, pStrides, pOffsets);
+		return;
+	}
+	if (m_softwareRasterizer && StartSlot == 0 && NumBuffers > 0) {
+		m_softwareRasterizer->setVertexBuffer(ppVertexBuffers[0], pStrides[0], pOffsets[0]);
+	}
+	if (m_filterRedundantState && StartSlot + NumBuffers <= D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT) {
+		bool changed = false;
+		for (unsigned int i = 0; i < NumBuffers; ++i) {
+			unsigned int slot = StartSlot + i;
+			if (m_vertexBuffers[slot] != ppVertexBuffers[i] ||
+				m_vertexStrides[slot] != pStrides[i] ||
+				m_vertexOffsets[slot] != pOffsets[i]) {
+				m_vertexBuffers[slot] = ppVertexBuffers[i];
+				m_vertexStrides[slot] = pStrides[i];
+				m_vertexOffsets[slot] = pOffsets[i];
+				changed = true;
+			}
+		}
+		if (!changed) {
+			m_stats.recordElided(GraphicsCall::IASetVertexBuffers);
+			return;
+		}
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::IASetVertexBuffers);
 	m_deviceContext->IASetVertexBuffers(StartSlot,
 		NumBuffers,
 		ppVertexBuffers,
@@ -103,6 +415,23 @@ DeviceContext::IASetIndexBuffer(ID3D11Buffer* pIndexBuffer,
 		ERROR("DeviceContext", "IASetIndexBuffer", "pIndexBuffer is nullptr");
 		return;
 	}
+	if (m_recorder) {
+		m_recorder->IASetIndexBuffer(pIndexBuffer, Format, Offset);
+		return;
+	}
+	if (m_softwareRasterizer) {
+		m_softwareRasterizer->setIndexBuffer(pIndexBuffer, Format, Offset);
+	}
+	if (m_filterRedundantState) {
+		if (m_indexBuffer == pIndexBuffer && m_indexFormat == Format && m_indexOffset == Offset) {
+			m_stats.recordElided(GraphicsCall::IASetIndexBuffer);
+			return;
+		}
+		m_indexBuffer = pIndexBuffer;
+		m_indexFormat = Format;
+		m_indexOffset = Offset;
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::IASetIndexBuffer);
 	m_deviceContext->IASetIndexBuffer(pIndexBuffer, Format, Offset);
 }
 
@@ -114,6 +443,22 @@ DeviceContext::PSSetSamplers(unsigned int StartSlot,
 		ERROR("DeviceContext", "PSSetSamplers", "ppSamplers is nullptr");
 		return;
 	}
+	if (m_recorder) {
+		m_recorder->PSSetSamplers(StartSlot, NumSamplers, ppSamplers);
+		return;
+	}
+	if (m_filterRedundantState) {
+		if (StartSlot + NumSamplers > D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT) {
+			ERROR("DeviceContext", "PSSetSamplers", "Slot range exceeds the pipeline limit");
+			return;
+		}
+		// Se difiere hasta el draw para combinar slots contiguos en una sola llamada
+		if (!m_psSamplers.stage(StartSlot, NumSamplers, ppSamplers)) {
+			m_stats.recordElided(GraphicsCall::PSSetSamplers);
+		}
+		return;
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::PSSetSamplers);
 	m_deviceContext->PSSetSamplers(StartSlot, NumSamplers, ppSamplers);
 }
 
@@ -123,6 +468,18 @@ DeviceContext::RSSetState(ID3D11RasterizerState* pRasterizerState) {
 		ERROR("DeviceContext", "RSSetState", "pRasterizerState is nullptr");
 		return;
 	}
+	if (m_recorder) {
+		m_recorder->RSSetState(pRasterizerState);
+		return;
+	}
+	if (m_filterRedundantState) {
+		if (m_rasterizerState == pRasterizerState) {
+			m_stats.recordElided(GraphicsCall::RSSetState);
+			return;
+		}
+		m_rasterizerState = pRasterizerState;
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::RSSetState);
 	m_deviceContext->RSSetState(pRasterizerState);
 }
 
@@ -130,13 +487,50 @@ void
 DeviceContext::OMSetBlendState(ID3D11BlendState* pBlendState,
 	const float BlendFactor[4],
 	unsigned int SampleMask) {
-	if (!pBlendState) {
-		ERROR("DeviceContext", "OMSetBlendState", "pBlendState is nullptr");
+	// nullptr es vlido: asigna el estado por defecto (sin blending) y se filtra como cualquier otro
+	if (m_recorder) {
+		m_recorder->OMSetBlendState(pBlendState, BlendFactor, SampleMask);
 		return;
 	}
+	if (m_filterRedundantState) {
+		const float defaultFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		const float* factor = BlendFactor ? BlendFactor : defaultFactor;
+		if (m_blendState == pBlendState && m_sampleMask == SampleMask &&
+			memcmp(m_blendFactor, factor, sizeof(m_blendFactor)) == 0) {
+			m_stats.recordElided(GraphicsCall::OMSetBlendState);
+			return;
+		}
+		m_blendState = pBlendState;
+		m_sampleMask = SampleMask;
+		memcpy(m_blendFactor, factor, sizeof(m_blendFactor));
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::OMSetBlendState);
 	m_deviceContext->OMSetBlendState(pBlendState, BlendFactor, SampleMask);
 }
 
+void
+DeviceContext::OMSetDepthStencilState(ID3D11DepthStencilState* pDepthStencilState,
+	unsigned int StencilRef) {
+	if (!pDepthStencilState) {
+		ERROR("DeviceContext", "OMSetDepthStencilState", "pDepthStencilState is nullptr");
+		return;
+	}
+	if (m_recorder) {
+		m_recorder->OMSetDepthStencilState(pDepthStencilState, StencilRef);
+		return;
+	}
+	if (m_filterRedundantState) {
+		if (m_depthStencilState == pDepthStencilState && m_stencilRef == StencilRef) {
+			m_stats.recordElided(GraphicsCall::OMSetDepthStencilState);
+			return;
+		}
+		m_depthStencilState = pDepthStencilState;
+		m_stencilRef = StencilRef;
+	}
+	ScopedCallTimer timer(m_stats, GraphicsCall::OMSetDepthStencilState);
+	m_deviceContext->OMSetDepthStencilState(pDepthStencilState, StencilRef);
+}
+
 void
 DeviceContext::OMSetRenderTargets(unsigned int NumViews,
 	ID3D11RenderTargetView* const* ppRenderTargetViews,
@@ -154,10 +548,71 @@ DeviceContext::OMSetRenderTargets(unsigned int NumViews,
 		return;
 	}
 
+	if (m_recorder) {
+		m_recorder->OMSetRenderTargets(NumViews, ppRenderTargetViews, pDepthStencilView);
+		return;
+	}
+	if (m_filterRedundantState && NumViews <= D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT) {
+		bool changed = (NumViews != m_renderTargetCount) || (pDepthStencilView != m_depthStencil);
+		for (unsigned int i = 0; i < NumViews && !changed; ++i) {
+			changed = (m_renderTargets[i] != ppRenderTargetViews[i]);
+		}
+		if (!changed) {
+			m_stats.recordElided(GraphicsCall::OMSetRenderTargets);
+			return;
+		}
+		// Las SRVs pendientes deben llegar antes para conservar el orden de desvinculacin del runtime
+		flushBindings();
+		m_renderTargetCount = NumViews;
+		for (unsigned int i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i) {
+			m_renderTargets[i] = (i < NumViews) ? ppRenderTargetViews[i] : nullptr;
+		}
+		m_depthStencil = pDepthStencilView;
+		dropOutputBoundShaderResources();
+	}
+
 	// Asignar los render targets y el depth stencil
+	ScopedCallTimer timer(m_stats, GraphicsCall::OMSetRenderTargets);
 	m_deviceContext->OMSetRenderTargets(NumViews, ppRenderTargetViews, pDepthStencilView);
 }
 
+void
+DeviceContext::dropOutputBoundShaderResources() {
+	ID3D11Resource* outputs[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT + 1] = {};
+	unsigned int outputCount = 0;
+	// Solo se comparan direcciones: las vistas guardadas mantienen vivos sus recursos
+	for (unsigned int i = 0; i <= m_renderTargetCount; ++i) {
+		ID3D11View* view = i < m_renderTargetCount ? static_cast<ID3D11View*>(m_renderTargets[i]) : m_depthStencil;
+		if (!view) {
+			continue;
+		}
+		ID3D11Resource* resource = nullptr;
+		view->GetResource(&resource);
+		outputs[outputCount++] = resource;
+		SAFE_RELEASE(resource);
+	}
+	if (outputCount == 0) {
+		return;
+	}
+	for (unsigned int slot = 0; slot < D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT; ++slot) {
+		ID3D11ShaderResourceView* view = m_psShaderResources.bound[slot];
+		if (!view) {
+			continue;
+		}
+		ID3D11Resource* resource = nullptr;
+		view->GetResource(&resource);
+		ID3D11Resource* address = resource;
+		SAFE_RELEASE(resource);
+		for (unsigned int i = 0; i < outputCount; ++i) {
+			if (outputs[i] == address) {
+				m_psShaderResources.bound[slot] = nullptr;
+				m_psShaderResources.pending[slot] = nullptr;
+				break;
+			}
+		}
+	}
+}
+
 void
 DeviceContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY Topology) {
 	// Validar el parmetro Topology
@@ -167,7 +622,24 @@ DeviceContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY Topology) {
 		return;
 	}
 
+	if (m_recorder) {
+		m_recorder->IASetPrimitiveTopology(Topology);
+		return;
+	}
+	if (m_softwareRasterizer) {
+		m_softwareRasterizer->setTopology(Topology);
+	}
+
+	if (m_filterRedundantState) {
+		if (m_topology == Topology) {
+			m_stats.recordElided(GraphicsCall::IASetPrimitiveTopology);
+			return;
+		}
+		m_topology = Topology;
+	}
+
 	// Asignar la topologa al Input Assembler
+	ScopedCallTimer timer(m_stats, GraphicsCall::IASetPrimitiveTopology);
 	m_deviceContext->IASetPrimitiveTopology(Topology);
 }
 
@@ -184,7 +656,16 @@ DeviceContext::ClearRenderTargetView(ID3D11RenderTargetView* pRenderTargetView,
 		return;
 	}
 
+	if (m_recorder) {
+		m_recorder->ClearRenderTargetView(pRenderTargetView, ColorRGBA);
+		return;
+	}
+	if (m_softwareRasterizer) {
+		m_softwareRasterizer->clearColor(ColorRGBA);
+	}
+
 	// Limpiar el render target
+	ScopedCallTimer timer(m_stats, GraphicsCall::ClearRenderTargetView);
 	m_deviceContext->ClearRenderTargetView(pRenderTargetView, ColorRGBA);
 }
 
@@ -207,7 +688,16 @@ DeviceContext::ClearDepthStencilView(ID3D11DepthStencilView* pDepthStencilView,
 		return;
 	}
 
+	if (m_recorder) {
+		m_recorder->ClearDepthStencilView(pDepthStencilView, ClearFlags, Depth, Stencil);
+		return;
+	}
+	if (m_softwareRasterizer && (ClearFlags & D3D11_CLEAR_DEPTH)) {
+		m_softwareRasterizer->clearDepth(Depth);
+	}
+
 	// Limpiar el depth stencil
+	ScopedCallTimer timer(m_stats, GraphicsCall::ClearDepthStencilView);
 	m_deviceContext->ClearDepthStencilView(pDepthStencilView, ClearFlags, Depth, Stencil);
 }
 
@@ -221,7 +711,30 @@ DeviceContext::VSSetConstantBuffers(unsigned int StartSlot,
 		return;
 	}
 
+	if (m_recorder) {
+		m_recorder->VSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
+		return;
+	}
+	if (m_softwareRasterizer) {
+		for (unsigned int i = 0; i < NumBuffers; ++i) {
+			m_softwareRasterizer->setVSConstantBuffer(StartSlot + i, ppConstantBuffers[i]);
+		}
+	}
+
+	if (m_filterRedundantState) {
+		if (StartSlot + NumBuffers > D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT) {
+			ERROR("DeviceContext", "VSSetConstantBuffers", "Slot range exceeds the pipeline limit");
+			return;
+		}
+		// Se difiere hasta el draw para combinar slots contiguos en una sola llamada
+		if (!m_vsConstantBuffers.stage(StartSlot, NumBuffers, ppConstantBuffers)) {
+			m_stats.recordElided(GraphicsCall::VSSetConstantBuffers);
+		}
+		return;
+	}
+
 	// Asignar los constant buffers al vertex shader
+	ScopedCallTimer timer(m_stats, GraphicsCall::VSSetConstantBuffers);
 	m_deviceContext->VSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
 }
 
@@ -235,7 +748,30 @@ DeviceContext::PSSetConstantBuffers(unsigned int StartSlot,
 		return;
 	}
 
+	if (m_recorder) {
+		m_recorder->PSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
+		return;
+	}
+	if (m_softwareRasterizer) {
+		for (unsigned int i = 0; i < NumBuffers; ++i) {
+			m_softwareRasterizer->setPSConstantBuffer(StartSlot + i, ppConstantBuffers[i]);
+		}
+	}
+
+	if (m_filterRedundantState) {
+		if (StartSlot + NumBuffers > D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT) {
+			ERROR("DeviceContext", "PSSetConstantBuffers", "Slot range exceeds the pipeline limit");
+			return;
+		}
+		// Se difiere hasta el draw para combinar slots contiguos en una sola llamada
+		if (!m_psConstantBuffers.stage(StartSlot, NumBuffers, ppConstantBuffers)) {
+			m_stats.recordElided(GraphicsCall::PSSetConstantBuffers);
+		}
+		return;
+	}
+
 	// Asignar los constant buffers al pixel shader
+	ScopedCallTimer timer(m_stats, GraphicsCall::PSSetConstantBuffers);
 	m_deviceContext->PSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
 }
 
@@ -249,6 +785,181 @@ DeviceContext::DrawIndexed(unsigned int IndexCount,
 		return;
 	}
 
+	if (m_recorder) {
+		m_recorder->DrawIndexed(IndexCount, StartIndexLocation, BaseVertexLocation);
+		return;
+	}
+	if (m_softwareRasterizer) {
+		m_softwareRasterizer->drawIndexed(IndexCount, StartIndexLocation, BaseVertexLocation);
+	}
+
+	// Enviar los slots pendientes antes del draw
+	flushBindings();
+
 	// Ejecutar el dibujo
+	ScopedCallTimer timer(m_stats, GraphicsCall::DrawIndexed);
 	m_deviceContext->DrawIndexed(IndexCount, StartIndexLocation, BaseVertexLocation);
-}
\ No newline at end of file
+}
+
+void
+DeviceContext::DrawIndexedInstanced(unsigned int IndexCountPerInstance,
+	unsigned int InstanceCount,
+	unsigned int StartIndexLocation,
+	int BaseVertexLocation,
+	unsigned int StartInstanceLocation) {
+	// Validar parmetros
+	if (IndexCountPerInstance == 0 || InstanceCount == 0) {
+		ERROR("DeviceContext", "DrawIndexedInstanced", "IndexCountPerInstance or InstanceCount is zero");
+		return;
+	}
+
+	if (m_recorder) {
+		m_recorder->DrawIndexedInstanced(IndexCountPerInstance,
+			InstanceCount,
+			StartIndexLocation,
+			BaseVertexLocation,
+			StartInstanceLocation);
+		return;
+	}
+
+	// Enviar los slots pendientes antes del draw
+	flushBindings();
+
+	// Ejecutar el dibujo
+	ScopedCallTimer timer(m_stats, GraphicsCall::DrawIndexedInstanced);
+	m_deviceContext->DrawIndexedInstanced(IndexCountPerInstance,
+		InstanceCount,
+		StartIndexLocation,
+		BaseVertexLocation,
+		StartInstanceLocation);
+}
+
+HRESULT
+DeviceContext::FinishCommandList(BOOL RestoreDeferredContextState,
+	ID3D11CommandList** ppCommandList) {
+	// Validar parmetros
+	if (!ppCommandList) {
+		ERROR("DeviceContext", "FinishCommandList", "ppCommandList is nullptr");
+		return E_POINTER;
+	}
+
+	// Cerrar la grabacin del contexto diferido
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::FinishCommandList);
+		hr = m_deviceContext->FinishCommandList(RestoreDeferredContextState, ppCommandList);
+	}
+	// Sin restaurar, el contexto diferido vuelve al estado por defecto
+	if (!RestoreDeferredContextState) {
+		resetShadowState();
+	}
+	return hr;
+}
+
+void
+DeviceContext::ExecuteCommandList(ID3D11CommandList* pCommandList,
+	BOOL RestoreContextState) {
+	// Validar parmetros
+	if (!pCommandList) {
+		ERROR("DeviceContext", "ExecuteCommandList", "pCommandList is nullptr");
+		return;
+	}
+
+	// Ejecutar la lista grabada
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::ExecuteCommandList);
+		m_deviceContext->ExecuteCommandList(pCommandList, RestoreContextState);
+	}
+	// Sin restaurar, el runtime limpia el estado del contexto inmediato tras la lista
+	if (!RestoreContextState) {
+		resetShadowState();
+	}
+}
+
+HRESULT
+DeviceContext::Map(ID3D11Resource* pResource,
+	unsigned int Subresource,
+	D3D11_MAP MapType,
+	unsigned int MapFlags,
+	D3D11_MAPPED_SUBRESOURCE* pMappedResource) {
+	// Validar parmetros
+	if (!pResource || !pMappedResource) {
+		ERROR("DeviceContext", "Map",
+			"Invalid arguments: pResource or pMappedResource is nullptr");
+		return E_INVALIDARG;
+	}
+	if (m_recorder) {
+		ERROR("DeviceContext", "Map", "Map cannot be recorded in a portable command list");
+		return E_FAIL;
+	}
+
+	HRESULT hr = S_OK;
+	{
+		ScopedCallTimer timer(m_stats, GraphicsCall::Map);
+		hr = m_deviceContext->Map(pResource, Subresource, MapType, MapFlags, pMappedResource);
+	}
+	if (SUCCEEDED(hr) && m_softwareRasterizer && Subresource == 0) {
+		m_mappedResource = pResource;
+		m_mappedData = pMappedResource->pData;
+	}
+	return hr;
+}
+
+void
+DeviceContext::Unmap(ID3D11Resource* pResource,
+	unsigned int Subresource) {
+	// Validar parmetros
+	if (!pResource) {
+		ERROR("DeviceContext", "Unmap", "pResource is nullptr");
+		return;
+	}
+
+	// Lo escrito en un buffer solo es visible para el rasterizador en CPU a travs de su copia
+	unsigned long long bytes = 0;
+	D3D11_RESOURCE_DIMENSION dimension = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+	pResource->GetType(&dimension);
+	if (dimension == D3D11_RESOURCE_DIMENSION_BUFFER) {
+		bytes = subresourceBytes(pResource, Subresource, nullptr, 0, 0);
+		if (m_softwareRasterizer && pResource == m_mappedResource && m_mappedData) {
+			m_softwareRasterizer->updateResource(pResource, nullptr, m_mappedData, 0);
+		}
+	}
+	if (pResource == m_mappedResource) {
+		m_mappedResource = nullptr;
+		m_mappedData = nullptr;
+	}
+
+	ScopedCallTimer timer(m_stats, GraphicsCall::Unmap, bytes);
+	m_deviceContext->Unmap(pResource, Subresource);
+}
+
+void
+DeviceContext::End(ID3D11Asynchronous* pAsync) {
+	// Validar parmetros
+	if (!pAsync) {
+		ERROR("DeviceContext", "End", "pAsync is nullptr");
+		return;
+	}
+	if (m_recorder) {
+		ERROR("DeviceContext", "End", "End cannot be recorded in a portable command list");
+		return;
+	}
+
+	ScopedCallTimer timer(m_stats, GraphicsCall::End);
+	m_deviceContext->End(pAsync);
+}
+
+HRESULT
+DeviceContext::GetData(ID3D11Asynchronous* pAsync,
+	void* pData,
+	unsigned int DataSize,
+	unsigned int GetDataFlags) {
+	// Validar parmetros
+	if (!pAsync) {
+		ERROR("DeviceContext", "GetData", "pAsync is nullptr");
+		return E_INVALIDARG;
+	}
+
+	ScopedCallTimer timer(m_stats, GraphicsCall::GetData);
+	return m_deviceContext->GetData(pAsync, pData, DataSize, GetDataFlags);
+}
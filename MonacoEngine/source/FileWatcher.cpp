@@ -0,0 +1,113 @@
+#include "FileWatcher.h"
+
+// 16 KB de notificaciones por lectura; si se llenan, el sistema reporta desbordamiento
+static const size_t kBufferDwords = 4096;
+
+HRESULT
+FileWatcher::init(const std::string& directory, unsigned int settleMilliseconds) {
+	destroy();
+	m_directory = directory;
+	if (!m_directory.empty() && m_directory.back() != '\\' && m_directory.back() != '/') {
+		m_directory.push_back('\\');
+	}
+	m_settleMilliseconds = settleMilliseconds;
+
+	std::string path = directory.empty() ? std::string(".") : directory;
+	m_handle = CreateFileA(path.c_str(), FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	if (m_handle == INVALID_HANDLE_VALUE) {
+		ERROR("FileWatcher", "init", ("Failed to open directory " + path).c_str());
+		return E_FAIL;
+	}
+	m_event = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	m_buffer.assign(kBufferDwords, 0);
+	if (!m_event || !issueRead()) {
+		ERROR("FileWatcher", "init", ("Failed to watch directory " + path).c_str());
+		destroy();
+		return E_FAIL;
+	}
+	return S_OK;
+}
+
+void
+FileWatcher::destroy() {
+	if (m_handle != INVALID_HANDLE_VALUE) {
+		if (m_reading) {
+			// La lectura cancelada an escribe en m_buffer hasta completarse
+			DWORD bytes = 0;
+			CancelIoEx(m_handle, &m_overlapped);
+			GetOverlappedResult(m_handle, &m_overlapped, &bytes, TRUE);
+		}
+		CloseHandle(m_handle);
+		m_handle = INVALID_HANDLE_VALUE;
+	}
+	if (m_event) {
+		CloseHandle(m_event);
+		m_event = nullptr;
+	}
+	m_reading = false;
+	m_buffer.clear();
+	m_pending.clear();
+	m_directory.clear();
+}
+
+bool
+FileWatcher::poll(std::vector<std::string>& changedFiles) {
+	if (m_handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	if (m_reading && WaitForSingleObject(m_event, 0) == WAIT_OBJECT_0) {
+		DWORD bytes = 0;
+		BOOL completed = GetOverlappedResult(m_handle, &m_overlapped, &bytes, FALSE);
+		m_reading = false;
+		if (completed && bytes == 0) {
+			// Desbordamiento: se perdieron notificaciones
+			m_pending[std::string()] = now;
+		}
+		else if (completed) {
+			const unsigned char* cursor = reinterpret_cast<const unsigned char*>(m_buffer.data());
+			for (;;) {
+				const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+				int wideLength = static_cast<int>(info->FileNameLength / sizeof(wchar_t));
+				int length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, wideLength, nullptr, 0, nullptr, nullptr);
+				std::string name(length, '\0');
+				WideCharToMultiByte(CP_UTF8, 0, info->FileName, wideLength, &name[0], length, nullptr, nullptr);
+				m_pending[name] = now;
+				if (info->NextEntryOffset == 0) {
+					break;
+				}
+				cursor += info->NextEntryOffset;
+			}
+		}
+		issueRead();
+	}
+
+	bool added = false;
+	std::chrono::milliseconds settle(m_settleMilliseconds);
+	for (std::unordered_map<std::string, std::chrono::steady_clock::time_point>::iterator it = m_pending.begin();
+		it != m_pending.end();) {
+		if (now - it->second >= settle) {
+			changedFiles.push_back(it->first);
+			added = true;
+			it = m_pending.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+	return added;
+}
+
+bool
+FileWatcher::issueRead() {
+	ResetEvent(m_event);
+	m_overlapped = OVERLAPPED();
+	m_overlapped.hEvent = m_event;
+	m_reading = ReadDirectoryChangesW(m_handle, m_buffer.data(),
+		static_cast<DWORD>(m_buffer.size() * sizeof(DWORD)), TRUE,
+		FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, nullptr, &m_overlapped, nullptr) != FALSE;
+	return m_reading;
+}
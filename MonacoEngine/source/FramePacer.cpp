@@ -0,0 +1,151 @@
+#include "FramePacer.h"
+
+double
+SystemPresentClock::now() const {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void
+SystemPresentClock::sleepUntil(double time) {
+	// Margen para la granularidad del planificador; el resto se espera cediendo el hilo
+	const double sleepMargin = 0.002;
+	double remaining = time - now();
+	if (remaining > sleepMargin) {
+		std::this_thread::sleep_for(std::chrono::duration<double>(remaining - sleepMargin));
+	}
+	while (now() < time) {
+		std::this_thread::yield();
+	}
+}
+
+HRESULT
+FramePacer::init(const FramePacerDesc& desc, PresentClock& clock, unsigned int historySize) {
+	if (desc.framesInFlight == 0 || desc.targetFps < 0.0 || historySize < 2) {
+		ERROR("FramePacer", "init", "framesInFlight must be non-zero, targetFps non-negative and historySize at least 2");
+		return E_INVALIDARG;
+	}
+	destroy();
+	m_desc = desc;
+	m_clock = &clock;
+	m_period = desc.targetFps > 0.0 ? 1.0 / desc.targetFps : 0.0;
+	m_historySize = historySize;
+	m_history.reserve(historySize);
+	return S_OK;
+}
+
+void
+FramePacer::destroy() {
+	m_desc = FramePacerDesc();
+	m_clock = nullptr;
+	m_period = 0.0;
+	m_nextDeadline = 0.0;
+	m_frame = 0;
+	m_current = FrameTiming();
+	m_history.clear();
+	m_historySize = 0;
+	m_historyHead = 0;
+}
+
+void
+FramePacer::beginFrame() {
+	if (!m_clock) {
+		ERROR("FramePacer", "beginFrame", "FramePacer is not initialized.");
+		return;
+	}
+	double now = m_clock->now();
+	double waited = 0.0;
+	if (m_period > 0.0) {
+		if (m_frame == 0) {
+			m_nextDeadline = now;
+		}
+		double deadline = m_nextDeadline;
+		if (now < deadline) {
+			m_clock->sleepUntil(deadline);
+			double woke = m_clock->now();
+			waited = woke - now;
+			now = woke;
+		}
+		// Atrasado ms de un periodo: no recuperar con una rfaga de frames
+		m_nextDeadline = (now - deadline > m_period) ? now + m_period : deadline + m_period;
+	}
+
+	m_current = FrameTiming();
+	m_current.frame = m_frame++;
+	m_current.cpuBegin = now;
+	m_current.waited = waited;
+}
+
+void
+FramePacer::beginPresent() {
+	if (m_clock) {
+		m_current.presentBegin = m_clock->now();
+	}
+}
+
+void
+FramePacer::endPresent() {
+	if (!m_clock) {
+		return;
+	}
+	m_current.presentEnd = m_clock->now();
+	if (m_history.size() < m_historySize) {
+		m_history.push_back(m_current);
+	}
+	else {
+		m_history[m_historyHead] = m_current;
+	}
+	m_historyHead = (m_historyHead + 1) % m_historySize;
+}
+
+const FrameTiming&
+FramePacer::timing(unsigned int index) const {
+	return m_history[(m_historyHead + m_historySize - 1 - index) % m_historySize];
+}
+
+double
+FramePacer::averageFrameTime() const {
+	unsigned int count = historyCount();
+	if (count < 2) {
+		return 0.0;
+	}
+	return (timing(0).cpuBegin - timing(count - 1).cpuBegin) / (count - 1);
+}
+
+double
+FramePacer::maxFrameTime() const {
+	double result = 0.0;
+	for (unsigned int i = 0; i + 1 < historyCount(); ++i) {
+		result = (std::max)(result, timing(i).cpuBegin - timing(i + 1).cpuBegin);
+	}
+	return result;
+}
+
+double
+FramePacer::averageCpuTime() const {
+	unsigned int count = historyCount();
+	if (count == 0) {
+		return 0.0;
+	}
+	double total = 0.0;
+	for (unsigned int i = 0; i < count; ++i) {
+		total += timing(i).presentBegin - timing(i).cpuBegin;
+	}
+	return total / count;
+}
+
+std::string
+FramePacer::report() const {
+	double waited = 0.0;
+	double present = 0.0;
+	for (unsigned int i = 0; i < historyCount(); ++i) {
+		waited += timing(i).waited;
+		present += timing(i).presentEnd - timing(i).presentBegin;
+	}
+	unsigned int count = (std::max)(historyCount(), 1u);
+	std::ostringstream os;
+	os << "Frame pacing: " << (averageFrameTime() * 1000.0) << " ms avg frame, "
+		<< (maxFrameTime() * 1000.0) << " ms max, " << (averageCpuTime() * 1000.0) << " ms cpu, "
+		<< (waited * 1000.0 / count) << " ms waiting, " << (present * 1000.0 / count) << " ms in present"
+		<< " (last " << historyCount() << " frames, " << m_desc.framesInFlight << " in flight)\n";
+	return os.str();
+}
@@ -0,0 +1,270 @@
+#include "GeometryPool.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "MeshComponent.h"
+#include "UploadManager.h"
+
+// Granularidad de los rangos: evita bloques diminutos sin desperdiciar demasiado en mallas chicas
+static const unsigned int kMinVertexBlock = 64;
+static const unsigned int kMinIndexBlock = 64;
+
+HRESULT
+GeometryPool::init(Device& device,
+	unsigned int vertexCapacity,
+	unsigned int indexCapacity,
+	UploadManager* uploadManager) {
+	if (!device.m_device) {
+		ERROR("GeometryPool", "init", "Device is null.");
+		return E_POINTER;
+	}
+	destroy();
+
+	vertexCapacity = BuddyAllocator::nextPowerOfTwo((std::max)(vertexCapacity, kMinVertexBlock));
+	indexCapacity = BuddyAllocator::nextPowerOfTwo((std::max)(indexCapacity, kMinIndexBlock));
+	m_device = &device;
+	m_uploadManager = uploadManager;
+
+	HRESULT hr = m_vertexAllocator.init(vertexCapacity, kMinVertexBlock);
+	if (SUCCEEDED(hr)) {
+		hr = m_indexAllocator.init(indexCapacity, kMinIndexBlock);
+	}
+	if (SUCCEEDED(hr)) {
+		hr = createBuffer(vertexCapacity * sizeof(SimpleVertex), D3D11_BIND_VERTEX_BUFFER, &m_vertexBuffer);
+	}
+	if (SUCCEEDED(hr)) {
+		hr = createBuffer(indexCapacity * sizeof(unsigned int), D3D11_BIND_INDEX_BUFFER, &m_indexBuffer);
+	}
+	if (FAILED(hr)) {
+		ERROR("GeometryPool", "init", "Failed to create the shared buffers");
+		destroy();
+		return hr;
+	}
+	return S_OK;
+}
+
+void
+GeometryPool::render(DeviceContext& deviceContext) {
+	if (!m_vertexBuffer || !m_indexBuffer) {
+		ERROR("GeometryPool", "render", "GeometryPool is not initialized.");
+		return;
+	}
+	unsigned int stride = sizeof(SimpleVertex);
+	unsigned int offset = 0;
+	deviceContext.IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+	deviceContext.IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+}
+
+void
+GeometryPool::destroy() {
+	SAFE_RELEASE(m_vertexBuffer);
+	SAFE_RELEASE(m_indexBuffer);
+	m_vertexAllocator.destroy();
+	m_indexAllocator.destroy();
+	m_entries.clear();
+	m_freeHandles.clear();
+	m_meshCount = 0;
+	m_device = nullptr;
+	m_uploadManager = nullptr;
+}
+
+unsigned int
+GeometryPool::add(DeviceContext& deviceContext, const MeshComponent& mesh) {
+	if (!m_vertexBuffer || !m_indexBuffer) {
+		ERROR("GeometryPool", "add", "GeometryPool is not initialized.");
+		return kInvalidHandle;
+	}
+	if (mesh.m_vertex.empty() || mesh.m_index.empty()) {
+		ERROR("GeometryPool", "add", "Mesh has no vertices or indices");
+		return kInvalidHandle;
+	}
+	unsigned int vertexCount = static_cast<unsigned int>(mesh.m_vertex.size());
+	unsigned int indexCount = static_cast<unsigned int>(mesh.m_index.size());
+
+	GeometryRange range;
+	if (!allocateRanges(vertexCount, indexCount, range)) {
+		// Primero compactar; si los huecos no bastan, duplicar el buffer que no alcanza
+		defragment(deviceContext);
+		while (!allocateRanges(vertexCount, indexCount, range)) {
+			unsigned int vertexCapacity = m_vertexAllocator.capacity();
+			unsigned int indexCapacity = m_indexAllocator.capacity();
+			if (m_vertexAllocator.largestFreeBlock() < vertexCount) {
+				vertexCapacity *= 2;
+			}
+			if (m_indexAllocator.largestFreeBlock() < indexCount) {
+				indexCapacity *= 2;
+			}
+			if (vertexCapacity < m_vertexAllocator.capacity() || indexCapacity < m_indexAllocator.capacity() ||
+				FAILED(defragment(deviceContext, vertexCapacity, indexCapacity))) {
+				ERROR("GeometryPool", "add", "Failed to grow the geometry pool");
+				return kInvalidHandle;
+			}
+		}
+	}
+
+	if (m_uploadManager) {
+		m_uploadManager->uploadBuffer(m_vertexBuffer, range.baseVertex * sizeof(SimpleVertex),
+			mesh.m_vertex.data(), vertexCount * sizeof(SimpleVertex));
+		m_uploadManager->uploadBuffer(m_indexBuffer, range.startIndex * sizeof(unsigned int),
+			mesh.m_index.data(), indexCount * sizeof(unsigned int));
+	}
+	else {
+		D3D11_BOX box = { 0, 0, 0, 0, 1, 1 };
+		box.left = range.baseVertex * sizeof(SimpleVertex);
+		box.right = (range.baseVertex + vertexCount) * sizeof(SimpleVertex);
+		deviceContext.UpdateSubresource(m_vertexBuffer, 0, &box, mesh.m_vertex.data(), 0, 0);
+		box.left = range.startIndex * sizeof(unsigned int);
+		box.right = (range.startIndex + indexCount) * sizeof(unsigned int);
+		deviceContext.UpdateSubresource(m_indexBuffer, 0, &box, mesh.m_index.data(), 0, 0);
+	}
+
+	unsigned int handle = 0;
+	if (!m_freeHandles.empty()) {
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+	else {
+		handle = static_cast<unsigned int>(m_entries.size());
+		m_entries.push_back(Entry());
+	}
+	m_entries[handle].range = range;
+	m_entries[handle].live = true;
+	m_meshCount++;
+	return handle;
+}
+
+void
+GeometryPool::remove(unsigned int handle) {
+	if (handle >= m_entries.size() || !m_entries[handle].live) {
+		ERROR("GeometryPool", "remove", "Invalid geometry handle");
+		return;
+	}
+	Entry& entry = m_entries[handle];
+	m_vertexAllocator.free(entry.range.baseVertex);
+	m_indexAllocator.free(entry.range.startIndex);
+	entry = Entry();
+	m_freeHandles.push_back(handle);
+	m_meshCount--;
+}
+
+const GeometryRange*
+GeometryPool::range(unsigned int handle) const {
+	if (handle >= m_entries.size() || !m_entries[handle].live) {
+		return nullptr;
+	}
+	return &m_entries[handle].range;
+}
+
+void
+GeometryPool::draw(DeviceContext& deviceContext, unsigned int handle) {
+	const GeometryRange* geometry = range(handle);
+	if (!geometry) {
+		ERROR("GeometryPool", "draw", "Invalid geometry handle");
+		return;
+	}
+	deviceContext.DrawIndexed(geometry->indexCount,
+		geometry->startIndex,
+		static_cast<int>(geometry->baseVertex));
+}
+
+HRESULT
+GeometryPool::defragment(DeviceContext& deviceContext,
+	unsigned int vertexCapacity,
+	unsigned int indexCapacity) {
+	if (!m_device) {
+		ERROR("GeometryPool", "defragment", "GeometryPool is not initialized.");
+		return E_FAIL;
+	}
+	vertexCapacity = vertexCapacity ? BuddyAllocator::nextPowerOfTwo(vertexCapacity) : m_vertexAllocator.capacity();
+	indexCapacity = indexCapacity ? BuddyAllocator::nextPowerOfTwo(indexCapacity) : m_indexAllocator.capacity();
+	if (vertexCapacity < m_vertexAllocator.usedSize() || indexCapacity < m_indexAllocator.usedSize()) {
+		ERROR("GeometryPool", "defragment", "New capacity does not fit the live meshes");
+		return E_INVALIDARG;
+	}
+	if (m_uploadManager) {
+		m_uploadManager->flush(deviceContext);
+	}
+
+	// Buffers nuevos: CopySubresourceRegion no admite origen y destino solapados
+	ID3D11Buffer* vertexBuffer = nullptr;
+	ID3D11Buffer* indexBuffer = nullptr;
+	HRESULT hr = createBuffer(vertexCapacity * sizeof(SimpleVertex), D3D11_BIND_VERTEX_BUFFER, &vertexBuffer);
+	if (SUCCEEDED(hr)) {
+		hr = createBuffer(indexCapacity * sizeof(unsigned int), D3D11_BIND_INDEX_BUFFER, &indexBuffer);
+	}
+	if (FAILED(hr)) {
+		SAFE_RELEASE(vertexBuffer);
+		SAFE_RELEASE(indexBuffer);
+		return hr;
+	}
+
+	std::vector<BuddyMove> vertexMoves;
+	std::vector<BuddyMove> indexMoves;
+	m_vertexAllocator.defragment(vertexMoves, vertexCapacity);
+	m_indexAllocator.defragment(indexMoves, indexCapacity);
+	std::unordered_map<unsigned int, unsigned int> vertexTargets;
+	std::unordered_map<unsigned int, unsigned int> indexTargets;
+	for (const BuddyMove& move : vertexMoves) {
+		vertexTargets[move.from] = move.to;
+	}
+	for (const BuddyMove& move : indexMoves) {
+		indexTargets[move.from] = move.to;
+	}
+
+	// Solo se copian los elementos usados, no el redondeo de cada bloque
+	for (Entry& entry : m_entries) {
+		if (!entry.live) {
+			continue;
+		}
+		GeometryRange& geometry = entry.range;
+		unsigned int baseVertex = vertexTargets[geometry.baseVertex];
+		unsigned int startIndex = indexTargets[geometry.startIndex];
+
+		D3D11_BOX box = { 0, 0, 0, 0, 1, 1 };
+		box.left = geometry.baseVertex * sizeof(SimpleVertex);
+		box.right = (geometry.baseVertex + geometry.vertexCount) * sizeof(SimpleVertex);
+		deviceContext.CopySubresourceRegion(vertexBuffer, 0, baseVertex * sizeof(SimpleVertex), 0, 0,
+			m_vertexBuffer, 0, &box);
+		box.left = geometry.startIndex * sizeof(unsigned int);
+		box.right = (geometry.startIndex + geometry.indexCount) * sizeof(unsigned int);
+		deviceContext.CopySubresourceRegion(indexBuffer, 0, startIndex * sizeof(unsigned int), 0, 0,
+			m_indexBuffer, 0, &box);
+
+		geometry.baseVertex = baseVertex;
+		geometry.startIndex = startIndex;
+	}
+
+	SAFE_RELEASE(m_vertexBuffer);
+	SAFE_RELEASE(m_indexBuffer);
+	m_vertexBuffer = vertexBuffer;
+	m_indexBuffer = indexBuffer;
+	return S_OK;
+}
+
+HRESULT
+GeometryPool::createBuffer(unsigned int byteWidth, unsigned int bindFlags, ID3D11Buffer** buffer) {
+	D3D11_BUFFER_DESC desc = {};
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.ByteWidth = byteWidth;
+	desc.BindFlags = bindFlags;
+	return m_device->CreateBuffer(&desc, nullptr, buffer);
+}
+
+bool
+GeometryPool::allocateRanges(unsigned int vertexCount,
+	unsigned int indexCount,
+	GeometryRange& range) {
+	unsigned int baseVertex = 0;
+	unsigned int startIndex = 0;
+	if (!m_vertexAllocator.allocate(vertexCount, baseVertex)) {
+		return false;
+	}
+	if (!m_indexAllocator.allocate(indexCount, startIndex)) {
+		m_vertexAllocator.free(baseVertex);
+		return false;
+	}
+	range.baseVertex = baseVertex;
+	range.vertexCount = vertexCount;
+	range.startIndex = startIndex;
+	range.indexCount = indexCount;
+	return true;
+}
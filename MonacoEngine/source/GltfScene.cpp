@@ -0,0 +1,932 @@
+#include "GltfScene.h"
+#include "ThreadPool.h"
+#include "Device.h"
+
+static const unsigned int kJsonNone = 0xFFFFFFFFu;
+static const unsigned int kMaxJsonDepth = 64;
+static const unsigned int kGlbMagic = 0x46546C67;
+static const unsigned int kGlbJsonChunk = 0x4E4F534A;
+static const unsigned int kGlbBinaryChunk = 0x004E4942;
+
+enum class GltfJsonType : unsigned char {
+	Null,
+	Boolean,
+	Number,
+	String,
+	Array,
+	Object
+};
+
+/**
+ * @brief Un valor del JSON; nmeros y cadenas apuntan al texto sin copiarlo.
+ */
+struct GltfJsonValue {
+	GltfJsonType type;
+	bool boolean;
+	bool escaped;
+	// Arreglos: elementos; objetos: pares clave, valor; ambos en GltfJson::children
+	unsigned int first;
+	unsigned int count;
+	const char* text;
+	unsigned int length;
+};
+
+/**
+ * @brief Documento JSON como arreglo plano: los hijos de cada contenedor quedan contiguos.
+ */
+struct GltfJson {
+	std::vector<GltfJsonValue> values;
+	std::vector<unsigned int> children;
+	unsigned int root = kJsonNone;
+};
+
+struct GltfJsonParser {
+	const char* p;
+	const char* end;
+	GltfJson* json;
+	// Hijos del contenedor abierto; se pasan a children al cerrarlo
+	std::vector<unsigned int> stack;
+	unsigned int depth;
+};
+
+static inline void
+skipWhitespace(GltfJsonParser& parser) {
+	while (parser.p < parser.end &&
+		(*parser.p == ' ' || *parser.p == '\n' || *parser.p == '\r' || *parser.p == '\t')) {
+		++parser.p;
+	}
+}
+
+static inline unsigned int
+pushJsonValue(GltfJson& json, GltfJsonType type, const char* text, unsigned int length) {
+	GltfJsonValue value = { type, false, false, 0, 0, text, length };
+	json.values.push_back(value);
+	return static_cast<unsigned int>(json.values.size() - 1);
+}
+
+static unsigned int
+parseJsonString(GltfJsonParser& parser) {
+	const char* start = ++parser.p;
+	bool escaped = false;
+	while (parser.p < parser.end && *parser.p != '"') {
+		if (*parser.p == '\\') {
+			escaped = true;
+			++parser.p;
+		}
+		++parser.p;
+	}
+	if (parser.p >= parser.end) {
+		return kJsonNone;
+	}
+	unsigned int index = pushJsonValue(*parser.json, GltfJsonType::String, start,
+		static_cast<unsigned int>(parser.p - start));
+	parser.json->values[index].escaped = escaped;
+	++parser.p;
+	return index;
+}
+
+static unsigned int
+parseJsonValue(GltfJsonParser& parser) {
+	skipWhitespace(parser);
+	if (parser.p >= parser.end) {
+		return kJsonNone;
+	}
+	GltfJson& json = *parser.json;
+	char c = *parser.p;
+	if (c == '"') {
+		return parseJsonString(parser);
+	}
+	if (c == '[' || c == '{') {
+		bool object = c == '{';
+		char close = object ? '}' : ']';
+		if (++parser.depth > kMaxJsonDepth) {
+			return kJsonNone;
+		}
+		unsigned int index = pushJsonValue(json, object ? GltfJsonType::Object : GltfJsonType::Array, parser.p, 0);
+		size_t mark = parser.stack.size();
+		++parser.p;
+		skipWhitespace(parser);
+		if (parser.p < parser.end && *parser.p == close) {
+			++parser.p;
+		}
+		else {
+			while (true) {
+				if (object) {
+					skipWhitespace(parser);
+					if (parser.p >= parser.end || *parser.p != '"') {
+						return kJsonNone;
+					}
+					unsigned int key = parseJsonString(parser);
+					skipWhitespace(parser);
+					if (key == kJsonNone || parser.p >= parser.end || *parser.p != ':') {
+						return kJsonNone;
+					}
+					++parser.p;
+					parser.stack.push_back(key);
+				}
+				unsigned int element = parseJsonValue(parser);
+				if (element == kJsonNone) {
+					return kJsonNone;
+				}
+				parser.stack.push_back(element);
+				skipWhitespace(parser);
+				if (parser.p < parser.end && *parser.p == ',') {
+					++parser.p;
+					continue;
+				}
+				if (parser.p < parser.end && *parser.p == close) {
+					++parser.p;
+					break;
+				}
+				return kJsonNone;
+			}
+		}
+		size_t childCount = parser.stack.size() - mark;
+		json.values[index].first = static_cast<unsigned int>(json.children.size());
+		json.values[index].count = static_cast<unsigned int>(object ? childCount / 2 : childCount);
+		json.children.insert(json.children.end(), parser.stack.begin() + mark, parser.stack.end());
+		parser.stack.resize(mark);
+		parser.depth--;
+		return index;
+	}
+	if (c == '-' || (c >= '0' && c <= '9')) {
+		const char* start = parser.p;
+		while (parser.p < parser.end && (isdigit(static_cast<unsigned char>(*parser.p)) || *parser.p == '-' ||
+			*parser.p == '+' || *parser.p == '.' || *parser.p == 'e' || *parser.p == 'E')) {
+			++parser.p;
+		}
+		return pushJsonValue(json, GltfJsonType::Number, start, static_cast<unsigned int>(parser.p - start));
+	}
+	static const char* literals[] = { "true", "false", "null" };
+	for (unsigned int i = 0; i < 3; ++i) {
+		size_t length = strlen(literals[i]);
+		if (static_cast<size_t>(parser.end - parser.p) >= length && memcmp(parser.p, literals[i], length) == 0) {
+			unsigned int index = pushJsonValue(json, i < 2 ? GltfJsonType::Boolean : GltfJsonType::Null, parser.p,
+				static_cast<unsigned int>(length));
+			json.values[index].boolean = i == 0;
+			parser.p += length;
+			return index;
+		}
+	}
+	return kJsonNone;
+}
+
+/**
+ * @brief Interpreta @p text; si falla devuelve el byte donde se detuvo en @p errorOffset.
+ */
+static bool
+parseJson(const char* text, size_t size, GltfJson& json, size_t& errorOffset) {
+	GltfJsonParser parser = { text, text + size, &json, std::vector<unsigned int>(), 0 };
+	// Un valor cada ~12 bytes en un glTF tpico
+	json.values.reserve(size / 12);
+	json.children.reserve(size / 12);
+	json.root = parseJsonValue(parser);
+	skipWhitespace(parser);
+	// El chunk JSON de un GLB se rellena con espacios o ceros hasta mltiplo de 4
+	while (parser.p < parser.end && *parser.p == '\0') {
+		++parser.p;
+	}
+	errorOffset = parser.p - text;
+	return json.root != kJsonNone && json.values[json.root].type == GltfJsonType::Object && parser.p == parser.end;
+}
+
+static unsigned int
+jsonMember(const GltfJson& json, unsigned int object, const char* key) {
+	if (object == kJsonNone || json.values[object].type != GltfJsonType::Object) {
+		return kJsonNone;
+	}
+	const GltfJsonValue& value = json.values[object];
+	size_t length = strlen(key);
+	for (unsigned int i = 0; i < value.count; ++i) {
+		const GltfJsonValue& name = json.values[json.children[value.first + i * 2]];
+		if (name.length == length && memcmp(name.text, key, length) == 0) {
+			return json.children[value.first + i * 2 + 1];
+		}
+	}
+	return kJsonNone;
+}
+
+static unsigned int
+jsonCount(const GltfJson& json, unsigned int array) {
+	return array != kJsonNone && json.values[array].type == GltfJsonType::Array ? json.values[array].count : 0;
+}
+
+static unsigned int
+jsonElement(const GltfJson& json, unsigned int array, unsigned int index) {
+	return json.children[json.values[array].first + index];
+}
+
+static double
+jsonNumber(const GltfJson& json, unsigned int value, double fallback) {
+	if (value == kJsonNone || json.values[value].type != GltfJsonType::Number) {
+		return fallback;
+	}
+	const GltfJsonValue& number = json.values[value];
+	double result = fallback;
+	std::from_chars_result parsed = std::from_chars(number.text, number.text + number.length, result);
+	return parsed.ec == std::errc() ? result : fallback;
+}
+
+static long long
+jsonInteger(const GltfJson& json, unsigned int value, long long fallback) {
+	return static_cast<long long>(jsonNumber(json, value, static_cast<double>(fallback)));
+}
+
+static std::string
+jsonString(const GltfJson& json, unsigned int value) {
+	if (value == kJsonNone || json.values[value].type != GltfJsonType::String) {
+		return std::string();
+	}
+	const GltfJsonValue& string = json.values[value];
+	if (!string.escaped) {
+		return std::string(string.text, string.length);
+	}
+	std::string result;
+	result.reserve(string.length);
+	for (unsigned int i = 0; i < string.length; ++i) {
+		char c = string.text[i];
+		if (c != '\\' || i + 1 >= string.length) {
+			result += c;
+			continue;
+		}
+		c = string.text[++i];
+		switch (c) {
+		case 'b': result += '\b'; break;
+		case 'f': result += '\f'; break;
+		case 'n': result += '\n'; break;
+		case 'r': result += '\r'; break;
+		case 't': result += '\t'; break;
+		case 'u': {
+			unsigned int code = 0;
+			if (i + 4 < string.length) {
+				std::from_chars(string.text + i + 1, string.text + i + 5, code, 16);
+				i += 4;
+			}
+			// UTF-8 sin pares sustitutos; basta para rutas y nombres
+			if (code < 0x80) {
+				result += static_cast<char>(code);
+			}
+			else if (code < 0x800) {
+				result += static_cast<char>(0xC0 | (code >> 6));
+				result += static_cast<char>(0x80 | (code & 0x3F));
+			}
+			else {
+				result += static_cast<char>(0xE0 | (code >> 12));
+				result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+				result += static_cast<char>(0x80 | (code & 0x3F));
+			}
+			break;
+		}
+		default: result += c; break;
+		}
+	}
+	return result;
+}
+
+/**
+ * @brief Ruta de un URI relativo de glTF: se decodifican los %XX.
+ */
+static std::string
+uriToPath(const std::string& directory, const std::string& uri) {
+	std::string path = directory;
+	for (size_t i = 0; i < uri.size(); ++i) {
+		unsigned int code = 0;
+		if (uri[i] == '%' && i + 2 < uri.size() &&
+			std::from_chars(uri.data() + i + 1, uri.data() + i + 3, code, 16).ptr == uri.data() + i + 3) {
+			path += static_cast<char>(code);
+			i += 2;
+		}
+		else {
+			path += uri[i];
+		}
+	}
+	return path;
+}
+
+static inline unsigned int
+readUInt32(const unsigned char* data) {
+	unsigned int value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static inline unsigned int
+readIndex(const GltfAccessorView& view, unsigned int i) {
+	const unsigned char* element = view.data + static_cast<size_t>(i) * view.stride;
+	if (view.componentType == 5121) {
+		return element[0];
+	}
+	if (view.componentType == 5123) {
+		unsigned short value;
+		memcpy(&value, element, sizeof(value));
+		return value;
+	}
+	return readUInt32(element);
+}
+
+static inline XMFLOAT2
+readTexcoord(const GltfAccessorView& view, unsigned int i) {
+	const unsigned char* element = view.data + static_cast<size_t>(i) * view.stride;
+	XMFLOAT2 texcoord;
+	if (view.componentType == 5126) {
+		memcpy(&texcoord, element, sizeof(texcoord));
+	}
+	else if (view.componentType == 5121) {
+		texcoord = XMFLOAT2(element[0] / 255.0f, element[1] / 255.0f);
+	}
+	else {
+		unsigned short value[2];
+		memcpy(value, element, sizeof(value));
+		texcoord = XMFLOAT2(value[0] / 65535.0f, value[1] / 65535.0f);
+	}
+	return texcoord;
+}
+
+static inline double
+millisecondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+HRESULT
+GltfScene::init(const std::string& fileName, const GltfLoadOptions& options, ThreadPool* threadPool) {
+	destroy();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (FAILED(m_file.init(fileName))) {
+		ERROR("GltfScene", "init", ("Failed to open " + fileName).c_str());
+		return E_FAIL;
+	}
+	const unsigned char* data = m_file.data();
+	size_t size = m_file.size();
+
+	// GLB: cabecera de 12 bytes, chunk JSON y chunk BIN opcional; si no, es un .gltf de texto
+	const char* jsonText = reinterpret_cast<const char*>(data);
+	size_t jsonSize = size;
+	const unsigned char* binary = nullptr;
+	size_t binarySize = 0;
+	if (size >= 12 && readUInt32(data) == kGlbMagic) {
+		size_t length = readUInt32(data + 8);
+		if (readUInt32(data + 4) != 2 || length > size || length < 20 || readUInt32(data + 16) != kGlbJsonChunk ||
+			20 + static_cast<size_t>(readUInt32(data + 12)) > length) {
+			ERROR("GltfScene", "init", ("Invalid GLB header in " + fileName).c_str());
+			destroy();
+			return E_FAIL;
+		}
+		jsonText = reinterpret_cast<const char*>(data + 20);
+		jsonSize = readUInt32(data + 12);
+		size_t binaryChunk = 20 + jsonSize;
+		if (binaryChunk + 8 <= length && readUInt32(data + binaryChunk + 4) == kGlbBinaryChunk &&
+			binaryChunk + 8 + readUInt32(data + binaryChunk) <= length) {
+			binary = data + binaryChunk + 8;
+			binarySize = readUInt32(data + binaryChunk);
+		}
+	}
+	m_stats.bytes = size;
+	m_stats.mapMilliseconds = millisecondsSince(start);
+
+	GltfJson json;
+	size_t errorOffset = 0;
+	if (!parseJson(jsonText, jsonSize, json, errorOffset)) {
+		ERROR("GltfScene", "init",
+			("Invalid JSON in " + fileName + " at byte " + std::to_string(errorOffset)).c_str());
+		destroy();
+		return E_FAIL;
+	}
+	std::string version = jsonString(json, jsonMember(json, jsonMember(json, json.root, "asset"), "version"));
+	if (version.compare(0, 2, "2.") != 0) {
+		ERROR("GltfScene", "init", ("Only glTF 2.x is supported: " + fileName).c_str());
+		destroy();
+		return E_FAIL;
+	}
+	size_t slash = fileName.find_last_of("/\\");
+	std::string directory = slash == std::string::npos ? std::string() : fileName.substr(0, slash + 1);
+	HRESULT hr = mapBuffers(json, binary, binarySize, directory);
+	if (SUCCEEDED(hr)) {
+		hr = readAccessors(json);
+	}
+	if (SUCCEEDED(hr)) {
+		hr = readImages(json, directory);
+	}
+	if (FAILED(hr)) {
+		ERROR("GltfScene", "init", ("Failed to load " + fileName).c_str());
+		destroy();
+		return hr;
+	}
+
+	unsigned int meshes = jsonMember(json, json.root, "meshes");
+	unsigned int meshCount = jsonCount(json, meshes);
+	std::vector<unsigned int> primitiveValues;
+	m_meshFirstPrimitive.resize(meshCount + 1);
+	for (unsigned int mesh = 0; mesh < meshCount; ++mesh) {
+		m_meshFirstPrimitive[mesh] = static_cast<unsigned int>(primitiveValues.size());
+		unsigned int primitives = jsonMember(json, jsonElement(json, meshes, mesh), "primitives");
+		for (unsigned int i = 0; i < jsonCount(json, primitives); ++i) {
+			primitiveValues.push_back(jsonElement(json, primitives, i));
+		}
+	}
+	m_meshFirstPrimitive[meshCount] = static_cast<unsigned int>(primitiveValues.size());
+	m_primitives.resize(primitiveValues.size());
+	for (unsigned int mesh = 0; mesh < meshCount; ++mesh) {
+		for (unsigned int i = m_meshFirstPrimitive[mesh]; i < m_meshFirstPrimitive[mesh + 1]; ++i) {
+			m_primitives[i].mesh = mesh;
+		}
+	}
+	m_stats.jsonMilliseconds = millisecondsSince(start) - m_stats.mapMilliseconds;
+
+	// Las imgenes van primero: son las tareas ms largas y as no quedan al final
+	std::chrono::steady_clock::time_point geometryStart = std::chrono::steady_clock::now();
+	unsigned int imageTasks = options.loadImages ? static_cast<unsigned int>(m_images.size()) : 0;
+	unsigned int taskCount = imageTasks + static_cast<unsigned int>(m_primitives.size());
+	std::vector<HRESULT> results(taskCount, S_OK);
+	std::function<void(unsigned int)> task = [&](unsigned int i) {
+		if (i < imageTasks) {
+			GltfImage& image = m_images[i];
+			if (image.dds) {
+				return;
+			}
+			results[i] = image.fileName.empty()
+				? ImageDecoder::decode(image.data, image.size, image.name, options.imageOptions, image.decoded)
+				: ImageDecoder::decode(image.fileName, options.imageOptions, image.decoded);
+		}
+		else {
+			results[i] = buildPrimitive(json, primitiveValues[i - imageTasks], options, m_primitives[i - imageTasks]);
+		}
+	};
+	if (threadPool && taskCount > 1) {
+		threadPool->parallelFor(taskCount, task);
+	}
+	else {
+		for (unsigned int i = 0; i < taskCount; ++i) {
+			task(i);
+		}
+	}
+	// Una imagen que no se decodifica solo deja su textura vaca; una primitiva invlida es un error
+	for (unsigned int i = imageTasks; i < taskCount; ++i) {
+		if (FAILED(results[i])) {
+			ERROR("GltfScene", "init", ("Failed to load " + fileName).c_str());
+			destroy();
+			return results[i];
+		}
+	}
+	m_stats.geometryMilliseconds = millisecondsSince(geometryStart);
+
+	std::chrono::steady_clock::time_point nodeStart = std::chrono::steady_clock::now();
+	hr = buildInstances(json, options);
+	if (FAILED(hr)) {
+		ERROR("GltfScene", "init", ("Failed to load " + fileName).c_str());
+		destroy();
+		return hr;
+	}
+	m_stats.nodeMilliseconds = millisecondsSince(nodeStart);
+
+	m_stats.nodes = jsonCount(json, jsonMember(json, json.root, "nodes"));
+	m_stats.meshes = meshCount;
+	m_stats.primitives = static_cast<unsigned int>(m_primitives.size());
+	m_stats.instances = static_cast<unsigned int>(m_instances.size());
+	m_stats.images = static_cast<unsigned int>(m_images.size());
+	for (const GltfPrimitive& primitive : m_primitives) {
+		m_stats.copiedPrimitives += primitive.copiedVertices ? 1 : 0;
+		m_stats.vertices += primitive.meshComponent.m_vertex.size();
+		m_stats.triangles += primitive.meshComponent.m_index.size() / 3;
+	}
+	m_stats.totalMilliseconds = millisecondsSince(start);
+	m_textures.resize(m_images.size());
+	return S_OK;
+}
+
+HRESULT
+GltfScene::createTextures(Device& device, UploadManager* uploadManager) {
+	HRESULT result = S_OK;
+	for (size_t i = 0; i < m_images.size(); ++i) {
+		GltfImage& image = m_images[i];
+		HRESULT hr = S_OK;
+		if (image.dds) {
+			hr = m_textures[i].init(device, image.fileName, DDS);
+		}
+		else if (!image.decoded.pixels.empty()) {
+			hr = m_textures[i].init(device, image.decoded, uploadManager);
+			// Sin UploadManager la textura es inmutable y los pxeles ya no hacen falta
+			std::vector<unsigned char>().swap(image.decoded.pixels);
+			std::vector<MipLevel>().swap(image.decoded.mips);
+		}
+		if (FAILED(hr) && SUCCEEDED(result)) {
+			result = hr;
+		}
+	}
+	return result;
+}
+
+void
+GltfScene::destroy() {
+	for (Texture& texture : m_textures) {
+		texture.destroy();
+	}
+	m_textures.clear();
+	m_images.clear();
+	m_instances.clear();
+	m_primitives.clear();
+	m_meshFirstPrimitive.clear();
+	m_accessors.clear();
+	m_bufferViews.clear();
+	m_buffers.clear();
+	m_bufferFiles.clear();
+	m_file.destroy();
+	m_stats = GltfLoadStats();
+}
+
+GltfAccessorView
+GltfScene::accessor(unsigned int index) const {
+	return index < m_accessors.size() ? m_accessors[index] : GltfAccessorView();
+}
+
+Texture*
+GltfScene::texture(int image) {
+	if (image < 0 || static_cast<size_t>(image) >= m_textures.size() || !m_textures[image].m_textureFromImg) {
+		return nullptr;
+	}
+	return &m_textures[image];
+}
+
+std::string
+GltfScene::report() const {
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+	os << "glTF scene: " << m_stats.nodes << " nodes, " << m_stats.instances << " mesh instances, " << m_stats.meshes
+		<< " meshes, " << m_stats.primitives << " primitives (" << m_stats.copiedPrimitives << " copied as SimpleVertex), "
+		<< m_stats.vertices << " vertices, " << m_stats.triangles << " triangles, " << m_stats.images << " images; "
+		<< (m_stats.bytes / 1048576.0) << " MB in " << m_stats.totalMilliseconds << " ms (map " << m_stats.mapMilliseconds
+		<< ", JSON " << m_stats.jsonMilliseconds << ", geometry and images " << m_stats.geometryMilliseconds
+		<< ", nodes " << m_stats.nodeMilliseconds << ")\n";
+	return os.str();
+}
+
+HRESULT
+GltfScene::mapBuffers(const GltfJson& json,
+	const unsigned char* binary,
+	size_t binarySize,
+	const std::string& directory) {
+	unsigned int buffers = jsonMember(json, json.root, "buffers");
+	for (unsigned int i = 0; i < jsonCount(json, buffers); ++i) {
+		unsigned int buffer = jsonElement(json, buffers, i);
+		long long byteLength = jsonInteger(json, jsonMember(json, buffer, "byteLength"), -1);
+		unsigned int uriValue = jsonMember(json, buffer, "uri");
+		const unsigned char* data = nullptr;
+		size_t size = 0;
+		if (uriValue == kJsonNone) {
+			// Solo el primer buffer puede ser el chunk BIN del GLB
+			if (i == 0 && binary) {
+				data = binary;
+				size = binarySize;
+			}
+		}
+		else {
+			std::string uri = jsonString(json, uriValue);
+			if (uri.compare(0, 5, "data:") == 0) {
+				ERROR("GltfScene", "mapBuffers", ("Buffer " + std::to_string(i) + " is a data URI; only files are supported").c_str());
+				return E_FAIL;
+			}
+			std::unique_ptr<MappedFile> file(new MappedFile());
+			if (FAILED(file->init(uriToPath(directory, uri)))) {
+				ERROR("GltfScene", "mapBuffers", ("Failed to open buffer " + uri).c_str());
+				return E_FAIL;
+			}
+			data = file->data();
+			size = file->size();
+			m_bufferFiles.push_back(std::move(file));
+		}
+		if (!data || byteLength < 0 || static_cast<unsigned long long>(byteLength) > size) {
+			ERROR("GltfScene", "mapBuffers", ("Buffer " + std::to_string(i) + " is missing or too short").c_str());
+			return E_FAIL;
+		}
+		m_buffers.push_back(std::make_pair(data, static_cast<size_t>(byteLength)));
+	}
+
+	unsigned int bufferViews = jsonMember(json, json.root, "bufferViews");
+	m_bufferViews.reserve(jsonCount(json, bufferViews));
+	for (unsigned int i = 0; i < jsonCount(json, bufferViews); ++i) {
+		unsigned int bufferView = jsonElement(json, bufferViews, i);
+		long long buffer = jsonInteger(json, jsonMember(json, bufferView, "buffer"), -1);
+		long long byteOffset = jsonInteger(json, jsonMember(json, bufferView, "byteOffset"), 0);
+		long long byteLength = jsonInteger(json, jsonMember(json, bufferView, "byteLength"), -1);
+		long long byteStride = jsonInteger(json, jsonMember(json, bufferView, "byteStride"), 0);
+		if (buffer < 0 || static_cast<size_t>(buffer) >= m_buffers.size() || byteOffset < 0 || byteLength < 0 ||
+			byteStride < 0 || byteStride > 252 ||
+			static_cast<unsigned long long>(byteOffset + byteLength) > m_buffers[static_cast<size_t>(buffer)].second) {
+			ERROR("GltfScene", "mapBuffers", ("bufferView " + std::to_string(i) + " is outside its buffer").c_str());
+			return E_FAIL;
+		}
+		BufferView view = { m_buffers[static_cast<size_t>(buffer)].first + byteOffset, static_cast<size_t>(byteLength),
+			static_cast<unsigned int>(byteStride) };
+		m_bufferViews.push_back(view);
+	}
+	return S_OK;
+}
+
+HRESULT
+GltfScene::readAccessors(const GltfJson& json) {
+	unsigned int accessors = jsonMember(json, json.root, "accessors");
+	m_accessors.resize(jsonCount(json, accessors));
+	for (unsigned int i = 0; i < m_accessors.size(); ++i) {
+		unsigned int accessor = jsonElement(json, accessors, i);
+		GltfAccessorView& view = m_accessors[i];
+		view.componentType = static_cast<unsigned int>(jsonInteger(json, jsonMember(json, accessor, "componentType"), 0));
+		view.normalized = jsonMember(json, accessor, "normalized") != kJsonNone &&
+			json.values[jsonMember(json, accessor, "normalized")].boolean;
+		long long count = jsonInteger(json, jsonMember(json, accessor, "count"), -1);
+		std::string type = jsonString(json, jsonMember(json, accessor, "type"));
+		unsigned int componentSize = view.componentType == 5120 || view.componentType == 5121 ? 1
+			: view.componentType == 5122 || view.componentType == 5123 ? 2
+			: view.componentType == 5125 || view.componentType == 5126 ? 4 : 0;
+		view.components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3
+			: type == "VEC4" || type == "MAT2" ? 4 : type == "MAT3" ? 9 : type == "MAT4" ? 16 : 0;
+		if (componentSize == 0 || view.components == 0 || count < 0 || count > 0x7FFFFFFF) {
+			ERROR("GltfScene", "readAccessors", ("Accessor " + std::to_string(i) + " has an invalid type or count").c_str());
+			return E_FAIL;
+		}
+		view.count = static_cast<unsigned int>(count);
+
+		// Sin bufferView (todo ceros) o con sparse la vista queda vaca; falla solo si se usa
+		long long bufferView = jsonInteger(json, jsonMember(json, accessor, "bufferView"), -1);
+		if (bufferView < 0 || jsonMember(json, accessor, "sparse") != kJsonNone) {
+			continue;
+		}
+		if (static_cast<size_t>(bufferView) >= m_bufferViews.size()) {
+			ERROR("GltfScene", "readAccessors", ("Accessor " + std::to_string(i) + " has an invalid bufferView").c_str());
+			return E_FAIL;
+		}
+		const BufferView& source = m_bufferViews[static_cast<size_t>(bufferView)];
+		long long byteOffset = jsonInteger(json, jsonMember(json, accessor, "byteOffset"), 0);
+		unsigned int elementSize = componentSize * view.components;
+		view.stride = source.stride > 0 ? source.stride : elementSize;
+		unsigned long long end = view.count == 0 ? 0
+			: static_cast<unsigned long long>(byteOffset) + static_cast<unsigned long long>(view.stride) * (view.count - 1) + elementSize;
+		if (byteOffset < 0 || end > source.length) {
+			ERROR("GltfScene", "readAccessors", ("Accessor " + std::to_string(i) + " is outside its bufferView").c_str());
+			return E_FAIL;
+		}
+		view.data = source.data + byteOffset;
+	}
+	return S_OK;
+}
+
+HRESULT
+GltfScene::readImages(const GltfJson& json, const std::string& directory) {
+	unsigned int images = jsonMember(json, json.root, "images");
+	m_images.resize(jsonCount(json, images));
+	for (unsigned int i = 0; i < m_images.size(); ++i) {
+		unsigned int imageValue = jsonElement(json, images, i);
+		GltfImage& image = m_images[i];
+		image.name = jsonString(json, jsonMember(json, imageValue, "name"));
+		long long bufferView = jsonInteger(json, jsonMember(json, imageValue, "bufferView"), -1);
+		std::string uri = jsonString(json, jsonMember(json, imageValue, "uri"));
+		if (bufferView >= 0 && static_cast<size_t>(bufferView) < m_bufferViews.size()) {
+			image.data = m_bufferViews[static_cast<size_t>(bufferView)].data;
+			image.size = m_bufferViews[static_cast<size_t>(bufferView)].length;
+		}
+		else if (!uri.empty() && uri.compare(0, 5, "data:") != 0) {
+			image.fileName = uriToPath(directory, uri);
+			size_t dot = image.fileName.find_last_of('.');
+			std::string extension = dot == std::string::npos ? std::string() : image.fileName.substr(dot + 1);
+			image.dds = extension == "dds" || extension == "DDS";
+		}
+		else {
+			// Las data URI se ignoran: la imagen queda sin textura
+			MESSAGE("GltfScene", "readImages", ("Image " + std::to_string(i) + " has no supported source").c_str());
+		}
+		if (image.name.empty()) {
+			image.name = image.fileName.empty() ? "image " + std::to_string(i) : image.fileName;
+		}
+	}
+	return S_OK;
+}
+
+HRESULT
+GltfScene::buildPrimitive(const GltfJson& json,
+	unsigned int primitiveValue,
+	const GltfLoadOptions& options,
+	GltfPrimitive& primitive) const {
+	std::string name = "mesh " + std::to_string(primitive.mesh);
+	unsigned int attributes = jsonMember(json, primitiveValue, "attributes");
+	long long positionAccessor = jsonInteger(json, jsonMember(json, attributes, "POSITION"), -1);
+	long long texcoordAccessor = jsonInteger(json, jsonMember(json, attributes, "TEXCOORD_0"), -1);
+	long long indexAccessor = jsonInteger(json, jsonMember(json, primitiveValue, "indices"), -1);
+	long long mode = jsonInteger(json, jsonMember(json, primitiveValue, "mode"), 4);
+	MeshComponent& mesh = primitive.meshComponent;
+	mesh.m_name = name;
+
+	// baseColorTexture del material -> textures[i].source -> imagen
+	primitive.material = static_cast<int>(jsonInteger(json, jsonMember(json, primitiveValue, "material"), -1));
+	unsigned int materials = jsonMember(json, json.root, "materials");
+	if (primitive.material >= 0 && static_cast<unsigned int>(primitive.material) < jsonCount(json, materials)) {
+		unsigned int baseColor = jsonMember(json, jsonMember(json,
+			jsonElement(json, materials, primitive.material), "pbrMetallicRoughness"), "baseColorTexture");
+		long long textureIndex = jsonInteger(json, jsonMember(json, baseColor, "index"), -1);
+		unsigned int textures = jsonMember(json, json.root, "textures");
+		if (textureIndex >= 0 && textureIndex < jsonCount(json, textures)) {
+			long long source = jsonInteger(json,
+				jsonMember(json, jsonElement(json, textures, static_cast<unsigned int>(textureIndex)), "source"), -1);
+			primitive.image = source >= 0 && static_cast<size_t>(source) < m_images.size() ? static_cast<int>(source) : -1;
+		}
+	}
+
+	// Puntos y lneas no tienen tringulos: la primitiva queda vaca
+	if (mode < 4 || mode > 6) {
+		mesh.init();
+		return S_OK;
+	}
+
+	GltfAccessorView positions = positionAccessor >= 0 ? accessor(static_cast<unsigned int>(positionAccessor)) : GltfAccessorView();
+	if (!positions.data || positions.componentType != 5126 || positions.components != 3) {
+		ERROR("GltfScene", "buildPrimitive", (name + ": POSITION must be a float3 accessor with data").c_str());
+		return E_FAIL;
+	}
+	GltfAccessorView texcoords;
+	if (texcoordAccessor >= 0) {
+		texcoords = accessor(static_cast<unsigned int>(texcoordAccessor));
+		bool supported = texcoords.componentType == 5126 ||
+			(texcoords.normalized && (texcoords.componentType == 5121 || texcoords.componentType == 5123));
+		if (!texcoords.data || texcoords.components != 2 || !supported || texcoords.count != positions.count) {
+			ERROR("GltfScene", "buildPrimitive", (name + ": unsupported TEXCOORD_0 accessor").c_str());
+			return E_FAIL;
+		}
+	}
+
+	// Si POSITION y TEXCOORD_0 ya estn intercalados como SimpleVertex, basta una copia en bloque
+	unsigned int vertexCount = positions.count;
+	mesh.m_vertex.resize(vertexCount);
+	primitive.copiedVertices = texcoords.data == positions.data + sizeof(XMFLOAT3) && texcoords.componentType == 5126 &&
+		positions.stride == sizeof(SimpleVertex) && texcoords.stride == sizeof(SimpleVertex);
+	if (primitive.copiedVertices) {
+		memcpy(mesh.m_vertex.data(), positions.data, static_cast<size_t>(vertexCount) * sizeof(SimpleVertex));
+	}
+	else {
+		for (unsigned int i = 0; i < vertexCount; ++i) {
+			memcpy(&mesh.m_vertex[i].Pos, positions.data + static_cast<size_t>(i) * positions.stride, sizeof(XMFLOAT3));
+			mesh.m_vertex[i].Tex = texcoords.data ? readTexcoord(texcoords, i) : XMFLOAT2(0.0f, 0.0f);
+		}
+	}
+
+	std::vector<unsigned int> indices;
+	if (indexAccessor >= 0) {
+		GltfAccessorView view = accessor(static_cast<unsigned int>(indexAccessor));
+		if (!view.data || view.components != 1 ||
+			(view.componentType != 5121 && view.componentType != 5123 && view.componentType != 5125)) {
+			ERROR("GltfScene", "buildPrimitive", (name + ": indices must be an unsigned scalar accessor with data").c_str());
+			return E_FAIL;
+		}
+		indices.resize(view.count);
+		if (view.componentType == 5125 && view.stride == sizeof(unsigned int)) {
+			memcpy(indices.data(), view.data, indices.size() * sizeof(unsigned int));
+		}
+		else {
+			for (unsigned int i = 0; i < view.count; ++i) {
+				indices[i] = readIndex(view, i);
+			}
+		}
+	}
+	else {
+		indices.resize(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; ++i) {
+			indices[i] = i;
+		}
+	}
+
+	// Strips y fans a lista de tringulos, con el orden de vrtices de la especificacin
+	if (mode != 4) {
+		std::vector<unsigned int> list;
+		unsigned int triangles = indices.size() >= 3 ? static_cast<unsigned int>(indices.size() - 2) : 0;
+		list.reserve(static_cast<size_t>(triangles) * 3);
+		for (unsigned int i = 0; i < triangles; ++i) {
+			if (mode == 5) {
+				list.push_back(indices[i]);
+				list.push_back(indices[i + 1 + i % 2]);
+				list.push_back(indices[i + 2 - i % 2]);
+			}
+			else {
+				list.push_back(indices[i + 1]);
+				list.push_back(indices[i + 2]);
+				list.push_back(indices[0]);
+			}
+		}
+		indices.swap(list);
+	}
+	indices.resize(indices.size() / 3 * 3);
+
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount) {
+			ERROR("GltfScene", "buildPrimitive", (name + ": index out of range").c_str());
+			return E_FAIL;
+		}
+		if (options.leftHanded) {
+			std::swap(indices[i + 1], indices[i + 2]);
+		}
+	}
+	mesh.m_index.swap(indices);
+	mesh.init();
+	return S_OK;
+}
+
+HRESULT
+GltfScene::buildInstances(const GltfJson& json, const GltfLoadOptions& options) {
+	unsigned int nodes = jsonMember(json, json.root, "nodes");
+	unsigned int nodeCount = jsonCount(json, nodes);
+	unsigned int meshCount = static_cast<unsigned int>(m_meshFirstPrimitive.size()) - 1;
+
+	// Races: las de la escena activa o, si no hay escenas, los nodos que nadie tiene de hijo
+	std::vector<unsigned int> roots;
+	unsigned int scenes = jsonMember(json, json.root, "scenes");
+	long long scene = jsonInteger(json, jsonMember(json, json.root, "scene"), 0);
+	if (scene >= 0 && scene < jsonCount(json, scenes)) {
+		unsigned int sceneNodes = jsonMember(json, jsonElement(json, scenes, static_cast<unsigned int>(scene)), "nodes");
+		for (unsigned int i = 0; i < jsonCount(json, sceneNodes); ++i) {
+			roots.push_back(static_cast<unsigned int>(jsonInteger(json, jsonElement(json, sceneNodes, i), -1)));
+		}
+	}
+	else {
+		std::vector<unsigned char> hasParent(nodeCount, 0);
+		for (unsigned int i = 0; i < nodeCount; ++i) {
+			unsigned int children = jsonMember(json, jsonElement(json, nodes, i), "children");
+			for (unsigned int c = 0; c < jsonCount(json, children); ++c) {
+				long long child = jsonInteger(json, jsonElement(json, children, c), -1);
+				if (child >= 0 && child < nodeCount) {
+					hasParent[static_cast<size_t>(child)] = 1;
+				}
+			}
+		}
+		for (unsigned int i = 0; i < nodeCount; ++i) {
+			if (!hasParent[i]) {
+				roots.push_back(i);
+			}
+		}
+	}
+
+	// Pila explcita: una jerarqua de miles de niveles no agota la pila del hilo
+	struct PendingNode {
+		unsigned int node;
+		XMFLOAT4X4 parent;
+	};
+	std::vector<PendingNode> stack;
+	std::vector<unsigned char> visited(nodeCount, 0);
+	PendingNode rootNode;
+	XMStoreFloat4x4(&rootNode.parent, options.leftHanded ? XMMatrixScaling(1.0f, 1.0f, -1.0f) : XMMatrixIdentity());
+	for (size_t i = roots.size(); i-- > 0;) {
+		rootNode.node = roots[i];
+		stack.push_back(rootNode);
+	}
+	while (!stack.empty()) {
+		PendingNode pending = stack.back();
+		stack.pop_back();
+		// Un nodo con dos padres o un ciclo rompe la regla de glTF; se visita solo la primera vez
+		if (pending.node >= nodeCount || visited[pending.node]) {
+			continue;
+		}
+		visited[pending.node] = 1;
+		unsigned int node = jsonElement(json, nodes, pending.node);
+
+		XMMATRIX local;
+		unsigned int matrix = jsonMember(json, node, "matrix");
+		if (jsonCount(json, matrix) == 16) {
+			// Columnas de glTF = filas de XNA Math (vectores fila)
+			XMFLOAT4X4 values;
+			for (unsigned int k = 0; k < 16; ++k) {
+				(&values._11)[k] = static_cast<float>(jsonNumber(json, jsonElement(json, matrix, k), k % 5 == 0 ? 1.0 : 0.0));
+			}
+			local = XMLoadFloat4x4(&values);
+		}
+		else {
+			float trs[10] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+			const char* names[] = { "translation", "rotation", "scale" };
+			unsigned int offsets[] = { 0, 3, 7 };
+			unsigned int sizes[] = { 3, 4, 3 };
+			for (unsigned int a = 0; a < 3; ++a) {
+				unsigned int values = jsonMember(json, node, names[a]);
+				if (jsonCount(json, values) == sizes[a]) {
+					for (unsigned int k = 0; k < sizes[a]; ++k) {
+						trs[offsets[a] + k] = static_cast<float>(jsonNumber(json, jsonElement(json, values, k), trs[offsets[a] + k]));
+					}
+				}
+			}
+			XMFLOAT4 rotation(trs[3], trs[4], trs[5], trs[6]);
+			local = XMMatrixMultiply(XMMatrixMultiply(XMMatrixScaling(trs[7], trs[8], trs[9]),
+				XMMatrixRotationQuaternion(XMLoadFloat4(&rotation))), XMMatrixTranslation(trs[0], trs[1], trs[2]));
+		}
+		XMMATRIX world = XMMatrixMultiply(local, XMLoadFloat4x4(&pending.parent));
+
+		long long mesh = jsonInteger(json, jsonMember(json, node, "mesh"), -1);
+		if (mesh >= 0 && mesh < meshCount) {
+			GltfMeshInstance instance;
+			instance.node = pending.node;
+			instance.mesh = static_cast<unsigned int>(mesh);
+			XMStoreFloat4x4(&instance.world, world);
+			m_instances.push_back(instance);
+		}
+		unsigned int children = jsonMember(json, node, "children");
+		PendingNode child;
+		XMStoreFloat4x4(&child.parent, world);
+		for (unsigned int c = jsonCount(json, children); c-- > 0;) {
+			child.node = static_cast<unsigned int>(jsonInteger(json, jsonElement(json, children, c), -1));
+			stack.push_back(child);
+		}
+	}
+	return S_OK;
+}
@@ -0,0 +1,301 @@
+#include "ImageDecoder.h"
+
+HRESULT
+ImageDecoder::init(ThreadPool* threadPool) {
+	destroy();
+	m_threadPool = threadPool;
+	if (!m_threadPool) {
+		m_ownThreadPool.reset(new ThreadPool());
+		if (FAILED(m_ownThreadPool->init())) {
+			ERROR("ImageDecoder", "init", "Failed to create decoding threads");
+			m_ownThreadPool.reset();
+			return E_FAIL;
+		}
+		m_threadPool = m_ownThreadPool.get();
+	}
+	return S_OK;
+}
+
+void
+ImageDecoder::update() {
+	std::vector<CompletedImage> completed;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		completed.swap(m_completed);
+	}
+	for (CompletedImage& entry : completed) {
+		DecodedImage& image = entry.image;
+		m_pending--;
+		m_stats.decodeMilliseconds += image.decodeMilliseconds;
+		m_stats.convertMilliseconds += image.convertMilliseconds;
+		m_stats.mipMilliseconds += image.mipMilliseconds;
+		if (FAILED(image.result)) {
+			m_stats.failures++;
+		}
+		else {
+			m_stats.images++;
+			m_stats.pixels += static_cast<unsigned long long>(image.width) * image.height;
+		}
+		if (entry.callback) {
+			entry.callback(image);
+		}
+	}
+}
+
+void
+ImageDecoder::destroy() {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this]() { return m_inFlight == 0; });
+		m_completed.clear();
+	}
+	m_ownThreadPool.reset();
+	m_threadPool = nullptr;
+	m_pending = 0;
+	m_stats = ImageDecoderStats();
+}
+
+HRESULT
+ImageDecoder::decodeAsync(const std::string& fileName,
+	const ImageDecodeOptions& options,
+	ImageDecodeCallback callback) {
+	if (!m_threadPool) {
+		ERROR("ImageDecoder", "decodeAsync", "ImageDecoder is not initialized.");
+		return E_FAIL;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_inFlight++;
+	}
+	m_pending++;
+
+	// La tarea solo usa copias y la cola protegida por m_mutex; destroy() espera a m_inFlight
+	m_threadPool->enqueue([this, fileName, options, callback]() {
+		CompletedImage entry;
+		entry.callback = callback;
+		decode(fileName, options, entry.image);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_completed.push_back(std::move(entry));
+		m_inFlight--;
+		m_idle.notify_all();
+	});
+	return S_OK;
+}
+
+std::string
+ImageDecoder::report() const {
+	unsigned long long finished = m_stats.images + m_stats.failures;
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+	os << "Image decoder: " << m_stats.images << " images (" << (m_stats.pixels / 1000000.0) << " MPix), "
+		<< m_stats.failures << " failed, " << m_pending << " pending; " << m_stats.decodeMilliseconds
+		<< " ms decoding, " << m_stats.convertMilliseconds << " ms converting, " << m_stats.mipMilliseconds
+		<< " ms building mips on " << (m_threadPool ? m_threadPool->size() : 0) << " threads";
+	if (finished > 0) {
+		double totalMilliseconds = m_stats.decodeMilliseconds + m_stats.convertMilliseconds + m_stats.mipMilliseconds;
+		os << " (" << (totalMilliseconds / finished) << " ms/image)";
+	}
+	os << "\n";
+	return os.str();
+}
+
+/**
+ * @brief Decodifica con WIC desde @p fileName o, si @p data no es @c nullptr, desde memoria.
+ */
+static HRESULT
+decodeWithWIC(const std::string& fileName,
+	const unsigned char* data,
+	size_t size,
+	const ImageDecodeOptions& options,
+	DecodedImage& image) {
+	image = DecodedImage();
+	image.fileName = fileName;
+	bool rgba = options.format == DXGI_FORMAT_R8G8B8A8_UNORM || options.format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	bool bgra = options.format == DXGI_FORMAT_B8G8R8A8_UNORM || options.format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+	if (!rgba && !bgra) {
+		ERROR("ImageDecoder", "decode", "Only RGBA8 and BGRA8 output formats are supported");
+		image.result = E_INVALIDARG;
+		return image.result;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	// WIC es COM: cada hilo necesita su propia inicializacin
+	HRESULT coInit = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	IWICImagingFactory* factory = nullptr;
+	IWICBitmapDecoder* decoder = nullptr;
+	IWICBitmapFrameDecode* frame = nullptr;
+	IWICFormatConverter* converter = nullptr;
+
+	IWICStream* stream = nullptr;
+
+	HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+	if (SUCCEEDED(hr) && data) {
+		// El stream lee directamente de data, sin copiarla
+		hr = size > 0 && size <= 0xFFFFFFFFu ? factory->CreateStream(&stream) : E_INVALIDARG;
+		if (SUCCEEDED(hr)) {
+			hr = stream->InitializeFromMemory(const_cast<BYTE*>(data), static_cast<DWORD>(size));
+		}
+		if (SUCCEEDED(hr)) {
+			hr = factory->CreateDecoderFromStream(stream, nullptr, WICDecodeMetadataCacheOnDemand, &decoder);
+		}
+	}
+	else if (SUCCEEDED(hr)) {
+		int length = MultiByteToWideChar(CP_ACP, 0, fileName.c_str(), -1, nullptr, 0);
+		std::wstring wideName(length > 0 ? length : 1, L'\0');
+		MultiByteToWideChar(CP_ACP, 0, fileName.c_str(), -1, &wideName[0], length);
+		hr = factory->CreateDecoderFromFilename(wideName.c_str(), nullptr, GENERIC_READ,
+			WICDecodeMetadataCacheOnDemand, &decoder);
+	}
+	if (SUCCEEDED(hr)) {
+		hr = decoder->GetFrame(0, &frame);
+	}
+	if (SUCCEEDED(hr)) {
+		hr = frame->GetSize(&image.width, &image.height);
+	}
+	if (SUCCEEDED(hr) && (image.width == 0 || image.height == 0 || image.width > 16384 || image.height > 16384)) {
+		hr = E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		// El convertidor de WIC solo lleva el formato nativo (24 bits, paleta...) a BGRA
+		hr = factory->CreateFormatConverter(&converter);
+	}
+	if (SUCCEEDED(hr)) {
+		hr = converter->Initialize(frame, GUID_WICPixelFormat32bppBGRA, WICBitmapDitherTypeNone,
+			nullptr, 0.0, WICBitmapPaletteTypeCustom);
+	}
+	if (SUCCEEDED(hr)) {
+		image.rowPitch = image.width * 4;
+		image.pixels.resize(static_cast<size_t>(image.rowPitch) * image.height);
+		hr = converter->CopyPixels(nullptr, image.rowPitch, static_cast<UINT>(image.pixels.size()),
+			image.pixels.data());
+	}
+
+	SAFE_RELEASE(converter);
+	SAFE_RELEASE(frame);
+	SAFE_RELEASE(decoder);
+	SAFE_RELEASE(stream);
+	SAFE_RELEASE(factory);
+	if (SUCCEEDED(coInit)) {
+		CoUninitialize();
+	}
+
+	std::chrono::steady_clock::time_point decoded = std::chrono::steady_clock::now();
+	image.decodeMilliseconds = std::chrono::duration<double, std::milli>(decoded - start).count();
+	if (FAILED(hr)) {
+		ERROR("ImageDecoder", "decode", ("Failed to decode " + fileName + ". HRESULT: " + std::to_string(hr)).c_str());
+		image.pixels.clear();
+		image.width = image.height = image.rowPitch = 0;
+		image.result = hr;
+		return hr;
+	}
+
+	if (rgba || options.premultiplyAlpha) {
+		ImageDecoder::convertPixels(image.pixels.data(), image.pixels.data(),
+			static_cast<size_t>(image.width) * image.height, rgba, options.premultiplyAlpha);
+	}
+	std::chrono::steady_clock::time_point converted = std::chrono::steady_clock::now();
+	image.convertMilliseconds = std::chrono::duration<double, std::milli>(converted - decoded).count();
+	image.format = options.format;
+	if (options.generateMips) {
+		hr = MipGenerator::generate(image.pixels.data(), image.width, image.height, image.rowPitch, image.format,
+			options.mipOptions, image.mips);
+		image.mipMilliseconds =
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - converted).count();
+		if (FAILED(hr)) {
+			image.result = hr;
+			return hr;
+		}
+	}
+	image.result = S_OK;
+	return S_OK;
+}
+
+HRESULT
+ImageDecoder::decode(const std::string& fileName, const ImageDecodeOptions& options, DecodedImage& image) {
+	return decodeWithWIC(fileName, nullptr, 0, options, image);
+}
+
+HRESULT
+ImageDecoder::decode(const unsigned char* data,
+	size_t size,
+	const std::string& name,
+	const ImageDecodeOptions& options,
+	DecodedImage& image) {
+	if (!data) {
+		ERROR("ImageDecoder", "decode", ("No data for " + name).c_str());
+		image = DecodedImage();
+		image.fileName = name;
+		image.result = E_POINTER;
+		return image.result;
+	}
+	return decodeWithWIC(name, data, size, options, image);
+}
+
+void
+ImageDecoder::convertPixels(const unsigned char* source,
+	unsigned char* destination,
+	size_t pixelCount,
+	bool swapRedBlue,
+	bool premultiplyAlpha) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lowByte = _mm_set1_epi32(0x000000FF);
+	const __m128i greenAlpha = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+	// Multiplicador del canal alfa: 255 lo deja igual
+	const __m128i alphaLane = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+	const __m128i colorLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+	const __m128i half = _mm_set1_epi16(128);
+
+	size_t i = 0;
+	for (; i + 4 <= pixelCount; i += 4) {
+		__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+		if (swapRedBlue) {
+			__m128i blue = _mm_slli_epi32(_mm_and_si128(pixels, lowByte), 16);
+			__m128i red = _mm_and_si128(_mm_srli_epi32(pixels, 16), lowByte);
+			pixels = _mm_or_si128(_mm_and_si128(pixels, greenAlpha), _mm_or_si128(red, blue));
+		}
+		if (premultiplyAlpha) {
+			// Dos pxeles por registro en 16 bits; el alfa se copia a los cuatro canales
+			__m128i low = _mm_unpacklo_epi8(pixels, zero);
+			__m128i high = _mm_unpackhi_epi8(pixels, zero);
+			__m128i lowAlpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			__m128i highAlpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(high, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			lowAlpha = _mm_or_si128(_mm_and_si128(lowAlpha, colorLanes), alphaLane);
+			highAlpha = _mm_or_si128(_mm_and_si128(highAlpha, colorLanes), alphaLane);
+			// x * a / 255 redondeado: t = x * a + 128; (t + (t >> 8)) >> 8
+			low = _mm_add_epi16(_mm_mullo_epi16(low, lowAlpha), half);
+			high = _mm_add_epi16(_mm_mullo_epi16(high, highAlpha), half);
+			low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+			high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+			pixels = _mm_packus_epi16(low, high);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), pixels);
+	}
+	convertPixelsScalar(source + i * 4, destination + i * 4, pixelCount - i, swapRedBlue, premultiplyAlpha);
+}
+
+void
+ImageDecoder::convertPixelsScalar(const unsigned char* source,
+	unsigned char* destination,
+	size_t pixelCount,
+	bool swapRedBlue,
+	bool premultiplyAlpha) {
+	for (size_t i = 0; i < pixelCount; ++i) {
+		const unsigned char* in = source + i * 4;
+		unsigned char* out = destination + i * 4;
+		unsigned int b = in[0], g = in[1], r = in[2], a = in[3];
+		if (premultiplyAlpha) {
+			unsigned int t = r * a + 128;
+			r = (t + (t >> 8)) >> 8;
+			t = g * a + 128;
+			g = (t + (t >> 8)) >> 8;
+			t = b * a + 128;
+			b = (t + (t >> 8)) >> 8;
+		}
+		out[0] = static_cast<unsigned char>(swapRedBlue ? r : b);
+		out[1] = static_cast<unsigned char>(g);
+		out[2] = static_cast<unsigned char>(swapRedBlue ? b : r);
+		out[3] = static_cast<unsigned char>(a);
+	}
+}
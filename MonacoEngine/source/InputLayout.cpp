@@ -43,10 +43,39 @@ InputLayout::render(DeviceContext& deviceContext) {
 		return;
 	}
 
-	deviceContext.m_deviceContext->IASetInputLayout(m_inputLayout);
+	deviceContext.IASetInputLayout(m_inputLayout);
 }
 
 void
 InputLayout::destroy() {
 	SAFE_RELEASE(m_inputLayout);
 }
+
+D3D11_INPUT_ELEMENT_DESC
+InputLayout::element(const char* semanticName,
+	unsigned int semanticIndex,
+	DXGI_FORMAT format,
+	unsigned int inputSlot,
+	bool perInstance,
+	unsigned int stepRate) {
+	D3D11_INPUT_ELEMENT_DESC desc;
+	desc.SemanticName = semanticName;
+	desc.SemanticIndex = semanticIndex;
+	desc.Format = format;
+	desc.InputSlot = inputSlot;
+	desc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	desc.InputSlotClass = perInstance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA;
+	desc.InstanceDataStepRate = perInstance ? stepRate : 0;
+	return desc;
+}
+
+void
+InputLayout::appendInstanceData(std::vector<D3D11_INPUT_ELEMENT_DESC>& Layout,
+	unsigned int inputSlot) {
+	// Mismo orden que los campos de InstanceData
+	for (unsigned int row = 0; row < 4; ++row) {
+		Layout.push_back(element("WORLD", row, DXGI_FORMAT_R32G32B32A32_FLOAT, inputSlot, true));
+	}
+	Layout.push_back(element("COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, inputSlot, true));
+	Layout.push_back(element("CUSTOM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, inputSlot, true));
+}
@@ -0,0 +1,132 @@
+#include "InstanceBatcher.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "MeshComponent.h"
+
+HRESULT
+InstanceBatcher::init(Device& device, unsigned int maxInstances) {
+	if (!device.m_device) {
+		ERROR("InstanceBatcher", "init", "Device is null.");
+		return E_POINTER;
+	}
+	if (maxInstances == 0) {
+		ERROR("InstanceBatcher", "init", "maxInstances is zero");
+		return E_INVALIDARG;
+	}
+	destroy();
+
+	m_device = &device;
+	HRESULT hr = m_instanceBuffer.init(device, sizeof(InstanceData), maxInstances, nullptr, true);
+	if (FAILED(hr)) {
+		ERROR("InstanceBatcher", "init", "Failed to create instance buffer");
+		return hr;
+	}
+	m_capacity = maxInstances;
+	return S_OK;
+}
+
+void
+InstanceBatcher::update() {
+	for (Batch* batch : m_activeBatches) {
+		batch->instances.clear();
+	}
+	m_activeBatches.clear();
+	m_instanceCount = 0;
+}
+
+void
+InstanceBatcher::render(DeviceContext& deviceContext) {
+	m_drawCount = 0;
+	if (m_activeBatches.empty()) {
+		return;
+	}
+	if (!m_device) {
+		ERROR("InstanceBatcher", "render", "InstanceBatcher is not initialized.");
+		return;
+	}
+
+	// Crecer al doble si el frame no cabe en el buffer actual
+	if (m_instanceCount > m_capacity) {
+		unsigned int capacity = m_capacity;
+		while (capacity < m_instanceCount) {
+			capacity *= 2;
+		}
+		m_instanceBuffer.destroy();
+		HRESULT hr = m_instanceBuffer.init(*m_device, sizeof(InstanceData), capacity, nullptr, true);
+		if (FAILED(hr)) {
+			ERROR("InstanceBatcher", "render", "Failed to grow instance buffer");
+			m_capacity = 0;
+			return;
+		}
+		m_capacity = capacity;
+	}
+
+	// Todos los lotes comparten el buffer: se sube una vez y cada draw empieza en su offset
+	m_upload.clear();
+	for (Batch* batch : m_activeBatches) {
+		m_upload.insert(m_upload.end(), batch->instances.begin(), batch->instances.end());
+	}
+	HRESULT hr = m_instanceBuffer.write(deviceContext,
+		m_upload.data(),
+		static_cast<unsigned int>(m_upload.size() * sizeof(InstanceData)));
+	if (FAILED(hr)) {
+		return;
+	}
+	m_instanceBuffer.render(deviceContext, 1, 1);
+
+	unsigned int startInstance = 0;
+	for (Batch* batch : m_activeBatches) {
+		unsigned int count = static_cast<unsigned int>(batch->instances.size());
+		batch->vertexBuffer.render(deviceContext, 0, 1);
+		batch->indexBuffer.render(deviceContext, 0, 1, false, DXGI_FORMAT_R32_UINT);
+		deviceContext.DrawIndexedInstanced(batch->indexCount, count, 0, 0, startInstance);
+		startInstance += count;
+		m_drawCount++;
+	}
+}
+
+void
+InstanceBatcher::destroy() {
+	for (auto& entry : m_batches) {
+		entry.second->vertexBuffer.destroy();
+		entry.second->indexBuffer.destroy();
+	}
+	m_batches.clear();
+	m_activeBatches.clear();
+	m_instanceBuffer.destroy();
+	m_upload = std::vector<InstanceData>();
+	m_device = nullptr;
+	m_capacity = 0;
+	m_drawCount = 0;
+	m_instanceCount = 0;
+}
+
+void
+InstanceBatcher::add(const MeshComponent& mesh, const InstanceData& instance) {
+	if (!m_device) {
+		ERROR("InstanceBatcher", "add", "InstanceBatcher is not initialized.");
+		return;
+	}
+
+	auto it = m_batches.find(&mesh);
+	if (it == m_batches.end()) {
+		// Primera vez que aparece la malla: se crean sus buffers y se reutilizan en adelante
+		std::unique_ptr<Batch> batch = std::make_unique<Batch>();
+		if (FAILED(batch->vertexBuffer.init(*m_device, mesh, D3D11_BIND_VERTEX_BUFFER)) ||
+			FAILED(batch->indexBuffer.init(*m_device, mesh, D3D11_BIND_INDEX_BUFFER))) {
+			ERROR("InstanceBatcher", "add", "Failed to create mesh buffers");
+			batch->vertexBuffer.destroy();
+			batch->indexBuffer.destroy();
+			return;
+		}
+		batch->indexCount = static_cast<unsigned int>(mesh.m_index.size());
+		it = m_batches.emplace(&mesh, std::move(batch)).first;
+	}
+
+	Batch* batch = it->second.get();
+	if (batch->instances.empty()) {
+		m_activeBatches.push_back(batch);
+	}
+	batch->instances.push_back(instance);
+	m_instanceCount++;
+}
@@ -0,0 +1,48 @@
+#include "MappedFile.h"
+
+HRESULT
+MappedFile::init(const std::string& fileName) {
+	destroy();
+	m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		ERROR("MappedFile", "init", ("Failed to open " + fileName).c_str());
+		return E_FAIL;
+	}
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart <= 0 ||
+		static_cast<unsigned long long>(fileSize.QuadPart) > static_cast<size_t>(-1)) {
+		// CreateFileMapping no acepta archivos vacos
+		ERROR("MappedFile", "init", ("Empty or oversized file " + fileName).c_str());
+		destroy();
+		return E_FAIL;
+	}
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping) {
+		m_view = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (!m_view) {
+		ERROR("MappedFile", "init", ("Failed to map " + fileName).c_str());
+		destroy();
+		return E_FAIL;
+	}
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	return S_OK;
+}
+
+void
+MappedFile::destroy() {
+	if (m_view) {
+		UnmapViewOfFile(m_view);
+		m_view = nullptr;
+	}
+	if (m_mapping) {
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+	}
+	if (m_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_file);
+		m_file = INVALID_HANDLE_VALUE;
+	}
+	m_size = 0;
+}
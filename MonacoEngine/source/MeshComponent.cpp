@@ -0,0 +1,23 @@
+#include "MeshComponent.h"
+
+void
+MeshComponent::init() {
+	m_numVertex = static_cast<int>(m_vertex.size());
+	m_numIndex = static_cast<int>(m_index.size());
+}
+
+void
+MeshComponent::update(float /*deltaTime*/) {
+}
+
+void
+MeshComponent::render(DeviceContext& /*deviceContext*/) {
+}
+
+void
+MeshComponent::destroy() {
+	m_vertex.clear();
+	m_index.clear();
+	m_numVertex = 0;
+	m_numIndex = 0;
+}
@@ -0,0 +1,543 @@
+#include "MipGenerator.h"
+#include "ThreadPool.h"
+
+// Cmo se guardan los pxeles de un formato soportado
+enum PixelEncoding {
+	kUnorm8 = 0,
+	kHalf = 1,
+	kFloat = 2
+};
+
+struct PixelLayout {
+	PixelEncoding encoding = kUnorm8;
+	unsigned int bytesPerPixel = 4;
+	bool srgb = false;
+	bool bgra = false;
+};
+
+// Pesos de un filtro separable: los taps del destino i van de first[i] a first[i + 1]
+struct ResampleTable {
+	std::vector<unsigned int> first;
+	std::vector<unsigned int> source;
+	std::vector<float> weight;
+};
+
+static bool
+describeFormat(DXGI_FORMAT format, PixelLayout& layout) {
+	layout = PixelLayout();
+	switch (format) {
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+		return true;
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		layout.srgb = true;
+		return true;
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+		layout.bgra = true;
+		return true;
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		layout.bgra = true;
+		layout.srgb = true;
+		return true;
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		layout.encoding = kHalf;
+		layout.bytesPerPixel = 8;
+		return true;
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		layout.encoding = kFloat;
+		layout.bytesPerPixel = 16;
+		return true;
+	default:
+		return false;
+	}
+}
+
+static float
+srgbToLinear(float value) {
+	return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+// Valor lineal de cada uno de los 256 cdigos sRGB
+static const float*
+srgbDecodeTable() {
+	static const std::vector<float> table = []() {
+		std::vector<float> values(256);
+		for (unsigned int i = 0; i < 256; ++i) {
+			values[i] = srgbToLinear(i / 255.0f);
+		}
+		return values;
+	}();
+	return table.data();
+}
+
+// Punto medio lineal entre cada par de cdigos sRGB, ms un cdigo de partida por cada
+// 1/4096 de valor lineal; los cdigos estn a ms de 1/4096 entre s, as que desde el de
+// partida basta avanzar uno o dos
+struct SRGBEncodeTable {
+	float thresholds[256];
+	unsigned char start[4097];
+};
+
+static const SRGBEncodeTable&
+srgbEncodeTable() {
+	static const SRGBEncodeTable table = []() {
+		SRGBEncodeTable values;
+		for (unsigned int i = 0; i < 255; ++i) {
+			values.thresholds[i] = srgbToLinear((i + 0.5f) / 255.0f);
+		}
+		values.thresholds[255] = 2.0f;
+		unsigned int code = 0;
+		for (unsigned int i = 0; i <= 4096; ++i) {
+			while (values.thresholds[code] <= i / 4096.0f) {
+				++code;
+			}
+			values.start[i] = static_cast<unsigned char>(code);
+		}
+		return values;
+	}();
+	return table;
+}
+
+// Cdigo sRGB ms cercano a @p value, que ya est en [0, 1]
+static unsigned char
+encodeSRGB(const SRGBEncodeTable& table, float value) {
+	unsigned int code = table.start[static_cast<unsigned int>(value * 4096.0f)];
+	while (table.thresholds[code] <= value) {
+		++code;
+	}
+	return static_cast<unsigned char>(code);
+}
+
+static float
+halfToFloat(unsigned short half) {
+	unsigned int sign = (half & 0x8000u) << 16;
+	unsigned int exponent = (half >> 10) & 0x1F;
+	unsigned int mantissa = half & 0x3FF;
+	unsigned int bits;
+	if (exponent == 0x1F) {
+		bits = sign | 0x7F800000u | (mantissa << 13);
+	}
+	else if (exponent != 0) {
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else if (mantissa != 0) {
+		// Subnormal: se normaliza desplazando la mantisa
+		exponent = 113;
+		while ((mantissa & 0x400) == 0) {
+			mantissa <<= 1;
+			--exponent;
+		}
+		bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+	}
+	else {
+		bits = sign;
+	}
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static unsigned short
+floatToHalf(float value) {
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	unsigned int sign = (bits >> 16) & 0x8000u;
+	unsigned int magnitude = bits & 0x7FFFFFFFu;
+	if (magnitude >= 0x7F800000u) {
+		// Infinito o NaN
+		return static_cast<unsigned short>(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+	}
+	if (magnitude >= 0x477FF000u) {
+		return static_cast<unsigned short>(sign | 0x7C00u);
+	}
+	if (magnitude < 0x38800000u) {
+		// Subnormal en 16 bits (o cero), redondeado al par ms cercano
+		if (magnitude < 0x33000000u) {
+			return static_cast<unsigned short>(sign);
+		}
+		unsigned int exponent = magnitude >> 23;
+		unsigned int mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+		unsigned int shift = 126 - exponent;
+		unsigned int half = mantissa >> shift;
+		unsigned int remainder = mantissa & ((1u << shift) - 1);
+		unsigned int halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1))) {
+			++half;
+		}
+		return static_cast<unsigned short>(sign | half);
+	}
+	unsigned int half = ((magnitude - 0x38000000u) >> 13);
+	unsigned int remainder = magnitude & 0x1FFFu;
+	if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1))) {
+		++half;
+	}
+	return static_cast<unsigned short>(sign | half);
+}
+
+static void
+loadRow(const unsigned char* source, unsigned int width, const PixelLayout& layout, float* destination) {
+	if (layout.encoding == kFloat) {
+		memcpy(destination, source, static_cast<size_t>(width) * 16);
+		return;
+	}
+	if (layout.encoding == kHalf) {
+		for (unsigned int i = 0; i < width * 4; ++i) {
+			unsigned short half;
+			memcpy(&half, source + i * 2, sizeof(half));
+			destination[i] = halfToFloat(half);
+		}
+		return;
+	}
+	const float* decode = srgbDecodeTable();
+	unsigned int red = layout.bgra ? 2 : 0;
+	unsigned int blue = layout.bgra ? 0 : 2;
+	if (layout.srgb) {
+		for (unsigned int x = 0; x < width; ++x) {
+			const unsigned char* in = source + x * 4;
+			float* out = destination + x * 4;
+			out[0] = decode[in[red]];
+			out[1] = decode[in[1]];
+			out[2] = decode[in[blue]];
+			out[3] = in[3] / 255.0f;
+		}
+		return;
+	}
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 inverse = _mm_set1_ps(1.0f / 255.0f);
+	for (unsigned int x = 0; x < width; ++x) {
+		int packed;
+		memcpy(&packed, source + x * 4, sizeof(packed));
+		__m128i bytes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+		__m128 pixel = _mm_mul_ps(_mm_cvtepi32_ps(bytes), inverse);
+		if (layout.bgra) {
+			pixel = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 0, 1, 2));
+		}
+		_mm_storeu_ps(destination + x * 4, pixel);
+	}
+}
+
+static void
+storeRow(const float* source, unsigned int width, const PixelLayout& layout, float alphaScale, unsigned char* destination) {
+	if (layout.encoding != kUnorm8) {
+		for (unsigned int x = 0; x < width; ++x) {
+			float pixel[4] = { source[x * 4], source[x * 4 + 1], source[x * 4 + 2], source[x * 4 + 3] };
+			if (alphaScale != 1.0f) {
+				pixel[3] = (std::min)(pixel[3] * alphaScale, 1.0f);
+			}
+			if (layout.encoding == kFloat) {
+				memcpy(destination + x * 16, pixel, sizeof(pixel));
+			}
+			else {
+				for (unsigned int c = 0; c < 4; ++c) {
+					unsigned short half = floatToHalf(pixel[c]);
+					memcpy(destination + x * 8 + c * 2, &half, sizeof(half));
+				}
+			}
+		}
+		return;
+	}
+	const SRGBEncodeTable& encode = srgbEncodeTable();
+	unsigned int red = layout.bgra ? 2 : 0;
+	unsigned int blue = layout.bgra ? 0 : 2;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set_ps(alphaScale, 1.0f, 1.0f, 1.0f);
+	for (unsigned int x = 0; x < width; ++x) {
+		// Los filtros con lbulos negativos pueden salir de [0, 1]
+		float pixel[4];
+		_mm_storeu_ps(pixel, _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(source + x * 4), scale), zero), one));
+		unsigned char* out = destination + x * 4;
+		if (layout.srgb) {
+			out[red] = encodeSRGB(encode, pixel[0]);
+			out[1] = encodeSRGB(encode, pixel[1]);
+			out[blue] = encodeSRGB(encode, pixel[2]);
+		}
+		else {
+			out[red] = static_cast<unsigned char>(pixel[0] * 255.0f + 0.5f);
+			out[1] = static_cast<unsigned char>(pixel[1] * 255.0f + 0.5f);
+			out[blue] = static_cast<unsigned char>(pixel[2] * 255.0f + 0.5f);
+		}
+		out[3] = static_cast<unsigned char>(pixel[3] * 255.0f + 0.5f);
+	}
+}
+
+static float
+sinc(float x) {
+	if (fabsf(x) < 1e-6f) {
+		return 1.0f;
+	}
+	x *= 3.14159265f;
+	return sinf(x) / x;
+}
+
+// Funcin de Bessel modificada de orden 0, por su serie
+static float
+besselI0(float x) {
+	float sum = 1.0f;
+	float term = 1.0f;
+	float quarter = x * x * 0.25f;
+	for (unsigned int k = 1; k < 32 && term > sum * 1e-8f; ++k) {
+		term *= quarter / static_cast<float>(k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+static float
+filterRadius(MipFilter filter) {
+	return filter == MipFilter::Box ? 0.5f : 3.0f;
+}
+
+// Peso del filtro a @p t pxeles de destino del centro
+static float
+filterWeight(MipFilter filter, float t) {
+	const float radius = 3.0f;
+	if (fabsf(t) >= radius) {
+		return 0.0f;
+	}
+	if (filter == MipFilter::Lanczos) {
+		return sinc(t) * sinc(t / radius);
+	}
+	const float alpha = 4.0f;
+	float ratio = t / radius;
+	return sinc(t) * besselI0(alpha * sqrtf(1.0f - ratio * ratio)) / besselI0(alpha);
+}
+
+static void
+buildResampleTable(unsigned int sourceSize,
+	unsigned int destinationSize,
+	MipFilter filter,
+	bool wrap,
+	ResampleTable& table) {
+	table.first.assign(1, 0);
+	table.source.clear();
+	table.weight.clear();
+	float scale = static_cast<float>(sourceSize) / destinationSize;
+	float support = filterRadius(filter) * scale;
+	for (unsigned int i = 0; i < destinationSize; ++i) {
+		size_t firstTap = table.weight.size();
+		if (sourceSize == destinationSize) {
+			table.source.push_back(i);
+			table.weight.push_back(1.0f);
+		}
+		else {
+			float center = (i + 0.5f) * scale;
+			int begin = static_cast<int>(floorf(center - support));
+			int end = static_cast<int>(ceilf(center + support));
+			float total = 0.0f;
+			for (int j = begin; j < end; ++j) {
+				float weight;
+				if (filter == MipFilter::Box) {
+					// rea del pxel j cubierta por la caja del destino
+					weight = (std::min)(j + 1.0f, center + support) - (std::max)(static_cast<float>(j), center - support);
+				}
+				else {
+					weight = filterWeight(filter, (j + 0.5f - center) / scale);
+				}
+				if (filter == MipFilter::Box ? weight <= 0.0f : weight == 0.0f) {
+					continue;
+				}
+				int index = j;
+				if (wrap) {
+					index %= static_cast<int>(sourceSize);
+					index += index < 0 ? static_cast<int>(sourceSize) : 0;
+				}
+				else {
+					index = (std::max)(0, (std::min)(index, static_cast<int>(sourceSize) - 1));
+				}
+				table.source.push_back(static_cast<unsigned int>(index));
+				table.weight.push_back(weight);
+				total += weight;
+			}
+			for (size_t k = firstTap; k < table.weight.size(); ++k) {
+				table.weight[k] /= total;
+			}
+		}
+		table.first.push_back(static_cast<unsigned int>(table.weight.size()));
+	}
+}
+
+static void
+forEachRow(ThreadPool* threadPool, unsigned int rows, const std::function<void(unsigned int)>& body) {
+	if (threadPool && rows > 1) {
+		threadPool->parallelFor(rows, body);
+		return;
+	}
+	for (unsigned int y = 0; y < rows; ++y) {
+		body(y);
+	}
+}
+
+// Fila @p y del nivel que se reduce, en RGBA lineal. El nivel 0 no se guarda entero en
+// flotantes: cada fila se convierte cuando se lee, en @p scratch (ancho * 4 flotantes)
+using RowReader = std::function<const float*(unsigned int y, float* scratch)>;
+
+// Reduce @p source a @p destination con el filtro separable de @p options; @p horizontal
+// guarda el resultado intermedio de filtrar las filas
+static void
+resample(const RowReader& source,
+	unsigned int sourceWidth,
+	unsigned int sourceHeight,
+	std::vector<float>& destination,
+	unsigned int width,
+	unsigned int height,
+	const MipGenerateOptions& options,
+	std::vector<float>& horizontal,
+	ThreadPool* threadPool) {
+	ResampleTable columns, rows;
+	buildResampleTable(sourceWidth, width, options.filter, options.wrap, columns);
+	buildResampleTable(sourceHeight, height, options.filter, options.wrap, rows);
+
+	// Filas: cada fila del origen a @p width pxeles
+	horizontal.resize(static_cast<size_t>(sourceHeight) * width * 4);
+	forEachRow(threadPool, sourceHeight, [&](unsigned int y) {
+		std::vector<float> scratch(static_cast<size_t>(sourceWidth) * 4);
+		const float* in = source(y, scratch.data());
+		float* out = &horizontal[static_cast<size_t>(y) * width * 4];
+		for (unsigned int x = 0; x < width; ++x) {
+			__m128 sum = _mm_setzero_ps();
+			for (unsigned int k = columns.first[x]; k < columns.first[x + 1]; ++k) {
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in + columns.source[k] * 4), _mm_set1_ps(columns.weight[k])));
+			}
+			_mm_storeu_ps(out + x * 4, sum);
+		}
+	});
+
+	// Columnas: se acumula fila por fila para recorrer la memoria en orden
+	forEachRow(threadPool, height, [&](unsigned int y) {
+		float* out = &destination[static_cast<size_t>(y) * width * 4];
+		std::fill(out, out + width * 4, 0.0f);
+		for (unsigned int k = rows.first[y]; k < rows.first[y + 1]; ++k) {
+			const float* in = &horizontal[static_cast<size_t>(rows.source[k]) * width * 4];
+			__m128 weight = _mm_set1_ps(rows.weight[k]);
+			for (unsigned int x = 0; x < width * 4; x += 4) {
+				_mm_storeu_ps(out + x, _mm_add_ps(_mm_loadu_ps(out + x), _mm_mul_ps(_mm_loadu_ps(in + x), weight)));
+			}
+		}
+	});
+}
+
+// Pxeles de @p pixels cuyo alfa multiplicado por @p scale supera @p reference
+static size_t
+coveredPixels(const float* pixels, size_t count, float reference, float scale) {
+	size_t covered = 0;
+	for (size_t i = 0; i < count; ++i) {
+		covered += pixels[i * 4 + 3] * scale > reference ? 1 : 0;
+	}
+	return covered;
+}
+
+bool
+MipGenerator::supportsFormat(DXGI_FORMAT format) {
+	PixelLayout layout;
+	return describeFormat(format, layout);
+}
+
+unsigned int
+MipGenerator::mipCount(unsigned int width, unsigned int height) {
+	unsigned int levels = 1;
+	for (unsigned int size = (std::max)(width, height); size > 1; size >>= 1) {
+		++levels;
+	}
+	return levels;
+}
+
+HRESULT
+MipGenerator::generate(const void* pixels,
+	unsigned int width,
+	unsigned int height,
+	unsigned int rowPitch,
+	DXGI_FORMAT format,
+	const MipGenerateOptions& options,
+	std::vector<MipLevel>& mips,
+	ThreadPool* threadPool) {
+	mips.clear();
+	PixelLayout layout;
+	if (!describeFormat(format, layout)) {
+		ERROR("MipGenerator", "generate", "Unsupported format for mip generation");
+		return E_INVALIDARG;
+	}
+	layout.srgb |= options.srgb && layout.encoding == kUnorm8;
+	if (!pixels || width == 0 || height == 0 || rowPitch < width * layout.bytesPerPixel) {
+		ERROR("MipGenerator", "generate", "Invalid image");
+		return E_INVALIDARG;
+	}
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(pixels);
+	std::vector<float> current, next, horizontal;
+	unsigned int currentWidth = width;
+	unsigned int currentHeight = height;
+	RowReader readRow = [&](unsigned int y, float* scratch) -> const float* {
+		if (current.empty()) {
+			loadRow(bytes + static_cast<size_t>(y) * rowPitch, width, layout, scratch);
+			return scratch;
+		}
+		return &current[static_cast<size_t>(y) * currentWidth * 4];
+	};
+
+	float targetCoverage = 0.0f;
+	if (options.preserveAlphaCoverage) {
+		std::vector<float> row(static_cast<size_t>(width) * 4);
+		size_t covered = 0;
+		for (unsigned int y = 0; y < height; ++y) {
+			covered += coveredPixels(readRow(y, row.data()), width, options.alphaReference, 1.0f);
+		}
+		targetCoverage = static_cast<float>(covered) / (static_cast<size_t>(width) * height);
+	}
+
+	mips.resize(mipCount(width, height) - 1);
+	for (MipLevel& mip : mips) {
+		unsigned int nextWidth = (std::max)(1u, currentWidth / 2);
+		unsigned int nextHeight = (std::max)(1u, currentHeight / 2);
+		next.resize(static_cast<size_t>(nextHeight) * nextWidth * 4);
+		if (options.filter == MipFilter::Box && currentWidth == nextWidth * 2 && currentHeight == nextHeight * 2) {
+			// Caso comn de tamaos pares: promedio directo de 2x2, en una sola pasada
+			const __m128 quarter = _mm_set1_ps(0.25f);
+			forEachRow(threadPool, nextHeight, [&](unsigned int y) {
+				std::vector<float> scratch(static_cast<size_t>(currentWidth) * 8);
+				const float* top = readRow(y * 2, scratch.data());
+				const float* bottom = readRow(y * 2 + 1, scratch.data() + currentWidth * 4);
+				float* out = &next[static_cast<size_t>(y) * nextWidth * 4];
+				for (unsigned int x = 0; x < nextWidth; ++x) {
+					__m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(top + x * 8), _mm_loadu_ps(top + x * 8 + 4)),
+						_mm_add_ps(_mm_loadu_ps(bottom + x * 8), _mm_loadu_ps(bottom + x * 8 + 4)));
+					_mm_storeu_ps(out + x * 4, _mm_mul_ps(sum, quarter));
+				}
+			});
+		}
+		else {
+			resample(readRow, currentWidth, currentHeight, next, nextWidth, nextHeight, options, horizontal, threadPool);
+		}
+
+		// La escala de alfa solo se aplica al escribir: el siguiente nivel se filtra del original
+		float alphaScale = 1.0f;
+		if (options.preserveAlphaCoverage && targetCoverage > 0.0f) {
+			float low = 0.0f;
+			float high = 4.0f;
+			for (unsigned int i = 0; i < 12; ++i) {
+				float middle = (low + high) * 0.5f;
+				size_t covered = coveredPixels(next.data(), next.size() / 4, options.alphaReference, middle);
+				if (covered > targetCoverage * (next.size() / 4)) {
+					high = middle;
+				}
+				else {
+					low = middle;
+				}
+			}
+			alphaScale = (low + high) * 0.5f;
+		}
+
+		mip.width = nextWidth;
+		mip.height = nextHeight;
+		mip.rowPitch = nextWidth * layout.bytesPerPixel;
+		mip.pixels.resize(static_cast<size_t>(mip.rowPitch) * nextHeight);
+		forEachRow(threadPool, nextHeight, [&](unsigned int y) {
+			storeRow(&next[static_cast<size_t>(y) * nextWidth * 4], nextWidth, layout, alphaScale,
+				&mip.pixels[static_cast<size_t>(y) * mip.rowPitch]);
+		});
+
+		current.swap(next);
+		currentWidth = nextWidth;
+		currentHeight = nextHeight;
+	}
+	return S_OK;
+}
@@ -0,0 +1,433 @@
+#include "ObjLoader.h"
+#include "ThreadPool.h"
+#include "MappedFile.h"
+#include "MeshComponent.h"
+
+static const unsigned int kNoTexcoord = 0xFFFFFFFFu;
+static const size_t kChunkBytes = 4 * 1024 * 1024;
+
+/**
+ * @brief ndices de posicin y UV de una esquina, en base 0.
+ */
+struct ObjCorner {
+	unsigned int position;
+	unsigned int texcoord;
+};
+
+/**
+ * @brief Copia de una esquina con ndice negativo; se le suma la base del chunk al resolver.
+ */
+struct ObjRelativeIndex {
+	size_t corner;
+	bool texcoord;
+};
+
+struct ObjChunk {
+	const char* begin = nullptr;
+	const char* end = nullptr;
+	std::vector<XMFLOAT3> positions;
+	std::vector<XMFLOAT2> texcoords;
+	std::vector<ObjCorner> corners;
+	std::vector<ObjRelativeIndex> relative;
+	size_t positionBase = 0;
+	size_t texcoordBase = 0;
+	size_t cornerBase = 0;
+	bool hasTexcoords = false;
+	// Primera lnea mal formada
+	const char* error = nullptr;
+	bool indexOutOfRange = false;
+};
+
+struct ObjFaceCorner {
+	ObjCorner corner;
+	bool relativePosition;
+	bool relativeTexcoord;
+};
+
+static inline bool
+isSpace(const char* p, const char* end) {
+	return p < end && (*p == ' ' || *p == '\t');
+}
+
+static inline const char*
+skipSpaces(const char* p, const char* end) {
+	while (isSpace(p, end)) {
+		++p;
+	}
+	return p;
+}
+
+static inline const char*
+nextLine(const char* p, const char* end) {
+	const void* newline = memchr(p, '\n', end - p);
+	return newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+static inline const char*
+parseFloat(const char* p, const char* end, float& value) {
+	p = skipSpaces(p, end);
+	if (p < end && *p == '+') {
+		++p;
+	}
+	std::from_chars_result result = std::from_chars(p, end, value);
+	return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+/**
+ * @brief Lee un ndice OBJ (base 1; negativo cuenta hacia atrs desde el ltimo elemento).
+ *
+ * @param count    Elementos ledos hasta esta lnea dentro del chunk.
+ * @param relative Salida: @c true si el ndice era negativo; @p index queda relativo al
+ *                 inicio del chunk (puede dar la vuelta si apunta a un chunk anterior).
+ */
+static inline const char*
+parseIndex(const char* p, const char* end, size_t count, unsigned int& index, bool& relative) {
+	if (p < end && *p == '+') {
+		++p;
+	}
+	long long value = 0;
+	std::from_chars_result result = std::from_chars(p, end, value);
+	if (result.ec != std::errc() || value == 0 || value > 0x7FFFFFFF || value < -0x7FFFFFFF) {
+		return nullptr;
+	}
+	relative = value < 0;
+	index = static_cast<unsigned int>(relative ? static_cast<long long>(count) + value : value - 1);
+	return result.ptr;
+}
+
+static inline void
+pushCorner(ObjChunk& chunk, const ObjFaceCorner& faceCorner) {
+	if (faceCorner.relativePosition) {
+		chunk.relative.push_back({ chunk.corners.size(), false });
+	}
+	if (faceCorner.relativeTexcoord) {
+		chunk.relative.push_back({ chunk.corners.size(), true });
+	}
+	chunk.corners.push_back(faceCorner.corner);
+}
+
+static void
+parseChunk(ObjChunk& chunk, const ObjLoadOptions& options) {
+	// Unos 30 bytes por lnea; la reserva evita casi todos los crecimientos
+	size_t estimate = (chunk.end - chunk.begin) / 30;
+	chunk.positions.reserve(estimate);
+	chunk.corners.reserve(estimate * 2);
+	float zSign = options.leftHanded ? -1.0f : 1.0f;
+
+	const char* p = chunk.begin;
+	const char* end = chunk.end;
+	while (p < end) {
+		const char* line = p;
+		p = skipSpaces(p, end);
+		if (p < end && p[0] == 'v' && isSpace(p + 1, end)) {
+			XMFLOAT3 position;
+			p = parseFloat(p + 1, end, position.x);
+			p = p ? parseFloat(p, end, position.y) : nullptr;
+			p = p ? parseFloat(p, end, position.z) : nullptr;
+			if (!p) {
+				chunk.error = line;
+				return;
+			}
+			position.z *= zSign;
+			chunk.positions.push_back(position);
+		}
+		else if (p + 1 < end && p[0] == 'v' && p[1] == 't' && isSpace(p + 2, end)) {
+			XMFLOAT2 texcoord(0.0f, 0.0f);
+			p = parseFloat(p + 2, end, texcoord.x);
+			if (!p) {
+				chunk.error = line;
+				return;
+			}
+			// La v es opcional
+			const char* next = parseFloat(p, end, texcoord.y);
+			p = next ? next : p;
+			if (options.flipV) {
+				texcoord.y = 1.0f - texcoord.y;
+			}
+			chunk.texcoords.push_back(texcoord);
+		}
+		else if (p < end && p[0] == 'f' && isSpace(p + 1, end)) {
+			// Polgono en abanico: (primera, anterior, actual) por cada esquina desde la tercera
+			ObjFaceCorner first = {};
+			ObjFaceCorner previous = {};
+			unsigned int count = 0;
+			p++;
+			while (true) {
+				p = skipSpaces(p, end);
+				if (p >= end || *p == '\r' || *p == '\n' || *p == '#') {
+					break;
+				}
+				ObjFaceCorner current = { { 0, kNoTexcoord }, false, false };
+				p = parseIndex(p, end, chunk.positions.size(), current.corner.position, current.relativePosition);
+				if (p && p < end && *p == '/') {
+					++p;
+					if (p < end && *p != '/') {
+						p = parseIndex(p, end, chunk.texcoords.size(), current.corner.texcoord, current.relativeTexcoord);
+						chunk.hasTexcoords = true;
+					}
+					if (p && p < end && *p == '/') {
+						// Las normales se validan pero no se guardan
+						unsigned int normal = 0;
+						bool relativeNormal = false;
+						p = parseIndex(p + 1, end, 0, normal, relativeNormal);
+					}
+				}
+				if (!p) {
+					chunk.error = line;
+					return;
+				}
+				if (count == 0) {
+					first = current;
+				}
+				else if (count >= 2) {
+					pushCorner(chunk, first);
+					pushCorner(chunk, options.leftHanded ? current : previous);
+					pushCorner(chunk, options.leftHanded ? previous : current);
+				}
+				previous = current;
+				count++;
+			}
+			if (count < 3) {
+				chunk.error = line;
+				return;
+			}
+		}
+		p = nextLine(p, end);
+	}
+}
+
+/**
+ * @brief Pasa los ndices negativos del chunk a base global y valida los rangos.
+ */
+static void
+resolveChunk(ObjChunk& chunk, size_t positionCount, size_t texcoordCount) {
+	for (const ObjRelativeIndex& relative : chunk.relative) {
+		ObjCorner& corner = chunk.corners[relative.corner];
+		if (relative.texcoord) {
+			corner.texcoord += static_cast<unsigned int>(chunk.texcoordBase);
+		}
+		else {
+			corner.position += static_cast<unsigned int>(chunk.positionBase);
+		}
+	}
+	for (const ObjCorner& corner : chunk.corners) {
+		if (corner.position >= positionCount ||
+			(corner.texcoord != kNoTexcoord && corner.texcoord >= texcoordCount)) {
+			chunk.indexOutOfRange = true;
+			return;
+		}
+	}
+}
+
+static inline double
+millisecondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void
+forEachChunk(ThreadPool* threadPool, std::vector<ObjChunk>& chunks, const std::function<void(ObjChunk&)>& body) {
+	if (threadPool && chunks.size() > 1) {
+		threadPool->parallelFor(static_cast<unsigned int>(chunks.size()), [&](unsigned int i) { body(chunks[i]); });
+	}
+	else {
+		for (ObjChunk& chunk : chunks) {
+			body(chunk);
+		}
+	}
+}
+
+HRESULT
+ObjLoader::load(const std::string& fileName,
+	MeshComponent& mesh,
+	const ObjLoadOptions& options,
+	ThreadPool* threadPool,
+	ObjLoadStats* stats) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	MappedFile file;
+	if (FAILED(file.init(fileName))) {
+		ERROR("ObjLoader", "load", ("Failed to open " + fileName).c_str());
+		return E_FAIL;
+	}
+	double mapMilliseconds = millisecondsSince(start);
+	HRESULT hr = parse(reinterpret_cast<const char*>(file.data()), file.size(), mesh, options, threadPool, stats);
+	if (FAILED(hr)) {
+		ERROR("ObjLoader", "load", ("Failed to load " + fileName).c_str());
+		return hr;
+	}
+	if (mesh.m_name.empty()) {
+		mesh.m_name = fileName;
+	}
+	if (stats) {
+		stats->mapMilliseconds = mapMilliseconds;
+		stats->totalMilliseconds = millisecondsSince(start);
+	}
+	return S_OK;
+}
+
+HRESULT
+ObjLoader::parse(const char* text,
+	size_t size,
+	MeshComponent& mesh,
+	const ObjLoadOptions& options,
+	ThreadPool* threadPool,
+	ObjLoadStats* stats) {
+	if (!text && size > 0) {
+		ERROR("ObjLoader", "parse", "text is null");
+		return E_POINTER;
+	}
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const char* end = text + size;
+
+	// Cortes en el primer salto de lnea despus de cada kChunkBytes
+	std::vector<ObjChunk> chunks;
+	for (const char* p = text; p < end;) {
+		ObjChunk chunk;
+		chunk.begin = p;
+		chunk.end = static_cast<size_t>(end - p) > kChunkBytes ? nextLine(p + kChunkBytes, end) : end;
+		p = chunk.end;
+		chunks.push_back(std::move(chunk));
+	}
+	forEachChunk(threadPool, chunks, [&](ObjChunk& chunk) { parseChunk(chunk, options); });
+	for (const ObjChunk& chunk : chunks) {
+		if (chunk.error) {
+			ERROR("ObjLoader", "parse",
+				("Malformed line at byte " + std::to_string(chunk.error - text)).c_str());
+			return E_FAIL;
+		}
+	}
+
+	size_t positionCount = 0;
+	size_t texcoordCount = 0;
+	size_t cornerCount = 0;
+	bool hasTexcoords = false;
+	for (ObjChunk& chunk : chunks) {
+		chunk.positionBase = positionCount;
+		chunk.texcoordBase = texcoordCount;
+		chunk.cornerBase = cornerCount;
+		positionCount += chunk.positions.size();
+		texcoordCount += chunk.texcoords.size();
+		cornerCount += chunk.corners.size();
+		hasTexcoords = hasTexcoords || chunk.hasTexcoords;
+	}
+	if (positionCount >= kNoTexcoord || cornerCount >= kNoTexcoord) {
+		ERROR("ObjLoader", "parse", "Mesh is too large for 32-bit indices");
+		return E_FAIL;
+	}
+	if (cornerCount == 0) {
+		ERROR("ObjLoader", "parse", "No faces found");
+		return E_FAIL;
+	}
+	forEachChunk(threadPool, chunks, [&](ObjChunk& chunk) { resolveChunk(chunk, positionCount, texcoordCount); });
+	for (const ObjChunk& chunk : chunks) {
+		if (chunk.indexOutOfRange) {
+			ERROR("ObjLoader", "parse",
+				("Face index out of range after byte " + std::to_string(chunk.begin - text)).c_str());
+			return E_FAIL;
+		}
+	}
+	double parseMilliseconds = millisecondsSince(start);
+
+	// Posiciones y UV de todos los chunks en arreglos globales
+	std::vector<XMFLOAT3> positions(positionCount);
+	std::vector<XMFLOAT2> texcoords(texcoordCount);
+	forEachChunk(threadPool, chunks, [&](ObjChunk& chunk) {
+		if (!chunk.positions.empty()) {
+			memcpy(&positions[chunk.positionBase], chunk.positions.data(), chunk.positions.size() * sizeof(XMFLOAT3));
+		}
+		if (!chunk.texcoords.empty()) {
+			memcpy(&texcoords[chunk.texcoordBase], chunk.texcoords.data(), chunk.texcoords.size() * sizeof(XMFLOAT2));
+		}
+		std::vector<XMFLOAT3>().swap(chunk.positions);
+		std::vector<XMFLOAT2>().swap(chunk.texcoords);
+	});
+
+	std::vector<SimpleVertex> vertices;
+	std::vector<unsigned int> indices(cornerCount);
+	if (!hasTexcoords) {
+		// Sin UV cada posicin es un vrtice y los ndices se copian tal cual
+		vertices.resize(positionCount);
+		for (size_t i = 0; i < positionCount; ++i) {
+			vertices[i].Pos = positions[i];
+			vertices[i].Tex = XMFLOAT2(0.0f, 0.0f);
+		}
+		forEachChunk(threadPool, chunks, [&](ObjChunk& chunk) {
+			for (size_t i = 0; i < chunk.corners.size(); ++i) {
+				indices[chunk.cornerBase + i] = chunk.corners[i].position;
+			}
+		});
+	}
+	else {
+		// Tabla de direccionamiento abierto: clave (posicin << 32 | UV), valor ndice del vrtice
+		size_t capacity = 1024;
+		while (capacity < positionCount * 2) {
+			capacity *= 2;
+		}
+		std::vector<unsigned long long> keys(capacity, ~0ull);
+		std::vector<unsigned int> values(capacity);
+		vertices.reserve(positionCount + positionCount / 4);
+		for (const ObjChunk& chunk : chunks) {
+			for (size_t i = 0; i < chunk.corners.size(); ++i) {
+				const ObjCorner& corner = chunk.corners[i];
+				unsigned long long key = (static_cast<unsigned long long>(corner.position) << 32) | corner.texcoord;
+				size_t mask = capacity - 1;
+				size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+				while (keys[slot] != key && keys[slot] != ~0ull) {
+					slot = (slot + 1) & mask;
+				}
+				if (keys[slot] == key) {
+					indices[chunk.cornerBase + i] = values[slot];
+					continue;
+				}
+				unsigned int vertexIndex = static_cast<unsigned int>(vertices.size());
+				SimpleVertex vertex;
+				vertex.Pos = positions[corner.position];
+				vertex.Tex = corner.texcoord != kNoTexcoord ? texcoords[corner.texcoord] : XMFLOAT2(0.0f, 0.0f);
+				vertices.push_back(vertex);
+				keys[slot] = key;
+				values[slot] = vertexIndex;
+				indices[chunk.cornerBase + i] = vertexIndex;
+
+				// Por encima del 70% de ocupacin la tabla se duplica y se reinsertan las claves
+				if (vertices.size() * 10 > capacity * 7) {
+					std::vector<unsigned long long> oldKeys;
+					std::vector<unsigned int> oldValues;
+					oldKeys.swap(keys);
+					oldValues.swap(values);
+					capacity *= 2;
+					mask = capacity - 1;
+					keys.assign(capacity, ~0ull);
+					values.resize(capacity);
+					for (size_t j = 0; j < oldKeys.size(); ++j) {
+						if (oldKeys[j] == ~0ull) {
+							continue;
+						}
+						size_t newSlot = static_cast<size_t>((oldKeys[j] * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+						while (keys[newSlot] != ~0ull) {
+							newSlot = (newSlot + 1) & mask;
+						}
+						keys[newSlot] = oldKeys[j];
+						values[newSlot] = oldValues[j];
+					}
+				}
+			}
+		}
+	}
+
+	mesh.m_vertex.swap(vertices);
+	mesh.m_index.swap(indices);
+	mesh.init();
+
+	if (stats) {
+		stats->bytes = size;
+		stats->chunks = static_cast<unsigned int>(chunks.size());
+		stats->positions = positionCount;
+		stats->texcoords = texcoordCount;
+		stats->triangles = cornerCount / 3;
+		stats->vertices = mesh.m_vertex.size();
+		stats->mapMilliseconds = 0.0;
+		stats->parseMilliseconds = parseMilliseconds;
+		stats->dedupMilliseconds = millisecondsSince(start) - parseMilliseconds;
+		stats->totalMilliseconds = millisecondsSince(start);
+	}
+	return S_OK;
+}
@@ -0,0 +1,506 @@
+#include "PipelineStateCache.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderCompiler.h"
+
+// Agrega a la llave los bytes de un campo. Las descripciones con relleno entre campos
+// (blend y depth-stencil) se agregan campo por campo para no depender del relleno.
+template<typename T>
+static void
+appendKey(std::string& key, const T& value) {
+	key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static unsigned long long
+fnv1a(const unsigned char* data, size_t size) {
+	unsigned long long hash = 1469598103934665603ull;
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ data[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+// Hash del chunk ISGN (firma de entrada) del contenedor DXBC; si no se encuentra se usa
+// todo el bytecode, que es ms estricto pero igual de correcto
+static unsigned long long
+inputSignatureHash(const void* bytecode, size_t size) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(bytecode);
+	if (size >= 32 && memcmp(bytes, "DXBC", 4) == 0) {
+		unsigned int chunkCount = 0;
+		memcpy(&chunkCount, bytes + 28, sizeof(chunkCount));
+		for (unsigned int i = 0; i < chunkCount && 32 + 4 * (i + 1) <= size; ++i) {
+			unsigned int offset = 0;
+			memcpy(&offset, bytes + 32 + 4 * i, sizeof(offset));
+			if (offset > size || size - offset < 8) {
+				break;
+			}
+			unsigned int chunkSize = 0;
+			memcpy(&chunkSize, bytes + offset + 4, sizeof(chunkSize));
+			if (memcmp(bytes + offset, "ISGN", 4) == 0 && chunkSize <= size - offset - 8) {
+				return fnv1a(bytes + offset + 8, chunkSize);
+			}
+		}
+	}
+	return fnv1a(bytes, size);
+}
+
+PipelineStateDesc::PipelineStateDesc() {
+	ZeroMemory(&rasterizer, sizeof(rasterizer));
+	rasterizer.FillMode = D3D11_FILL_SOLID;
+	rasterizer.CullMode = D3D11_CULL_BACK;
+	rasterizer.DepthClipEnable = TRUE;
+
+	ZeroMemory(&blend, sizeof(blend));
+	for (D3D11_RENDER_TARGET_BLEND_DESC& target : blend.RenderTarget) {
+		target.SrcBlend = D3D11_BLEND_ONE;
+		target.DestBlend = D3D11_BLEND_ZERO;
+		target.BlendOp = D3D11_BLEND_OP_ADD;
+		target.SrcBlendAlpha = D3D11_BLEND_ONE;
+		target.DestBlendAlpha = D3D11_BLEND_ZERO;
+		target.BlendOpAlpha = D3D11_BLEND_OP_ADD;
+		target.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+	}
+
+	ZeroMemory(&depthStencil, sizeof(depthStencil));
+	depthStencil.DepthEnable = TRUE;
+	depthStencil.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+	depthStencil.DepthFunc = D3D11_COMPARISON_LESS;
+	depthStencil.StencilReadMask = D3D11_DEFAULT_STENCIL_READ_MASK;
+	depthStencil.StencilWriteMask = D3D11_DEFAULT_STENCIL_WRITE_MASK;
+	for (D3D11_DEPTH_STENCILOP_DESC* face : { &depthStencil.FrontFace, &depthStencil.BackFace }) {
+		face->StencilFailOp = D3D11_STENCIL_OP_KEEP;
+		face->StencilDepthFailOp = D3D11_STENCIL_OP_KEEP;
+		face->StencilPassOp = D3D11_STENCIL_OP_KEEP;
+		face->StencilFunc = D3D11_COMPARISON_ALWAYS;
+	}
+
+	ZeroMemory(&sampler, sizeof(sampler));
+	sampler.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	sampler.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+	sampler.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+	sampler.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+	sampler.ComparisonFunc = D3D11_COMPARISON_NEVER;
+	sampler.MinLOD = 0;
+	sampler.MaxLOD = D3D11_FLOAT32_MAX;
+}
+
+HRESULT
+PipelineStateCache::init(Device& device, ShaderCache* shaderCache) {
+	if (!device.m_device) {
+		ERROR("PipelineStateCache", "init", "Device is null.");
+		return E_POINTER;
+	}
+	destroy();
+	m_device = &device;
+	m_shaderCache = shaderCache;
+	return S_OK;
+}
+
+void
+PipelineStateCache::destroy() {
+	for (std::pair<const std::string, std::unique_ptr<ShaderProgram>>& shader : m_shaders) {
+		shader.second->destroy();
+	}
+	for (std::pair<const std::string, std::unique_ptr<InputLayout>>& inputLayout : m_inputLayouts) {
+		inputLayout.second->destroy();
+	}
+	for (std::pair<const std::string, ID3D11RasterizerState*>& state : m_rasterizerStates) {
+		SAFE_RELEASE(state.second);
+	}
+	for (std::pair<const std::string, ID3D11BlendState*>& state : m_blendStates) {
+		SAFE_RELEASE(state.second);
+	}
+	for (std::pair<const std::string, ID3D11DepthStencilState*>& state : m_depthStencilStates) {
+		SAFE_RELEASE(state.second);
+	}
+	for (std::pair<const std::string, ID3D11SamplerState*>& state : m_samplerStates) {
+		SAFE_RELEASE(state.second);
+	}
+	m_shaders.clear();
+	m_inputLayouts.clear();
+	m_rasterizerStates.clear();
+	m_blendStates.clear();
+	m_depthStencilStates.clear();
+	m_samplerStates.clear();
+	m_stateIndex.clear();
+	m_states.clear();
+	m_sources.clear();
+	m_semanticNames.clear();
+	m_device = nullptr;
+	m_shaderCache = nullptr;
+	m_stats = PipelineStateCacheStats();
+}
+
+HRESULT
+PipelineStateCache::create(const PipelineStateDesc& desc, unsigned int& pipelineState) {
+	pipelineState = kInvalidPipelineState;
+	if (!m_device) {
+		ERROR("PipelineStateCache", "create", "PipelineStateCache is not initialized.");
+		return E_FAIL;
+	}
+	if (desc.shaderFile.empty() || desc.layout.empty()) {
+		ERROR("PipelineStateCache", "create", "Shader file and input layout are required");
+		return E_INVALIDARG;
+	}
+	m_stats.requests++;
+
+	PipelineState state;
+	ShaderProgram* program = nullptr;
+	HRESULT hr = findShader(desc.shaderFile, program);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	state.vertexShader = program->m_VertexShader;
+	state.pixelShader = program->m_PixelShader;
+
+	hr = findInputLayout(*program, desc.layout, state.inputLayout);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	// Rasterizer y sampler no tienen relleno entre campos: se comparan byte a byte
+	std::string key;
+	appendKey(key, desc.rasterizer);
+	hr = findState(m_rasterizerStates, key, [&](ID3D11RasterizerState** created) {
+		return m_device->CreateRasterizerState(&desc.rasterizer, created);
+	}, state.rasterizerState);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	key.clear();
+	appendKey(key, desc.blend.AlphaToCoverageEnable);
+	appendKey(key, desc.blend.IndependentBlendEnable);
+	for (const D3D11_RENDER_TARGET_BLEND_DESC& target : desc.blend.RenderTarget) {
+		appendKey(key, target.BlendEnable);
+		appendKey(key, target.SrcBlend);
+		appendKey(key, target.DestBlend);
+		appendKey(key, target.BlendOp);
+		appendKey(key, target.SrcBlendAlpha);
+		appendKey(key, target.DestBlendAlpha);
+		appendKey(key, target.BlendOpAlpha);
+		appendKey(key, target.RenderTargetWriteMask);
+	}
+	hr = findState(m_blendStates, key, [&](ID3D11BlendState** created) {
+		return m_device->CreateBlendState(&desc.blend, created);
+	}, state.blendState);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	key.clear();
+	appendKey(key, desc.depthStencil.DepthEnable);
+	appendKey(key, desc.depthStencil.DepthWriteMask);
+	appendKey(key, desc.depthStencil.DepthFunc);
+	appendKey(key, desc.depthStencil.StencilEnable);
+	appendKey(key, desc.depthStencil.StencilReadMask);
+	appendKey(key, desc.depthStencil.StencilWriteMask);
+	for (const D3D11_DEPTH_STENCILOP_DESC* face : { &desc.depthStencil.FrontFace, &desc.depthStencil.BackFace }) {
+		appendKey(key, face->StencilFailOp);
+		appendKey(key, face->StencilDepthFailOp);
+		appendKey(key, face->StencilPassOp);
+		appendKey(key, face->StencilFunc);
+	}
+	hr = findState(m_depthStencilStates, key, [&](ID3D11DepthStencilState** created) {
+		return m_device->CreateDepthStencilState(&desc.depthStencil, created);
+	}, state.depthStencilState);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	key.clear();
+	appendKey(key, desc.sampler);
+	hr = findState(m_samplerStates, key, [&](ID3D11SamplerState** created) {
+		return m_device->CreateSamplerState(&desc.sampler, created);
+	}, state.sampler);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	state.stencilRef = desc.stencilRef;
+
+	key = stateKey(state);
+	std::unordered_map<std::string, unsigned int>::iterator found = m_stateIndex.find(key);
+	if (found != m_stateIndex.end()) {
+		m_stats.hits++;
+		pipelineState = found->second;
+		return S_OK;
+	}
+	pipelineState = static_cast<unsigned int>(m_states.size());
+	m_states.push_back(state);
+	m_stateIndex[key] = pipelineState;
+
+	StateSource source;
+	source.shaderFile = desc.shaderFile;
+	source.layout = desc.layout;
+	for (D3D11_INPUT_ELEMENT_DESC& element : source.layout) {
+		element.SemanticName = m_semanticNames.insert(element.SemanticName ? element.SemanticName : "").first->c_str();
+	}
+	m_sources.push_back(source);
+	return S_OK;
+}
+
+HRESULT
+PipelineStateCache::replaceShader(const std::string& fileName,
+	ID3DBlob* vertexShaderData,
+	ID3DBlob* pixelShaderData) {
+	std::unordered_map<std::string, std::unique_ptr<ShaderProgram>>::iterator found = m_shaders.find(fileName);
+	if (!m_device || found == m_shaders.end()) {
+		SAFE_RELEASE(vertexShaderData);
+		SAFE_RELEASE(pixelShaderData);
+		return S_FALSE;
+	}
+
+	// Sin CreateInputLayout() el programa conserva el bytecode del VS para los layouts
+	std::unique_ptr<ShaderProgram> created(new ShaderProgram());
+	created->setShaderCache(m_shaderCache);
+	HRESULT hr = created->CreateShader(*m_device, ShaderType::VERTEX_SHADER, vertexShaderData);
+	if (SUCCEEDED(hr)) {
+		hr = created->CreateShader(*m_device, ShaderType::PIXEL_SHADER, pixelShaderData);
+	}
+	else {
+		SAFE_RELEASE(pixelShaderData);
+	}
+
+	// Todos los layouts antes de tocar ningn estado: o cambian todos o ninguno
+	std::vector<size_t> affected;
+	std::vector<ID3D11InputLayout*> inputLayouts;
+	for (size_t i = 0; SUCCEEDED(hr) && i < m_sources.size(); ++i) {
+		if (m_sources[i].shaderFile != fileName) {
+			continue;
+		}
+		ID3D11InputLayout* inputLayout = nullptr;
+		hr = findInputLayout(*created, m_sources[i].layout, inputLayout);
+		affected.push_back(i);
+		inputLayouts.push_back(inputLayout);
+	}
+	if (FAILED(hr)) {
+		ERROR("PipelineStateCache", "replaceShader", ("Keeping previous shaders of " + fileName).c_str());
+		created->destroy();
+		return hr;
+	}
+
+	for (size_t i = 0; i < affected.size(); ++i) {
+		PipelineState& state = m_states[affected[i]];
+		state.vertexShader = created->m_VertexShader;
+		state.pixelShader = created->m_PixelShader;
+		state.inputLayout = inputLayouts[i];
+	}
+	m_stateIndex.clear();
+	for (size_t i = 0; i < m_states.size(); ++i) {
+		m_stateIndex.insert(std::make_pair(stateKey(m_states[i]), static_cast<unsigned int>(i)));
+	}
+
+	// El contexto conserva su propia referencia a los shaders que sigan asignados
+	found->second->destroy();
+	found->second = std::move(created);
+	m_stats.shaderReloads++;
+	return S_OK;
+}
+
+std::vector<std::string>
+PipelineStateCache::shaderFiles() const {
+	std::vector<std::string> files;
+	for (const std::pair<const std::string, std::unique_ptr<ShaderProgram>>& shader : m_shaders) {
+		files.push_back(shader.first);
+	}
+	return files;
+}
+
+void
+PipelineStateCache::apply(DeviceContext& deviceContext, unsigned int pipelineState) const {
+	const PipelineState* state = this->state(pipelineState);
+	if (!state) {
+		ERROR("PipelineStateCache", "apply", "Invalid pipeline state handle");
+		return;
+	}
+	deviceContext.IASetInputLayout(state->inputLayout);
+	deviceContext.VSSetShader(state->vertexShader, nullptr, 0);
+	deviceContext.PSSetShader(state->pixelShader, nullptr, 0);
+	deviceContext.RSSetState(state->rasterizerState);
+	deviceContext.OMSetBlendState(state->blendState, nullptr, 0xffffffff);
+	deviceContext.OMSetDepthStencilState(state->depthStencilState, state->stencilRef);
+	deviceContext.PSSetSamplers(0, 1, &state->sampler);
+}
+
+const PipelineState*
+PipelineStateCache::state(unsigned int pipelineState) const {
+	return pipelineState < m_states.size() ? &m_states[pipelineState] : nullptr;
+}
+
+std::string
+PipelineStateCache::report() const {
+	std::ostringstream os;
+	os << "Pipeline states: " << m_states.size() << " states from " << m_stats.requests << " requests ("
+		<< m_stats.hits << " hits); " << m_shaders.size() << " shader files, "
+		<< m_inputLayouts.size() << " input layouts, "
+		<< (m_rasterizerStates.size() + m_blendStates.size() + m_depthStencilStates.size() + m_samplerStates.size())
+		<< " fixed-function states; " << m_stats.reusedObjects << " duplicate creations avoided, "
+		<< m_stats.shaderReloads << " shader reloads\n";
+	return os.str();
+}
+
+HRESULT
+PipelineStateCache::create(const std::vector<PipelineStateDesc>& descs,
+	ShaderCompiler& compiler,
+	std::vector<unsigned int>& pipelineStates) {
+	pipelineStates.assign(descs.size(), kInvalidPipelineState);
+	if (!m_device) {
+		ERROR("PipelineStateCache", "create", "PipelineStateCache is not initialized.");
+		return E_FAIL;
+	}
+
+	// Un programa por archivo que falte; el lote conserva el bytecode del VS para los layouts
+	std::vector<ShaderCompileRequest> requests;
+	std::vector<std::unique_ptr<ShaderProgram>> programs;
+	for (const PipelineStateDesc& desc : descs) {
+		bool pending = false;
+		for (const ShaderCompileRequest& request : requests) {
+			pending = pending || request.fileName == desc.shaderFile;
+		}
+		if (desc.shaderFile.empty() || pending || m_shaders.find(desc.shaderFile) != m_shaders.end()) {
+			continue;
+		}
+		programs.emplace_back(new ShaderProgram());
+		ShaderCompileRequest request;
+		request.program = programs.back().get();
+		request.fileName = desc.shaderFile;
+		requests.push_back(request);
+	}
+	HRESULT result = compiler.compile(*m_device, requests);
+
+	unsigned long long compiled = 0;
+	std::vector<std::string> failedFiles;
+	for (size_t i = 0; i < requests.size(); ++i) {
+		if (programs[i]->m_VertexShader && programs[i]->m_PixelShader) {
+			m_shaders[requests[i].fileName] = std::move(programs[i]);
+			m_stats.createdObjects++;
+			compiled++;
+		}
+		else {
+			failedFiles.push_back(requests[i].fileName);
+		}
+	}
+
+	for (size_t i = 0; i < descs.size(); ++i) {
+		// Sin volver a compilar en serie lo que ya fall en el lote
+		if (std::find(failedFiles.begin(), failedFiles.end(), descs[i].shaderFile) != failedFiles.end()) {
+			continue;
+		}
+		HRESULT hr = create(descs[i], pipelineStates[i]);
+		if (FAILED(hr) && SUCCEEDED(result)) {
+			result = hr;
+		}
+	}
+	// La primera bsqueda de cada programa recin compilado no evit ninguna creacin
+	m_stats.reusedObjects -= (std::min)(compiled, m_stats.reusedObjects);
+	return result;
+}
+
+HRESULT
+PipelineStateCache::findShader(const std::string& fileName, ShaderProgram*& program) {
+	std::unordered_map<std::string, std::unique_ptr<ShaderProgram>>::iterator found = m_shaders.find(fileName);
+	if (found != m_shaders.end()) {
+		m_stats.reusedObjects++;
+		program = found->second.get();
+		return S_OK;
+	}
+
+	// Sin CreateInputLayout() el programa conserva el bytecode del VS para los layouts
+	std::unique_ptr<ShaderProgram> created(new ShaderProgram());
+	created->setShaderCache(m_shaderCache);
+	HRESULT hr = created->CreateShader(*m_device, ShaderType::VERTEX_SHADER, fileName);
+	if (SUCCEEDED(hr)) {
+		hr = created->CreateShader(*m_device, ShaderType::PIXEL_SHADER);
+	}
+	if (FAILED(hr)) {
+		ERROR("PipelineStateCache", "findShader", ("Failed to create shaders from " + fileName).c_str());
+		created->destroy();
+		return hr;
+	}
+	m_stats.createdObjects++;
+	program = created.get();
+	m_shaders[fileName] = std::move(created);
+	return S_OK;
+}
+
+HRESULT
+PipelineStateCache::findInputLayout(ShaderProgram& program,
+	const std::vector<D3D11_INPUT_ELEMENT_DESC>& layout,
+	ID3D11InputLayout*& inputLayout) {
+	ID3DBlob* vertexShaderData = program.vertexShaderData();
+	if (!vertexShaderData) {
+		ERROR("PipelineStateCache", "findInputLayout", "Vertex shader data is null.");
+		return E_POINTER;
+	}
+
+	// La semntica se guarda por contenido: el puntero del llamador no es estable
+	std::string key;
+	appendKey(key, inputSignatureHash(vertexShaderData->GetBufferPointer(), vertexShaderData->GetBufferSize()));
+	for (const D3D11_INPUT_ELEMENT_DESC& element : layout) {
+		key.append(element.SemanticName ? element.SemanticName : "");
+		key.push_back('\0');
+		appendKey(key, element.SemanticIndex);
+		appendKey(key, element.Format);
+		appendKey(key, element.InputSlot);
+		appendKey(key, element.AlignedByteOffset);
+		appendKey(key, element.InputSlotClass);
+		appendKey(key, element.InstanceDataStepRate);
+	}
+
+	std::unordered_map<std::string, std::unique_ptr<InputLayout>>::iterator found = m_inputLayouts.find(key);
+	if (found != m_inputLayouts.end()) {
+		m_stats.reusedObjects++;
+		inputLayout = found->second->m_inputLayout;
+		return S_OK;
+	}
+
+	std::unique_ptr<InputLayout> created(new InputLayout());
+	std::vector<D3D11_INPUT_ELEMENT_DESC> elements = layout;
+	HRESULT hr = created->init(*m_device, elements, vertexShaderData);
+	if (FAILED(hr)) {
+		ERROR("PipelineStateCache", "findInputLayout", "Failed to create input layout.");
+		return hr;
+	}
+	m_stats.createdObjects++;
+	inputLayout = created->m_inputLayout;
+	m_inputLayouts[key] = std::move(created);
+	return S_OK;
+}
+
+std::string
+PipelineStateCache::stateKey(const PipelineState& state) {
+	// Cada parte ya es nica, as que la combinacin de punteros identifica el estado
+	std::string key;
+	appendKey(key, state.vertexShader);
+	appendKey(key, state.pixelShader);
+	appendKey(key, state.inputLayout);
+	appendKey(key, state.rasterizerState);
+	appendKey(key, state.blendState);
+	appendKey(key, state.depthStencilState);
+	appendKey(key, state.sampler);
+	appendKey(key, state.stencilRef);
+	return key;
+}
+
+template<typename State, typename Create>
+HRESULT
+PipelineStateCache::findState(std::unordered_map<std::string, State*>& states,
+	const std::string& key,
+	Create create,
+	State*& state) {
+	typename std::unordered_map<std::string, State*>::iterator found = states.find(key);
+	if (found != states.end()) {
+		m_stats.reusedObjects++;
+		state = found->second;
+		return S_OK;
+	}
+	State* created = nullptr;
+	HRESULT hr = create(&created);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	m_stats.createdObjects++;
+	states[key] = created;
+	state = created;
+	return S_OK;
+}
@@ -0,0 +1,376 @@
+#include "RenderGraph.h"
+#include "DeviceContext.h"
+
+void
+RenderGraphBuilder::read(unsigned int texture) {
+	if (!m_graph.validResource(texture)) {
+		ERROR("RenderGraphBuilder", "read", "Invalid texture handle");
+		return;
+	}
+	m_graph.m_passes[m_pass].reads.push_back(texture);
+}
+
+void
+RenderGraphBuilder::writeColor(unsigned int texture, RenderGraphLoadOp loadOp, const float clearColor[4]) {
+	if (!m_graph.validResource(texture)) {
+		ERROR("RenderGraphBuilder", "writeColor", "Invalid texture handle");
+		return;
+	}
+	std::vector<RenderGraph::Attachment>& colors = m_graph.m_passes[m_pass].colors;
+	if (colors.size() >= D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT) {
+		ERROR("RenderGraphBuilder", "writeColor", "Too many render targets in one pass");
+		return;
+	}
+	RenderGraph::Attachment attachment;
+	attachment.resource = texture;
+	attachment.loadOp = loadOp;
+	if (clearColor) {
+		memcpy(attachment.clearColor, clearColor, sizeof(attachment.clearColor));
+	}
+	colors.push_back(attachment);
+}
+
+void
+RenderGraphBuilder::writeDepth(unsigned int texture,
+	RenderGraphLoadOp loadOp,
+	float clearDepth,
+	unsigned char clearStencil) {
+	if (!m_graph.validResource(texture)) {
+		ERROR("RenderGraphBuilder", "writeDepth", "Invalid texture handle");
+		return;
+	}
+	RenderGraph::Attachment& depth = m_graph.m_passes[m_pass].depth;
+	depth.resource = texture;
+	depth.loadOp = loadOp;
+	depth.clearDepth = clearDepth;
+	depth.clearStencil = clearStencil;
+}
+
+void
+RenderGraphBuilder::sideEffect() {
+	m_graph.m_passes[m_pass].sideEffect = true;
+}
+
+HRESULT
+RenderGraph::init(RenderTargetPool& pool) {
+	destroy();
+	m_pool = &pool;
+	return S_OK;
+}
+
+void
+RenderGraph::update() {
+	releasePhysical();
+	m_passes.clear();
+	m_resources.clear();
+	m_compiled = false;
+}
+
+void
+RenderGraph::destroy() {
+	update();
+	m_pool = nullptr;
+	m_stats = RenderGraphStats();
+}
+
+unsigned int
+RenderGraph::createTexture(const std::string& name, const RenderTargetDesc& desc) {
+	if (desc.width == 0 || desc.height == 0 || desc.format == DXGI_FORMAT_UNKNOWN || desc.sampleCount == 0) {
+		ERROR("RenderGraph", "createTexture", ("Invalid description for " + name).c_str());
+		return kInvalidRenderGraphHandle;
+	}
+	Resource resource;
+	resource.name = name;
+	resource.desc = desc;
+	m_resources.push_back(resource);
+	m_compiled = false;
+	return static_cast<unsigned int>(m_resources.size() - 1);
+}
+
+unsigned int
+RenderGraph::importRenderTarget(const std::string& name, ID3D11RenderTargetView* renderTargetView) {
+	if (!renderTargetView) {
+		ERROR("RenderGraph", "importRenderTarget", ("Render target view is null for " + name).c_str());
+		return kInvalidRenderGraphHandle;
+	}
+	Resource resource;
+	resource.name = name;
+	resource.imported = true;
+	resource.renderTargetView = renderTargetView;
+	m_resources.push_back(resource);
+	m_compiled = false;
+	return static_cast<unsigned int>(m_resources.size() - 1);
+}
+
+unsigned int
+RenderGraph::importDepthStencil(const std::string& name, ID3D11DepthStencilView* depthStencilView) {
+	if (!depthStencilView) {
+		ERROR("RenderGraph", "importDepthStencil", ("Depth stencil view is null for " + name).c_str());
+		return kInvalidRenderGraphHandle;
+	}
+	Resource resource;
+	resource.name = name;
+	resource.imported = true;
+	resource.depthStencilView = depthStencilView;
+	m_resources.push_back(resource);
+	m_compiled = false;
+	return static_cast<unsigned int>(m_resources.size() - 1);
+}
+
+void
+RenderGraph::addPass(const std::string& name, const RenderGraphSetup& setup, const RenderGraphExecute& execute) {
+	Pass pass;
+	pass.name = name;
+	pass.execute = execute;
+	m_passes.push_back(pass);
+	m_compiled = false;
+
+	RenderGraphBuilder builder(*this, static_cast<unsigned int>(m_passes.size() - 1));
+	if (setup) {
+		setup(builder);
+	}
+}
+
+HRESULT
+RenderGraph::compile() {
+	if (!m_pool) {
+		ERROR("RenderGraph", "compile", "RenderGraph is not initialized.");
+		return E_FAIL;
+	}
+	releasePhysical();
+	m_stats = RenderGraphStats();
+	m_stats.passes = static_cast<unsigned int>(m_passes.size());
+
+	// Recorrido hacia atrs: un pase vive si alguien necesita lo que escribe. Los recursos
+	// importados se necesitan al final del frame; Clear/DontCare cortan la dependencia.
+	std::vector<bool> needed(m_resources.size());
+	for (size_t i = 0; i < m_resources.size(); ++i) {
+		needed[i] = m_resources[i].imported;
+	}
+	for (size_t i = m_passes.size(); i-- > 0;) {
+		Pass& pass = m_passes[i];
+		std::vector<const Attachment*> writes;
+		for (const Attachment& color : pass.colors) {
+			writes.push_back(&color);
+		}
+		if (pass.depth.resource != kInvalidRenderGraphHandle) {
+			writes.push_back(&pass.depth);
+		}
+
+		pass.alive = pass.sideEffect;
+		for (const Attachment* write : writes) {
+			pass.alive = pass.alive || needed[write->resource];
+		}
+		if (!pass.alive) {
+			m_stats.culledPasses++;
+			continue;
+		}
+		for (const Attachment* write : writes) {
+			if (write->loadOp != RenderGraphLoadOp::Load) {
+				needed[write->resource] = false;
+			}
+		}
+		for (unsigned int read : pass.reads) {
+			needed[read] = true;
+		}
+	}
+
+	// Vida de cada textura transitoria, en ndices de pase
+	for (Resource& resource : m_resources) {
+		resource.firstPass = -1;
+		resource.lastPass = -1;
+		resource.physical = kInvalidRenderGraphHandle;
+	}
+	auto touch = [this](unsigned int index, int pass) {
+		Resource& resource = m_resources[index];
+		if (resource.firstPass < 0) {
+			resource.firstPass = pass;
+		}
+		resource.lastPass = pass;
+	};
+	for (size_t i = 0; i < m_passes.size(); ++i) {
+		const Pass& pass = m_passes[i];
+		if (!pass.alive) {
+			continue;
+		}
+		for (unsigned int read : pass.reads) {
+			touch(read, static_cast<int>(i));
+		}
+		for (const Attachment& color : pass.colors) {
+			touch(color.resource, static_cast<int>(i));
+		}
+		if (pass.depth.resource != kInvalidRenderGraphHandle) {
+			touch(pass.depth.resource, static_cast<int>(i));
+		}
+	}
+
+	// Asignacin en orden de pases: se toma al primer uso y se devuelve tras el ltimo
+	for (size_t i = 0; i < m_passes.size(); ++i) {
+		if (!m_passes[i].alive) {
+			continue;
+		}
+		for (Resource& resource : m_resources) {
+			if (!resource.imported && resource.firstPass == static_cast<int>(i)) {
+				HRESULT hr = acquirePhysical(resource.desc, resource.physical);
+				if (FAILED(hr)) {
+					ERROR("RenderGraph", "compile", ("Failed to create texture for " + resource.name).c_str());
+					releasePhysical();
+					return hr;
+				}
+				m_stats.transientTextures++;
+			}
+		}
+		for (Resource& resource : m_resources) {
+			if (!resource.imported && resource.lastPass == static_cast<int>(i)) {
+				m_physical[resource.physical].inUse = false;
+			}
+		}
+	}
+
+	m_stats.physicalTextures = static_cast<unsigned int>(m_physical.size());
+	m_compiled = true;
+	return S_OK;
+}
+
+void
+RenderGraph::execute(DeviceContext& deviceContext) {
+	if (!m_compiled) {
+		ERROR("RenderGraph", "execute", "RenderGraph is not compiled.");
+		return;
+	}
+
+	// Al inicio del frame no se sabe qu qued enlazado: el primer pase siempre enlaza
+	bool targetsKnown = false;
+	ID3D11RenderTargetView* boundColors[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+	unsigned int boundColorCount = 0;
+	ID3D11DepthStencilView* boundDepth = nullptr;
+
+	for (const Pass& pass : m_passes) {
+		if (!pass.alive) {
+			continue;
+		}
+
+		if (!pass.colors.empty() || pass.depth.resource != kInvalidRenderGraphHandle) {
+			ID3D11RenderTargetView* colors[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+			unsigned int colorCount = static_cast<unsigned int>(pass.colors.size());
+			for (unsigned int i = 0; i < colorCount; ++i) {
+				colors[i] = renderTargetView(pass.colors[i].resource);
+			}
+			ID3D11DepthStencilView* depth = pass.depth.resource != kInvalidRenderGraphHandle
+				? depthStencilView(pass.depth.resource)
+				: nullptr;
+
+			bool changed = !targetsKnown || colorCount != boundColorCount || depth != boundDepth;
+			for (unsigned int i = 0; !changed && i < colorCount; ++i) {
+				changed = colors[i] != boundColors[i];
+			}
+			if (changed) {
+				deviceContext.OMSetRenderTargets(colorCount, colorCount ? colors : nullptr, depth);
+				memcpy(boundColors, colors, sizeof(colors));
+				boundColorCount = colorCount;
+				boundDepth = depth;
+				targetsKnown = true;
+				m_stats.renderTargetBinds++;
+			}
+
+			for (unsigned int i = 0; i < colorCount; ++i) {
+				if (pass.colors[i].loadOp == RenderGraphLoadOp::Clear && colors[i]) {
+					deviceContext.ClearRenderTargetView(colors[i], pass.colors[i].clearColor);
+					m_stats.clears++;
+				}
+			}
+			if (depth && pass.depth.loadOp == RenderGraphLoadOp::Clear) {
+				deviceContext.ClearDepthStencilView(depth,
+					D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL,
+					pass.depth.clearDepth,
+					pass.depth.clearStencil);
+				m_stats.clears++;
+			}
+		}
+
+		if (pass.execute) {
+			pass.execute(deviceContext, *this);
+		}
+	}
+
+	// Lo enviado ya referencia las texturas; el pool no las entrega de nuevo hasta
+	// pasado su retraso de reciclado
+	releasePhysical();
+	m_compiled = false;
+}
+
+ID3D11RenderTargetView*
+RenderGraph::renderTargetView(unsigned int texture) const {
+	if (validResource(texture) && m_resources[texture].imported) {
+		return m_resources[texture].renderTargetView;
+	}
+	const PooledRenderTarget* target = physicalTarget(texture);
+	return target ? target->renderTargetView : nullptr;
+}
+
+ID3D11DepthStencilView*
+RenderGraph::depthStencilView(unsigned int texture) const {
+	if (validResource(texture) && m_resources[texture].imported) {
+		return m_resources[texture].depthStencilView;
+	}
+	const PooledRenderTarget* target = physicalTarget(texture);
+	return target ? target->depthStencilView : nullptr;
+}
+
+ID3D11ShaderResourceView*
+RenderGraph::shaderResourceView(unsigned int texture) const {
+	const PooledRenderTarget* target = physicalTarget(texture);
+	return target ? target->shaderResourceView : nullptr;
+}
+
+bool
+RenderGraph::isPassAlive(const std::string& name) const {
+	for (const Pass& pass : m_passes) {
+		if (pass.name == name) {
+			return pass.alive;
+		}
+	}
+	return false;
+}
+
+HRESULT
+RenderGraph::acquirePhysical(const RenderTargetDesc& desc, unsigned int& physical) {
+	for (size_t i = 0; i < m_physical.size(); ++i) {
+		if (!m_physical[i].inUse && m_physical[i].target->desc == desc) {
+			m_physical[i].inUse = true;
+			physical = static_cast<unsigned int>(i);
+			return S_OK;
+		}
+	}
+
+	PhysicalTexture acquired;
+	HRESULT hr = m_pool->acquire(desc, acquired.target);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	acquired.inUse = true;
+	m_physical.push_back(acquired);
+	physical = static_cast<unsigned int>(m_physical.size() - 1);
+	return S_OK;
+}
+
+void
+RenderGraph::releasePhysical() {
+	if (m_pool) {
+		for (PhysicalTexture& physical : m_physical) {
+			m_pool->release(physical.target);
+		}
+	}
+	m_physical.clear();
+	for (Resource& resource : m_resources) {
+		resource.physical = kInvalidRenderGraphHandle;
+	}
+}
+
+const PooledRenderTarget*
+RenderGraph::physicalTarget(unsigned int texture) const {
+	if (!validResource(texture) || m_resources[texture].physical >= m_physical.size()) {
+		return nullptr;
+	}
+	return m_physical[m_resources[texture].physical].target;
+}
@@ -0,0 +1,265 @@
+#include "RenderQueue.h"
+#include "DeviceContext.h"
+#include "ShaderProgram.h"
+
+// Mayor identificador que cabe en los 12 bits de programa o textura de la llave; los objetos
+// que no alcanzan identificador propio comparten este
+static const unsigned int kMaxSortId = 0xFFF;
+
+HRESULT
+RenderQueue::init(float farPlane, unsigned int capacity, const PipelineStateCache* pipelineStates) {
+	if (!(farPlane > 0.0f)) {
+		ERROR("RenderQueue", "init", "farPlane must be positive");
+		return E_INVALIDARG;
+	}
+	m_farPlane = farPlane;
+	m_pipelineStates = pipelineStates;
+	m_items.reserve(capacity);
+	m_keys.reserve(capacity);
+	m_order.reserve(capacity);
+	m_keyScratch.reserve(capacity);
+	m_orderScratch.reserve(capacity);
+	return S_OK;
+}
+
+void
+RenderQueue::update() {
+	m_items.clear();
+	m_keys.clear();
+	m_order.clear();
+	// Las vistas de textura se recrean (p. ej. al cambiar la residencia de un TextureStreamer) y
+	// sus direcciones pueden reutilizarse, as que sus identificadores solo valen un frame
+	m_textureIds.clear();
+	m_sorted = true;
+}
+
+void
+RenderQueue::destroy() {
+	m_items = std::vector<DrawItem>();
+	m_keys = std::vector<unsigned long long>();
+	m_order = std::vector<unsigned int>();
+	m_keyScratch = std::vector<unsigned long long>();
+	m_orderScratch = std::vector<unsigned int>();
+	m_programIds.clear();
+	m_pipelineStateIds.clear();
+	m_programCount = 0;
+	m_textureIds.clear();
+	m_stats = RenderQueueStats();
+	m_pipelineStates = nullptr;
+	m_sorted = true;
+}
+
+void
+RenderQueue::push(const DrawItem& item, unsigned int pass, float viewDepth, bool translucent) {
+	bool hasProgram = item.pipelineState != kInvalidPipelineState
+		? m_pipelineStates && m_pipelineStates->state(item.pipelineState)
+		: item.shaderProgram != nullptr;
+	if (!hasProgram || item.indexCount == 0) {
+		ERROR("RenderQueue", "push", "DrawItem needs a ShaderProgram or pipeline state and a non-zero index count");
+		return;
+	}
+	unsigned long long key = makeKey(pass,
+		programId(item),
+		objectId(m_textureIds, item.texture),
+		viewDepth / m_farPlane,
+		translucent);
+
+	m_order.push_back(static_cast<unsigned int>(m_items.size()));
+	m_items.push_back(item);
+	m_keys.push_back(key);
+	m_sorted = false;
+}
+
+void
+RenderQueue::sort() {
+	m_stats.radixPasses = radixSort(m_keys, m_order, m_keyScratch, m_orderScratch);
+	m_sorted = true;
+}
+
+void
+RenderQueue::submit(DeviceContext& deviceContext) {
+	if (!deviceContext.m_deviceContext) {
+		ERROR("RenderQueue", "submit", "DeviceContext is nullptr.");
+		return;
+	}
+	if (!m_sorted) {
+		sort();
+	}
+	m_stats.draws = 0;
+	m_stats.programChanges = 0;
+	m_stats.textureChanges = 0;
+
+	// Solo se enva lo que cambia respecto al draw anterior; la llave agrupa los cambios caros
+	const float blendFactor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const DrawItem* previous = nullptr;
+	for (unsigned int index : m_order) {
+		const DrawItem& item = m_items[index];
+
+		bool usesPipelineState = item.pipelineState != kInvalidPipelineState;
+		if (!previous || item.pipelineState != previous->pipelineState
+			|| (!usesPipelineState && item.shaderProgram != previous->shaderProgram)) {
+			if (usesPipelineState) {
+				m_pipelineStates->apply(deviceContext, item.pipelineState);
+			}
+			else {
+				item.shaderProgram->render(deviceContext);
+			}
+			m_stats.programChanges++;
+		}
+		if (!previous || item.texture != previous->texture) {
+			deviceContext.PSSetShaderResources(0, 1, &item.texture);
+			m_stats.textureChanges++;
+		}
+		if (!usesPipelineState) {
+			// Un estado de pipeline anterior pudo dejar otro sampler y blend asignados
+			bool afterPipelineState = previous && previous->pipelineState != kInvalidPipelineState;
+			if (!previous || afterPipelineState || item.sampler != previous->sampler) {
+				deviceContext.PSSetSamplers(0, 1, &item.sampler);
+			}
+			if (!previous || afterPipelineState || item.blendState != previous->blendState) {
+				deviceContext.OMSetBlendState(item.blendState, blendFactor, 0xffffffff);
+			}
+		}
+		if (!previous || item.vertexBuffer != previous->vertexBuffer
+			|| item.vertexStride != previous->vertexStride
+			|| item.vertexOffset != previous->vertexOffset) {
+			deviceContext.IASetVertexBuffers(0, 1, &item.vertexBuffer, &item.vertexStride, &item.vertexOffset);
+		}
+		if (!previous || item.indexBuffer != previous->indexBuffer
+			|| item.indexFormat != previous->indexFormat) {
+			deviceContext.IASetIndexBuffer(item.indexBuffer, item.indexFormat, 0);
+		}
+		if (!previous || item.constantBuffer != previous->constantBuffer) {
+			deviceContext.VSSetConstantBuffers(2, 1, &item.constantBuffer);
+			deviceContext.PSSetConstantBuffers(2, 1, &item.constantBuffer);
+		}
+
+		deviceContext.DrawIndexed(item.indexCount, item.startIndex, item.baseVertex);
+		m_stats.draws++;
+		previous = &item;
+	}
+}
+
+unsigned long long
+RenderQueue::makeKey(unsigned int pass,
+	unsigned int programId,
+	unsigned int textureId,
+	float depth,
+	bool translucent) {
+	float clamped = (std::min)((std::max)(depth, 0.0f), 1.0f);
+	unsigned long long bucket = static_cast<unsigned long long>(clamped * 65535.0f + 0.5f);
+	unsigned long long key = static_cast<unsigned long long>(pass & 0xF) << 60;
+
+	if (translucent) {
+		key |= 1ull << 59;
+		key |= (0xFFFFull - bucket) << 43;
+		key |= static_cast<unsigned long long>(programId & 0xFFF) << 31;
+		key |= static_cast<unsigned long long>(textureId & 0xFFF) << 19;
+	}
+	else {
+		key |= static_cast<unsigned long long>(programId & 0xFFF) << 47;
+		key |= static_cast<unsigned long long>(textureId & 0xFFF) << 35;
+		key |= bucket << 19;
+	}
+	return key;
+}
+
+unsigned int
+RenderQueue::radixSort(std::vector<unsigned long long>& keys,
+	std::vector<unsigned int>& values,
+	std::vector<unsigned long long>& keyScratch,
+	std::vector<unsigned int>& valueScratch) {
+	size_t count = keys.size();
+	if (count < 2) {
+		return 0;
+	}
+	keyScratch.resize(count);
+	valueScratch.resize(count);
+
+	// Histogramas de los 8 bytes en un solo recorrido
+	static thread_local unsigned int histograms[8][256];
+	memset(histograms, 0, sizeof(histograms));
+	for (unsigned long long key : keys) {
+		for (unsigned int byte = 0; byte < 8; ++byte) {
+			histograms[byte][(key >> (byte * 8)) & 0xFF]++;
+		}
+	}
+
+	unsigned long long* srcKeys = keys.data();
+	unsigned int* srcValues = values.data();
+	unsigned long long* dstKeys = keyScratch.data();
+	unsigned int* dstValues = valueScratch.data();
+	unsigned int passes = 0;
+	for (unsigned int byte = 0; byte < 8; ++byte) {
+		unsigned int shift = byte * 8;
+		unsigned int* histogram = histograms[byte];
+		// Si todas las llaves comparten este byte, la pasada no cambiara el orden
+		if (histogram[(srcKeys[0] >> shift) & 0xFF] == count) {
+			continue;
+		}
+
+		unsigned int offset = 0;
+		for (unsigned int digit = 0; digit < 256; ++digit) {
+			unsigned int digitCount = histogram[digit];
+			histogram[digit] = offset;
+			offset += digitCount;
+		}
+		for (size_t i = 0; i < count; ++i) {
+			unsigned int position = histogram[(srcKeys[i] >> shift) & 0xFF]++;
+			dstKeys[position] = srcKeys[i];
+			dstValues[position] = srcValues[i];
+		}
+		std::swap(srcKeys, dstKeys);
+		std::swap(srcValues, dstValues);
+		passes++;
+	}
+
+	// Con un nmero impar de pasadas el resultado qued en la memoria auxiliar
+	if (srcKeys != keys.data()) {
+		keys.swap(keyScratch);
+		values.swap(valueScratch);
+	}
+	return passes;
+}
+
+unsigned int
+RenderQueue::programId(const DrawItem& item) {
+	// Se usa el handle, no la direccin del estado: el vector del cach puede reubicarse al crecer
+	if (item.pipelineState != kInvalidPipelineState) {
+		auto it = m_pipelineStateIds.find(item.pipelineState);
+		if (it != m_pipelineStateIds.end()) {
+			return it->second;
+		}
+		if (m_programCount == kMaxSortId) {
+			return kMaxSortId;
+		}
+		m_pipelineStateIds.emplace(item.pipelineState, ++m_programCount);
+		return m_programCount;
+	}
+	auto it = m_programIds.find(item.shaderProgram);
+	if (it != m_programIds.end()) {
+		return it->second;
+	}
+	if (m_programCount == kMaxSortId) {
+		return kMaxSortId;
+	}
+	m_programIds.emplace(item.shaderProgram, ++m_programCount);
+	return m_programCount;
+}
+
+unsigned int
+RenderQueue::objectId(std::unordered_map<const void*, unsigned int>& ids, const void* object) {
+	if (!object) {
+		return 0;
+	}
+	auto it = ids.find(object);
+	if (it != ids.end()) {
+		return it->second;
+	}
+	if (ids.size() >= kMaxSortId) {
+		return kMaxSortId;
+	}
+	unsigned int id = static_cast<unsigned int>(ids.size()) + 1;
+	ids.emplace(object, id);
+	return id;
+}
@@ -0,0 +1,233 @@
+#include "RenderTargetPool.h"
+#include "Device.h"
+
+HRESULT
+RenderTargetPool::init(Device& device,
+	unsigned int recycleDelay,
+	unsigned int maxIdleFrames,
+	unsigned long long idleBudget) {
+	if (!device.m_device) {
+		ERROR("RenderTargetPool", "init", "Device is null.");
+		return E_POINTER;
+	}
+	destroy();
+	m_device = &device;
+	m_recycleDelay = recycleDelay;
+	m_maxIdleFrames = maxIdleFrames;
+	m_idleBudget = idleBudget;
+	return S_OK;
+}
+
+void
+RenderTargetPool::update() {
+	m_frame++;
+
+	while (!m_pending.empty() && m_pending.front()->releasedFrame + m_recycleDelay <= m_frame) {
+		PooledRenderTarget* target = m_pending.front();
+		m_pending.pop_front();
+		m_free[target->desc].push_back(target);
+		m_idleBytes += target->bytes;
+	}
+
+	// Desalojo por antigedad y, si an se excede el presupuesto, de la menos usada a la ms usada
+	std::vector<PooledRenderTarget*> idle;
+	for (std::pair<const RenderTargetDesc, std::vector<PooledRenderTarget*>>& bucket : m_free) {
+		idle.insert(idle.end(), bucket.second.begin(), bucket.second.end());
+	}
+	std::sort(idle.begin(), idle.end(), [](const PooledRenderTarget* a, const PooledRenderTarget* b) {
+		return a->lastUsedFrame < b->lastUsedFrame;
+	});
+	for (PooledRenderTarget* target : idle) {
+		bool stale = target->lastUsedFrame + m_maxIdleFrames < m_frame;
+		if (!stale && m_idleBytes <= m_idleBudget) {
+			break;
+		}
+		evict(target);
+	}
+}
+
+void
+RenderTargetPool::destroy() {
+	for (std::unique_ptr<PooledRenderTarget>& target : m_targets) {
+		releaseViews(*target);
+	}
+	m_targets.clear();
+	m_free.clear();
+	m_pending.clear();
+	m_device = nullptr;
+	m_frame = 0;
+	m_totalBytes = 0;
+	m_idleBytes = 0;
+	m_stats = RenderTargetPoolStats();
+}
+
+HRESULT
+RenderTargetPool::acquire(const RenderTargetDesc& desc, PooledRenderTarget*& target) {
+	target = nullptr;
+	if (!m_device) {
+		ERROR("RenderTargetPool", "acquire", "RenderTargetPool is not initialized.");
+		return E_FAIL;
+	}
+	if (desc.width == 0 || desc.height == 0 || desc.format == DXGI_FORMAT_UNKNOWN || desc.sampleCount == 0) {
+		ERROR("RenderTargetPool", "acquire", "Invalid render target description");
+		return E_INVALIDARG;
+	}
+
+	std::unordered_map<RenderTargetDesc, std::vector<PooledRenderTarget*>, RenderTargetDescHash>::iterator bucket =
+		m_free.find(desc);
+	if (bucket != m_free.end() && !bucket->second.empty()) {
+		// La usada ms recientemente: es la que ms probablemente siga en cach del driver
+		target = bucket->second.back();
+		bucket->second.pop_back();
+		m_idleBytes -= target->bytes;
+		m_stats.hits++;
+	}
+	else {
+		std::unique_ptr<PooledRenderTarget> created(new PooledRenderTarget());
+		created->desc = desc;
+		HRESULT hr = createTarget(*created);
+		if (FAILED(hr)) {
+			ERROR("RenderTargetPool", "acquire",
+				("Failed to create render target. HRESULT: " + std::to_string(hr)).c_str());
+			releaseViews(*created);
+			return hr;
+		}
+		created->bytes = static_cast<unsigned long long>(desc.width) * desc.height *
+			bytesPerPixel(desc.format) * desc.sampleCount;
+		m_totalBytes += created->bytes;
+		target = created.get();
+		m_targets.push_back(std::move(created));
+		m_stats.misses++;
+	}
+	target->inUse = true;
+	target->lastUsedFrame = m_frame;
+	return S_OK;
+}
+
+void
+RenderTargetPool::release(PooledRenderTarget* target) {
+	if (!target || !target->inUse) {
+		ERROR("RenderTargetPool", "release", "Render target is not in use");
+		return;
+	}
+	target->inUse = false;
+	target->releasedFrame = m_frame;
+	m_pending.push_back(target);
+}
+
+std::string
+RenderTargetPool::report() const {
+	std::ostringstream os;
+	os << "Render target pool: " << m_targets.size() << " textures, "
+		<< (m_totalBytes / 1024) << " KB (" << (m_idleBytes / 1024) << " KB idle), "
+		<< m_stats.hits << " hits, " << m_stats.misses << " misses, "
+		<< m_stats.evictions << " evictions\n";
+	return os.str();
+}
+
+unsigned int
+RenderTargetPool::bytesPerPixel(DXGI_FORMAT format) {
+	switch (format) {
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+	case DXGI_FORMAT_R32G32B32A32_UINT:
+	case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+		return 16;
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+	case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+		return 8;
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_R16_UNORM:
+	case DXGI_FORMAT_D16_UNORM:
+		return 2;
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_A8_UNORM:
+		return 1;
+	default:
+		// RGBA8, BGRA8, R10G10B10A2, R11G11B10, R32, D24S8, D32...
+		return 4;
+	}
+}
+
+HRESULT
+RenderTargetPool::createTarget(PooledRenderTarget& target) {
+	const RenderTargetDesc& desc = target.desc;
+	bool multisampled = desc.sampleCount > 1;
+
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = desc.width;
+	textureDesc.Height = desc.height;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = desc.format;
+	textureDesc.SampleDesc.Count = desc.sampleCount;
+	textureDesc.SampleDesc.Quality = desc.sampleQuality;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags = desc.bindFlags;
+	HRESULT hr = m_device->CreateTexture2D(&textureDesc, nullptr, &target.texture);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	if (desc.bindFlags & D3D11_BIND_RENDER_TARGET) {
+		D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+		rtvDesc.Format = desc.format;
+		rtvDesc.ViewDimension = multisampled ? D3D11_RTV_DIMENSION_TEXTURE2DMS : D3D11_RTV_DIMENSION_TEXTURE2D;
+		hr = m_device->CreateRenderTargetView(target.texture, &rtvDesc, &target.renderTargetView);
+		if (FAILED(hr)) {
+			return hr;
+		}
+	}
+	if (desc.bindFlags & D3D11_BIND_DEPTH_STENCIL) {
+		D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+		dsvDesc.Format = desc.format;
+		dsvDesc.ViewDimension = multisampled ? D3D11_DSV_DIMENSION_TEXTURE2DMS : D3D11_DSV_DIMENSION_TEXTURE2D;
+		hr = m_device->CreateDepthStencilView(target.texture, &dsvDesc, &target.depthStencilView);
+		if (FAILED(hr)) {
+			return hr;
+		}
+	}
+	// Un depth-stencil legible necesitara formatos typeless; solo se crea SRV para color
+	if ((desc.bindFlags & D3D11_BIND_SHADER_RESOURCE) && !(desc.bindFlags & D3D11_BIND_DEPTH_STENCIL)) {
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = desc.format;
+		srvDesc.ViewDimension = multisampled ? D3D11_SRV_DIMENSION_TEXTURE2DMS : D3D11_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels = 1;
+		hr = m_device->CreateShaderResourceView(target.texture, &srvDesc, &target.shaderResourceView);
+		if (FAILED(hr)) {
+			return hr;
+		}
+	}
+	return S_OK;
+}
+
+void
+RenderTargetPool::evict(PooledRenderTarget* target) {
+	std::vector<PooledRenderTarget*>& bucket = m_free[target->desc];
+	bucket.erase(std::remove(bucket.begin(), bucket.end(), target), bucket.end());
+	if (bucket.empty()) {
+		m_free.erase(target->desc);
+	}
+	m_idleBytes -= target->bytes;
+	m_totalBytes -= target->bytes;
+	m_stats.evictions++;
+
+	releaseViews(*target);
+	for (size_t i = 0; i < m_targets.size(); ++i) {
+		if (m_targets[i].get() == target) {
+			m_targets[i] = std::move(m_targets.back());
+			m_targets.pop_back();
+			break;
+		}
+	}
+}
+
+void
+RenderTargetPool::releaseViews(PooledRenderTarget& target) {
+	SAFE_RELEASE(target.shaderResourceView);
+	SAFE_RELEASE(target.depthStencilView);
+	SAFE_RELEASE(target.renderTargetView);
+	SAFE_RELEASE(target.texture);
+}
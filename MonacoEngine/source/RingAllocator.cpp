@@ -0,0 +1,111 @@
+#include "RingAllocator.h"
+
+HRESULT
+RingAllocator::init(unsigned int capacity, unsigned int alignment) {
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		ERROR("RingAllocator", "init", "alignment must be a power of two");
+		return E_INVALIDARG;
+	}
+	if (capacity == 0 || capacity % alignment != 0) {
+		ERROR("RingAllocator", "init", "capacity must be a non-zero multiple of alignment");
+		return E_INVALIDARG;
+	}
+
+	destroy();
+	m_capacity = capacity;
+	m_alignment = alignment;
+	m_stats = RingAllocatorStats();
+	return S_OK;
+}
+
+void
+RingAllocator::destroy() {
+	m_head = 0;
+	m_tail = 0;
+	m_used = 0;
+	m_frameBytes = 0;
+	m_frames.clear();
+}
+
+bool
+RingAllocator::allocate(unsigned int size, unsigned int& offset) {
+	if (size == 0 || size > m_capacity) {
+		ERROR("RingAllocator", "allocate", "size must be between 1 and the ring capacity");
+		return false;
+	}
+	unsigned int aligned = (size + m_alignment - 1) & ~(m_alignment - 1);
+
+	// Anillo vaco: se reinicia desde el principio para aprovechar todo el espacio
+	if (m_used == 0) {
+		m_head = 0;
+		m_tail = 0;
+	}
+
+	unsigned int start = m_head;
+	unsigned int waste = 0;
+	if (m_used > 0 && m_head > m_tail) {
+		// Libre: [head, capacity) y [0, tail)
+		if (m_capacity - m_head < aligned) {
+			if (m_tail < aligned) {
+				m_stats.stalls++;
+				return false;
+			}
+			waste = m_capacity - m_head;
+			start = 0;
+			m_stats.wraps++;
+		}
+	}
+	else if (m_used > 0 && m_tail - m_head < aligned) {
+		// Libre: [head, tail); head == tail con datos significa anillo lleno
+		m_stats.stalls++;
+		return false;
+	}
+
+	offset = start;
+	m_head = start + aligned;
+	if (m_head == m_capacity) {
+		m_head = 0;
+		m_stats.wraps++;
+	}
+	m_used += waste + aligned;
+	m_frameBytes += waste + aligned;
+
+	m_stats.allocations++;
+	m_stats.bytes += aligned;
+	m_stats.wastedBytes += waste;
+	return true;
+}
+
+void
+RingAllocator::endFrame(unsigned long long fence) {
+	m_frames.push_back({ fence, m_head, m_frameBytes });
+	m_frameBytes = 0;
+}
+
+void
+RingAllocator::retire(unsigned long long completedFence) {
+	while (!m_frames.empty() && m_frames.front().fence <= completedFence) {
+		const Frame& frame = m_frames.front();
+		m_used -= frame.bytes;
+		// Un frame vaco no movi la cabeza; su "end" puede ser anterior a un reinicio
+		if (frame.bytes > 0) {
+			m_tail = frame.end;
+		}
+		m_frames.pop_front();
+	}
+}
+
+void
+RingAllocator::forceRetire() {
+	if (!m_frames.empty()) {
+		retire(m_frames.front().fence);
+		m_stats.forcedRetires++;
+		return;
+	}
+	if (m_frameBytes > 0) {
+		m_used -= m_frameBytes;
+		m_frameBytes = 0;
+		m_tail = m_head;
+		m_stats.forcedRetires++;
+	}
+}
@@ -0,0 +1,454 @@
+#include "ShaderCache.h"
+
+// Cabecera: magic, versin, nmero de entradas, reservado y offset del ndice
+static const unsigned long long kHeaderSize = 4 + 4 + 4 + 4 + 8;
+// Registro del ndice: llave, ranura, offset de datos, dependencias, tamao y offset del bytecode
+static const unsigned long long kIndexRecordSize = 8 + 8 + 8 + 4 + 4 + 8;
+
+template<typename T>
+static void
+writeValue(std::ofstream& out, const T& value) {
+	out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * @brief Lee un @p T de @p view en @p offset si cabe antes de @p size, y avanza @p offset.
+ */
+template<typename T>
+static bool
+readValue(const unsigned char* view, unsigned long long size, unsigned long long& offset, T& value) {
+	if (offset > size || size - offset < sizeof(T)) {
+		return false;
+	}
+	memcpy(&value, view + offset, sizeof(T));
+	offset += sizeof(T);
+	return true;
+}
+
+static std::string
+directoryOf(const std::string& path) {
+	size_t slash = path.find_last_of("/\\");
+	return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+/**
+ * @brief Resuelve los #include relativos al archivo que los contiene y anota cada
+ *        archivo abierto como dependencia de la compilacin.
+ */
+class
+	ShaderIncludeHandler : public ID3DInclude {
+public:
+	ShaderIncludeHandler(const std::string& sourceDirectory, std::vector<std::pair<std::string, unsigned long long>>& dependencies)
+		: m_sourceDirectory(sourceDirectory), m_dependencies(dependencies) {}
+
+	HRESULT __stdcall
+		Open(D3D_INCLUDE_TYPE, LPCSTR fileName, LPCVOID parentData, LPCVOID* data, UINT* bytes) override {
+		std::string directory = m_sourceDirectory;
+		std::unordered_map<LPCVOID, std::string>::const_iterator parent = m_directories.find(parentData);
+		if (parentData && parent != m_directories.end()) {
+			directory = parent->second;
+		}
+		std::string path = fileName;
+		bool absolute = path.size() > 1 && (path[1] == ':' || path[0] == '/' || path[0] == '\\');
+		if (!absolute) {
+			path = directory + path;
+		}
+
+		m_buffers.emplace_back();
+		std::string& contents = m_buffers.back();
+		std::ifstream in(path, std::ios::binary);
+		if (!in) {
+			m_buffers.pop_back();
+			return E_FAIL;
+		}
+		std::ostringstream ss;
+		ss << in.rdbuf();
+		contents = ss.str();
+
+		unsigned long long contentHash = ShaderCache::hash(contents.data(), contents.size());
+		bool known = false;
+		for (const std::pair<std::string, unsigned long long>& dependency : m_dependencies) {
+			known = known || dependency.first == path;
+		}
+		if (!known) {
+			m_dependencies.emplace_back(path, contentHash);
+		}
+
+		m_directories[contents.data()] = directoryOf(path);
+		*data = contents.data();
+		*bytes = static_cast<UINT>(contents.size());
+		return S_OK;
+	}
+
+	HRESULT __stdcall
+		Close(LPCVOID) override {
+		// Los buffers viven hasta que termina la compilacin
+		return S_OK;
+	}
+
+private:
+	std::string m_sourceDirectory;
+	std::vector<std::pair<std::string, unsigned long long>>& m_dependencies;
+	std::deque<std::string> m_buffers;
+	std::unordered_map<LPCVOID, std::string> m_directories;
+};
+
+HRESULT
+ShaderCache::init(const std::string& cacheFile) {
+	if (cacheFile.empty()) {
+		ERROR("ShaderCache", "init", "Cache file name is empty.");
+		return E_INVALIDARG;
+	}
+	unmapFile();
+	m_cacheFile = cacheFile;
+	m_dirty = false;
+	m_stats = ShaderCacheStats();
+	mapFile();
+	return S_OK;
+}
+
+void
+ShaderCache::destroy() {
+	if (!m_cacheFile.empty()) {
+		save();
+	}
+	unmapFile();
+	m_cacheFile.clear();
+	m_dirty = false;
+}
+
+HRESULT
+ShaderCache::compile(const std::string& fileName,
+	const D3D_SHADER_MACRO* defines,
+	LPCSTR entryPoint,
+	LPCSTR shaderModel,
+	unsigned int flags,
+	ID3DBlob** ppBlobOut,
+	ID3DBlob** ppErrorBlob) {
+	if (ppErrorBlob) {
+		*ppErrorBlob = nullptr;
+	}
+	if (!ppBlobOut || !entryPoint || !shaderModel) {
+		ERROR("ShaderCache", "compile", "Invalid arguments.");
+		return E_INVALIDARG;
+	}
+	*ppBlobOut = nullptr;
+
+	std::string source;
+	if (!readFile(fileName, source)) {
+		ERROR("ShaderCache", "compile", ("Failed to read shader file: " + fileName).c_str());
+		return E_FAIL;
+	}
+
+	// Ranura: la compilacin sin el contenido del archivo. Llave: la ranura ms el contenido;
+	// los includes se validan aparte
+	unsigned long long slot = hash(fileName.c_str(), fileName.size() + 1);
+	for (const D3D_SHADER_MACRO* define = defines; define && define->Name; ++define) {
+		slot = hash(define->Name, strlen(define->Name) + 1, slot);
+		const char* definition = define->Definition ? define->Definition : "";
+		slot = hash(definition, strlen(definition) + 1, slot);
+	}
+	slot = hash(entryPoint, strlen(entryPoint) + 1, slot);
+	slot = hash(shaderModel, strlen(shaderModel) + 1, slot);
+	slot = hash(&flags, sizeof(flags), slot);
+	unsigned long long key = hash(source.data(), source.size(), slot);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	std::unordered_map<unsigned long long, Entry>::iterator found = m_entries.find(key);
+	if (found != m_entries.end()) {
+		bool valid = true;
+		std::string contents;
+		for (const Dependency& dependency : found->second.dependencies) {
+			if (!readFile(dependency.path, contents) ||
+				hash(contents.data(), contents.size()) != dependency.hash) {
+				valid = false;
+				break;
+			}
+		}
+		if (valid) {
+			HRESULT hr = D3DCreateBlob(found->second.bytecodeSize, ppBlobOut);
+			if (FAILED(hr)) {
+				ERROR("ShaderCache", "compile", "Failed to create blob for cached bytecode.");
+				return hr;
+			}
+			memcpy((*ppBlobOut)->GetBufferPointer(), found->second.bytecode, found->second.bytecodeSize);
+			m_stats.hits++;
+			return S_OK;
+		}
+		m_stats.stale++;
+	}
+	else {
+		m_stats.misses++;
+	}
+	m_stats.compiles++;
+	lock.unlock();
+
+	std::vector<std::pair<std::string, unsigned long long>> dependencies;
+	ShaderIncludeHandler includeHandler(directoryOf(fileName), dependencies);
+	ID3DBlob* errorBlob = nullptr;
+	HRESULT hr = D3DCompile(source.data(),
+		source.size(),
+		fileName.c_str(),
+		defines,
+		&includeHandler,
+		entryPoint,
+		shaderModel,
+		flags,
+		0,
+		ppBlobOut,
+		&errorBlob);
+	if (ppErrorBlob) {
+		*ppErrorBlob = errorBlob;
+	}
+	else {
+		SAFE_RELEASE(errorBlob);
+	}
+
+	lock.lock();
+	if (FAILED(hr)) {
+		m_stats.failures++;
+		return hr;
+	}
+
+	// Una edicin del archivo deja obsoleta la entrada anterior de la misma ranura: se
+	// reemplaza para que el archivo no crezca con cada recarga
+	std::unordered_map<unsigned long long, unsigned long long>::iterator previous = m_slots.find(slot);
+	if (previous != m_slots.end() && previous->second != key) {
+		m_entries.erase(previous->second);
+	}
+	m_slots[slot] = key;
+
+	Entry& entry = m_entries[key];
+	entry.slot = slot;
+	entry.dependencies.clear();
+	for (const std::pair<std::string, unsigned long long>& dependency : dependencies) {
+		entry.dependencies.push_back({ dependency.first, dependency.second });
+	}
+	const unsigned char* bytecode = static_cast<const unsigned char*>((*ppBlobOut)->GetBufferPointer());
+	entry.owned.assign(bytecode, bytecode + (*ppBlobOut)->GetBufferSize());
+	entry.bytecode = entry.owned.data();
+	entry.bytecodeSize = entry.owned.size();
+	m_dirty = true;
+	return S_OK;
+}
+
+HRESULT
+ShaderCache::save() {
+	if (!m_dirty || m_cacheFile.empty()) {
+		return S_OK;
+	}
+
+	std::string tempFile = m_cacheFile + ".tmp";
+	{
+		std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			ERROR("ShaderCache", "save", ("Failed to open " + tempFile).c_str());
+			return E_FAIL;
+		}
+
+		struct IndexRecord {
+			unsigned long long key;
+			unsigned long long slot;
+			unsigned long long dataOffset;
+			unsigned int dependencyCount;
+			unsigned int bytecodeSize;
+			unsigned long long bytecodeOffset;
+		};
+		std::vector<IndexRecord> index;
+		index.reserve(m_entries.size());
+
+		// La cabecera se reescribe al final, cuando se conoce el offset del ndice
+		unsigned long long offset = 0;
+		writeValue(out, kMagic);
+		writeValue(out, kVersion);
+		writeValue(out, static_cast<unsigned int>(m_entries.size()));
+		writeValue(out, 0u);
+		writeValue(out, 0ull);
+		offset += kHeaderSize;
+
+		for (const std::pair<const unsigned long long, Entry>& pair : m_entries) {
+			const Entry& entry = pair.second;
+			IndexRecord record = { pair.first, entry.slot, offset, static_cast<unsigned int>(entry.dependencies.size()),
+				static_cast<unsigned int>(entry.bytecodeSize), 0 };
+			for (const Dependency& dependency : entry.dependencies) {
+				writeValue(out, dependency.hash);
+				writeValue(out, static_cast<unsigned int>(dependency.path.size()));
+				out.write(dependency.path.data(), dependency.path.size());
+				offset += 8 + 4 + dependency.path.size();
+			}
+			while (offset % 4 != 0) {
+				out.put(0);
+				offset++;
+			}
+			record.bytecodeOffset = offset;
+			out.write(reinterpret_cast<const char*>(entry.bytecode), entry.bytecodeSize);
+			offset += entry.bytecodeSize;
+			index.push_back(record);
+		}
+
+		unsigned long long indexOffset = offset;
+		for (const IndexRecord& record : index) {
+			writeValue(out, record.key);
+			writeValue(out, record.slot);
+			writeValue(out, record.dataOffset);
+			writeValue(out, record.dependencyCount);
+			writeValue(out, record.bytecodeSize);
+			writeValue(out, record.bytecodeOffset);
+		}
+		out.seekp(kHeaderSize - 8);
+		writeValue(out, indexOffset);
+		if (!out) {
+			ERROR("ShaderCache", "save", ("Failed to write " + tempFile).c_str());
+			return E_FAIL;
+		}
+	}
+
+	// Windows no deja reemplazar un archivo mapeado: se suelta la vista y se vuelve a mapear
+	// el archivo nuevo, que ya contiene todas las entradas
+	unmapFile();
+	if (!MoveFileExA(tempFile.c_str(), m_cacheFile.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		ERROR("ShaderCache", "save", ("Failed to replace " + m_cacheFile).c_str());
+		DeleteFileA(tempFile.c_str());
+		mapFile();
+		return E_FAIL;
+	}
+	mapFile();
+	return S_OK;
+}
+
+std::string
+ShaderCache::report() const {
+	std::ostringstream os;
+	os << "Shader cache: " << m_entries.size() << " entries, "
+		<< m_stats.hits << " hits, " << m_stats.misses << " misses, "
+		<< m_stats.stale << " stale, " << m_stats.compiles << " compiles ("
+		<< m_stats.failures << " failed)\n";
+	return os.str();
+}
+
+unsigned long long
+ShaderCache::hash(const void* data, size_t size, unsigned long long seed) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	unsigned long long value = seed;
+	for (size_t i = 0; i < size; ++i) {
+		value = (value ^ bytes[i]) * 1099511628211ull;
+	}
+	return value;
+}
+
+void
+ShaderCache::mapFile() {
+	m_entries.clear();
+	m_slots.clear();
+	m_dirty = false;
+
+	m_file = CreateFileA(m_cacheFile.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		// Primera ejecucin: no hay archivo todava
+		return;
+	}
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(m_file, &fileSize) || static_cast<unsigned long long>(fileSize.QuadPart) < kHeaderSize) {
+		unmapFile();
+		return;
+	}
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping) {
+		m_view = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (!m_view) {
+		ERROR("ShaderCache", "mapFile", ("Failed to map " + m_cacheFile).c_str());
+		unmapFile();
+		return;
+	}
+	m_viewSize = static_cast<unsigned long long>(fileSize.QuadPart);
+
+	unsigned long long offset = 0;
+	unsigned int magic = 0, version = 0, count = 0, reserved = 0;
+	unsigned long long indexOffset = 0;
+	bool valid = readValue(m_view, m_viewSize, offset, magic) &&
+		readValue(m_view, m_viewSize, offset, version) &&
+		readValue(m_view, m_viewSize, offset, count) &&
+		readValue(m_view, m_viewSize, offset, reserved) &&
+		readValue(m_view, m_viewSize, offset, indexOffset) &&
+		magic == kMagic;
+	if (valid && version != kVersion) {
+		// Archivo de otra versin del formato: se empieza vaco y save() lo reescribe
+		unmapFile();
+		return;
+	}
+	valid = valid && indexOffset <= m_viewSize && (m_viewSize - indexOffset) / kIndexRecordSize >= count;
+
+	offset = indexOffset;
+	for (unsigned int i = 0; valid && i < count; ++i) {
+		unsigned long long key = 0, slot = 0, dataOffset = 0, bytecodeOffset = 0;
+		unsigned int dependencyCount = 0, bytecodeSize = 0;
+		valid = readValue(m_view, m_viewSize, offset, key) &&
+			readValue(m_view, m_viewSize, offset, slot) &&
+			readValue(m_view, m_viewSize, offset, dataOffset) &&
+			readValue(m_view, m_viewSize, offset, dependencyCount) &&
+			readValue(m_view, m_viewSize, offset, bytecodeSize) &&
+			readValue(m_view, m_viewSize, offset, bytecodeOffset) &&
+			bytecodeOffset <= m_viewSize && m_viewSize - bytecodeOffset >= bytecodeSize;
+
+		Entry entry;
+		entry.slot = slot;
+		unsigned long long dependencyOffset = dataOffset;
+		for (unsigned int d = 0; valid && d < dependencyCount; ++d) {
+			Dependency dependency;
+			unsigned int length = 0;
+			valid = readValue(m_view, m_viewSize, dependencyOffset, dependency.hash) &&
+				readValue(m_view, m_viewSize, dependencyOffset, length) &&
+				m_viewSize - dependencyOffset >= length;
+			if (valid) {
+				dependency.path.assign(reinterpret_cast<const char*>(m_view + dependencyOffset), length);
+				dependencyOffset += length;
+				entry.dependencies.push_back(std::move(dependency));
+			}
+		}
+		if (valid) {
+			entry.bytecode = m_view + bytecodeOffset;
+			entry.bytecodeSize = bytecodeSize;
+			m_entries[key] = std::move(entry);
+			m_slots[slot] = key;
+		}
+	}
+
+	if (!valid) {
+		ERROR("ShaderCache", "mapFile", ("Ignoring invalid cache file " + m_cacheFile).c_str());
+		unmapFile();
+	}
+}
+
+void
+ShaderCache::unmapFile() {
+	// Las entradas del archivo apuntan a la vista
+	m_entries.clear();
+	m_slots.clear();
+	if (m_view) {
+		UnmapViewOfFile(m_view);
+		m_view = nullptr;
+	}
+	if (m_mapping) {
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+	}
+	if (m_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_file);
+		m_file = INVALID_HANDLE_VALUE;
+	}
+	m_viewSize = 0;
+}
+
+bool
+ShaderCache::readFile(const std::string& path, std::string& contents) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		return false;
+	}
+	std::ostringstream ss;
+	ss << in.rdbuf();
+	contents = ss.str();
+	return true;
+}
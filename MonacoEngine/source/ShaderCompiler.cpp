@@ -0,0 +1,156 @@
+#include "ShaderCompiler.h"
+#include "Device.h"
+#include "ShaderCache.h"
+#include "ThreadPool.h"
+
+// Etapas ms lentas que muestra report()
+static const size_t kReportedStages = 5;
+
+HRESULT
+ShaderCompiler::init(ThreadPool* threadPool, ShaderCache* shaderCache) {
+	destroy();
+	m_threadPool = threadPool;
+	m_shaderCache = shaderCache;
+	return S_OK;
+}
+
+void
+ShaderCompiler::destroy() {
+	m_threadPool = nullptr;
+	m_shaderCache = nullptr;
+	m_timings.clear();
+	m_lastWallMilliseconds = 0.0;
+	m_lastFailures = 0;
+	m_lastThreads = 0;
+	m_stats = ShaderCompilerStats();
+}
+
+HRESULT
+ShaderCompiler::compile(Device& device, const std::vector<ShaderCompileRequest>& requests) {
+	if (!device.m_device) {
+		ERROR("ShaderCompiler", "compile", "Device is null.");
+		return E_POINTER;
+	}
+	for (const ShaderCompileRequest& request : requests) {
+		if (!request.program || request.fileName.empty()) {
+			ERROR("ShaderCompiler", "compile", "Every request needs a program and a file name");
+			return E_INVALIDARG;
+		}
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// Etapa 2 * i es el VS de la peticin i y 2 * i + 1 su PS
+	unsigned int stageCount = static_cast<unsigned int>(requests.size() * 2);
+	std::vector<ID3DBlob*> bytecode(stageCount, nullptr);
+	m_timings.assign(stageCount, ShaderCompileTiming());
+
+	ShaderCache* shaderCache = m_shaderCache;
+	std::function<void(unsigned int)> compileStage = [&requests, &bytecode, shaderCache, this](unsigned int stage) {
+		const ShaderCompileRequest& request = requests[stage / 2];
+		ShaderType type = (stage % 2 == 0) ? VERTEX_SHADER : PIXEL_SHADER;
+		ShaderCompileTiming& timing = m_timings[stage];
+		timing.fileName = request.fileName;
+		timing.type = type;
+		for (const ShaderMacro& define : request.defines) {
+			timing.defines += (timing.defines.empty() ? "" : " ") + define.name + "=" + define.definition;
+		}
+
+		std::chrono::steady_clock::time_point stageStart = std::chrono::steady_clock::now();
+		timing.result = ShaderProgram::CompileShader(request.fileName,
+			request.defines,
+			ShaderProgram::entryPoint(type),
+			ShaderProgram::shaderModel(type),
+			shaderCache,
+			&bytecode[stage]);
+		timing.milliseconds =
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stageStart).count();
+	};
+	// parallelFor tambin trabaja en el hilo que llama
+	m_lastThreads = m_threadPool ? m_threadPool->size() + 1 : 1;
+	if (m_threadPool) {
+		m_threadPool->parallelFor(stageCount, compileStage);
+	}
+	else {
+		for (unsigned int stage = 0; stage < stageCount; ++stage) {
+			compileStage(stage);
+		}
+	}
+
+	// Creacin en el hilo que llama y en orden de dependencia: VS, input layout, PS
+	HRESULT result = S_OK;
+	m_lastFailures = 0;
+	for (size_t i = 0; i < requests.size(); ++i) {
+		const ShaderCompileRequest& request = requests[i];
+		ID3DBlob* vertexShaderData = bytecode[i * 2];
+		ID3DBlob* pixelShaderData = bytecode[i * 2 + 1];
+		HRESULT hr = FAILED(m_timings[i * 2].result) ? m_timings[i * 2].result : m_timings[i * 2 + 1].result;
+
+		if (SUCCEEDED(hr)) {
+			request.program->setShaderCache(m_shaderCache);
+			hr = request.program->CreateShader(device, VERTEX_SHADER, vertexShaderData);
+			vertexShaderData = nullptr;
+		}
+		if (SUCCEEDED(hr) && !request.layout.empty()) {
+			hr = request.program->CreateInputLayout(device, request.layout);
+		}
+		if (SUCCEEDED(hr)) {
+			hr = request.program->CreateShader(device, PIXEL_SHADER, pixelShaderData);
+			pixelShaderData = nullptr;
+		}
+
+		SAFE_RELEASE(vertexShaderData);
+		SAFE_RELEASE(pixelShaderData);
+		if (FAILED(hr)) {
+			ERROR("ShaderCompiler", "compile", ("Failed to build shader program " + request.fileName).c_str());
+			request.program->destroy();
+			m_lastFailures++;
+			if (SUCCEEDED(result)) {
+				result = hr;
+			}
+		}
+	}
+
+	m_lastWallMilliseconds =
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	m_stats.batches++;
+	m_stats.programs += requests.size();
+	m_stats.stages += stageCount;
+	m_stats.failures += m_lastFailures;
+	m_stats.wallMilliseconds += m_lastWallMilliseconds;
+	for (const ShaderCompileTiming& timing : m_timings) {
+		m_stats.compileMilliseconds += timing.milliseconds;
+	}
+	return result;
+}
+
+std::string
+ShaderCompiler::report() const {
+	double compileMilliseconds = 0.0;
+	for (const ShaderCompileTiming& timing : m_timings) {
+		compileMilliseconds += timing.milliseconds;
+	}
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+	os << "Shader compiler: " << (m_timings.size() / 2) << " programs, " << m_timings.size()
+		<< " stages on " << m_lastThreads << " threads in " << m_lastWallMilliseconds << " ms ("
+		<< compileMilliseconds << " ms serial), " << m_lastFailures << " failed\n";
+
+	std::vector<const ShaderCompileTiming*> slowest;
+	for (const ShaderCompileTiming& timing : m_timings) {
+		slowest.push_back(&timing);
+	}
+	std::sort(slowest.begin(), slowest.end(), [](const ShaderCompileTiming* a, const ShaderCompileTiming* b) {
+		return a->milliseconds > b->milliseconds;
+	});
+	for (size_t i = 0; i < slowest.size() && i < kReportedStages; ++i) {
+		const ShaderCompileTiming& timing = *slowest[i];
+		os << "  " << timing.fileName << " " << ShaderProgram::entryPoint(timing.type);
+		if (!timing.defines.empty()) {
+			os << " [" << timing.defines << "]";
+		}
+		os << ": " << timing.milliseconds << " ms" << (FAILED(timing.result) ? " (failed)" : "") << "\n";
+	}
+	return os.str();
+}
@@ -0,0 +1,234 @@
+#include "ShaderHotReload.h"
+#include "PipelineStateCache.h"
+#include "ShaderPermutations.h"
+#include "ShaderProgram.h"
+
+HRESULT
+ShaderHotReload::init(const std::string& directory, ThreadPool* threadPool, ShaderCache* shaderCache) {
+	destroy();
+	HRESULT hr = m_watcher.init(directory);
+	if (FAILED(hr)) {
+		ERROR("ShaderHotReload", "init", "Failed to watch the shader directory");
+		return hr;
+	}
+	m_shaderCache = shaderCache;
+	m_threadPool = threadPool;
+	if (!m_threadPool) {
+		m_ownThreadPool.reset(new ThreadPool());
+		m_ownThreadPool->init(1);
+		m_threadPool = m_ownThreadPool.get();
+	}
+	return S_OK;
+}
+
+void
+ShaderHotReload::watch(PipelineStateCache& pipelineStateCache) {
+	if (std::find(m_pipelineStateCaches.begin(), m_pipelineStateCaches.end(), &pipelineStateCache) ==
+		m_pipelineStateCaches.end()) {
+		m_pipelineStateCaches.push_back(&pipelineStateCache);
+	}
+}
+
+void
+ShaderHotReload::watch(ShaderPermutations& permutations) {
+	if (std::find(m_permutations.begin(), m_permutations.end(), &permutations) == m_permutations.end()) {
+		m_permutations.push_back(&permutations);
+	}
+}
+
+void
+ShaderHotReload::update() {
+	if (!m_threadPool) {
+		return;
+	}
+
+	// 1. Frontera de frame: se reemplazan los shaders de las compilaciones terminadas
+	std::vector<CompiledFile> completed;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		completed.swap(m_completed);
+	}
+	for (CompiledFile& compiled : completed) {
+		m_stats.compileMilliseconds += compiled.milliseconds;
+		if (compiled.generation != m_generations[compiled.fileName]) {
+			// El archivo volvi a cambiar mientras se compilaba
+			SAFE_RELEASE(compiled.vertexShaderData);
+			SAFE_RELEASE(compiled.pixelShaderData);
+			m_stats.discarded++;
+			continue;
+		}
+		if (FAILED(compiled.result)) {
+			ERROR("ShaderHotReload", "update", ("Keeping previous shaders of " + compiled.fileName).c_str());
+			SAFE_RELEASE(compiled.vertexShaderData);
+			SAFE_RELEASE(compiled.pixelShaderData);
+			m_stats.failures++;
+			continue;
+		}
+
+		bool applied = false;
+		for (PipelineStateCache* pipelineStateCache : m_pipelineStateCaches) {
+			// replaceShader() toma posesin de su copia
+			compiled.vertexShaderData->AddRef();
+			compiled.pixelShaderData->AddRef();
+			HRESULT hr = pipelineStateCache->replaceShader(compiled.fileName,
+				compiled.vertexShaderData, compiled.pixelShaderData);
+			if (hr == S_OK) {
+				applied = true;
+			}
+			else if (FAILED(hr)) {
+				m_stats.failures++;
+			}
+		}
+		SAFE_RELEASE(compiled.vertexShaderData);
+		SAFE_RELEASE(compiled.pixelShaderData);
+		if (applied) {
+			MESSAGE("ShaderHotReload", "update", compiled.fileName.c_str());
+			m_stats.applied++;
+		}
+	}
+
+	// 2. Archivos modificados
+	std::vector<std::string> changed;
+	if (!m_watcher.poll(changed)) {
+		return;
+	}
+	std::vector<std::string> rootFiles;
+	for (PipelineStateCache* pipelineStateCache : m_pipelineStateCaches) {
+		std::vector<std::string> files = pipelineStateCache->shaderFiles();
+		rootFiles.insert(rootFiles.end(), files.begin(), files.end());
+	}
+
+	bool reloadAll = false;
+	std::vector<std::string> reloadFiles;
+	std::vector<ShaderPermutations*> reloadPermutations;
+	for (const std::string& path : changed) {
+		// Ruta vaca: se perdieron notificaciones
+		if (!path.empty() && !isShaderSource(path)) {
+			continue;
+		}
+		m_stats.changes++;
+		std::string changedFile = normalize(m_watcher.directory() + path);
+		bool root = false;
+		for (const std::string& file : rootFiles) {
+			if (!path.empty() && normalize(file) == changedFile) {
+				reloadFiles.push_back(file);
+				root = true;
+			}
+		}
+		for (ShaderPermutations* permutations : m_permutations) {
+			if (!path.empty() && normalize(permutations->fileName()) == changedFile) {
+				reloadPermutations.push_back(permutations);
+				root = true;
+			}
+		}
+		// Un include puede usarlo cualquiera
+		reloadAll = reloadAll || !root;
+	}
+	if (reloadAll) {
+		reloadFiles = rootFiles;
+		reloadPermutations = m_permutations;
+	}
+
+	std::sort(reloadFiles.begin(), reloadFiles.end());
+	reloadFiles.erase(std::unique(reloadFiles.begin(), reloadFiles.end()), reloadFiles.end());
+	for (const std::string& file : reloadFiles) {
+		compileInBackground(file);
+	}
+	std::sort(reloadPermutations.begin(), reloadPermutations.end());
+	reloadPermutations.erase(std::unique(reloadPermutations.begin(), reloadPermutations.end()),
+		reloadPermutations.end());
+	for (ShaderPermutations* permutations : reloadPermutations) {
+		permutations->reload();
+	}
+}
+
+void
+ShaderHotReload::destroy() {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this]() { return m_inFlight == 0; });
+		for (CompiledFile& compiled : m_completed) {
+			SAFE_RELEASE(compiled.vertexShaderData);
+			SAFE_RELEASE(compiled.pixelShaderData);
+		}
+		m_completed.clear();
+	}
+	m_watcher.destroy();
+	m_ownThreadPool.reset();
+	m_threadPool = nullptr;
+	m_shaderCache = nullptr;
+	m_pipelineStateCaches.clear();
+	m_permutations.clear();
+	m_generations.clear();
+	m_stats = ShaderHotReloadStats();
+}
+
+std::string
+ShaderHotReload::report() const {
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+	os << "Shader hot reload: " << m_stats.changes << " changes, " << m_stats.compiles << " recompiles ("
+		<< m_stats.compileMilliseconds << " ms in background), " << m_stats.applied << " applied, "
+		<< m_stats.failures << " failed, " << m_stats.discarded << " superseded\n";
+	return os.str();
+}
+
+std::string
+ShaderHotReload::normalize(const std::string& path) {
+	std::string normalized = path;
+	for (char& c : normalized) {
+		c = (c == '/') ? '\\' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+	while (normalized.compare(0, 2, ".\\") == 0) {
+		normalized.erase(0, 2);
+	}
+	return normalized;
+}
+
+bool
+ShaderHotReload::isShaderSource(const std::string& path) {
+	static const char* const extensions[] = { ".fx", ".fxh", ".hlsl", ".hlsli" };
+	std::string normalized = normalize(path);
+	for (const char* extension : extensions) {
+		size_t length = std::strlen(extension);
+		if (normalized.size() > length && normalized.compare(normalized.size() - length, length, extension) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+ShaderHotReload::compileInBackground(const std::string& fileName) {
+	unsigned int generation = ++m_generations[fileName];
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_inFlight++;
+	}
+	m_stats.compiles++;
+
+	// La tarea solo usa copias y la cola protegida por m_mutex; destroy() espera a m_inFlight
+	ShaderCache* shaderCache = m_shaderCache;
+	m_threadPool->enqueue([this, fileName, generation, shaderCache]() {
+		CompiledFile compiled;
+		compiled.fileName = fileName;
+		compiled.generation = generation;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		compiled.result = ShaderProgram::CompileShader(fileName, {},
+			ShaderProgram::entryPoint(VERTEX_SHADER), ShaderProgram::shaderModel(VERTEX_SHADER),
+			shaderCache, &compiled.vertexShaderData);
+		if (SUCCEEDED(compiled.result)) {
+			compiled.result = ShaderProgram::CompileShader(fileName, {},
+				ShaderProgram::entryPoint(PIXEL_SHADER), ShaderProgram::shaderModel(PIXEL_SHADER),
+				shaderCache, &compiled.pixelShaderData);
+		}
+		compiled.milliseconds =
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_completed.push_back(compiled);
+		m_inFlight--;
+		m_idle.notify_all();
+	});
+}
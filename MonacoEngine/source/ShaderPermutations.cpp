@@ -0,0 +1,392 @@
+#include "ShaderPermutations.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderCompiler.h"
+
+HRESULT
+ShaderPermutations::init(Device& device,
+	const ShaderPermutationDesc& desc,
+	ThreadPool* threadPool,
+	ShaderCache* shaderCache) {
+	if (!device.m_device) {
+		ERROR("ShaderPermutations", "init", "Device is null.");
+		return E_POINTER;
+	}
+	if (desc.fileName.empty() || desc.layout.empty() || desc.keywords.size() > 32) {
+		ERROR("ShaderPermutations", "init", "A file, a layout and at most 32 keywords are required");
+		return E_INVALIDARG;
+	}
+	destroy();
+	m_device = &device;
+	m_desc = desc;
+	m_validMask = desc.keywords.size() == 32 ? 0xFFFFFFFF : (1u << desc.keywords.size()) - 1;
+	m_shaderCache = shaderCache;
+	m_threadPool = threadPool;
+	if (!m_threadPool) {
+		m_ownThreadPool.reset(new ThreadPool());
+		m_ownThreadPool->init(1);
+		m_threadPool = m_ownThreadPool.get();
+	}
+
+	// La variante base es el ltimo respaldo: se compila aqu, en el hilo que llama
+	Variant& base = m_variants[0];
+	base.program.reset(new ShaderProgram());
+	base.program->setShaderCache(m_shaderCache);
+	ID3DBlob* vertexShaderData = nullptr;
+	ID3DBlob* pixelShaderData = nullptr;
+	HRESULT hr = ShaderProgram::CompileShader(desc.fileName, defines(0),
+		ShaderProgram::entryPoint(VERTEX_SHADER), ShaderProgram::shaderModel(VERTEX_SHADER),
+		m_shaderCache, &vertexShaderData);
+	if (SUCCEEDED(hr)) {
+		hr = ShaderProgram::CompileShader(desc.fileName, defines(0),
+			ShaderProgram::entryPoint(PIXEL_SHADER), ShaderProgram::shaderModel(PIXEL_SHADER),
+			m_shaderCache, &pixelShaderData);
+	}
+	if (SUCCEEDED(hr)) {
+		hr = base.program->CreateShader(device, VERTEX_SHADER, vertexShaderData);
+		vertexShaderData = nullptr;
+	}
+	if (SUCCEEDED(hr)) {
+		hr = base.program->CreateInputLayout(device, layout(0));
+	}
+	if (SUCCEEDED(hr)) {
+		hr = base.program->CreateShader(device, PIXEL_SHADER, pixelShaderData);
+		pixelShaderData = nullptr;
+	}
+	SAFE_RELEASE(vertexShaderData);
+	SAFE_RELEASE(pixelShaderData);
+	if (FAILED(hr)) {
+		ERROR("ShaderPermutations", "init", ("Failed to create base variant of " + desc.fileName).c_str());
+		destroy();
+		return hr;
+	}
+	base.state = VARIANT_READY;
+	return S_OK;
+}
+
+void
+ShaderPermutations::update() {
+	std::vector<CompiledVariant> completed;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		completed.swap(m_completed);
+	}
+
+	for (CompiledVariant& compiled : completed) {
+		Variant& entry = m_variants[compiled.variant];
+		m_stats.compileMilliseconds += compiled.milliseconds;
+
+		// Una recarga posterior ya la reemplaz: su resultado, bueno o malo, no cuenta
+		if (compiled.generation != entry.generation) {
+			SAFE_RELEASE(compiled.vertexShaderData);
+			SAFE_RELEASE(compiled.pixelShaderData);
+			continue;
+		}
+
+		// Se construye aparte: una recarga fallida no debe tocar el programa en uso
+		std::unique_ptr<ShaderProgram> created(new ShaderProgram());
+		created->setShaderCache(m_shaderCache);
+		HRESULT hr = compiled.result;
+		if (SUCCEEDED(hr)) {
+			hr = created->CreateShader(*m_device, VERTEX_SHADER, compiled.vertexShaderData);
+			compiled.vertexShaderData = nullptr;
+		}
+		if (SUCCEEDED(hr)) {
+			hr = created->CreateInputLayout(*m_device, layout(compiled.variant));
+		}
+		if (SUCCEEDED(hr)) {
+			hr = created->CreateShader(*m_device, PIXEL_SHADER, compiled.pixelShaderData);
+			compiled.pixelShaderData = nullptr;
+		}
+		SAFE_RELEASE(compiled.vertexShaderData);
+		SAFE_RELEASE(compiled.pixelShaderData);
+
+		if (FAILED(hr)) {
+			ERROR("ShaderPermutations", "update",
+				("Failed to create variant " + std::to_string(compiled.variant) + " of " + m_desc.fileName).c_str());
+			created->destroy();
+			m_stats.failures++;
+			// Una variante nueva queda marcada y se usa el respaldo; una recargada conserva su programa
+			if (entry.state != VARIANT_READY) {
+				entry.state = VARIANT_FAILED;
+			}
+			continue;
+		}
+		if (entry.state == VARIANT_READY) {
+			entry.program->destroy();
+			m_stats.reloads++;
+		}
+		entry.program = std::move(created);
+		entry.state = VARIANT_READY;
+	}
+}
+
+void
+ShaderPermutations::render(DeviceContext& deviceContext, unsigned int variant) {
+	ShaderProgram* program = request(variant);
+	if (program) {
+		program->render(deviceContext);
+	}
+}
+
+void
+ShaderPermutations::destroy() {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this]() { return m_inFlight == 0; });
+		for (CompiledVariant& compiled : m_completed) {
+			SAFE_RELEASE(compiled.vertexShaderData);
+			SAFE_RELEASE(compiled.pixelShaderData);
+		}
+		m_completed.clear();
+	}
+	for (std::pair<const unsigned int, Variant>& entry : m_variants) {
+		if (entry.second.program) {
+			entry.second.program->destroy();
+		}
+	}
+	m_variants.clear();
+	m_ownThreadPool.reset();
+	m_threadPool = nullptr;
+	m_shaderCache = nullptr;
+	m_device = nullptr;
+	m_desc = ShaderPermutationDesc();
+	m_validMask = 0;
+	m_stats = ShaderPermutationStats();
+}
+
+unsigned int
+ShaderPermutations::variant(const std::vector<std::string>& keywords) const {
+	unsigned int mask = 0;
+	for (const std::string& keyword : keywords) {
+		for (size_t i = 0; i < m_desc.keywords.size(); ++i) {
+			if (m_desc.keywords[i] == keyword) {
+				mask |= 1u << i;
+			}
+		}
+	}
+	return mask;
+}
+
+ShaderProgram*
+ShaderPermutations::request(unsigned int variant) {
+	if (!m_device) {
+		return nullptr;
+	}
+	variant &= m_validMask;
+	m_stats.requests++;
+
+	std::unordered_map<unsigned int, Variant>::iterator found = m_variants.find(variant);
+	if (found != m_variants.end() && found->second.state == VARIANT_READY) {
+		return found->second.program.get();
+	}
+	if (found == m_variants.end()) {
+		m_variants[variant].state = VARIANT_COMPILING;
+		compileInBackground(variant);
+	}
+	m_stats.fallbacks++;
+	return fallback(variant);
+}
+
+bool
+ShaderPermutations::isReady(unsigned int variant) const {
+	std::unordered_map<unsigned int, Variant>::const_iterator found = m_variants.find(variant & m_validMask);
+	return found != m_variants.end() && found->second.state == VARIANT_READY;
+}
+
+void
+ShaderPermutations::reload() {
+	if (!m_device) {
+		return;
+	}
+	for (std::pair<const unsigned int, Variant>& entry : m_variants) {
+		if (entry.second.state == VARIANT_FAILED) {
+			entry.second.state = VARIANT_COMPILING;
+		}
+		// Tambin las que estn compilando: pueden haber ledo el archivo anterior
+		compileInBackground(entry.first);
+	}
+}
+
+HRESULT
+ShaderPermutations::loadVariantSet(const std::string& fileName, ShaderCompiler& compiler) {
+	if (!m_device) {
+		ERROR("ShaderPermutations", "loadVariantSet", "ShaderPermutations is not initialized.");
+		return E_FAIL;
+	}
+	std::ifstream in(fileName);
+	if (!in) {
+		return S_OK;
+	}
+
+	std::vector<unsigned int> variants;
+	std::vector<ShaderCompileRequest> requests;
+	std::string line;
+	while (std::getline(in, line)) {
+		std::istringstream words(line);
+		std::vector<std::string> keywords;
+		std::string keyword;
+		while (words >> keyword) {
+			keywords.push_back(keyword);
+		}
+		unsigned int mask = variant(keywords);
+		if (m_variants.find(mask) != m_variants.end() ||
+			std::find(variants.begin(), variants.end(), mask) != variants.end()) {
+			continue;
+		}
+		variants.push_back(mask);
+	}
+
+	// Los programas se crean antes de armar las peticiones: sus direcciones no cambian
+	for (unsigned int mask : variants) {
+		Variant& entry = m_variants[mask];
+		entry.program.reset(new ShaderProgram());
+		ShaderCompileRequest request;
+		request.program = entry.program.get();
+		request.fileName = m_desc.fileName;
+		request.defines = defines(mask);
+		request.layout = layout(mask);
+		requests.push_back(request);
+	}
+	HRESULT hr = compiler.compile(*m_device, requests);
+
+	for (unsigned int mask : variants) {
+		Variant& entry = m_variants[mask];
+		if (entry.program->m_VertexShader && entry.program->m_PixelShader) {
+			entry.state = VARIANT_READY;
+			m_stats.preloaded++;
+		}
+		else {
+			entry.program.reset();
+			entry.state = VARIANT_FAILED;
+			m_stats.failures++;
+		}
+	}
+	return hr;
+}
+
+HRESULT
+ShaderPermutations::saveVariantSet(const std::string& fileName) const {
+	std::vector<unsigned int> ready;
+	for (const std::pair<const unsigned int, Variant>& entry : m_variants) {
+		if (entry.second.state == VARIANT_READY) {
+			ready.push_back(entry.first);
+		}
+	}
+	std::sort(ready.begin(), ready.end());
+
+	std::ofstream out(fileName, std::ios::trunc);
+	if (!out) {
+		ERROR("ShaderPermutations", "saveVariantSet", ("Failed to open " + fileName).c_str());
+		return E_FAIL;
+	}
+	for (unsigned int mask : ready) {
+		const char* separator = "";
+		for (size_t i = 0; i < m_desc.keywords.size(); ++i) {
+			if (mask & (1u << i)) {
+				out << separator << m_desc.keywords[i];
+				separator = " ";
+			}
+		}
+		out << "\n";
+	}
+	return out ? S_OK : E_FAIL;
+}
+
+std::string
+ShaderPermutations::report() const {
+	unsigned int ready = 0, compiling = 0, failed = 0;
+	for (const std::pair<const unsigned int, Variant>& entry : m_variants) {
+		ready += entry.second.state == VARIANT_READY;
+		compiling += entry.second.state == VARIANT_COMPILING;
+		failed += entry.second.state == VARIANT_FAILED;
+	}
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+	os << "Shader permutations (" << m_desc.fileName << "): " << m_desc.keywords.size() << " keywords, "
+		<< ready << " variants ready (" << m_stats.preloaded << " preloaded), " << compiling << " compiling, "
+		<< failed << " failed; " << m_stats.requests << " requests, " << m_stats.fallbacks << " fallbacks, "
+		<< m_stats.backgroundCompiles << " background compiles (" << m_stats.compileMilliseconds << " ms), "
+		<< m_stats.reloads << " reloaded\n";
+	return os.str();
+}
+
+std::vector<ShaderMacro>
+ShaderPermutations::defines(unsigned int variant) const {
+	std::vector<ShaderMacro> macros;
+	for (size_t i = 0; i < m_desc.keywords.size(); ++i) {
+		if (variant & (1u << i)) {
+			macros.push_back({ m_desc.keywords[i], "1" });
+		}
+	}
+	return macros;
+}
+
+std::vector<D3D11_INPUT_ELEMENT_DESC>
+ShaderPermutations::layout(unsigned int variant) const {
+	std::vector<D3D11_INPUT_ELEMENT_DESC> elements = m_desc.layout;
+	if (m_desc.extendLayout) {
+		m_desc.extendLayout(variant, elements);
+	}
+	return elements;
+}
+
+ShaderProgram*
+ShaderPermutations::fallback(unsigned int variant) const {
+	ShaderProgram* best = nullptr;
+	int bestKeywords = -1;
+	for (const std::pair<const unsigned int, Variant>& entry : m_variants) {
+		unsigned int candidate = entry.first;
+		bool subset = (candidate & ~variant) == 0;
+		bool sameLayout = (candidate & m_desc.layoutKeywords) == (variant & m_desc.layoutKeywords);
+		if (entry.second.state != VARIANT_READY || !subset || !sameLayout) {
+			continue;
+		}
+		int keywords = 0;
+		for (unsigned int bits = candidate; bits; bits &= bits - 1) {
+			++keywords;
+		}
+		if (keywords > bestKeywords) {
+			bestKeywords = keywords;
+			best = entry.second.program.get();
+		}
+	}
+	return best;
+}
+
+void
+ShaderPermutations::compileInBackground(unsigned int variant) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_inFlight++;
+	}
+	m_stats.backgroundCompiles++;
+
+	// La tarea solo usa copias y la cola protegida por m_mutex; destroy() espera a m_inFlight
+	unsigned int generation = ++m_variants[variant].generation;
+	std::string fileName = m_desc.fileName;
+	std::vector<ShaderMacro> macros = defines(variant);
+	ShaderCache* shaderCache = m_shaderCache;
+	m_threadPool->enqueue([this, variant, generation, fileName, macros, shaderCache]() {
+		CompiledVariant compiled;
+		compiled.variant = variant;
+		compiled.generation = generation;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		compiled.result = ShaderProgram::CompileShader(fileName, macros,
+			ShaderProgram::entryPoint(VERTEX_SHADER), ShaderProgram::shaderModel(VERTEX_SHADER),
+			shaderCache, &compiled.vertexShaderData);
+		if (SUCCEEDED(compiled.result)) {
+			compiled.result = ShaderProgram::CompileShader(fileName, macros,
+				ShaderProgram::entryPoint(PIXEL_SHADER), ShaderProgram::shaderModel(PIXEL_SHADER),
+				shaderCache, &compiled.pixelShaderData);
+		}
+		compiled.milliseconds =
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_completed.push_back(compiled);
+		m_inFlight--;
+		m_idle.notify_all();
+	});
+}
@@ -1,6 +1,7 @@
 #include "ShaderProgram.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "ShaderCache.h"
 
 
 HRESULT
@@ -82,16 +83,12 @@ ShaderProgram::CreateShader(Device& device, ShaderType type) {
 		return E_INVALIDARG;
 	}
 
-	HRESULT hr = S_OK;
 	ID3DBlob* shaderData = nullptr;
 
-	const char* shaderEntryPoint = (type == ShaderType::PIXEL_SHADER) ? "PS" : "VS";
-	const char* shaderModel = (type == ShaderType::PIXEL_SHADER) ? "ps_4_0" : "vs_4_0";
-
 	// Compile the shader from file
-	hr = CompileShaderFromFile(m_shaderFileName.data(),
-		shaderEntryPoint,
-		shaderModel,
+	HRESULT hr = CompileShaderFromFile(m_shaderFileName.data(),
+		entryPoint(type),
+		shaderModel(type),
 		&shaderData);
 
 	if (FAILED(hr)) {
@@ -100,14 +97,32 @@ ShaderProgram::CreateShader(Device& device, ShaderType type) {
 		return hr;
 	}
 
+	return CreateShader(device, type, shaderData);
+}
+
+HRESULT
+ShaderProgram::CreateShader(Device& device, ShaderType type, ID3DBlob* shaderData) {
+	if (!shaderData) {
+		ERROR("ShaderProgram", "CreateShader", "Shader data is null.");
+		return E_POINTER;
+	}
+	if (!device.m_device) {
+		ERROR("ShaderProgram", "CreateShader", "Device is null.");
+		shaderData->Release();
+		return E_POINTER;
+	}
+
 	// Create the shader object
+	HRESULT hr = S_OK;
 	if (type == PIXEL_SHADER) {
+		SAFE_RELEASE(m_PixelShader);
 		hr = device.CreatePixelShader(shaderData->GetBufferPointer(),
 			shaderData->GetBufferSize(),
 			nullptr,
 			&m_PixelShader);
 	}
 	else {
+		SAFE_RELEASE(m_VertexShader);
 		hr = device.CreateVertexShader(shaderData->GetBufferPointer(),
 			shaderData->GetBufferSize(),
 			nullptr,
@@ -164,6 +179,16 @@ ShaderProgram::CompileShaderFromFile(char* szFileName,
 	LPCSTR szEntryPoint,
 	LPCSTR szShaderModel,
 	ID3DBlob** ppBlobOut) {
+	return CompileShader(szFileName, std::vector<ShaderMacro>(), szEntryPoint, szShaderModel, m_shaderCache, ppBlobOut);
+}
+
+HRESULT
+ShaderProgram::CompileShader(const std::string& fileName,
+	const std::vector<ShaderMacro>& defines,
+	LPCSTR entryPoint,
+	LPCSTR shaderModel,
+	ShaderCache* shaderCache,
+	ID3DBlob** ppBlobOut) {
 	HRESULT hr = S_OK;
 
 	DWORD dwShaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
@@ -174,31 +199,48 @@ ShaderProgram::CompileShaderFromFile(char* szFileName,
 	// the release configuration of this program.
 	dwShaderFlags |= D3DCOMPILE_DEBUG;
 #endif
-	ID3DBlob* pErrorBlob;
-	hr = D3DX11CompileFromFile(szFileName,
-		nullptr,
-		nullptr,
-		szEntryPoint,
-		szShaderModel,
-		dwShaderFlags,
-		0,
-		nullptr,
-		ppBlobOut,
-		&pErrorBlob,
-		nullptr);
+	// D3D_SHADER_MACRO apunta a las cadenas de @p defines; termina en {nullptr, nullptr}
+	std::vector<D3D_SHADER_MACRO> macros;
+	for (const ShaderMacro& define : defines) {
+		macros.push_back({ define.name.c_str(), define.definition.c_str() });
+	}
+	macros.push_back({ nullptr, nullptr });
+
+	ID3DBlob* pErrorBlob = nullptr;
+	if (shaderCache) {
+		hr = shaderCache->compile(fileName,
+			macros.data(),
+			entryPoint,
+			shaderModel,
+			dwShaderFlags,
+			ppBlobOut,
+			&pErrorBlob);
+	}
+	else {
+		hr = D3DX11CompileFromFile(fileName.c_str(),
+			macros.data(),
+			nullptr,
+			entryPoint,
+			shaderModel,
+			dwShaderFlags,
+			0,
+			nullptr,
+			ppBlobOut,
+			&pErrorBlob,
+			nullptr);
+	}
 
 	if (FAILED(hr)) {
 		if (pErrorBlob) {
-			ERROR("ShaderProgram", "CompileShaderFromFile",
-				"Failed to compile shader from file: %s. Error: %s",
-				szFileName, static_cast<const char*>(pErrorBlob->GetBufferPointer()));
+			ERROR("ShaderProgram", "CompileShader",
+				"Failed to compile shader from file: " << fileName.c_str() << ". Error: "
+				<< static_cast<const char*>(pErrorBlob->GetBufferPointer()));
 
 			pErrorBlob->Release();
 		}
 		else {
-			ERROR("ShaderProgram", "CompileShaderFromFile",
-				"Failed to compile shader from file: %s. No error message available.",
-				szFileName);
+			ERROR("ShaderProgram", "CompileShader",
+				"Failed to compile shader from file: " << fileName.c_str() << ". No error message available.");
 		}
 		return hr;
 	}
@@ -216,8 +258,8 @@ ShaderProgram::render(DeviceContext& deviceContext) {
 	}
 
 	m_inputLayout.render(deviceContext);
-	deviceContext.m_deviceContext->VSSetShader(m_VertexShader, nullptr, 0);
-	deviceContext.m_deviceContext->PSSetShader(m_PixelShader, nullptr, 0);
+	deviceContext.VSSetShader(m_VertexShader, nullptr, 0);
+	deviceContext.PSSetShader(m_PixelShader, nullptr, 0);
 }
 
 void
@@ -228,10 +270,10 @@ ShaderProgram::render(DeviceContext& deviceContext, ShaderType type) {
 	}
 	switch (type) {
 	case VERTEX_SHADER:
-		deviceContext.m_deviceContext->VSSetShader(m_VertexShader, nullptr, 0);
+		deviceContext.VSSetShader(m_VertexShader, nullptr, 0);
 		break;
 	case PIXEL_SHADER:
-		deviceContext.m_deviceContext->PSSetShader(m_PixelShader, nullptr, 0);
+		deviceContext.PSSetShader(m_PixelShader, nullptr, 0);
 		break;
 	default:
 		break;
@@ -0,0 +1,112 @@
+#include "SkylinePacker.h"
+
+HRESULT
+SkylinePacker::init(unsigned int width, unsigned int height) {
+	if (width == 0 || height == 0) {
+		ERROR("SkylinePacker", "init", "width and height must be greater than 0");
+		return E_INVALIDARG;
+	}
+	destroy();
+	m_width = width;
+	m_height = height;
+	m_skyline.push_back({ 0, 0, width });
+	return S_OK;
+}
+
+void
+SkylinePacker::destroy() {
+	m_skyline.clear();
+	m_width = 0;
+	m_height = 0;
+	m_usedArea = 0;
+}
+
+bool
+SkylinePacker::insert(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y) {
+	if (width == 0 || height == 0 || width > m_width || height > m_height) {
+		return false;
+	}
+
+	size_t bestIndex = m_skyline.size();
+	unsigned int bestTop = 0;
+	unsigned long long bestWaste = 0;
+	unsigned int bestY = 0;
+	for (size_t i = 0; i < m_skyline.size(); ++i) {
+		unsigned int candidateY = 0;
+		unsigned long long waste = 0;
+		if (!fit(i, width, height, candidateY, waste)) {
+			continue;
+		}
+		unsigned int top = candidateY + height;
+		if (bestIndex == m_skyline.size() || top < bestTop || (top == bestTop && waste < bestWaste)) {
+			bestIndex = i;
+			bestTop = top;
+			bestWaste = waste;
+			bestY = candidateY;
+		}
+	}
+	if (bestIndex == m_skyline.size()) {
+		return false;
+	}
+
+	// El rectngulo se vuelve un segmento nuevo; los que quedan debajo se recortan o se quitan
+	x = m_skyline[bestIndex].x;
+	y = bestY;
+	unsigned int right = x + width;
+	m_skyline.insert(m_skyline.begin() + bestIndex, { x, y + height, width });
+	size_t next = bestIndex + 1;
+	while (next < m_skyline.size() && m_skyline[next].x < right) {
+		Segment& segment = m_skyline[next];
+		unsigned int segmentRight = segment.x + segment.width;
+		if (segmentRight <= right) {
+			m_skyline.erase(m_skyline.begin() + next);
+			continue;
+		}
+		segment.width = segmentRight - right;
+		segment.x = right;
+		break;
+	}
+	// Segmentos vecinos a la misma altura se unen para que el contorno no crezca sin lmite
+	for (size_t i = 0; i + 1 < m_skyline.size();) {
+		if (m_skyline[i].y == m_skyline[i + 1].y) {
+			m_skyline[i].width += m_skyline[i + 1].width;
+			m_skyline.erase(m_skyline.begin() + i + 1);
+		}
+		else {
+			++i;
+		}
+	}
+	m_usedArea += static_cast<unsigned long long>(width) * height;
+	return true;
+}
+
+float
+SkylinePacker::occupancy() const {
+	if (m_width == 0 || m_height == 0) {
+		return 0.0f;
+	}
+	return static_cast<float>(static_cast<double>(m_usedArea) / (static_cast<double>(m_width) * m_height));
+}
+
+bool
+SkylinePacker::fit(size_t index, unsigned int width, unsigned int height, unsigned int& y, unsigned long long& waste) const {
+	unsigned int x = m_skyline[index].x;
+	if (x + width > m_width) {
+		return false;
+	}
+	// El rectngulo descansa sobre el segmento ms alto de los que cubre
+	unsigned int right = x + width;
+	y = 0;
+	for (size_t i = index; i < m_skyline.size() && m_skyline[i].x < right; ++i) {
+		y = (std::max)(y, m_skyline[i].y);
+	}
+	if (y + height > m_height) {
+		return false;
+	}
+	waste = 0;
+	for (size_t i = index; i < m_skyline.size() && m_skyline[i].x < right; ++i) {
+		unsigned int covered = (std::min)(right, m_skyline[i].x + m_skyline[i].width) - m_skyline[i].x;
+		waste += static_cast<unsigned long long>(y - m_skyline[i].y) * covered;
+	}
+	return true;
+}
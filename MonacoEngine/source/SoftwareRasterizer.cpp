@@ -0,0 +1,830 @@
+#include "SoftwareRasterizer.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "BlockCompressor.h"
+
+// Lado de un tile de pantalla en pxeles
+static const int kTileSize = 64;
+// Bits de subpxel de las coordenadas en punto fijo
+static const int kSubpixelBits = 4;
+static const long long kSubpixelOne = 1LL << kSubpixelBits;
+// Tringulos que procesa cada bloque de la etapa de vrtices
+static const unsigned int kTrianglesPerChunk = 256;
+// Lmite de las coordenadas de pantalla para que las funciones de arista quepan en 64 bits
+static const float kGuardBand = 4194304.0f;
+
+// Bytes por bloque de 4x4 de los formatos BC que se descomprimen; 0 para el resto
+static unsigned int
+compressedBlockBytes(DXGI_FORMAT format) {
+	switch (format) {
+	case DXGI_FORMAT_BC1_UNORM:
+		return 8;
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC3_UNORM:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Matriz 4x4 con la convencin de HLSL @c mul(vector, matriz): out[c] = sum_r v[r] * m[r][c].
+ */
+struct Matrix4 {
+	float m[4][4];
+};
+
+/**
+ * Lee una matriz de un constant buffer. El demo guarda las matrices transpuestas y HLSL
+ * las lee por columnas, as que el elemento (r, c) est en stored[c * 4 + r].
+ */
+static Matrix4
+loadShaderMatrix(const unsigned char* data) {
+	const float* stored = reinterpret_cast<const float*>(data);
+	Matrix4 result;
+	for (int r = 0; r < 4; ++r) {
+		for (int c = 0; c < 4; ++c) {
+			result.m[r][c] = stored[c * 4 + r];
+		}
+	}
+	return result;
+}
+
+static Matrix4
+multiply(const Matrix4& a, const Matrix4& b) {
+	Matrix4 result;
+	for (int r = 0; r < 4; ++r) {
+		for (int c = 0; c < 4; ++c) {
+			result.m[r][c] = a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c] +
+				a.m[r][2] * b.m[2][c] + a.m[r][3] * b.m[3][c];
+		}
+	}
+	return result;
+}
+
+static Matrix4
+identity() {
+	Matrix4 result = {};
+	result.m[0][0] = result.m[1][1] = result.m[2][2] = result.m[3][3] = 1.0f;
+	return result;
+}
+
+/**
+ * Vrtice en espacio de recorte con sus atributos, usado durante el recorte contra el plano cercano.
+ */
+struct ClipVertex {
+	float pos[4];
+	float u, v;
+};
+
+static ClipVertex
+lerpVertex(const ClipVertex& a, const ClipVertex& b, float t) {
+	ClipVertex result;
+	for (int i = 0; i < 4; ++i) {
+		result.pos[i] = a.pos[i] + (b.pos[i] - a.pos[i]) * t;
+	}
+	result.u = a.u + (b.u - a.u) * t;
+	result.v = a.v + (b.v - a.v) * t;
+	return result;
+}
+
+static unsigned int
+packColor(float r, float g, float b, float a) {
+	auto toByte = [](float value) {
+		value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		return static_cast<unsigned int>(value * 255.0f + 0.5f);
+	};
+	return toByte(r) | (toByte(g) << 8) | (toByte(b) << 16) | (toByte(a) << 24);
+}
+
+HRESULT
+SoftwareRasterizer::init(Device& device,
+	DeviceContext& deviceContext,
+	unsigned int width,
+	unsigned int height,
+	unsigned int numThreads) {
+	if (width == 0 || height == 0) {
+		ERROR("SoftwareRasterizer", "init", "Width and height must be greater than zero");
+		return E_INVALIDARG;
+	}
+	if (m_device) {
+		ERROR("SoftwareRasterizer", "init", "SoftwareRasterizer is already initialized.");
+		return E_FAIL;
+	}
+
+	// El hilo que llama tambin rasteriza, as que el pool tiene un hilo menos
+	if (numThreads == 0) {
+		numThreads = std::thread::hardware_concurrency();
+	}
+	HRESULT hr = S_OK;
+	if (numThreads > 1) {
+		hr = m_threadPool.init(numThreads - 1);
+		if (FAILED(hr)) {
+			return hr;
+		}
+	}
+
+	m_width = width;
+	m_height = height;
+	m_colorBuffer.assign(static_cast<size_t>(width) * height, 0);
+	m_depthBuffer.assign(static_cast<size_t>(width) * height, 1.0f);
+	m_tilesX = (width + kTileSize - 1) / kTileSize;
+	m_tilesY = (height + kTileSize - 1) / kTileSize;
+	m_tileBins.resize(m_tilesX * m_tilesY);
+
+	m_viewport.Width = static_cast<float>(width);
+	m_viewport.Height = static_cast<float>(height);
+	m_viewport.MinDepth = 0.0f;
+	m_viewport.MaxDepth = 1.0f;
+
+	m_device = &device;
+	m_deviceContext = &deviceContext;
+	device.m_softwareRasterizer = this;
+	deviceContext.m_softwareRasterizer = this;
+
+	MESSAGE("SoftwareRasterizer", "init",
+		("Software rasterizer created with " + std::to_string(m_threadPool.size() + 1) + " threads").c_str());
+	return S_OK;
+}
+
+void
+SoftwareRasterizer::destroy() {
+	if (m_device && m_device->m_softwareRasterizer == this) {
+		m_device->m_softwareRasterizer = nullptr;
+	}
+	if (m_deviceContext && m_deviceContext->m_softwareRasterizer == this) {
+		m_deviceContext->m_softwareRasterizer = nullptr;
+	}
+	m_device = nullptr;
+	m_deviceContext = nullptr;
+	m_threadPool.destroy();
+
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	m_resources.clear();
+	m_colorBuffer.clear();
+	m_depthBuffer.clear();
+	m_triangles.clear();
+	m_chunkBins.clear();
+	m_tileBins.clear();
+}
+
+bool
+SoftwareRasterizer::supportsTextureFormat(DXGI_FORMAT format) {
+	return format == DXGI_FORMAT_R8G8B8A8_UNORM || format == DXGI_FORMAT_B8G8R8A8_UNORM ||
+		compressedBlockBytes(format) != 0;
+}
+
+void
+SoftwareRasterizer::registerResource(ID3D11Resource* resource,
+	const void* data,
+	unsigned int size,
+	unsigned int width,
+	unsigned int height,
+	unsigned int rowPitch,
+	DXGI_FORMAT format) {
+	if (!resource) {
+		return;
+	}
+
+	ResourceData entry;
+	entry.width = width;
+	entry.height = height;
+	entry.format = format;
+	entry.sourceFormat = format;
+	entry.bytes.assign(size, 0);
+
+	if (width > 0 && height > 0) {
+		// Las texturas se guardan sin relleno entre filas
+		entry.rowPitch = size / height;
+		if (compressedBlockBytes(format) != 0) {
+			// El rasterizador solo muestrea RGBA8: los bloques se descomprimen una vez aqu
+			entry.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			if (data) {
+				writeBlocks(entry, 0, 0, width, height, static_cast<const unsigned char*>(data), rowPitch);
+			}
+		}
+		else if (data) {
+			const unsigned char* source = static_cast<const unsigned char*>(data);
+			unsigned int sourcePitch = rowPitch ? rowPitch : entry.rowPitch;
+			for (unsigned int y = 0; y < height; ++y) {
+				memcpy(&entry.bytes[y * entry.rowPitch], source + y * sourcePitch, entry.rowPitch);
+			}
+		}
+	}
+	else if (data) {
+		memcpy(entry.bytes.data(), data, size);
+	}
+
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	m_resources[resource] = std::move(entry);
+}
+
+void
+SoftwareRasterizer::updateResource(ID3D11Resource* resource,
+	const D3D11_BOX* pDstBox,
+	const void* pSrcData,
+	unsigned int SrcRowPitch) {
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	auto it = m_resources.find(resource);
+	if (it == m_resources.end() || !pSrcData) {
+		return;
+	}
+
+	ResourceData& entry = it->second;
+	const unsigned char* source = static_cast<const unsigned char*>(pSrcData);
+	if (entry.width == 0) {
+		unsigned int left = pDstBox ? pDstBox->left : 0;
+		unsigned int right = pDstBox ? pDstBox->right : static_cast<unsigned int>(entry.bytes.size());
+		right = (std::min)(right, static_cast<unsigned int>(entry.bytes.size()));
+		if (left < right) {
+			memcpy(&entry.bytes[left], source, right - left);
+		}
+		return;
+	}
+
+	if (entry.sourceFormat != entry.format) {
+		// La caja est en texels y los datos son filas de bloques; writeBlocks() recorta
+		unsigned int left = pDstBox ? pDstBox->left : 0;
+		unsigned int top = pDstBox ? pDstBox->top : 0;
+		unsigned int right = pDstBox ? pDstBox->right : entry.width;
+		unsigned int bottom = pDstBox ? pDstBox->bottom : entry.height;
+		if (left < right && top < bottom) {
+			writeBlocks(entry, left, top, right - left, bottom - top, source, SrcRowPitch);
+		}
+		return;
+	}
+
+	unsigned int texelSize = entry.rowPitch / entry.width;
+	unsigned int left = pDstBox ? pDstBox->left : 0;
+	unsigned int top = pDstBox ? pDstBox->top : 0;
+	unsigned int right = (std::min)(pDstBox ? pDstBox->right : entry.width, entry.width);
+	unsigned int bottom = (std::min)(pDstBox ? pDstBox->bottom : entry.height, entry.height);
+	if (left >= right || top >= bottom) {
+		return;
+	}
+	unsigned int sourcePitch = SrcRowPitch ? SrcRowPitch : (right - left) * texelSize;
+	for (unsigned int y = top; y < bottom; ++y) {
+		memcpy(&entry.bytes[y * entry.rowPitch + left * texelSize],
+			source + (y - top) * sourcePitch,
+			(right - left) * texelSize);
+	}
+}
+
+void
+SoftwareRasterizer::setViewport(const D3D11_VIEWPORT& viewport) {
+	m_viewport = viewport;
+}
+
+void
+SoftwareRasterizer::setVertexBuffer(ID3D11Buffer* buffer, unsigned int stride, unsigned int offset) {
+	m_vertexBuffer = buffer;
+	m_vertexStride = stride;
+	m_vertexOffset = offset;
+}
+
+void
+SoftwareRasterizer::setIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, unsigned int offset) {
+	m_indexBuffer = buffer;
+	m_indexFormat = format;
+	m_indexOffset = offset;
+}
+
+void
+SoftwareRasterizer::setVSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer) {
+	if (slot < ARRAYSIZE(m_vsConstantBuffers)) {
+		m_vsConstantBuffers[slot] = buffer;
+	}
+}
+
+void
+SoftwareRasterizer::setPSConstantBuffer(unsigned int slot, ID3D11Buffer* buffer) {
+	if (slot < ARRAYSIZE(m_psConstantBuffers)) {
+		m_psConstantBuffers[slot] = buffer;
+	}
+}
+
+void
+SoftwareRasterizer::setPSShaderResource(unsigned int slot, ID3D11ShaderResourceView* view) {
+	if (slot != 0) {
+		return;
+	}
+	m_psTexture = nullptr;
+	if (view) {
+		// Solo se guarda el puntero como llave del registro; no se conserva la referencia
+		ID3D11Resource* resource = nullptr;
+		view->GetResource(&resource);
+		m_psTexture = resource;
+		SAFE_RELEASE(resource);
+	}
+}
+
+void
+SoftwareRasterizer::clearColor(const float color[4]) {
+	unsigned int packed = packColor(color[0], color[1], color[2], color[3]);
+	std::fill(m_colorBuffer.begin(), m_colorBuffer.end(), packed);
+	m_trianglesDrawn = 0;
+}
+
+void
+SoftwareRasterizer::clearDepth(float depth) {
+	std::fill(m_depthBuffer.begin(), m_depthBuffer.end(), depth);
+}
+
+void
+SoftwareRasterizer::copyBufferRegion(ID3D11Resource* destination,
+	unsigned int destinationOffset,
+	ID3D11Resource* source,
+	unsigned int sourceOffset,
+	unsigned int size) {
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	auto destinationIt = m_resources.find(destination);
+	auto sourceIt = m_resources.find(source);
+	if (destinationIt == m_resources.end() || sourceIt == m_resources.end()) {
+		return;
+	}
+
+	std::vector<unsigned char>& target = destinationIt->second.bytes;
+	const std::vector<unsigned char>& origin = sourceIt->second.bytes;
+	if (static_cast<size_t>(destinationOffset) + size > target.size() ||
+		static_cast<size_t>(sourceOffset) + size > origin.size()) {
+		return;
+	}
+	memmove(&target[destinationOffset], &origin[sourceOffset], size);
+}
+
+void
+SoftwareRasterizer::copyTextureRegion(ID3D11Resource* destination,
+	unsigned int destinationX,
+	unsigned int destinationY,
+	ID3D11Resource* source,
+	unsigned int sourceLevel,
+	const D3D11_BOX* sourceBox) {
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	auto destinationIt = m_resources.find(destination);
+	auto sourceIt = m_resources.find(source);
+	if (destinationIt == m_resources.end() || sourceIt == m_resources.end()) {
+		return;
+	}
+
+	ResourceData& target = destinationIt->second;
+	const ResourceData& origin = sourceIt->second;
+	if (target.width == 0 || origin.width == 0 || target.format != origin.format) {
+		return;
+	}
+
+	const unsigned char* pixels = origin.bytes.data();
+	unsigned int width = origin.width;
+	unsigned int height = origin.height;
+	unsigned int rowPitch = origin.rowPitch;
+	// Solo se guarda el nivel 0; los inferiores se reconstruyen con el filtro de caja
+	std::vector<MipLevel> mips;
+	if (sourceLevel > 0) {
+		if (FAILED(MipGenerator::generate(pixels, width, height, rowPitch, origin.format, MipGenerateOptions(), mips)) ||
+			sourceLevel > mips.size()) {
+			return;
+		}
+		const MipLevel& mip = mips[sourceLevel - 1];
+		pixels = mip.pixels.data();
+		width = mip.width;
+		height = mip.height;
+		rowPitch = mip.rowPitch;
+	}
+
+	unsigned int left = sourceBox ? sourceBox->left : 0;
+	unsigned int top = sourceBox ? sourceBox->top : 0;
+	unsigned int right = (std::min)(sourceBox ? sourceBox->right : width, width);
+	unsigned int bottom = (std::min)(sourceBox ? sourceBox->bottom : height, height);
+	if (left >= right || top >= bottom || destinationX >= target.width || destinationY >= target.height) {
+		return;
+	}
+	unsigned int columns = (std::min)(right - left, target.width - destinationX);
+	unsigned int rows = (std::min)(bottom - top, target.height - destinationY);
+	for (unsigned int y = 0; y < rows; ++y) {
+		memcpy(&target.bytes[(destinationY + y) * target.rowPitch + destinationX * 4],
+			pixels + (top + y) * rowPitch + left * 4,
+			columns * 4);
+	}
+}
+
+void
+SoftwareRasterizer::writeBlocks(ResourceData& entry,
+	unsigned int left,
+	unsigned int top,
+	unsigned int width,
+	unsigned int height,
+	const unsigned char* blocks,
+	unsigned int rowPitch) {
+	// BlockCompressor::decompress() espera las filas de bloques contiguas
+	unsigned int blocksWide = (width + 3) / 4;
+	unsigned int blocksHigh = (height + 3) / 4;
+	unsigned int blockRowBytes = blocksWide * compressedBlockBytes(entry.sourceFormat);
+	std::vector<unsigned char> packed;
+	if (rowPitch != 0 && rowPitch != blockRowBytes) {
+		packed.resize(static_cast<size_t>(blockRowBytes) * blocksHigh);
+		for (unsigned int y = 0; y < blocksHigh; ++y) {
+			memcpy(&packed[static_cast<size_t>(y) * blockRowBytes], blocks + static_cast<size_t>(y) * rowPitch, blockRowBytes);
+		}
+		blocks = packed.data();
+	}
+
+	std::vector<unsigned char> pixels;
+	if (FAILED(BlockCompressor::decompress(blocks, width, height, entry.sourceFormat, pixels))) {
+		return;
+	}
+	if (left >= entry.width || top >= entry.height) {
+		return;
+	}
+	unsigned int columns = (std::min)(width, entry.width - left);
+	unsigned int rows = (std::min)(height, entry.height - top);
+	for (unsigned int y = 0; y < rows; ++y) {
+		memcpy(&entry.bytes[(top + y) * entry.rowPitch + left * 4],
+			&pixels[static_cast<size_t>(y) * width * 4],
+			columns * 4);
+	}
+}
+
+const SoftwareRasterizer::ResourceData*
+SoftwareRasterizer::findResource(ID3D11Resource* resource) const {
+	if (!resource) {
+		return nullptr;
+	}
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	auto it = m_resources.find(resource);
+	return it != m_resources.end() ? &it->second : nullptr;
+}
+
+void
+SoftwareRasterizer::drawIndexed(unsigned int IndexCount,
+	unsigned int StartIndexLocation,
+	int BaseVertexLocation) {
+	if (m_colorBuffer.empty()) {
+		return;
+	}
+	if (m_topology != D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST) {
+		ERROR("SoftwareRasterizer", "drawIndexed", "Only TRIANGLELIST topology is supported");
+		return;
+	}
+	if (m_vertexStride < sizeof(SimpleVertex)) {
+		ERROR("SoftwareRasterizer", "drawIndexed", "Vertex stride is smaller than SimpleVertex");
+		return;
+	}
+
+	const ResourceData* vertices = findResource(m_vertexBuffer);
+	const ResourceData* indices = findResource(m_indexBuffer);
+	if (!vertices || !indices) {
+		ERROR("SoftwareRasterizer", "drawIndexed", "Vertex or index buffer has no CPU copy");
+		return;
+	}
+
+	// Constantes del VS: b0 = View, b1 = Projection, b2 = World + vMeshColor
+	const ResourceData* cbView = findResource(m_vsConstantBuffers[0]);
+	const ResourceData* cbProjection = findResource(m_vsConstantBuffers[1]);
+	const ResourceData* cbFrame = findResource(m_vsConstantBuffers[2]);
+	const ResourceData* cbPixel = findResource(m_psConstantBuffers[2]);
+	if (!cbPixel) {
+		cbPixel = cbFrame;
+	}
+
+	Matrix4 world = (cbFrame && cbFrame->bytes.size() >= 64) ? loadShaderMatrix(cbFrame->bytes.data()) : identity();
+	Matrix4 view = (cbView && cbView->bytes.size() >= 64) ? loadShaderMatrix(cbView->bytes.data()) : identity();
+	Matrix4 projection = (cbProjection && cbProjection->bytes.size() >= 64) ? loadShaderMatrix(cbProjection->bytes.data()) : identity();
+	Matrix4 worldViewProjection = multiply(multiply(world, view), projection);
+
+	XMFLOAT4 meshColor(1.0f, 1.0f, 1.0f, 1.0f);
+	if (cbPixel && cbPixel->bytes.size() >= sizeof(CBChangesEveryFrame)) {
+		memcpy(&meshColor, cbPixel->bytes.data() + 64, sizeof(XMFLOAT4));
+	}
+
+	const ResourceData* texture = findResource(m_psTexture);
+	if (texture && texture->format != DXGI_FORMAT_R8G8B8A8_UNORM &&
+		texture->format != DXGI_FORMAT_B8G8R8A8_UNORM) {
+		texture = nullptr;
+	}
+
+	unsigned int indexSize = (m_indexFormat == DXGI_FORMAT_R32_UINT) ? 4 : 2;
+	unsigned int triangleCount = IndexCount / 3;
+	unsigned int chunkCount = (triangleCount + kTrianglesPerChunk - 1) / kTrianglesPerChunk;
+	unsigned int tileCount = m_tilesX * m_tilesY;
+
+	// Etapa de vrtices y setup: bloques fijos para que el orden no dependa del nmero de hilos
+	std::vector<std::vector<Triangle>> chunkTriangles(chunkCount);
+	if (m_chunkBins.size() < chunkCount) {
+		m_chunkBins.resize(chunkCount);
+	}
+
+	m_threadPool.parallelFor(chunkCount, [&](unsigned int chunk) {
+		std::vector<Triangle>& output = chunkTriangles[chunk];
+		std::vector<std::vector<unsigned int>>& bins = m_chunkBins[chunk];
+		bins.resize(tileCount);
+		for (std::vector<unsigned int>& bin : bins) {
+			bin.clear();
+		}
+
+		unsigned int first = chunk * kTrianglesPerChunk;
+		unsigned int last = (std::min)(first + kTrianglesPerChunk, triangleCount);
+		for (unsigned int tri = first; tri < last; ++tri) {
+			ClipVertex corners[3];
+			bool valid = true;
+			for (unsigned int k = 0; k < 3; ++k) {
+				size_t indexPosition = m_indexOffset + static_cast<size_t>(StartIndexLocation + tri * 3 + k) * indexSize;
+				if (indexPosition + indexSize > indices->bytes.size()) {
+					valid = false;
+					break;
+				}
+				unsigned int index = 0;
+				if (indexSize == 2) {
+					unsigned short shortIndex;
+					memcpy(&shortIndex, &indices->bytes[indexPosition], 2);
+					index = shortIndex;
+				}
+				else {
+					memcpy(&index, &indices->bytes[indexPosition], 4);
+				}
+
+				long long vertexIndex = static_cast<long long>(index) + BaseVertexLocation;
+				size_t vertexPosition = m_vertexOffset + static_cast<size_t>(vertexIndex) * m_vertexStride;
+				if (vertexIndex < 0 || vertexPosition + sizeof(SimpleVertex) > vertices->bytes.size()) {
+					valid = false;
+					break;
+				}
+				SimpleVertex vertex;
+				memcpy(&vertex, &vertices->bytes[vertexPosition], sizeof(SimpleVertex));
+
+				float in[4] = { vertex.Pos.x, vertex.Pos.y, vertex.Pos.z, 1.0f };
+				for (int c = 0; c < 4; ++c) {
+					corners[k].pos[c] = in[0] * worldViewProjection.m[0][c] + in[1] * worldViewProjection.m[1][c] +
+						in[2] * worldViewProjection.m[2][c] + in[3] * worldViewProjection.m[3][c];
+				}
+				corners[k].u = vertex.Tex.x;
+				corners[k].v = vertex.Tex.y;
+			}
+			if (!valid) {
+				continue;
+			}
+
+			// Recorte contra el plano cercano (z >= 0); el resto lo resuelven la banda de guarda y el depth test
+			ClipVertex polygon[4];
+			unsigned int polygonSize = 0;
+			for (unsigned int k = 0; k < 3; ++k) {
+				const ClipVertex& a = corners[k];
+				const ClipVertex& b = corners[(k + 1) % 3];
+				bool insideA = a.pos[2] >= 0.0f;
+				bool insideB = b.pos[2] >= 0.0f;
+				if (insideA) {
+					polygon[polygonSize++] = a;
+				}
+				if (insideA != insideB) {
+					float t = a.pos[2] / (a.pos[2] - b.pos[2]);
+					polygon[polygonSize++] = lerpVertex(a, b, t);
+				}
+			}
+
+			for (unsigned int fan = 1; fan + 1 < polygonSize; ++fan) {
+				const ClipVertex* source[3] = { &polygon[0], &polygon[fan], &polygon[fan + 1] };
+				Triangle triangle;
+				bool visible = true;
+				for (unsigned int k = 0; k < 3; ++k) {
+					float w = source[k]->pos[3];
+					if (w <= 1e-6f) {
+						visible = false;
+						break;
+					}
+					float invW = 1.0f / w;
+					float x = m_viewport.TopLeftX + (source[k]->pos[0] * invW + 1.0f) * 0.5f * m_viewport.Width;
+					float y = m_viewport.TopLeftY + (1.0f - source[k]->pos[1] * invW) * 0.5f * m_viewport.Height;
+					x = (std::max)(-kGuardBand, (std::min)(kGuardBand, x));
+					y = (std::max)(-kGuardBand, (std::min)(kGuardBand, y));
+
+					triangle.x[k] = static_cast<long long>(floorf(x * kSubpixelOne + 0.5f));
+					triangle.y[k] = static_cast<long long>(floorf(y * kSubpixelOne + 0.5f));
+					triangle.z[k] = m_viewport.MinDepth +
+						source[k]->pos[2] * invW * (m_viewport.MaxDepth - m_viewport.MinDepth);
+					triangle.invW[k] = invW;
+					triangle.uOverW[k] = source[k]->u * invW;
+					triangle.vOverW[k] = source[k]->v * invW;
+				}
+				if (!visible) {
+					continue;
+				}
+
+				// Culling de caras traseras: el frente es horario en pantalla (rea positiva con y hacia abajo)
+				long long area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) -
+					(triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+				if (area <= 0) {
+					continue;
+				}
+
+				long long minX = (std::min)({ triangle.x[0], triangle.x[1], triangle.x[2] });
+				long long maxX = (std::max)({ triangle.x[0], triangle.x[1], triangle.x[2] });
+				long long minY = (std::min)({ triangle.y[0], triangle.y[1], triangle.y[2] });
+				long long maxY = (std::max)({ triangle.y[0], triangle.y[1], triangle.y[2] });
+				triangle.minX = static_cast<int>((std::max)(0LL, minX >> kSubpixelBits));
+				triangle.minY = static_cast<int>((std::max)(0LL, minY >> kSubpixelBits));
+				triangle.maxX = static_cast<int>((std::min)(static_cast<long long>(m_width) - 1, maxX >> kSubpixelBits));
+				triangle.maxY = static_cast<int>((std::min)(static_cast<long long>(m_height) - 1, maxY >> kSubpixelBits));
+				if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+					continue;
+				}
+
+				unsigned int localIndex = static_cast<unsigned int>(output.size());
+				output.push_back(triangle);
+				for (int ty = triangle.minY / kTileSize; ty <= triangle.maxY / kTileSize; ++ty) {
+					for (int tx = triangle.minX / kTileSize; tx <= triangle.maxX / kTileSize; ++tx) {
+						bins[ty * m_tilesX + tx].push_back(localIndex);
+					}
+				}
+			}
+		}
+	});
+
+	// Unir los bins de cada bloque en orden de envo
+	m_triangles.clear();
+	for (std::vector<unsigned int>& bin : m_tileBins) {
+		bin.clear();
+	}
+	for (unsigned int chunk = 0; chunk < chunkCount; ++chunk) {
+		unsigned int base = static_cast<unsigned int>(m_triangles.size());
+		m_triangles.insert(m_triangles.end(), chunkTriangles[chunk].begin(), chunkTriangles[chunk].end());
+		for (unsigned int tile = 0; tile < tileCount; ++tile) {
+			for (unsigned int localIndex : m_chunkBins[chunk][tile]) {
+				m_tileBins[tile].push_back(base + localIndex);
+			}
+		}
+	}
+	if (m_triangles.empty()) {
+		return;
+	}
+	m_trianglesDrawn += m_triangles.size();
+
+	// Cada tile es independiente: ningn pxel se escribe desde dos hilos
+	m_threadPool.parallelFor(tileCount, [&](unsigned int tile) {
+		rasterizeTile(tile, texture, meshColor);
+	});
+}
+
+/**
+ * Muestreo bilineal con direccionamiento wrap (equivalente a @c samLinear del demo).
+ */
+static void
+sampleBilinear(const unsigned char* texels,
+	unsigned int width,
+	unsigned int height,
+	bool bgra,
+	float u,
+	float v,
+	float out[4]) {
+	float x = u * width - 0.5f;
+	float y = v * height - 0.5f;
+	float fx = floorf(x);
+	float fy = floorf(y);
+	float wx = x - fx;
+	float wy = y - fy;
+
+	auto wrap = [](long long coord, unsigned int size) {
+		long long result = coord % static_cast<long long>(size);
+		return static_cast<unsigned int>(result < 0 ? result + size : result);
+	};
+	unsigned int x0 = wrap(static_cast<long long>(fx), width);
+	unsigned int x1 = wrap(static_cast<long long>(fx) + 1, width);
+	unsigned int y0 = wrap(static_cast<long long>(fy), height);
+	unsigned int y1 = wrap(static_cast<long long>(fy) + 1, height);
+
+	const unsigned char* p00 = texels + (static_cast<size_t>(y0) * width + x0) * 4;
+	const unsigned char* p10 = texels + (static_cast<size_t>(y0) * width + x1) * 4;
+	const unsigned char* p01 = texels + (static_cast<size_t>(y1) * width + x0) * 4;
+	const unsigned char* p11 = texels + (static_cast<size_t>(y1) * width + x1) * 4;
+	for (int c = 0; c < 4; ++c) {
+		float top = p00[c] + (p10[c] - p00[c]) * wx;
+		float bottom = p01[c] + (p11[c] - p01[c]) * wx;
+		out[c] = (top + (bottom - top) * wy) * (1.0f / 255.0f);
+	}
+	if (bgra) {
+		std::swap(out[0], out[2]);
+	}
+}
+
+void
+SoftwareRasterizer::rasterizeTile(unsigned int tileIndex,
+	const ResourceData* texture,
+	const XMFLOAT4& meshColor) {
+	const std::vector<unsigned int>& bin = m_tileBins[tileIndex];
+	if (bin.empty()) {
+		return;
+	}
+
+	int tileMinX = static_cast<int>(tileIndex % m_tilesX) * kTileSize;
+	int tileMinY = static_cast<int>(tileIndex / m_tilesX) * kTileSize;
+	int tileMaxX = (std::min)(tileMinX + kTileSize, static_cast<int>(m_width)) - 1;
+	int tileMaxY = (std::min)(tileMinY + kTileSize, static_cast<int>(m_height)) - 1;
+	bool bgra = texture && texture->format == DXGI_FORMAT_B8G8R8A8_UNORM;
+
+	for (unsigned int triangleIndex : bin) {
+		const Triangle& t = m_triangles[triangleIndex];
+		int minX = (std::max)(t.minX, tileMinX);
+		int maxX = (std::min)(t.maxX, tileMaxX);
+		int minY = (std::max)(t.minY, tileMinY);
+		int maxY = (std::min)(t.maxY, tileMaxY);
+		if (minX > maxX || minY > maxY) {
+			continue;
+		}
+
+		// Funciones de arista E(p) = A*x + B*y + C para v0->v1, v1->v2 y v2->v0
+		long long A[3], B[3], C[3], bias[3];
+		for (int e = 0; e < 3; ++e) {
+			int a = e;
+			int b = (e + 1) % 3;
+			A[e] = t.y[a] - t.y[b];
+			B[e] = t.x[b] - t.x[a];
+			C[e] = t.x[a] * t.y[b] - t.y[a] * t.x[b];
+			// Regla top-left: las aristas superiores o izquierdas incluyen los pxeles sobre ellas
+			bool topEdge = (t.y[b] == t.y[a]) && (t.x[b] > t.x[a]);
+			bool leftEdge = t.y[b] < t.y[a];
+			bias[e] = (topEdge || leftEdge) ? 0 : -1;
+		}
+		float invArea = 1.0f / static_cast<float>(C[0] + C[1] + C[2]);
+
+		long long startX = (static_cast<long long>(minX) << kSubpixelBits) + kSubpixelOne / 2;
+		long long startY = (static_cast<long long>(minY) << kSubpixelBits) + kSubpixelOne / 2;
+		long long row[3];
+		for (int e = 0; e < 3; ++e) {
+			row[e] = A[e] * startX + B[e] * startY + C[e] + bias[e];
+		}
+
+		for (int y = minY; y <= maxY; ++y) {
+			long long edge[3] = { row[0], row[1], row[2] };
+			for (int x = minX; x <= maxX; ++x) {
+				if ((edge[0] | edge[1] | edge[2]) >= 0) {
+					// Pesos baricntricos: cada arista pesa el vrtice opuesto
+					float w0 = static_cast<float>(edge[1] - bias[1]) * invArea;
+					float w1 = static_cast<float>(edge[2] - bias[2]) * invArea;
+					float w2 = 1.0f - w0 - w1;
+
+					size_t pixel = static_cast<size_t>(y) * m_width + x;
+					float depth = w0 * t.z[0] + w1 * t.z[1] + w2 * t.z[2];
+					if (depth >= 0.0f && depth < m_depthBuffer[pixel]) {
+						m_depthBuffer[pixel] = depth;
+
+						float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+						if (texture) {
+							float invW = w0 * t.invW[0] + w1 * t.invW[1] + w2 * t.invW[2];
+							float u = (w0 * t.uOverW[0] + w1 * t.uOverW[1] + w2 * t.uOverW[2]) / invW;
+							float v = (w0 * t.vOverW[0] + w1 * t.vOverW[1] + w2 * t.vOverW[2]) / invW;
+							sampleBilinear(texture->bytes.data(), texture->width, texture->height, bgra, u, v, color);
+						}
+						m_colorBuffer[pixel] = packColor(color[0] * meshColor.x,
+							color[1] * meshColor.y,
+							color[2] * meshColor.z,
+							color[3] * meshColor.w);
+					}
+				}
+				edge[0] += A[0] * kSubpixelOne;
+				edge[1] += A[1] * kSubpixelOne;
+				edge[2] += A[2] * kSubpixelOne;
+			}
+			row[0] += B[0] * kSubpixelOne;
+			row[1] += B[1] * kSubpixelOne;
+			row[2] += B[2] * kSubpixelOne;
+		}
+	}
+}
+
+HRESULT
+SoftwareRasterizer::saveToFile(const std::string& fileName) const {
+	if (m_colorBuffer.empty()) {
+		ERROR("SoftwareRasterizer", "saveToFile", "Color buffer is empty");
+		return E_FAIL;
+	}
+
+	FILE* file = fopen(fileName.c_str(), "wb");
+	if (!file) {
+		ERROR("SoftwareRasterizer", "saveToFile", ("Failed to open " + fileName).c_str());
+		return E_FAIL;
+	}
+
+	// Encabezado TGA sin compresin, 32 bpp, origen arriba a la izquierda
+	unsigned char header[18] = {};
+	header[2] = 2;
+	header[12] = static_cast<unsigned char>(m_width & 0xFF);
+	header[13] = static_cast<unsigned char>(m_width >> 8);
+	header[14] = static_cast<unsigned char>(m_height & 0xFF);
+	header[15] = static_cast<unsigned char>(m_height >> 8);
+	header[16] = 32;
+	header[17] = 0x28;
+	fwrite(header, 1, sizeof(header), file);
+
+	std::vector<unsigned char> row(static_cast<size_t>(m_width) * 4);
+	for (unsigned int y = 0; y < m_height; ++y) {
+		for (unsigned int x = 0; x < m_width; ++x) {
+			unsigned int color = m_colorBuffer[static_cast<size_t>(y) * m_width + x];
+			row[x * 4 + 0] = static_cast<unsigned char>((color >> 16) & 0xFF);
+			row[x * 4 + 1] = static_cast<unsigned char>((color >> 8) & 0xFF);
+			row[x * 4 + 2] = static_cast<unsigned char>(color & 0xFF);
+			row[x * 4 + 3] = static_cast<unsigned char>(color >> 24);
+		}
+		fwrite(row.data(), 1, row.size(), file);
+	}
+	fclose(file);
+
+	MESSAGE("SoftwareRasterizer", "saveToFile", ("Frame saved to " + fileName).c_str());
+	return S_OK;
+}
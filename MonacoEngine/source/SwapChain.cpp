@@ -8,7 +8,8 @@ HRESULT
 SwapChain::init(Device& device,
     DeviceContext& deviceContext,
     Texture& backBuffer,
-    Window window) {
+    Window window,
+    unsigned int bufferCount) {
     // Check if Window is valid
     if (!window.m_hWnd) {
         ERROR("SwapChain", "init", "Invalid window handle. (m_hWnd is nullptr)");
@@ -77,7 +78,7 @@ SwapChain::init(Device& device,
     // Config the swap chain description
     DXGI_SWAP_CHAIN_DESC sd;
     memset(&sd, 0, sizeof(sd));
-    sd.BufferCount = 1;
+    sd.BufferCount = bufferCount;
     sd.BufferDesc.Width = window.m_width;
     sd.BufferDesc.Height = window.m_height;
     sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -150,10 +151,33 @@ SwapChain::destroy() {
     }
 }
 
+HRESULT
+SwapChain::setMaximumFrameLatency(unsigned int framesInFlight) {
+    if (!m_dxgiDevice) {
+        ERROR("SwapChain", "setMaximumFrameLatency", "Swap chain is not initialized.");
+        return E_POINTER;
+    }
+
+    IDXGIDevice1* dxgiDevice1 = nullptr;
+    HRESULT hr = m_dxgiDevice->QueryInterface(__uuidof(IDXGIDevice1), reinterpret_cast<void**>(&dxgiDevice1));
+    if (FAILED(hr)) {
+        ERROR("SwapChain", "setMaximumFrameLatency",
+            ("Failed to query IDXGIDevice1. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+    hr = dxgiDevice1->SetMaximumFrameLatency(framesInFlight);
+    SAFE_RELEASE(dxgiDevice1);
+    if (FAILED(hr)) {
+        ERROR("SwapChain", "setMaximumFrameLatency",
+            ("Failed to set maximum frame latency. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
 void
-SwapChain::present() {
+SwapChain::present(unsigned int syncInterval, unsigned int flags) {
     if (m_swapChain) {
-        HRESULT hr = m_swapChain->Present(0, 0);
+        HRESULT hr = m_swapChain->Present(syncInterval, flags);
         if (FAILED(hr)) {
             ERROR("SwapChain", "present",
                 ("Failed to present swap chain. HRESULT: " + std::to_string(hr)).c_str());
@@ -1,12 +1,185 @@
 #include "Texture.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "DDSLoader.h"
+#include "MappedFile.h"
+#include "MipGenerator.h"
+#include "ImageDecoder.h"
+#include "UploadManager.h"
 
 HRESULT
 Texture::init(Device& device,
     const std::string& textureName,
     ExtensionType extensionType) {
-    return E_NOTIMPL;
+    if (!device.m_device) {
+        ERROR("Texture", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (textureName.empty()) {
+        ERROR("Texture", "init", "Texture name is empty.");
+        return E_INVALIDARG;
+    }
+    if (extensionType == PNG || extensionType == JPG) {
+        ImageDecodeOptions options;
+        options.generateMips = true;
+        DecodedImage decoded;
+        HRESULT hr = ImageDecoder::decode(textureName, options, decoded);
+        if (FAILED(hr)) {
+            return hr;
+        }
+        return init(device, decoded);
+    }
+    if (extensionType != DDS) {
+        ERROR("Texture", "init", ("Unsupported image type for " + textureName).c_str());
+        return E_NOTIMPL;
+    }
+
+    // Los datos iniciales apuntan a la vista del archivo: no hay copias intermedias en CPU
+    MappedFile file;
+    HRESULT hr = file.init(textureName);
+    if (FAILED(hr)) {
+        return hr;
+    }
+    DDSImage image;
+    hr = DDSLoader::parse(file.data(), file.size(), image);
+    if (FAILED(hr)) {
+        ERROR("Texture", "init", ("Invalid DDS file " + textureName).c_str());
+        return hr;
+    }
+    if (image.dimension != D3D11_RESOURCE_DIMENSION_TEXTURE2D) {
+        ERROR("Texture", "init", ("Only 2D and cube DDS textures are supported: " + textureName).c_str());
+        return E_NOTIMPL;
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.Width = image.width;
+    desc.Height = image.height;
+    desc.MipLevels = image.mipLevels;
+    desc.ArraySize = image.arraySize;
+    desc.Format = image.format;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.MiscFlags = image.cubeMap ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+
+    std::vector<D3D11_SUBRESOURCE_DATA> initialData(image.subresources.size());
+    for (size_t i = 0; i < image.subresources.size(); ++i) {
+        initialData[i].pSysMem = image.subresources[i].data;
+        initialData[i].SysMemPitch = image.subresources[i].rowPitch;
+        initialData[i].SysMemSlicePitch = image.subresources[i].slicePitch;
+    }
+    hr = device.CreateTexture2D(&desc, initialData.data(), &m_texture);
+    if (FAILED(hr)) {
+        ERROR("Texture", "init",
+            ("Failed to create texture from " + textureName + ". HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = image.format;
+    if (image.cubeMap && image.arraySize > 6) {
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+        srvDesc.TextureCubeArray.MipLevels = image.mipLevels;
+        srvDesc.TextureCubeArray.NumCubes = image.arraySize / 6;
+    }
+    else if (image.cubeMap) {
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+        srvDesc.TextureCube.MipLevels = image.mipLevels;
+    }
+    else if (image.arraySize > 1) {
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        srvDesc.Texture2DArray.MipLevels = image.mipLevels;
+        srvDesc.Texture2DArray.ArraySize = image.arraySize;
+    }
+    else {
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MipLevels = image.mipLevels;
+    }
+    hr = device.CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
+    if (FAILED(hr)) {
+        ERROR("Texture", "init",
+            ("Failed to create shader resource view for " + textureName + ". HRESULT: " + std::to_string(hr)).c_str());
+        SAFE_RELEASE(m_texture);
+        return hr;
+    }
+    m_textureName = textureName;
+    return S_OK;
+}
+
+HRESULT
+Texture::init(Device& device,
+    DecodedImage& image,
+    UploadManager* uploadManager,
+    std::function<void(unsigned int)> onUploaded) {
+    if (!device.m_device) {
+        ERROR("Texture", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (FAILED(image.result) || image.pixels.empty() ||
+        image.pixels.size() != static_cast<size_t>(image.rowPitch) * image.height) {
+        ERROR("Texture", "init", ("Image has no pixels: " + image.fileName).c_str());
+        return E_INVALIDARG;
+    }
+
+    unsigned int mipLevels = 1 + static_cast<unsigned int>(image.mips.size());
+    D3D11_TEXTURE2D_DESC desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.Width = image.width;
+    desc.Height = image.height;
+    desc.MipLevels = mipLevels;
+    desc.ArraySize = 1;
+    desc.Format = image.format;
+    desc.SampleDesc.Count = 1;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    // Sin UploadManager los pxeles se pasan como datos iniciales; con l, la textura se crea
+    // vaca y los pxeles se mueven a la cola para subirse por bandas en los siguientes frames
+    std::vector<D3D11_SUBRESOURCE_DATA> initialData(mipLevels);
+    initialData[0].pSysMem = image.pixels.data();
+    initialData[0].SysMemPitch = image.rowPitch;
+    for (unsigned int level = 1; level < mipLevels; ++level) {
+        initialData[level].pSysMem = image.mips[level - 1].pixels.data();
+        initialData[level].SysMemPitch = image.mips[level - 1].rowPitch;
+    }
+    desc.Usage = uploadManager ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
+    HRESULT hr = device.CreateTexture2D(&desc, uploadManager ? nullptr : initialData.data(), &m_texture);
+    if (FAILED(hr)) {
+        ERROR("Texture", "init",
+            ("Failed to create texture from " + image.fileName + ". HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = image.format;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = mipLevels;
+    hr = device.CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
+    if (FAILED(hr)) {
+        ERROR("Texture", "init",
+            ("Failed to create shader resource view for " + image.fileName + ". HRESULT: " + std::to_string(hr)).c_str());
+        SAFE_RELEASE(m_texture);
+        return hr;
+    }
+
+    if (uploadManager) {
+        // Un subrecurso por nivel; la cola los completa en orden, as que el callback va en el ltimo
+        for (unsigned int level = 0; level < mipLevels; ++level) {
+            std::vector<unsigned char>& pixels = level == 0 ? image.pixels : image.mips[level - 1].pixels;
+            unsigned int width = level == 0 ? image.width : image.mips[level - 1].width;
+            unsigned int height = level == 0 ? image.height : image.mips[level - 1].height;
+            unsigned int rowPitch = level == 0 ? image.rowPitch : image.mips[level - 1].rowPitch;
+            D3D11_BOX box = { 0, 0, 0, width, height, 1 };
+            unsigned int ticket = uploadManager->uploadTexture(m_texture, level, box, std::move(pixels),
+                rowPitch, level + 1 == mipLevels ? onUploaded : nullptr);
+            if (ticket == 0) {
+                destroy();
+                return E_FAIL;
+            }
+        }
+    }
+    m_textureName = image.fileName;
+    return S_OK;
 }
 
 HRESULT
@@ -62,14 +235,16 @@ Texture::init(Device& device, Texture& textureRef, DXGI_FORMAT format) {
         ERROR("Texture", "init", "Texture is null.");
         return E_POINTER;
     }
-    // Create Shader Resource View
+    // Create Shader Resource View; la vista cubre todos los mips de la textura
+    D3D11_TEXTURE2D_DESC textureDesc;
+    textureRef.m_texture->GetDesc(&textureDesc);
     D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
     srvDesc.Format = format;
     srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Texture2D.MipLevels = 1;
+    srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
     srvDesc.Texture2D.MostDetailedMip = 0;
 
-    HRESULT hr = device.m_device->CreateShaderResourceView(textureRef.m_texture,
+    HRESULT hr = device.CreateShaderResourceView(textureRef.m_texture,
         &srvDesc,
         &m_textureFromImg);
 
@@ -103,10 +278,7 @@ Texture::render(DeviceContext& deviceContext,
 
 void
 Texture::destroy() {
-    if (m_texture != nullptr) {
-        SAFE_RELEASE(m_texture);
-    }
-    else if (m_textureFromImg != nullptr) {
-        SAFE_RELEASE(m_textureFromImg);
-    }
+    // Una textura cargada de archivo tiene ambos
+    SAFE_RELEASE(m_textureFromImg);
+    SAFE_RELEASE(m_texture);
 }
\ No newline at end of file
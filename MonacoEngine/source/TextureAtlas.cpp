@@ -0,0 +1,232 @@
+#include "TextureAtlas.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "UploadManager.h"
+#include "MeshComponent.h"
+
+HRESULT
+TextureAtlas::init(Device& device, const TextureAtlasDesc& desc, UploadManager* uploadManager) {
+	if (!device.m_device) {
+		ERROR("TextureAtlas", "init", "Device is null.");
+		return E_POINTER;
+	}
+	if (desc.pageSize == 0 || (desc.pageSize & (desc.pageSize - 1)) != 0) {
+		ERROR("TextureAtlas", "init", "pageSize must be a power of two");
+		return E_INVALIDARG;
+	}
+	if (desc.mipLevels == 0 || desc.mipLevels > MipGenerator::mipCount(desc.pageSize, desc.pageSize)) {
+		ERROR("TextureAtlas", "init", "mipLevels must be between 1 and the page's full chain");
+		return E_INVALIDARG;
+	}
+	bool rgba = desc.format == DXGI_FORMAT_R8G8B8A8_UNORM || desc.format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	bool bgra = desc.format == DXGI_FORMAT_B8G8R8A8_UNORM || desc.format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+	if (!rgba && !bgra) {
+		ERROR("TextureAtlas", "init", "Only RGBA8 and BGRA8 atlas formats are supported");
+		return E_INVALIDARG;
+	}
+	destroy();
+	m_device = &device;
+	m_uploadManager = uploadManager;
+	m_desc = desc;
+	m_desc.mipOptions.wrap = false;
+	m_alignment = 1u << (desc.mipLevels - 1);
+	return S_OK;
+}
+
+void
+TextureAtlas::update(DeviceContext& deviceContext) {
+	for (const PendingTile& tile : m_pending) {
+		deviceContext.UpdateSubresource(m_pages[tile.page].texture, tile.level, &tile.box, tile.pixels.data(),
+			tile.rowPitch, 0);
+	}
+	m_pending.clear();
+}
+
+void
+TextureAtlas::render(DeviceContext& deviceContext, unsigned int page, unsigned int slot) {
+	if (page >= m_pages.size()) {
+		ERROR("TextureAtlas", "render", ("Page " + std::to_string(page) + " does not exist").c_str());
+		return;
+	}
+	deviceContext.PSSetShaderResources(slot, 1, &m_pages[page].view);
+}
+
+void
+TextureAtlas::destroy() {
+	for (Page& page : m_pages) {
+		SAFE_RELEASE(page.view);
+		SAFE_RELEASE(page.texture);
+	}
+	m_pages.clear();
+	m_regions.clear();
+	m_pending.clear();
+	m_device = nullptr;
+	m_uploadManager = nullptr;
+	m_alignment = 0;
+	m_stats = TextureAtlasStats();
+}
+
+unsigned int
+TextureAtlas::add(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int rowPitch) {
+	if (!m_device) {
+		ERROR("TextureAtlas", "add", "TextureAtlas is not initialized.");
+		return kInvalidHandle;
+	}
+	if (!pixels || width == 0 || height == 0 || rowPitch < width * 4) {
+		ERROR("TextureAtlas", "add", "Invalid image");
+		return kInvalidHandle;
+	}
+	// Borde repetido alrededor y tamao redondeado a la alineacin: cada nivel usa texels enteros
+	unsigned int padding = m_desc.padding;
+	unsigned int tileWidth = (width + 2 * padding + m_alignment - 1) / m_alignment * m_alignment;
+	unsigned int tileHeight = (height + 2 * padding + m_alignment - 1) / m_alignment * m_alignment;
+	if (tileWidth > m_desc.pageSize || tileHeight > m_desc.pageSize) {
+		m_stats.rejected++;
+		ERROR("TextureAtlas", "add",
+			("A " + std::to_string(width) + "x" + std::to_string(height) + " image does not fit in an atlas page").c_str());
+		return kInvalidHandle;
+	}
+
+	unsigned int page = 0;
+	unsigned int column = 0;
+	unsigned int row = 0;
+	while (page < m_pages.size() &&
+		!m_pages[page].packer.insert(tileWidth / m_alignment, tileHeight / m_alignment, column, row)) {
+		page++;
+	}
+	if (page == m_pages.size()) {
+		if (FAILED(addPage())) {
+			return kInvalidHandle;
+		}
+		m_pages[page].packer.insert(tileWidth / m_alignment, tileHeight / m_alignment, column, row);
+	}
+	unsigned int tileX = column * m_alignment;
+	unsigned int tileY = row * m_alignment;
+
+	std::vector<unsigned char> tile(static_cast<size_t>(tileWidth) * tileHeight * 4);
+	for (unsigned int y = 0; y < tileHeight; ++y) {
+		unsigned int sourceY = y < padding ? 0 : (std::min)(y - padding, height - 1);
+		const unsigned char* source = pixels + static_cast<size_t>(sourceY) * rowPitch;
+		unsigned char* destination = tile.data() + static_cast<size_t>(y) * tileWidth * 4;
+		for (unsigned int x = 0; x < padding; ++x) {
+			memcpy(destination + x * 4, source, 4);
+		}
+		memcpy(destination + padding * 4, source, static_cast<size_t>(width) * 4);
+		for (unsigned int x = padding + width; x < tileWidth; ++x) {
+			memcpy(destination + x * 4, source + (width - 1) * 4, 4);
+		}
+	}
+	std::vector<MipLevel> mips;
+	if (m_desc.mipLevels > 1) {
+		HRESULT hr = MipGenerator::generate(tile.data(), tileWidth, tileHeight, tileWidth * 4, m_desc.format,
+			m_desc.mipOptions, mips);
+		if (FAILED(hr)) {
+			return kInvalidHandle;
+		}
+	}
+
+	for (unsigned int level = 0; level < m_desc.mipLevels; ++level) {
+		PendingTile pending;
+		pending.page = page;
+		pending.level = level;
+		pending.box = { tileX >> level, tileY >> level, 0, (tileX + tileWidth) >> level, (tileY + tileHeight) >> level, 1 };
+		pending.rowPitch = level == 0 ? tileWidth * 4 : mips[level - 1].rowPitch;
+		pending.pixels = level == 0 ? std::move(tile) : std::move(mips[level - 1].pixels);
+		m_stats.uploadedBytes += pending.pixels.size();
+		if (m_uploadManager) {
+			m_uploadManager->uploadTexture(m_pages[page].texture, level, pending.box, std::move(pending.pixels),
+				pending.rowPitch);
+		}
+		else {
+			m_pending.push_back(std::move(pending));
+		}
+	}
+
+	AtlasRegion region;
+	region.page = page;
+	region.x = tileX + padding;
+	region.y = tileY + padding;
+	region.width = width;
+	region.height = height;
+	float pageSize = static_cast<float>(m_desc.pageSize);
+	region.uvTransform = XMFLOAT4(width / pageSize, height / pageSize, region.x / pageSize, region.y / pageSize);
+	m_regions.push_back(region);
+	m_stats.entries++;
+	return static_cast<unsigned int>(m_regions.size());
+}
+
+const AtlasRegion*
+TextureAtlas::region(unsigned int handle) const {
+	if (handle == kInvalidHandle || handle > m_regions.size()) {
+		return nullptr;
+	}
+	return &m_regions[handle - 1];
+}
+
+HRESULT
+TextureAtlas::remapUVs(MeshComponent& mesh, unsigned int handle) const {
+	const AtlasRegion* atlasRegion = region(handle);
+	if (!atlasRegion) {
+		ERROR("TextureAtlas", "remapUVs", ("Invalid region handle " + std::to_string(handle)).c_str());
+		return E_INVALIDARG;
+	}
+	const XMFLOAT4& transform = atlasRegion->uvTransform;
+	for (SimpleVertex& vertex : mesh.m_vertex) {
+		vertex.Tex.x = vertex.Tex.x * transform.x + transform.z;
+		vertex.Tex.y = vertex.Tex.y * transform.y + transform.w;
+	}
+	return S_OK;
+}
+
+ID3D11ShaderResourceView*
+TextureAtlas::view(unsigned int page) const {
+	return page < m_pages.size() ? m_pages[page].view : nullptr;
+}
+
+std::string
+TextureAtlas::report() const {
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+	os << "Texture atlas: " << m_regions.size() << " regions on " << m_pages.size() << " pages of " << m_desc.pageSize
+		<< "x" << m_desc.pageSize << " (";
+	for (size_t i = 0; i < m_pages.size(); ++i) {
+		os << (i > 0 ? ", " : "") << (m_pages[i].packer.occupancy() * 100.0f) << "%";
+	}
+	os << " used), " << m_stats.rejected << " rejected, " << (m_stats.uploadedBytes / 1048576.0) << " MB uploaded\n";
+	return os.str();
+}
+
+HRESULT
+TextureAtlas::addPage() {
+	D3D11_TEXTURE2D_DESC desc;
+	memset(&desc, 0, sizeof(desc));
+	desc.Width = m_desc.pageSize;
+	desc.Height = m_desc.pageSize;
+	desc.MipLevels = m_desc.mipLevels;
+	desc.ArraySize = 1;
+	desc.Format = m_desc.format;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	Page page;
+	HRESULT hr = m_device->CreateTexture2D(&desc, nullptr, &page.texture);
+	if (FAILED(hr)) {
+		ERROR("TextureAtlas", "addPage", ("Failed to create atlas page. HRESULT: " + std::to_string(hr)).c_str());
+		return hr;
+	}
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = m_desc.format;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MipLevels = m_desc.mipLevels;
+	hr = m_device->CreateShaderResourceView(page.texture, &srvDesc, &page.view);
+	if (FAILED(hr)) {
+		ERROR("TextureAtlas", "addPage",
+			("Failed to create shader resource view for atlas page. HRESULT: " + std::to_string(hr)).c_str());
+		SAFE_RELEASE(page.texture);
+		return hr;
+	}
+	page.packer.init(m_desc.pageSize / m_alignment, m_desc.pageSize / m_alignment);
+	m_pages.push_back(page);
+	return S_OK;
+}
@@ -0,0 +1,257 @@
+#include "TextureResidency.h"
+
+HRESULT
+TextureResidency::init(unsigned long long budget, unsigned int maxLoadsInFlight) {
+	if (budget == 0 || maxLoadsInFlight == 0) {
+		ERROR("TextureResidency", "init", "budget and maxLoadsInFlight must be greater than 0");
+		return E_INVALIDARG;
+	}
+	destroy();
+	m_budget = budget;
+	m_maxLoadsInFlight = maxLoadsInFlight;
+	return S_OK;
+}
+
+void
+TextureResidency::destroy() {
+	m_entries.clear();
+	m_budget = 0;
+	m_residentBytes = 0;
+	m_frame = 1;
+	m_maxLoadsInFlight = 0;
+	m_loadsInFlight = 0;
+	m_stats = TextureResidencyStats();
+}
+
+unsigned int
+TextureResidency::add(unsigned int width,
+	unsigned int height,
+	const std::vector<unsigned long long>& levelBytes,
+	unsigned int tailMip) {
+	if (m_budget == 0) {
+		ERROR("TextureResidency", "add", "TextureResidency is not initialized.");
+		return kInvalidHandle;
+	}
+	if (width == 0 || height == 0 || levelBytes.empty() || tailMip >= levelBytes.size()) {
+		ERROR("TextureResidency", "add", "Invalid texture size, mip levels or tail mip");
+		return kInvalidHandle;
+	}
+	Entry entry;
+	entry.width = width;
+	entry.height = height;
+	entry.tailMip = tailMip;
+	entry.residentMip = tailMip;
+	entry.loadingMip = tailMip;
+	entry.requestedMip = tailMip;
+	entry.screenSize = 0.0f;
+	entry.lastUsedFrame = 0;
+	entry.bytesFrom.assign(levelBytes.size() + 1, 0);
+	for (size_t mip = levelBytes.size(); mip-- > 0;) {
+		entry.bytesFrom[mip] = entry.bytesFrom[mip + 1] + levelBytes[mip];
+	}
+	m_residentBytes += entry.bytesFrom[tailMip];
+	m_entries.push_back(std::move(entry));
+	return static_cast<unsigned int>(m_entries.size());
+}
+
+void
+TextureResidency::request(unsigned int handle, float screenSize) {
+	if (handle == kInvalidHandle || handle > m_entries.size()) {
+		return;
+	}
+	Entry& entry = m_entries[handle - 1];
+	unsigned int mipLevels = static_cast<unsigned int>(entry.bytesFrom.size()) - 1;
+	unsigned int mip = (std::min)(mipForScreenSize(entry.width, entry.height, mipLevels, screenSize), entry.tailMip);
+	if (entry.lastUsedFrame != m_frame) {
+		entry.requestedMip = mip;
+		entry.screenSize = screenSize;
+		entry.lastUsedFrame = m_frame;
+	}
+	else {
+		entry.requestedMip = (std::min)(entry.requestedMip, mip);
+		entry.screenSize = (std::max)(entry.screenSize, screenSize);
+	}
+}
+
+void
+TextureResidency::schedule(std::vector<TextureResidencyChange>& loads,
+	std::vector<TextureResidencyChange>& evictions) {
+	loads.clear();
+	evictions.clear();
+
+	// Niveles que pueden salir, de la textura usada hace ms tiempo a la ms reciente; en cada
+	// textura los mips van del ms detallado al menos, as que siempre se expulsa desde arriba
+	struct Evictable {
+		unsigned int entry;
+		unsigned int mip;
+		unsigned long long bytes;
+		unsigned long long lastUsedFrame;
+	};
+	std::vector<Evictable> evictable;
+	unsigned long long evictableBytes = 0;
+	for (unsigned int i = 0; i < m_entries.size(); ++i) {
+		const Entry& entry = m_entries[i];
+		if (entry.loadingMip != entry.residentMip) {
+			continue;
+		}
+		for (unsigned int mip = entry.residentMip; mip < keepMip(entry); ++mip) {
+			unsigned long long bytes = entry.bytesFrom[mip] - entry.bytesFrom[mip + 1];
+			evictable.push_back({ i, mip, bytes, entry.lastUsedFrame });
+			evictableBytes += bytes;
+		}
+	}
+	std::stable_sort(evictable.begin(), evictable.end(), [](const Evictable& a, const Evictable& b) {
+		return a.lastUsedFrame != b.lastUsedFrame ? a.lastUsedFrame < b.lastUsedFrame : a.bytes > b.bytes;
+	});
+
+	size_t nextEvictable = 0;
+	std::vector<unsigned int> evicted;
+	auto makeRoom = [&](unsigned long long bytes) {
+		while (m_residentBytes + bytes > m_budget && nextEvictable < evictable.size()) {
+			const Evictable& item = evictable[nextEvictable++];
+			Entry& entry = m_entries[item.entry];
+			if (std::find(evicted.begin(), evicted.end(), item.entry) == evicted.end()) {
+				evicted.push_back(item.entry);
+			}
+			entry.residentMip = item.mip + 1;
+			entry.loadingMip = item.mip + 1;
+			m_residentBytes -= item.bytes;
+			evictableBytes -= item.bytes;
+			m_stats.evictions++;
+			m_stats.evictedBytes += item.bytes;
+		}
+	};
+	// Si el presupuesto baj, se expulsa aunque no haya cargas
+	makeRoom(0);
+
+	// El mayor dficit primero; a igual dficit, la textura ms grande en pantalla
+	std::vector<unsigned int> candidates;
+	for (unsigned int i = 0; i < m_entries.size(); ++i) {
+		const Entry& entry = m_entries[i];
+		if (entry.lastUsedFrame == m_frame && entry.loadingMip == entry.residentMip &&
+			entry.requestedMip < entry.residentMip) {
+			candidates.push_back(i);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [this](unsigned int a, unsigned int b) {
+		const Entry& first = m_entries[a];
+		const Entry& second = m_entries[b];
+		unsigned int firstDeficit = first.residentMip - first.requestedMip;
+		unsigned int secondDeficit = second.residentMip - second.requestedMip;
+		return firstDeficit != secondDeficit ? firstDeficit > secondDeficit : first.screenSize > second.screenSize;
+	});
+
+	for (unsigned int index : candidates) {
+		Entry& entry = m_entries[index];
+		if (m_loadsInFlight >= m_maxLoadsInFlight) {
+			m_stats.deferredLoads++;
+			continue;
+		}
+		// Si el mip pedido no cabe ni expulsando todo lo posible, se intenta uno menos detallado
+		unsigned int target = entry.requestedMip;
+		while (target < entry.residentMip &&
+			m_residentBytes + (entry.bytesFrom[target] - entry.bytesFrom[entry.residentMip]) > m_budget + evictableBytes) {
+			target++;
+		}
+		if (target == entry.residentMip) {
+			m_stats.deferredLoads++;
+			continue;
+		}
+		unsigned long long bytes = entry.bytesFrom[target] - entry.bytesFrom[entry.residentMip];
+		makeRoom(bytes);
+		entry.loadingMip = target;
+		m_residentBytes += bytes;
+		m_loadsInFlight++;
+		loads.push_back({ index + 1, target });
+	}
+
+	for (unsigned int index : evicted) {
+		evictions.push_back({ index + 1, m_entries[index].residentMip });
+	}
+	if (m_residentBytes > m_budget) {
+		m_stats.overBudgetFrames++;
+	}
+	m_frame++;
+}
+
+void
+TextureResidency::completeLoad(unsigned int handle, bool succeeded) {
+	if (handle == kInvalidHandle || handle > m_entries.size()) {
+		return;
+	}
+	Entry& entry = m_entries[handle - 1];
+	if (entry.loadingMip == entry.residentMip) {
+		ERROR("TextureResidency", "completeLoad", ("Texture " + std::to_string(handle) + " has no load in flight").c_str());
+		return;
+	}
+	unsigned long long bytes = entry.bytesFrom[entry.loadingMip] - entry.bytesFrom[entry.residentMip];
+	if (succeeded) {
+		entry.residentMip = entry.loadingMip;
+		m_stats.loads++;
+		m_stats.loadedBytes += bytes;
+	}
+	else {
+		entry.loadingMip = entry.residentMip;
+		m_residentBytes -= bytes;
+		m_stats.failedLoads++;
+	}
+	m_loadsInFlight--;
+}
+
+unsigned int
+TextureResidency::residentMip(unsigned int handle) const {
+	return handle != kInvalidHandle && handle <= m_entries.size() ? m_entries[handle - 1].residentMip : 0;
+}
+
+unsigned int
+TextureResidency::requestedMip(unsigned int handle) const {
+	return handle != kInvalidHandle && handle <= m_entries.size() ? m_entries[handle - 1].requestedMip : 0;
+}
+
+std::string
+TextureResidency::report() const {
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+	os << "Texture residency: " << m_entries.size() << " textures, " << (m_residentBytes / 1048576.0) << "/"
+		<< (m_budget / 1048576.0) << " MB resident, " << m_loadsInFlight << " loads in flight; "
+		<< m_stats.loads << " loads (" << (m_stats.loadedBytes / 1048576.0) << " MB), "
+		<< m_stats.failedLoads << " failed, " << m_stats.evictions << " mips evicted ("
+		<< (m_stats.evictedBytes / 1048576.0) << " MB), " << m_stats.deferredLoads << " deferred, "
+		<< m_stats.overBudgetFrames << " frames over budget\n";
+	return os.str();
+}
+
+unsigned int
+TextureResidency::mipForScreenSize(unsigned int width, unsigned int height, unsigned int mipLevels, float screenSize) {
+	if (mipLevels == 0) {
+		return 0;
+	}
+	if (screenSize <= 0.0f) {
+		return mipLevels - 1;
+	}
+	float texelsPerPixel = static_cast<float>((std::max)(width, height)) / screenSize;
+	if (texelsPerPixel <= 1.0f) {
+		return 0;
+	}
+	unsigned int mip = 0;
+	while (texelsPerPixel >= 2.0f && mip + 1 < mipLevels) {
+		texelsPerPixel *= 0.5f;
+		mip++;
+	}
+	return mip;
+}
+
+float
+TextureResidency::projectedSize(float radius, float distance, float fovY, float viewportHeight) {
+	// La cmara est dentro de la esfera: ocupa toda la pantalla
+	if (distance <= radius) {
+		return viewportHeight;
+	}
+	return radius / (distance * tanf(fovY * 0.5f)) * viewportHeight;
+}
+
+unsigned int
+TextureResidency::keepMip(const Entry& entry) const {
+	return entry.lastUsedFrame == m_frame ? entry.requestedMip : entry.tailMip;
+}
@@ -0,0 +1,304 @@
+#include "TextureStreamer.h"
+#include "Device.h"
+#include "DeviceContext.h"
+
+HRESULT
+TextureStreamer::init(Device& device,
+	unsigned long long budget,
+	ThreadPool* threadPool,
+	unsigned int tailSize,
+	unsigned int maxLoadsInFlight) {
+	if (!device.m_device) {
+		ERROR("TextureStreamer", "init", "Device is null.");
+		return E_POINTER;
+	}
+	if (tailSize == 0) {
+		ERROR("TextureStreamer", "init", "tailSize must be greater than 0");
+		return E_INVALIDARG;
+	}
+	destroy();
+	HRESULT hr = m_residency.init(budget, maxLoadsInFlight);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	m_threadPool = threadPool;
+	if (!m_threadPool) {
+		m_ownThreadPool.reset(new ThreadPool());
+		if (FAILED(m_ownThreadPool->init(maxLoadsInFlight))) {
+			ERROR("TextureStreamer", "init", "Failed to create reading threads");
+			m_ownThreadPool.reset();
+			m_residency.destroy();
+			return E_FAIL;
+		}
+		m_threadPool = m_ownThreadPool.get();
+	}
+	m_device = &device;
+	m_tailSize = tailSize;
+	return S_OK;
+}
+
+void
+TextureStreamer::update(DeviceContext& deviceContext) {
+	if (!m_device) {
+		return;
+	}
+	std::vector<CompletedLoad> completed;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		completed.swap(m_completed);
+	}
+	for (CompletedLoad& load : completed) {
+		StreamedTexture& texture = *m_textures[load.handle - 1];
+		HRESULT hr = recreate(deviceContext, texture, load.mip, load.data.data());
+		m_residency.completeLoad(load.handle, SUCCEEDED(hr));
+		m_readMilliseconds += load.milliseconds;
+	}
+
+	m_residency.schedule(m_loads, m_evictions);
+	for (const TextureResidencyChange& eviction : m_evictions) {
+		recreate(deviceContext, *m_textures[eviction.handle - 1], eviction.mip, nullptr);
+	}
+
+	// Mientras hay una lectura en vuelo la residencia no expulsa esa textura, as que topMip
+	// y los punteros al archivo no cambian hasta que update() entrega el resultado
+	for (const TextureResidencyChange& change : m_loads) {
+		StreamedTexture* texture = m_textures[change.handle - 1].get();
+		unsigned int handle = change.handle;
+		unsigned int mip = change.mip;
+		unsigned int topMip = texture->topMip;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_inFlight++;
+		}
+		m_threadPool->enqueue([this, texture, handle, mip, topMip]() {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			CompletedLoad load;
+			load.handle = handle;
+			load.mip = mip;
+			size_t bytes = 0;
+			for (unsigned int level = mip; level < topMip; ++level) {
+				bytes += texture->image.subresources[level].slicePitch;
+			}
+			// Copiar desde la vista del archivo es lo que lee del disco, fuera del hilo de render
+			load.data.resize(bytes);
+			unsigned char* destination = load.data.data();
+			for (unsigned int level = mip; level < topMip; ++level) {
+				const DDSSubresource& subresource = texture->image.subresources[level];
+				memcpy(destination, subresource.data, subresource.slicePitch);
+				destination += subresource.slicePitch;
+			}
+			load.milliseconds =
+				std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_completed.push_back(std::move(load));
+			m_inFlight--;
+			m_idle.notify_all();
+		});
+	}
+}
+
+void
+TextureStreamer::destroy() {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this]() { return m_inFlight == 0; });
+		m_completed.clear();
+	}
+	m_ownThreadPool.reset();
+	m_threadPool = nullptr;
+	for (std::unique_ptr<StreamedTexture>& texture : m_textures) {
+		texture->texture.destroy();
+	}
+	m_textures.clear();
+	m_residency.destroy();
+	m_loads.clear();
+	m_evictions.clear();
+	m_device = nullptr;
+	m_tailSize = 0;
+	m_readMilliseconds = 0.0;
+	m_recreations = 0;
+}
+
+unsigned int
+TextureStreamer::load(const std::string& fileName) {
+	if (!m_device) {
+		ERROR("TextureStreamer", "load", "TextureStreamer is not initialized.");
+		return TextureResidency::kInvalidHandle;
+	}
+	std::unique_ptr<StreamedTexture> texture(new StreamedTexture());
+	if (FAILED(texture->file.init(fileName))) {
+		return TextureResidency::kInvalidHandle;
+	}
+	DDSImage& image = texture->image;
+	if (FAILED(DDSLoader::parse(texture->file.data(), texture->file.size(), image))) {
+		ERROR("TextureStreamer", "load", ("Invalid DDS file " + fileName).c_str());
+		return TextureResidency::kInvalidHandle;
+	}
+	if (image.dimension != D3D11_RESOURCE_DIMENSION_TEXTURE2D || image.arraySize != 1 || image.cubeMap) {
+		ERROR("TextureStreamer", "load", ("Only simple 2D textures can be streamed: " + fileName).c_str());
+		return TextureResidency::kInvalidHandle;
+	}
+
+	unsigned int tailMip = 0;
+	while (tailMip + 1 < image.mipLevels &&
+		(std::max)(image.width >> tailMip, image.height >> tailMip) > m_tailSize) {
+		tailMip++;
+	}
+	// Direct3D 11 pide mltiplos de 4 en el nivel 0 de una textura por bloques
+	bool blockCompressed = (image.format >= DXGI_FORMAT_BC1_TYPELESS && image.format <= DXGI_FORMAT_BC5_SNORM) ||
+		(image.format >= DXGI_FORMAT_BC6H_TYPELESS && image.format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+	if (blockCompressed) {
+		unsigned int lastTop = 0;
+		while (lastTop < tailMip && ((image.width >> (lastTop + 1)) % 4) == 0 && ((image.height >> (lastTop + 1)) % 4) == 0 &&
+			(image.width >> (lastTop + 1)) > 0 && (image.height >> (lastTop + 1)) > 0) {
+			lastTop++;
+		}
+		tailMip = lastTop;
+	}
+
+	texture->texture.m_textureName = fileName;
+	HRESULT hr = createFromFile(*texture, tailMip);
+	if (FAILED(hr)) {
+		ERROR("TextureStreamer", "load",
+			("Failed to create texture from " + fileName + ". HRESULT: " + std::to_string(hr)).c_str());
+		return TextureResidency::kInvalidHandle;
+	}
+
+	std::vector<unsigned long long> levelBytes(image.mipLevels);
+	for (unsigned int level = 0; level < image.mipLevels; ++level) {
+		levelBytes[level] = image.subresources[level].slicePitch;
+	}
+	unsigned int handle = m_residency.add(image.width, image.height, levelBytes, tailMip);
+	if (handle == TextureResidency::kInvalidHandle) {
+		texture->texture.destroy();
+		return TextureResidency::kInvalidHandle;
+	}
+	m_textures.push_back(std::move(texture));
+	return handle;
+}
+
+ID3D11ShaderResourceView*
+TextureStreamer::view(unsigned int handle) const {
+	if (handle == TextureResidency::kInvalidHandle || handle > m_textures.size()) {
+		return nullptr;
+	}
+	return m_textures[handle - 1]->texture.m_textureFromImg;
+}
+
+std::string
+TextureStreamer::report() const {
+	std::ostringstream os;
+	os.setf(std::ios::fixed);
+	os.precision(2);
+	os << "Texture streamer: " << m_recreations << " texture swaps, " << m_readMilliseconds << " ms reading on "
+		<< (m_threadPool ? m_threadPool->size() : 0) << " threads\n";
+	os << m_residency.report();
+	return os.str();
+}
+
+HRESULT
+TextureStreamer::recreate(DeviceContext& deviceContext,
+	StreamedTexture& texture,
+	unsigned int mip,
+	const unsigned char* data) {
+	const DDSImage& image = texture.image;
+	D3D11_TEXTURE2D_DESC desc;
+	memset(&desc, 0, sizeof(desc));
+	desc.Width = (std::max)(1u, image.width >> mip);
+	desc.Height = (std::max)(1u, image.height >> mip);
+	desc.MipLevels = image.mipLevels - mip;
+	desc.ArraySize = 1;
+	desc.Format = image.format;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	ID3D11Texture2D* resource = nullptr;
+	HRESULT hr = m_device->CreateTexture2D(&desc, nullptr, &resource);
+	if (FAILED(hr)) {
+		ERROR("TextureStreamer", "recreate",
+			("Failed to create texture for " + texture.texture.m_textureName + ". HRESULT: " + std::to_string(hr)).c_str());
+		return hr;
+	}
+	ID3D11ShaderResourceView* view = nullptr;
+	hr = createView(texture, resource, &view);
+	if (FAILED(hr)) {
+		SAFE_RELEASE(resource);
+		return hr;
+	}
+
+	// Los niveles que siguen residentes no vuelven a leerse: se copian de la textura anterior
+	for (unsigned int level = (std::max)(mip, texture.topMip); level < image.mipLevels; ++level) {
+		deviceContext.CopySubresourceRegion(resource, level - mip, 0, 0, 0,
+			texture.texture.m_texture, level - texture.topMip, nullptr);
+	}
+	const unsigned char* source = data;
+	for (unsigned int level = mip; level < texture.topMip && source; ++level) {
+		const DDSSubresource& subresource = image.subresources[level];
+		deviceContext.UpdateSubresource(resource, level - mip, nullptr, source, subresource.rowPitch, subresource.slicePitch);
+		source += subresource.slicePitch;
+	}
+
+	std::string name = texture.texture.m_textureName;
+	texture.texture.destroy();
+	texture.texture.m_texture = resource;
+	texture.texture.m_textureFromImg = view;
+	texture.texture.m_textureName = name;
+	texture.topMip = mip;
+	m_recreations++;
+	return S_OK;
+}
+
+HRESULT
+TextureStreamer::createFromFile(StreamedTexture& texture, unsigned int mip) {
+	const DDSImage& image = texture.image;
+	D3D11_TEXTURE2D_DESC desc;
+	memset(&desc, 0, sizeof(desc));
+	desc.Width = (std::max)(1u, image.width >> mip);
+	desc.Height = (std::max)(1u, image.height >> mip);
+	desc.MipLevels = image.mipLevels - mip;
+	desc.ArraySize = 1;
+	desc.Format = image.format;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	std::vector<D3D11_SUBRESOURCE_DATA> initialData(desc.MipLevels);
+	for (unsigned int level = 0; level < desc.MipLevels; ++level) {
+		const DDSSubresource& subresource = image.subresources[mip + level];
+		initialData[level].pSysMem = subresource.data;
+		initialData[level].SysMemPitch = subresource.rowPitch;
+		initialData[level].SysMemSlicePitch = subresource.slicePitch;
+	}
+	ID3D11Texture2D* resource = nullptr;
+	HRESULT hr = m_device->CreateTexture2D(&desc, initialData.data(), &resource);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	ID3D11ShaderResourceView* view = nullptr;
+	hr = createView(texture, resource, &view);
+	if (FAILED(hr)) {
+		SAFE_RELEASE(resource);
+		return hr;
+	}
+	texture.texture.m_texture = resource;
+	texture.texture.m_textureFromImg = view;
+	texture.topMip = mip;
+	return S_OK;
+}
+
+HRESULT
+TextureStreamer::createView(StreamedTexture& texture, ID3D11Texture2D* resource, ID3D11ShaderResourceView** view) {
+	D3D11_TEXTURE2D_DESC desc;
+	resource->GetDesc(&desc);
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = desc.Format;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MipLevels = desc.MipLevels;
+	HRESULT hr = m_device->CreateShaderResourceView(resource, &srvDesc, view);
+	if (FAILED(hr)) {
+		ERROR("TextureStreamer", "createView",
+			("Failed to create shader resource view for " + texture.texture.m_textureName + ". HRESULT: " + std::to_string(hr)).c_str());
+	}
+	return hr;
+}
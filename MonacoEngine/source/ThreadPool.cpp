@@ -0,0 +1,123 @@
+#include "ThreadPool.h"
+
+HRESULT
+ThreadPool::init(unsigned int numThreads) {
+	if (!m_workers.empty()) {
+		ERROR("ThreadPool", "init", "ThreadPool is already initialized.");
+		return E_FAIL;
+	}
+	if (numThreads == 0) {
+		numThreads = std::thread::hardware_concurrency();
+		if (numThreads == 0) {
+			numThreads = 1;
+		}
+	}
+
+	m_stopping = false;
+	m_workers.reserve(numThreads);
+	for (unsigned int i = 0; i < numThreads; ++i) {
+		m_workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+	return S_OK;
+}
+
+void
+ThreadPool::destroy() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_taskAvailable.notify_all();
+
+	for (std::thread& worker : m_workers) {
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+	m_workers.clear();
+}
+
+void
+ThreadPool::enqueue(std::function<void()> task) {
+	if (m_workers.empty()) {
+		task();
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+	}
+	m_taskAvailable.notify_one();
+}
+
+void
+ThreadPool::parallelFor(unsigned int count, const std::function<void(unsigned int)>& body) {
+	if (count == 0) {
+		return;
+	}
+
+	// Estado compartido: un ayudante que arranque tarde solo toca este bloque, nunca @p body
+	struct ForState {
+		std::atomic<unsigned int> next{ 0 };
+		std::atomic<unsigned int> done{ 0 };
+		std::mutex mutex;
+		std::condition_variable signal;
+	};
+	std::shared_ptr<ForState> state = std::make_shared<ForState>();
+	const std::function<void(unsigned int)>* task = &body;
+
+	auto run = [state, task, count]() {
+		unsigned int finished = 0;
+		for (unsigned int i = state->next.fetch_add(1); i < count; i = state->next.fetch_add(1)) {
+			(*task)(i);
+			++finished;
+		}
+		if (finished > 0 && state->done.fetch_add(finished) + finished == count) {
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->signal.notify_all();
+		}
+	};
+
+	// Un ayudante por hilo (sin exceder las iteraciones); el hilo que llama tambin participa
+	unsigned int helpers = (std::min)(size(), count - 1);
+	for (unsigned int i = 0; i < helpers; ++i) {
+		enqueue(run);
+	}
+	run();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->signal.wait(lock, [&state, count]() { return state->done.load() == count; });
+}
+
+void
+ThreadPool::wait() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idle.wait(lock, [this]() { return m_tasks.empty() && m_activeTasks == 0; });
+}
+
+void
+ThreadPool::workerLoop() {
+	for (;;) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_taskAvailable.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+			if (m_tasks.empty()) {
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+			m_activeTasks++;
+		}
+
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_activeTasks--;
+			if (m_tasks.empty() && m_activeTasks == 0) {
+				m_idle.notify_all();
+			}
+		}
+	}
+}
@@ -0,0 +1,284 @@
+#include "UploadManager.h"
+#include "Device.h"
+#include "DeviceContext.h"
+
+HRESULT
+UploadManager::init(Device& device, unsigned int budgetPerFrame, unsigned int framesInFlight) {
+	if (!device.m_device) {
+		ERROR("UploadManager", "init", "Device is null.");
+		return E_POINTER;
+	}
+	if (framesInFlight == 0) {
+		ERROR("UploadManager", "init", "framesInFlight must be non-zero");
+		return E_INVALIDARG;
+	}
+	destroy();
+
+	HRESULT hr = m_queue.init(budgetPerFrame);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.ByteWidth = budgetPerFrame;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	m_pages.resize(framesInFlight, nullptr);
+	for (ID3D11Buffer*& page : m_pages) {
+		hr = device.CreateBuffer(&desc, nullptr, &page);
+		if (FAILED(hr)) {
+			ERROR("UploadManager", "init", "Failed to create staging page");
+			destroy();
+			return hr;
+		}
+	}
+
+	D3D11_QUERY_DESC queryDesc = {};
+	queryDesc.Query = D3D11_QUERY_EVENT;
+	m_fences.resize(framesInFlight, nullptr);
+	for (ID3D11Query*& fence : m_fences) {
+		hr = device.CreateQuery(&queryDesc, &fence);
+		if (FAILED(hr)) {
+			ERROR("UploadManager", "init", "Failed to create fence query");
+			destroy();
+			return hr;
+		}
+	}
+	return S_OK;
+}
+
+void
+UploadManager::update(DeviceContext& deviceContext) {
+	if (m_pages.empty() || !deviceContext.m_deviceContext) {
+		return;
+	}
+	pollFences(deviceContext);
+	if (m_queue.pendingBytes() == 0) {
+		return;
+	}
+	if (nextPageBusy()) {
+		m_busyFrames++;
+		return;
+	}
+	submit(deviceContext);
+}
+
+void
+UploadManager::destroy() {
+	for (std::pair<const unsigned int, Upload>& upload : m_uploads) {
+		SAFE_RELEASE(upload.second.destination);
+	}
+	for (ID3D11Buffer*& page : m_pages) {
+		SAFE_RELEASE(page);
+	}
+	for (ID3D11Query*& fence : m_fences) {
+		SAFE_RELEASE(fence);
+	}
+	m_uploads.clear();
+	m_pages.clear();
+	m_fences.clear();
+	m_chunks.clear();
+	m_queue.destroy();
+	m_frame = 0;
+	m_completedFrame = 0;
+	m_busyFrames = 0;
+}
+
+unsigned int
+UploadManager::uploadBuffer(ID3D11Buffer* destination,
+	unsigned int dstOffset,
+	const void* data,
+	unsigned int size,
+	UploadCallback callback) {
+	if (m_pages.empty()) {
+		ERROR("UploadManager", "uploadBuffer", "UploadManager is not initialized.");
+		return 0;
+	}
+	if (!destination || !data || size == 0) {
+		ERROR("UploadManager", "uploadBuffer", "Invalid destination or data");
+		return 0;
+	}
+	unsigned int ticket = m_queue.push(size);
+	if (ticket == 0) {
+		return 0;
+	}
+
+	Upload& upload = m_uploads[ticket];
+	upload.destination = destination;
+	upload.destination->AddRef();
+	upload.dstOffset = dstOffset;
+	upload.data.assign(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + size);
+	upload.callback = callback;
+	return ticket;
+}
+
+unsigned int
+UploadManager::uploadTexture(ID3D11Resource* destination,
+	unsigned int subresource,
+	const D3D11_BOX& box,
+	const void* data,
+	unsigned int rowPitch,
+	UploadCallback callback) {
+	if (!data || box.bottom <= box.top) {
+		ERROR("UploadManager", "uploadTexture", "Invalid destination, data or box");
+		return 0;
+	}
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	std::vector<unsigned char> copy(bytes, bytes + static_cast<size_t>(rowPitch) * (box.bottom - box.top));
+	return uploadTexture(destination, subresource, box, std::move(copy), rowPitch, callback);
+}
+
+unsigned int
+UploadManager::uploadTexture(ID3D11Resource* destination,
+	unsigned int subresource,
+	const D3D11_BOX& box,
+	std::vector<unsigned char>&& data,
+	unsigned int rowPitch,
+	UploadCallback callback) {
+	if (m_pages.empty()) {
+		ERROR("UploadManager", "uploadTexture", "UploadManager is not initialized.");
+		return 0;
+	}
+	if (!destination || data.empty() || rowPitch == 0 || box.bottom <= box.top || box.right <= box.left ||
+		box.front != 0 || box.back != 1) {
+		ERROR("UploadManager", "uploadTexture", "Invalid destination, data or box");
+		return 0;
+	}
+	unsigned int size = rowPitch * (box.bottom - box.top);
+	if (data.size() != size) {
+		ERROR("UploadManager", "uploadTexture", "Data size does not match the box");
+		return 0;
+	}
+	// Cortes por filas completas para que cada banda sea una regin vlida
+	unsigned int ticket = m_queue.push(size, rowPitch);
+	if (ticket == 0) {
+		return 0;
+	}
+
+	Upload& upload = m_uploads[ticket];
+	upload.destination = destination;
+	upload.destination->AddRef();
+	upload.texture = true;
+	upload.subresource = subresource;
+	upload.box = box;
+	upload.rowPitch = rowPitch;
+	upload.data = std::move(data);
+	upload.callback = callback;
+	return ticket;
+}
+
+void
+UploadManager::flush(DeviceContext& deviceContext) {
+	if (m_pages.empty() || !deviceContext.m_deviceContext) {
+		return;
+	}
+	pollFences(deviceContext);
+	while (m_queue.pendingBytes() > 0) {
+		if (nextPageBusy()) {
+			// Esperar a la pgina ms antigua; GetData sin DONOTFLUSH enva el trabajo a la GPU
+			ID3D11Query* fence = m_fences[(m_completedFrame + 1) % m_fences.size()];
+			while (deviceContext.GetData(fence, nullptr, 0, 0) == S_FALSE) {
+				std::this_thread::yield();
+			}
+			pollFences(deviceContext);
+			if (nextPageBusy()) {
+				ERROR("UploadManager", "flush", "Staging page did not complete");
+				return;
+			}
+		}
+		submit(deviceContext);
+	}
+}
+
+std::string
+UploadManager::report() const {
+	const UploadQueueStats& stats = m_queue.m_stats;
+	std::ostringstream os;
+	os << "Upload manager: " << stats.requests << " uploads, " << stats.completed << " completed, "
+		<< stats.bytes << " bytes in " << stats.chunks << " chunks, "
+		<< stats.budgetFrames << " frames at budget, " << m_busyFrames << " frames waiting for staging\n";
+	return os.str();
+}
+
+void
+UploadManager::submit(DeviceContext& deviceContext) {
+	m_queue.schedule(m_chunks);
+	if (m_chunks.empty()) {
+		return;
+	}
+	unsigned long long fence = m_frame + 1;
+	ID3D11Buffer* page = m_pages[fence % m_pages.size()];
+
+	// Primero todos los chunks de buffers a la pgina, con un solo Map
+	bool hasBufferChunks = false;
+	for (const UploadChunk& chunk : m_chunks) {
+		hasBufferChunks |= !m_uploads[chunk.request].texture;
+	}
+	if (hasBufferChunks) {
+		D3D11_MAPPED_SUBRESOURCE mapped = {};
+		// El fence de la pgina ya se seal, as que D3D11_MAP_WRITE no espera a la GPU
+		HRESULT hr = deviceContext.Map(page, 0, D3D11_MAP_WRITE, 0, &mapped);
+		if (FAILED(hr)) {
+			ERROR("UploadManager", "submit",
+				("Failed to map staging page. HRESULT: " + std::to_string(hr)).c_str());
+			return;
+		}
+		unsigned char* staging = static_cast<unsigned char*>(mapped.pData);
+		for (const UploadChunk& chunk : m_chunks) {
+			const Upload& upload = m_uploads[chunk.request];
+			if (!upload.texture) {
+				memcpy(staging + chunk.stagingOffset, upload.data.data() + chunk.offset, chunk.size);
+			}
+		}
+		deviceContext.Unmap(page, 0);
+	}
+
+	for (const UploadChunk& chunk : m_chunks) {
+		const Upload& upload = m_uploads[chunk.request];
+		if (upload.texture) {
+			D3D11_BOX box = upload.box;
+			box.top = upload.box.top + chunk.offset / upload.rowPitch;
+			box.bottom = box.top + chunk.size / upload.rowPitch;
+			deviceContext.UpdateSubresource(upload.destination, upload.subresource, &box,
+				upload.data.data() + chunk.offset, upload.rowPitch, 0);
+		}
+		else {
+			D3D11_BOX box = { chunk.stagingOffset, 0, 0, chunk.stagingOffset + chunk.size, 1, 1 };
+			deviceContext.CopySubresourceRegion(upload.destination, 0, upload.dstOffset + chunk.offset, 0, 0,
+				page, 0, &box);
+		}
+	}
+
+	m_frame = fence;
+	m_queue.endFrame(fence);
+	deviceContext.End(m_fences[fence % m_fences.size()]);
+}
+
+void
+UploadManager::pollFences(DeviceContext& deviceContext) {
+	unsigned long long frameCount = m_fences.size();
+	while (m_completedFrame < m_frame) {
+		ID3D11Query* fence = m_fences[(m_completedFrame + 1) % frameCount];
+		if (deviceContext.GetData(fence, nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) {
+			break;
+		}
+		m_completedFrame++;
+	}
+
+	// Copia local: un callback puede volver a entrar con flush()
+	std::vector<unsigned int> completed;
+	m_queue.retire(m_completedFrame, completed);
+	for (unsigned int ticket : completed) {
+		std::unordered_map<unsigned int, Upload>::iterator it = m_uploads.find(ticket);
+		if (it == m_uploads.end()) {
+			continue;
+		}
+		// Sacar la subida antes del callback por si este encola otra
+		Upload upload = std::move(it->second);
+		m_uploads.erase(it);
+		if (upload.callback) {
+			upload.callback(ticket);
+		}
+		SAFE_RELEASE(upload.destination);
+	}
+}
@@ -0,0 +1,97 @@
+#include "UploadQueue.h"
+
+HRESULT
+UploadQueue::init(unsigned int budget, unsigned int alignment) {
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		ERROR("UploadQueue", "init", "alignment must be a power of two");
+		return E_INVALIDARG;
+	}
+	if (budget < alignment) {
+		ERROR("UploadQueue", "init", "budget must be at least one alignment unit");
+		return E_INVALIDARG;
+	}
+	destroy();
+	m_budget = budget;
+	m_alignment = alignment;
+	return S_OK;
+}
+
+void
+UploadQueue::destroy() {
+	m_requests.clear();
+	m_scheduledCount = 0;
+	m_pendingBytes = 0;
+	m_budget = 0;
+	m_alignment = 0;
+	m_stats = UploadQueueStats();
+}
+
+unsigned int
+UploadQueue::push(unsigned int size, unsigned int granularity) {
+	if (m_budget == 0) {
+		ERROR("UploadQueue", "push", "Queue is not initialized.");
+		return 0;
+	}
+	if (size == 0 || granularity == 0 || size % granularity != 0) {
+		ERROR("UploadQueue", "push", "size must be a non-zero multiple of granularity");
+		return 0;
+	}
+	unsigned int id = m_nextId++;
+	m_requests.push_back({ id, size, granularity, 0, 0 });
+	m_pendingBytes += size;
+	m_stats.requests++;
+	return id;
+}
+
+void
+UploadQueue::schedule(std::vector<UploadChunk>& chunks) {
+	chunks.clear();
+	unsigned int used = 0;
+	for (size_t i = m_scheduledCount; i < m_requests.size(); ++i) {
+		Request& request = m_requests[i];
+		while (request.scheduled < request.size) {
+			unsigned int remaining = request.size - request.scheduled;
+			unsigned int size = (std::min)(remaining, used < m_budget ? m_budget - used : 0u);
+			size -= size % request.granularity;
+			if (size == 0) {
+				if (!chunks.empty()) {
+					// Presupuesto agotado; el resto sale en los prximos frames
+					m_stats.budgetFrames++;
+					return;
+				}
+				size = request.granularity;
+			}
+			chunks.push_back({ request.id, request.scheduled, size, used });
+			request.scheduled += size;
+			used += (size + m_alignment - 1) & ~(m_alignment - 1);
+			m_pendingBytes -= size;
+			m_stats.bytes += size;
+			m_stats.chunks++;
+		}
+		m_scheduledCount++;
+	}
+}
+
+void
+UploadQueue::endFrame(unsigned long long fence) {
+	for (size_t i = 0; i < m_scheduledCount; ++i) {
+		if (m_requests[i].fence == 0) {
+			m_requests[i].fence = fence;
+		}
+	}
+}
+
+void
+UploadQueue::retire(unsigned long long completedFence, std::vector<unsigned int>& completed) {
+	while (m_scheduledCount > 0) {
+		const Request& request = m_requests.front();
+		if (request.fence == 0 || request.fence > completedFence) {
+			break;
+		}
+		completed.push_back(request.id);
+		m_lastCompleted = request.id;
+		m_requests.pop_front();
+		m_scheduledCount--;
+		m_stats.completed++;
+	}
+}